@@ -1,3 +1,4 @@
+@[has_globals]
 module testing
 
 import os
@@ -384,7 +385,7 @@ pub fn (mut ts TestSession) test() {
 		njobs = remaining_files.len
 	}
 	ts.benchmark.njobs = njobs
-	mut pool_of_test_runners := pool.new_pool_processor(callback: worker_trunner)
+	mut pool_of_test_runners := g_test_runners
 	// ensure that the nmessages queue/channel, has enough capacity for handling many messages across threads, without blocking
 	ts.nmessages = chan LogMessage{cap: 10000}
 	ts.nmessage_idx = 0
@@ -415,6 +416,10 @@ pub fn (mut ts TestSession) test() {
 	}
 }
 
+// g_test_runners is shared by all the test sessions of the process (some tools, like
+// `v build-examples`, run several), so that its threads are started only once
+__global g_test_runners = pool.new_pool_processor(callback: worker_trunner, persistent: true)
+
 fn worker_trunner(mut p pool.PoolProcessor, idx int, thread_id int) voidptr {
 	mut ts := unsafe { &TestSession(p.get_shared_context()) }
 	if ts.fail_fast {
@@ -0,0 +1,79 @@
+module main
+
+import arrays.parallel
+import benchmark
+import math
+import os
+import rand
+
+// Usage: v -prod run vlib/arrays/parallel/bench/bench_parallel_vs_sequential.v [n]
+// Compares the functions in arrays.parallel with their sequential equivalents,
+// on a numeric array with `n` elements (10_000_000 by default).
+
+fn work(x f64) f64 {
+	return math.sqrt(x) * math.sin(x)
+}
+
+fn main() {
+	n := if os.args.len > 1 { os.args[1].int() } else { 10_000_000 }
+	input := []f64{len: n, init: f64(index)}
+	println('n: ${n}')
+
+	mut clock := benchmark.start()
+	smapped := input.map(work(it))
+	clock.measure('sequential map')
+	pmapped := parallel.amap(input, work)
+	clock.measure('parallel.amap')
+	assert smapped == pmapped
+
+	mut ssum := 0.0
+	for x in smapped {
+		ssum += x
+	}
+	clock.measure('sequential sum')
+	psum := parallel.reduce(smapped, 0.0, fn (acc f64, x f64) f64 {
+		return acc + x
+	})
+	clock.measure('parallel.reduce sum')
+	println('   sums: ${ssum} ${psum}')
+
+	sfiltered := smapped.filter(it > 0)
+	clock.measure('sequential filter')
+	pfiltered := parallel.filter(smapped, fn (x f64) bool {
+		return x > 0
+	})
+	clock.measure('parallel.filter')
+	assert sfiltered == pfiltered
+
+	mut counts := []int{len: n}
+	for i in 0 .. n {
+		counts[i] = int(input[i]) % 7
+	}
+	clock.measure('sequential loop')
+	mut pcounts := &counts
+	parallel.for_range(n, fn [input, mut pcounts] (lo int, hi int) {
+		for i in lo .. hi {
+			unsafe {
+				pcounts[i] = int(input[i]) % 7
+			}
+		}
+	})
+	clock.measure('parallel.for_range loop')
+
+	mut sa := []int{len: n, init: rand.int()}
+	mut pa := sa.clone()
+	clock.measure('generating the random ints')
+	sa.sort()
+	clock.measure('sequential sort')
+	parallel.sort(mut pa, fn (x &int, y &int) int {
+		return if *x < *y {
+			-1
+		} else if *x > *y {
+			1
+		} else {
+			0
+		}
+	})
+	clock.measure('parallel.sort')
+	assert sa == pa
+}
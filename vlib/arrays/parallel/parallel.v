@@ -1,13 +1,22 @@
 module parallel
 
-import sync
 import runtime
+import sync.stdatomic
 
-// Params contains the optional parameters that can be passed to `run` and `amap`.
+// chunks_per_worker is the number of chunks, that each worker gets on average, when the
+// grain size is chosen automatically. More chunks balance the load better, when the items
+// take different amounts of time to process, at the cost of more atomic operations.
+const chunks_per_worker = 8
+
+// min_parallel_sort_len is the length, below which `sort` just sorts in the calling thread.
+const min_parallel_sort_len = 4096
+
+// Params contains the optional parameters that can be passed to `run`, `amap` and the other functions in this module.
 @[params]
 pub struct Params {
 pub mut:
 	workers int // 0 by default, so that VJOBS will be used, through runtime.nr_jobs()
+	grain   int // the number of items processed at once by a worker; 0 by default, so that it will be chosen based on the input length
 }
 
 fn limited_workers(max_workers int, ilen int) int {
@@ -19,6 +28,50 @@ fn limited_workers(max_workers int, ilen int) int {
 	return workers
 }
 
+fn grain_size(grain int, ilen int, workers int) int {
+	if grain > 0 {
+		return grain
+	}
+	g := ilen / (workers * chunks_per_worker)
+	return if g > 0 { g } else { 1 }
+}
+
+// for_range splits the range [0, n) in chunks of `grain` items, and calls `worker(lo, hi)`
+// for each chunk [lo, hi) in parallel. The chunks start at multiples of the grain size.
+// The worker threads take the next chunk from a shared atomic counter, so there is no
+// channel operation or allocation per item.
+// Example: parallel.for_range(a.len, fn [mut pa] (lo int, hi int) { for i in lo .. hi { unsafe { pa[i] *= 2 } } })
+pub fn for_range(n int, worker fn (lo int, hi int), opt Params) {
+	if n <= 0 {
+		return
+	}
+	workers := limited_workers(opt.workers, n)
+	grain := grain_size(opt.grain, n, workers)
+	mut next := stdatomic.new_atomic(0)
+	if workers <= 1 || grain >= n {
+		process_chunks(n, grain, worker, mut next)
+		return
+	}
+	mut threads := []thread{cap: workers - 1}
+	for _ in 1 .. workers {
+		threads << spawn process_chunks(n, grain, worker, mut next)
+	}
+	// the calling thread works too, instead of just waiting:
+	process_chunks(n, grain, worker, mut next)
+	threads.wait()
+}
+
+fn process_chunks(n int, grain int, worker fn (lo int, hi int), mut next stdatomic.AtomicVal[int]) {
+	for {
+		lo := next.add(grain)
+		if lo >= n {
+			break
+		}
+		hi := if n - lo > grain { lo + grain } else { n }
+		worker(lo, hi)
+	}
+}
+
 // run lets the user run an array of input with a user provided function in parallel.
 // It limits the number of worker threads to min(num_workers, num_cpu).
 // The function aborts if an error is encountered.
@@ -27,34 +80,11 @@ pub fn run[T](input []T, worker fn (T), opt Params) {
 	if input.len == 0 {
 		return
 	}
-	workers := limited_workers(opt.workers, input.len)
-	ch := chan T{cap: workers * 2}
-	mut wg := sync.new_waitgroup()
-	wg.add(input.len)
-	for _ in 0 .. workers {
-		spawn fn [ch, worker, mut wg] [T]() {
-			for {
-				task := <-ch or { break }
-				worker(task)
-				wg.done()
-			}
-		}()
-	}
-
-	// put the input into the channel
-	for i in input {
-		ch <- i
-	}
-
-	// wait for all tasks to complete
-	wg.wait()
-	ch.close() // this will signal all the workers to exit, and we can return, without having to wait for them to finish
-}
-
-struct Task[T, R] {
-	idx    int
-	input  T
-	result R
+	for_range(input.len, fn [input, worker] [T](lo int, hi int) {
+		for i in lo .. hi {
+			worker(input[i])
+		}
+	}, opt)
 }
 
 // amap lets the user run an array of input with a user provided function in parallel.
@@ -66,44 +96,159 @@ pub fn amap[T, R](input []T, worker fn (T) R, opt Params) []R {
 	if input.len == 0 {
 		return []
 	}
-	mut tasks := []Task[T, R]{len: input.len}
-	// the tasks array will be passed to the closure of each worker by reference, so that it could
-	// then modify the same tasks:
-	mut tasks_ref := &tasks
+	mut results := unsafe { []R{len: input.len} }
+	// the results array will be passed to the closure by reference, so that each worker
+	// could write its results directly in their places:
+	mut results_ref := &results
+	for_range(input.len, fn [input, worker, mut results_ref] [T, R](lo int, hi int) {
+		for i in lo .. hi {
+			unsafe {
+				results_ref[i] = worker(input[i])
+			}
+		}
+	}, opt)
+	return results
+}
+
+// reduce combines all the elements of `input` with `reducer` in parallel, starting with `init`.
+// Each worker reduces its chunks separately, then the partial results are combined in order,
+// so `reducer` should be associative, but does not have to be commutative.
+// Example: sum := parallel.reduce([1, 2, 3, 4, 5], 0, |acc, x| acc + x); assert sum == 15
+pub fn reduce[T](input []T, init T, reducer fn (acc T, elem T) T, opt Params) T {
+	if input.len == 0 {
+		return init
+	}
+	workers := limited_workers(opt.workers, input.len)
+	grain := grain_size(opt.grain, input.len, workers)
+	mut partials := unsafe { []T{len: (input.len + grain - 1) / grain} }
+	mut partials_ref := &partials
+	for_range(input.len, fn [input, reducer, grain, mut partials_ref] [T](lo int, hi int) {
+		mut acc := input[lo]
+		for i in lo + 1 .. hi {
+			acc = reducer(acc, input[i])
+		}
+		unsafe {
+			partials_ref[lo / grain] = acc
+		}
+	}, workers: workers, grain: grain)
+	mut acc := init
+	for p in partials {
+		acc = reducer(acc, p)
+	}
+	return acc
+}
 
+// filter returns a new array, containing only the elements of `input`, for which `predicate`
+// returned true. The predicate is called in parallel, but the result keeps the input order.
+// Example: evens := parallel.filter([1, 2, 3, 4, 5], |x| x % 2 == 0); assert evens == [2, 4]
+pub fn filter[T](input []T, predicate fn (elem T) bool, opt Params) []T {
+	if input.len == 0 {
+		return []
+	}
 	workers := limited_workers(opt.workers, input.len)
-	// use a buffered channel for transfering the tasks, that has enough space to keep all the workers busy,
-	// without blocking the main thread needlessly
-	ch := chan Task[T, R]{cap: workers * 2}
-	mut wg := sync.new_waitgroup()
-	wg.add(input.len)
-	for _ in 0 .. workers {
-		spawn fn [ch, worker, mut wg, mut tasks_ref] [T, R]() {
-			for {
-				mut task := <-ch or { break }
-				unsafe {
-					tasks_ref[task.idx] = Task[T, R]{
-						idx:    task.idx
-						input:  task.input
-						result: worker(task.input)
-					}
-				}
-				wg.done()
+	grain := grain_size(opt.grain, input.len, workers)
+	mut parts := [][]T{len: (input.len + grain - 1) / grain}
+	mut parts_ref := &parts
+	for_range(input.len, fn [input, predicate, grain, mut parts_ref] [T](lo int, hi int) {
+		mut kept := []T{}
+		for i in lo .. hi {
+			if predicate(input[i]) {
+				kept << input[i]
 			}
-		}()
+		}
+		unsafe {
+			parts_ref[lo / grain] = kept
+		}
+	}, workers: workers, grain: grain)
+	mut total := 0
+	for p in parts {
+		total += p.len
 	}
+	mut res := []T{cap: total}
+	for p in parts {
+		res << p
+	}
+	return res
+}
 
-	// put the input into the channel
-	for idx, inp in input {
-		ch <- Task[T, R]{
-			idx:   idx
-			input: inp
+// sort sorts `input` in place, using `cmp`, that should return a negative number, 0, or
+// a positive number, when its first argument is less than, equal to, or greater than its second.
+// The array is split in one run per worker, the runs are sorted in parallel, and then the
+// neighbouring runs are merged in parallel, until only one is left. The sort is stable: the runs
+// are sorted with `sort_stable_with_compare`, and the merges keep the order of equal elements.
+// Example: parallel.sort(mut a, fn (x &int, y &int) int { return *x - *y })
+pub fn sort[T](mut input []T, cmp fn (a &T, b &T) int, opt Params) {
+	n := input.len
+	workers := limited_workers(opt.workers, n)
+	if workers <= 1 || n < min_parallel_sort_len {
+		input.sort_stable_with_compare(cmp)
+		return
+	}
+	mut runs := []int{len: workers + 1, init: int(i64(n) * i64(index) / i64(workers))}
+	mut psrc := unsafe { &input }
+	for_range(workers, fn [psrc, runs, cmp] [T](lo int, hi int) {
+		mut all := unsafe { *psrc }
+		for r in lo .. hi {
+			mut run := all[runs[r]..runs[r + 1]]
+			run.sort_stable_with_compare(cmp)
+		}
+	}, workers: workers, grain: 1)
+	mut tmp := unsafe { []T{len: n} }
+	mut pdst := &tmp
+	mut in_tmp := false
+	for runs.len > 2 {
+		npairs := runs.len / 2
+		last := runs.len - 1
+		for_range(npairs, fn [psrc, pdst, runs, last, cmp] [T](lo int, hi int) {
+			src := unsafe { *psrc }
+			mut dst := unsafe { *pdst }
+			for p in lo .. hi {
+				mid := if 2 * p + 1 < last { 2 * p + 1 } else { last }
+				end := if 2 * p + 2 < last { 2 * p + 2 } else { last }
+				merge_runs(src, mut dst, runs[2 * p], runs[mid], runs[end], cmp)
+			}
+		}, workers: workers, grain: 1)
+		mut next := []int{cap: npairs + 1}
+		for i := 0; i < runs.len; i += 2 {
+			next << runs[i]
+		}
+		if next.last() != n {
+			next << n
 		}
+		runs = next
+		psrc, pdst = pdst, psrc
+		in_tmp = !in_tmp
 	}
+	if in_tmp {
+		unsafe { vmemcpy(input.data, tmp.data, n * int(sizeof(T))) }
+	}
+}
 
-	// wait for all tasks to complete
-	wg.wait()
-	ch.close()
-	tasks.sort(a.idx < b.idx)
-	return tasks.map(it.result)
+// merge_runs merges the sorted runs src[lo..mid] and src[mid..hi] into dst[lo..hi].
+// When 2 elements are equal, the one from the first run goes first.
+@[direct_array_access]
+fn merge_runs[T](src []T, mut dst []T, lo int, mid int, hi int, cmp fn (a &T, b &T) int) {
+	mut i := lo
+	mut j := mid
+	mut k := lo
+	for i < mid && j < hi {
+		if cmp(&src[j], &src[i]) < 0 {
+			dst[k] = src[j]
+			j++
+		} else {
+			dst[k] = src[i]
+			i++
+		}
+		k++
+	}
+	for i < mid {
+		dst[k] = src[i]
+		i++
+		k++
+	}
+	for j < hi {
+		dst[k] = src[j]
+		j++
+		k++
+	}
 }
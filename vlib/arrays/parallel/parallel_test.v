@@ -65,3 +65,93 @@ fn test_parallel_amap() {
 		assert op == input[i] * input[i]
 	}
 }
+
+fn test_parallel_for_range() {
+	for n in [0, 1, 7, 1000, 100_003] {
+		mut hits := []int{len: n}
+		mut phits := &hits
+		parallel.for_range(n, fn [mut phits] (lo int, hi int) {
+			for i in lo .. hi {
+				unsafe {
+					phits[i]++
+				}
+			}
+		})
+		assert hits.all(it == 1)
+	}
+	// the chunks start at multiples of the grain size, and are not longer than it:
+	parallel.for_range(100, fn (lo int, hi int) {
+		assert lo % 7 == 0
+		assert hi - lo <= 7
+	}, grain: 7, workers: 3)
+}
+
+fn test_parallel_amap_large() {
+	input := []int{len: 100_000, init: index}
+	output := parallel.amap(input, fn (i int) i64 {
+		return i64(i) * i
+	})
+	assert output.len == input.len
+	for i, x in output {
+		assert x == i64(i) * i
+	}
+}
+
+fn test_parallel_reduce() {
+	assert parallel.reduce([]int{}, 42, fn (acc int, x int) int {
+		return acc + x
+	}) == 42
+	input := []i64{len: 100_000, init: index}
+	assert parallel.reduce(input, i64(0), fn (acc i64, x i64) i64 {
+		return acc + x
+	}) == i64(99_999) * 100_000 / 2
+	// the partial results are combined in order, so non commutative reducers work too:
+	words := []string{len: 1000, init: '${index % 10}'}
+	joined := parallel.reduce(words, '', fn (acc string, x string) string {
+		return acc + x
+	}, workers: 4)
+	assert joined == words.join('')
+}
+
+fn test_parallel_filter() {
+	assert parallel.filter([]int{}, fn (x int) bool {
+		return true
+	}) == []
+	input := []int{len: 100_000, init: index}
+	evens := parallel.filter(input, fn (x int) bool {
+		return x % 2 == 0
+	})
+	assert evens == input.filter(it % 2 == 0)
+}
+
+fn test_parallel_sort() {
+	for n in [0, 1, 100, 5000, 100_001] {
+		mut a := []int{len: n, init: rand.intn(1000) or { 0 }}
+		mut expected := a.clone()
+		expected.sort()
+		parallel.sort(mut a, fn (x &int, y &int) int {
+			return *x - *y
+		}, workers: 5)
+		assert a == expected
+	}
+}
+
+struct SortItem {
+	key int
+	idx int
+}
+
+fn test_parallel_sort_is_stable() {
+	for n in [100, 20_000] {
+		mut a := []SortItem{len: n, init: SortItem{
+			key: rand.intn(10) or { 0 }
+			idx: index
+		}}
+		parallel.sort(mut a, fn (x &SortItem, y &SortItem) int {
+			return x.key - y.key
+		}, workers: 5)
+		for i in 1 .. n {
+			assert a[i - 1].key < a[i].key || (a[i - 1].key == a[i].key && a[i - 1].idx < a[i].idx)
+		}
+	}
+}
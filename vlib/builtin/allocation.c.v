@@ -507,3 +507,41 @@ pub fn gc_memory_use() usize {
 		return 0
 	}
 }
+
+// PreallocMark is a position in the memory blocks of the current thread, used by `-prealloc`.
+pub struct PreallocMark {
+	block   voidptr
+	current voidptr
+}
+
+// prealloc_mark returns the current position of the `-prealloc` allocator of the calling thread.
+// Pass it later to prealloc_reset, to free everything that the thread allocated after it.
+// Without `-prealloc`, it returns an empty mark, that prealloc_reset ignores.
+pub fn prealloc_mark() PreallocMark {
+	$if prealloc {
+		return unsafe { vmemory_block_mark() }
+	} $else {
+		return PreallocMark{}
+	}
+}
+
+// prealloc_reset frees all the memory, that the calling thread allocated after `mark` was taken, in O(1).
+// It is useful for example for request handlers, that can take a mark at the start of each request.
+// It is unsafe, since any value allocated after the mark, that is still used after the reset,
+// will point to memory, that will be overwritten by the next allocations.
+// Without `-prealloc`, it does nothing.
+@[unsafe]
+pub fn prealloc_reset(mark PreallocMark) {
+	$if prealloc {
+		unsafe { vmemory_block_reset(mark) }
+	}
+}
+
+// prealloc_scope calls `cb`, then frees all the memory, that the calling thread allocated in `cb`.
+// See also prealloc_reset.
+@[unsafe]
+pub fn prealloc_scope(cb fn ()) {
+	mark := prealloc_mark()
+	cb()
+	unsafe { prealloc_reset(mark) }
+}
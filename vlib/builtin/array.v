@@ -986,6 +986,86 @@ pub fn (a &array) sorted_with_compare(callback fn (voidptr, voidptr) int) array
 	return array{}
 }
 
+// sort_stable_with_compare sorts the array in-place, like .sort_with_compare(), but the
+// elements, for which the callback returns 0, keep their original order.
+// It is a merge sort, that needs a temporary buffer of the size of the array.
+pub fn (mut a array) sort_stable_with_compare(callback fn (voidptr, voidptr) int) {
+	$if freestanding {
+		panic('sort_stable_with_compare does not work with -freestanding')
+	} $else {
+		unsafe { stable_sort(a.data, a.len, a.element_size, callback) }
+	}
+}
+
+const stable_sort_run = 16
+
+// stable_sort sorts the `len` elements of `size` bytes at `data` with a bottom up merge sort.
+// The runs of stable_sort_run elements are sorted first with an insertion sort.
+@[unsafe]
+fn stable_sort(data voidptr, len int, size int, callback fn (voidptr, voidptr) int) {
+	if len < 2 {
+		return
+	}
+	unsafe {
+		base := &u8(data)
+		esize := isize(size)
+		x := malloc(esize)
+		for start := 0; start < len; start += stable_sort_run {
+			end := if start + stable_sort_run < len { start + stable_sort_run } else { len }
+			for i := start + 1; i < end; i++ {
+				vmemcpy(x, base + isize(i) * esize, esize)
+				mut j := i
+				for j > start && callback(x, base + isize(j - 1) * esize) < 0 {
+					j--
+				}
+				if j < i {
+					vmemmove(base + isize(j + 1) * esize, base + isize(j) * esize, isize(i - j) * esize)
+					vmemcpy(base + isize(j) * esize, x, esize)
+				}
+			}
+		}
+		free(x)
+		if len <= stable_sort_run {
+			return
+		}
+		buf := malloc(isize(len) * esize)
+		mut src := base
+		mut dst := buf
+		for width := stable_sort_run; width < len; width *= 2 {
+			for lo := 0; lo < len; lo += 2 * width {
+				mid := if lo + width < len { lo + width } else { len }
+				hi := if lo + 2 * width < len { lo + 2 * width } else { len }
+				mut i := lo
+				mut j := mid
+				mut k := lo
+				for i < mid && j < hi {
+					// an element of the right run goes first only when it is strictly smaller
+					if callback(src + isize(j) * esize, src + isize(i) * esize) < 0 {
+						vmemcpy(dst + isize(k) * esize, src + isize(j) * esize, esize)
+						j++
+					} else {
+						vmemcpy(dst + isize(k) * esize, src + isize(i) * esize, esize)
+						i++
+					}
+					k++
+				}
+				if i < mid {
+					vmemcpy(dst + isize(k) * esize, src + isize(i) * esize, isize(mid - i) * esize)
+					k += mid - i
+				}
+				if j < hi {
+					vmemcpy(dst + isize(k) * esize, src + isize(j) * esize, isize(hi - j) * esize)
+				}
+			}
+			src, dst = dst, src
+		}
+		if src != base {
+			vmemcpy(base, src, isize(len) * esize)
+		}
+		free(buf)
+	}
+}
+
 // contains determines whether an array includes a certain value among its elements.
 // It will return `true` if the array contains an element with this value.
 // It is similar to `.any` but does not take an `it` expression.
@@ -31,6 +31,25 @@ pub fn (ch chan) try_push(obj voidptr) ChanState {
 	return .success
 }
 
+// push_many pushes all the objects in `objs` to the channel, waiting for free space when needed.
+// Buffered channels transfer the objects in batches, with one synchronisation per batch.
+// It returns the number of pushed objects, that is less than `objs.len` only if the channel was closed.
+pub fn (ch chan) push_many(objs array) int {
+	return 0
+}
+
+// pop_many waits for at least one object, then pops as many objects, as are available
+// in the channel, up to `objs.len`, into `objs`. It returns the number of popped objects,
+// that is 0 only when the channel is closed and empty.
+pub fn (ch chan) pop_many(mut objs array) int {
+	return 0
+}
+
+// try_pop_many is like pop_many, but it does not wait, and returns 0 when the channel is empty.
+pub fn (ch chan) try_pop_many(mut objs array) int {
+	return 0
+}
+
 // IError holds information about an error instance.
 pub interface IError {
 	msg() string
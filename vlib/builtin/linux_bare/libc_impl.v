@@ -114,6 +114,19 @@ fn memcmp(a voidptr, b voidptr, n usize) int {
 	return 0
 }
 
+// memchr is used by the substring searches of string, see string_search.c.v
+@[export: 'memchr']
+@[unsafe]
+fn memchr(s voidptr, c int, n usize) voidptr {
+	s_ := unsafe { &u8(s) }
+	for i in 0 .. int(n) {
+		if unsafe { s_[i] == u8(c) } {
+			return unsafe { &u8(s_) + i }
+		}
+	}
+	return unsafe { nil }
+}
+
 @[export: 'free']
 @[unsafe]
 fn __free(ptr voidptr) {
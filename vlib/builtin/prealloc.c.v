@@ -9,13 +9,25 @@ module builtin
 // Each new chunk has a pointer to the old one, and at the end of the program,
 // the entire linked list of chunks is freed.
 // The goal of all this is to amortize the cost of calling libc's malloc,
-// trading higher memory usage for a compiler (or any single threaded batch
-// mode program), for a ~8-10% speed increase.
-// Note: `-prealloc` is NOT safe to be used for multithreaded programs!
+// trading higher memory usage for a compiler (or any batch mode program),
+// for a ~8-10% speed increase.
+// Each thread has its own list of chunks, so the threads do not need to
+// synchronise, when they allocate. The chunks of the other threads are created
+// on their first allocation, starting with smaller sizes, and are not freed at
+// the end of the program, since their memory can be still referenced by the
+// values that the threads returned.
+// Note: with tcc, the chunks are shared by all threads, so `-prealloc` is NOT
+// safe to be used for multithreaded programs, compiled with it.
+// See also prealloc_mark/prealloc_reset/prealloc_scope, that can free all the
+// memory allocated by the current thread after a given point, at once.
 
 // size of the preallocated chunk
 const prealloc_block_size = 16 * 1024 * 1024
 
+// size of the first chunk of each thread, other than the main one
+const prealloc_thread_block_size = 1024 * 1024
+
+@[thread_local]
 __global g_memory_block &VMemoryBlock
 @[heap]
 struct VMemoryBlock {
@@ -46,11 +58,23 @@ fn vmemory_block_new(prev &VMemoryBlock, at_least isize, align isize) &VMemoryBl
 	}
 
 	v.previous = prev
+	mut min_block_size := isize(prealloc_thread_block_size)
 	if unsafe { prev != 0 } {
+		// keep the blocks after prev, that prealloc_reset left for reuse:
+		v.next = prev.next
+		if unsafe { prev.next != 0 } {
+			prev.next.previous = v
+		}
 		prev.next = v
+		prev_size := isize(i64(prev.stop) - i64(prev.start))
+		min_block_size = if prev_size < isize(prealloc_block_size) / 2 {
+			2 * prev_size
+		} else {
+			isize(prealloc_block_size)
+		}
 	}
-	base_block_size := if at_least < isize(prealloc_block_size) {
-		isize(prealloc_block_size)
+	base_block_size := if at_least < min_block_size {
+		min_block_size
 	} else {
 		at_least
 	}
@@ -89,14 +113,25 @@ fn vmemory_block_new(prev &VMemoryBlock, at_least isize, align isize) &VMemoryBl
 
 @[unsafe]
 fn vmemory_block_malloc(n isize, align isize) &u8 {
-	$if prealloc_trace_malloc ? {
-		C.fprintf(C.stderr, c'vmemory_block_malloc g_memory_block.id: %d, n: %lld align: %d\n',
-			g_memory_block.id, n, align)
-	}
 	unsafe {
+		if _unlikely_(g_memory_block == 0) {
+			// the first allocation in a thread, other than the main one:
+			g_memory_block = vmemory_block_new(nil, n, align)
+		}
+		$if prealloc_trace_malloc ? {
+			C.fprintf(C.stderr, c'vmemory_block_malloc g_memory_block.id: %d, n: %lld align: %d\n',
+				g_memory_block.id, n, align)
+		}
 		remaining := i64(g_memory_block.stop) - i64(g_memory_block.current)
 		if _unlikely_(remaining < n) {
-			g_memory_block = vmemory_block_new(g_memory_block, n, align)
+			next := g_memory_block.next
+			if next != 0 && i64(next.stop) - i64(next.start) >= n {
+				// reuse a block, that was left after a prealloc_reset:
+				next.current = next.start
+				g_memory_block = next
+			} else {
+				g_memory_block = vmemory_block_new(g_memory_block, n, align)
+			}
 		}
 		res := &u8(g_memory_block.current)
 		g_memory_block.current += n
@@ -107,6 +142,33 @@ fn vmemory_block_malloc(n isize, align isize) &u8 {
 	}
 }
 
+// vmemory_block_mark returns the current position of the allocator of the calling thread
+@[unsafe]
+fn vmemory_block_mark() PreallocMark {
+	unsafe {
+		if g_memory_block == 0 {
+			g_memory_block = vmemory_block_new(nil, 0, 0)
+		}
+		return PreallocMark{
+			block:   g_memory_block
+			current: g_memory_block.current
+		}
+	}
+}
+
+// vmemory_block_reset moves the allocator of the calling thread back to `mark`, in O(1).
+// The blocks after the marked one are kept, and reused by the next allocations.
+@[unsafe]
+fn vmemory_block_reset(mark PreallocMark) {
+	if unsafe { mark.block == 0 } {
+		return
+	}
+	unsafe {
+		g_memory_block = &VMemoryBlock(mark.block)
+		g_memory_block.current = &u8(mark.current)
+	}
+}
+
 /////////////////////////////////////////////////
 
 @[unsafe]
@@ -131,7 +193,7 @@ fn prealloc_vcleanup() {
 		// The second loop however should *not* allocate at all.
 		mut nr_mallocs := i64(0)
 		mut total_used := i64(0)
-		mut mb := g_memory_block
+		mut mb := vmemory_last_block()
 		for unsafe { mb != 0 } {
 			nr_mallocs += mb.mallocs
 			used := i64(mb.current) - i64(mb.start)
@@ -188,6 +250,7 @@ fn prealloc_vcleanup() {
 		}
 	}
 	unsafe {
+		g_memory_block = vmemory_last_block()
 		for g_memory_block != 0 {
 			$if windows {
 				// Warning! On windows, we always use _aligned_free to free memory.
@@ -203,6 +266,16 @@ fn prealloc_vcleanup() {
 	}
 }
 
+// vmemory_last_block returns the last block of the calling thread, including the blocks,
+// that prealloc_reset left after the current one
+fn vmemory_last_block() &VMemoryBlock {
+	mut mb := g_memory_block
+	for unsafe { mb != 0 && mb.next != 0 } {
+		mb = mb.next
+	}
+	return mb
+}
+
 @[unsafe]
 fn prealloc_malloc(n isize) &u8 {
 	return unsafe { vmemory_block_malloc(n, 0) }
@@ -0,0 +1,40 @@
+// vtest vflags: -prealloc
+// vtest build: !tinyc
+fn allocate_strings(n int) []string {
+	mut res := []string{cap: n}
+	for i in 0 .. n {
+		res << 'item ${i}'
+	}
+	return res
+}
+
+fn test_prealloc_in_threads() {
+	mut threads := []thread []string{}
+	for _ in 0 .. 4 {
+		threads << spawn allocate_strings(100_000)
+	}
+	for t in threads {
+		res := t.wait()
+		assert res.len == 100_000
+		assert res[99_999] == 'item 99999'
+	}
+}
+
+fn test_prealloc_reset_reuses_the_memory() {
+	mark := prealloc_mark()
+	first := allocate_strings(10)
+	first_ptr := voidptr(first[0].str)
+	unsafe { prealloc_reset(mark) }
+	second := allocate_strings(10)
+	assert voidptr(second[0].str) == first_ptr
+}
+
+fn test_prealloc_scope() {
+	mark := prealloc_mark()
+	unsafe {
+		prealloc_scope(fn () {
+			allocate_strings(1000)
+		})
+	}
+	assert prealloc_mark() == mark
+}
@@ -80,3 +80,104 @@ fn f(mut users []User) {
 fn z(mut users []User) {
 	users.sort(a.name < b.name)
 }
+
+struct Row {
+	id    int
+	score f64
+	delta i16
+}
+
+// pseudo_random returns a deterministic sequence, so the test does not depend on `rand`
+fn pseudo_random(n int) []int {
+	mut res := []int{cap: n}
+	mut x := u32(12345)
+	for _ in 0 .. n {
+		x = x * 1103515245 + 12345
+		res << int(x >> 8) - 4_000_000
+	}
+	return res
+}
+
+fn test_sorting_large_arrays_of_numbers() {
+	nums := pseudo_random(5000)
+	mut a := nums.clone()
+	a.sort()
+	for i in 1 .. a.len {
+		assert a[i - 1] <= a[i]
+	}
+	a.sort(a > b)
+	for i in 1 .. a.len {
+		assert a[i - 1] >= a[i]
+	}
+	mut floats := nums.map(f64(it) / 7.0)
+	floats << [-0.5, 0.0, 1e300, -1e300]
+	floats.sort()
+	for i in 1 .. floats.len {
+		assert floats[i - 1] <= floats[i]
+	}
+	mut bytes := nums.map(u8(it))
+	bytes.sort()
+	for i in 1 .. bytes.len {
+		assert bytes[i - 1] <= bytes[i]
+	}
+}
+
+fn test_sorting_large_arrays_by_a_number_field_is_stable() {
+	nums := pseudo_random(3000)
+	mut rows := []Row{cap: nums.len}
+	for i, n in nums {
+		rows << Row{
+			id:    i
+			score: f64(n % 100)
+			delta: i16(n % 50)
+		}
+	}
+	rows.sort(a.score < b.score)
+	for i in 1 .. rows.len {
+		assert rows[i - 1].score <= rows[i].score
+		if rows[i - 1].score == rows[i].score {
+			assert rows[i - 1].id < rows[i].id
+		}
+	}
+	rows.sort(b.delta < a.delta)
+	for i in 1 .. rows.len {
+		assert rows[i - 1].delta >= rows[i].delta
+	}
+}
+
+fn test_sorting_large_arrays_of_strings() {
+	mut words := pseudo_random(2000).map(it.str())
+	words.sort()
+	for i in 1 .. words.len {
+		assert words[i - 1] <= words[i]
+	}
+	words.sort(a.len > b.len)
+	for i in 1 .. words.len {
+		assert words[i - 1].len >= words[i].len
+	}
+}
+
+fn test_sort_stable_with_compare() {
+	nums := pseudo_random(1000)
+	mut rows := []Row{cap: nums.len}
+	for i, n in nums {
+		rows << Row{
+			id:    i
+			delta: i16(n % 10)
+		}
+	}
+	rows.sort_stable_with_compare(fn (a &Row, b &Row) int {
+		return int(a.delta) - int(b.delta)
+	})
+	for i in 1 .. rows.len {
+		assert rows[i - 1].delta <= rows[i].delta
+		if rows[i - 1].delta == rows[i].delta {
+			assert rows[i - 1].id < rows[i].id
+		}
+	}
+	mut words := ['bb', 'a', 'cc', 'b', 'aaa', 'c']
+	words.sort_stable_with_compare(fn (a &string, b &string) int {
+		return a.len - b.len
+	})
+	assert words == ['a', 'b', 'c', 'bb', 'cc', 'aaa']
+}
@@ -1010,14 +1010,13 @@ pub fn (s string) split_nth(delim string, nth int) []string {
 		1 {
 			delim_byte := delim[0]
 			mut start := 0
-			for i, ch in s {
-				if ch == delim_byte {
-					if nth > 0 && res.len == nth - 1 {
-						break
-					}
-					res << s.substr(start, i)
-					start = i + 1
+			for {
+				i := s.index_u8_from(delim_byte, start)
+				if i == -1 || (nth > 0 && res.len == nth - 1) {
+					break
 				}
+				res << s.substr(start, i)
+				start = i + 1
 			}
 			if nth < 1 || res.len < nth {
 				res << s[start..]
@@ -1026,17 +1025,13 @@ pub fn (s string) split_nth(delim string, nth int) []string {
 		else {
 			mut start := 0
 			// Add up to `nth` segments left of every occurrence of the delimiter.
-			for i := 0; i + delim.len <= s.len; {
-				if unsafe { s.substr_unsafe(i, i + delim.len) } == delim {
-					if nth > 0 && res.len == nth - 1 {
-						break
-					}
-					res << s.substr(start, i)
-					i += delim.len
-					start = i
-				} else {
-					i++
+			for {
+				i := s.index_from(delim, start)
+				if i == -1 || (nth > 0 && res.len == nth - 1) {
+					break
 				}
+				res << s.substr(start, i)
+				start = i + delim.len
 			}
 			// Then add the remaining part of the string as the last segment.
 			if nth < 1 || res.len < nth {
@@ -1272,21 +1267,7 @@ pub fn (s string) index_(p string) int {
 	if p.len > s.len || p.len == 0 {
 		return -1
 	}
-	if p.len > 2 {
-		return s.index_kmp(p)
-	}
-	mut i := 0
-	for i < s.len {
-		mut j := 0
-		for j < p.len && unsafe { s.str[i + j] == p.str[j] } {
-			j++
-		}
-		if j == p.len {
-			return i
-		}
-		i++
-	}
-	return -1
+	return s.index_from(p, 0)
 }
 
 // index returns the position of the first character of the first occurrence of the `needle` string in `s`.
@@ -1314,9 +1295,15 @@ const kmp_stack_buffer_size = 20
 // index_kmp does KMP search inside the string `s` for the needle `p`.
 // It returns the first found index where the string `p` is found.
 // It returns -1, when the needle `p` is not present in `s`.
-@[direct_array_access; manualfree]
+@[inline]
 fn (s string) index_kmp(p string) int {
-	if p.len > s.len {
+	return s.index_kmp_from(p, 0)
+}
+
+// index_kmp_from is like index_kmp, but it starts the search at `start`.
+@[direct_array_access; manualfree]
+fn (s string) index_kmp_from(p string, start int) int {
+	if p.len == 0 || start < 0 || p.len > s.len - start {
 		return -1
 	}
 	mut stack_prefixes := [kmp_stack_buffer_size]int{}
@@ -1342,7 +1329,7 @@ fn (s string) index_kmp(p string) int {
 		}
 	}
 	j = 0
-	for i in 0 .. s.len {
+	for i in start .. s.len {
 		for unsafe { p.str[j] != s.str[i] } && j > 0 {
 			j = unsafe { p_prefixes[j - 1] }
 		}
@@ -1401,20 +1388,14 @@ pub fn (s string) index_after(p string, start int) ?int {
 	if start >= s.len {
 		return none
 	}
-	mut i := strt
-	for i < s.len {
-		mut j := 0
-		mut ii := i
-		for j < p.len && unsafe { s.str[ii] == p.str[j] } {
-			j++
-			ii++
-		}
-		if j == p.len {
-			return i
-		}
-		i++
+	if p.len == 0 {
+		return strt
+	}
+	idx := s.index_from(p, strt)
+	if idx == -1 {
+		return none
 	}
-	return none
+	return idx
 }
 
 // index_after_ returns the position of the input string, starting search from `start` position.
@@ -1430,32 +1411,17 @@ pub fn (s string) index_after_(p string, start int) int {
 	if start >= s.len {
 		return -1
 	}
-	mut i := strt
-	for i < s.len {
-		mut j := 0
-		mut ii := i
-		for j < p.len && unsafe { s.str[ii] == p.str[j] } {
-			j++
-			ii++
-		}
-		if j == p.len {
-			return i
-		}
-		i++
+	if p.len == 0 {
+		return strt
 	}
-	return -1
+	return s.index_from(p, strt)
 }
 
 // index_u8 returns the index of byte `c` if found in the string.
 // index_u8 returns -1 if the byte can not be found.
-@[direct_array_access]
+@[inline]
 pub fn (s string) index_u8(c u8) int {
-	for i, b in s {
-		if b == c {
-			return i
-		}
-	}
-	return -1
+	return s.index_u8_from(c, 0)
 }
 
 // last_index_u8 returns the index of the last occurrence of byte `c` if it was found in the string.
@@ -1484,13 +1450,11 @@ pub fn (s string) count(substr string) int {
 
 	if substr.len == 1 {
 		target := substr[0]
-
-		for letter in s {
-			if letter == target {
-				n++
-			}
+		mut i := s.index_u8_from(target, 0)
+		for i != -1 {
+			n++
+			i = s.index_u8_from(target, i + 1)
 		}
-
 		return n
 	}
 
@@ -1509,12 +1473,7 @@ pub fn (s string) count(substr string) int {
 // contains_u8 returns `true` if the string contains the byte value `x`.
 // See also: [`string.index_u8`](#string.index_u8) , to get the index of the byte as well.
 pub fn (s string) contains_u8(x u8) bool {
-	for c in s {
-		if x == c {
-			return true
-		}
-	}
-	return false
+	return s.index_u8_from(x, 0) != -1
 }
 
 // contains returns `true` if the string contains `substr`.
@@ -0,0 +1,61 @@
+module builtin
+
+// The functions in this file are the building blocks of the substring searches in string.v.
+// They use C.memchr to skip to the next possible start of a match. The libc implementations
+// of memchr compare 16 to 64 bytes at a time with SSE2/AVX2/NEON instructions, and fall back
+// to a word at a time loop on other targets, so the search does not need its own SIMD code.
+
+// index_u8_from returns the index of the first byte `c` in `s`, at or after `start`.
+// It returns -1, when there is no such byte.
+@[direct_array_access; inline]
+fn (s string) index_u8_from(c u8, start int) int {
+	if start < 0 || start >= s.len {
+		return -1
+	}
+	unsafe {
+		p := C.memchr(s.str + start, c, usize(s.len - start))
+		if p == voidptr(nil) {
+			return -1
+		}
+		return int(&u8(p) - s.str)
+	}
+}
+
+// index_from returns the index of the first occurrence of the non empty needle `p` in `s`,
+// at or after `start`. It returns -1, when there is no such occurrence.
+// The candidates are found with memchr for the first byte of `p`, then filtered by its last
+// byte, before comparing the rest. When too many candidates pass the filter without matching,
+// i.e. for inputs like `'aaa...a'.index('aab')`, the rest of `s` is searched with KMP instead,
+// so the worst case stays linear.
+@[direct_array_access]
+fn (s string) index_from(p string, start int) int {
+	mut i := if start < 0 { 0 } else { start }
+	if p.len == 1 {
+		return s.index_u8_from(unsafe { p.str[0] }, i)
+	}
+	last_start := s.len - p.len
+	if p.len == 0 || i > last_start {
+		return -1
+	}
+	first := unsafe { p.str[0] }
+	last := unsafe { p.str[p.len - 1] }
+	mut budget := s.len - i + 64
+	for i <= last_start {
+		unsafe {
+			c := C.memchr(s.str + i, first, usize(last_start - i + 1))
+			if c == voidptr(nil) {
+				return -1
+			}
+			i = int(&u8(c) - s.str)
+			if s.str[i + p.len - 1] == last && vmemcmp(s.str + i + 1, p.str + 1, p.len - 2) == 0 {
+				return i
+			}
+		}
+		budget -= p.len
+		if budget < 0 {
+			return s.index_kmp_from(p, i + 1)
+		}
+		i++
+	}
+	return -1
+}
@@ -1632,6 +1632,43 @@ fn test_index_u8() {
 	assert 'abc'.index_u8(`C`) == -1
 }
 
+fn naive_index_after(s string, p string, start int) int {
+	for i in start .. s.len - p.len + 1 {
+		if s[i..i + p.len] == p {
+			return i
+		}
+	}
+	return -1
+}
+
+fn test_index_matches_naive_search() {
+	haystacks := ['', 'a', 'abcabcabd', 'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab', 'x'.repeat(300) + 'xy' + 'x'.repeat(5),
+		'the quick brown fox jumps over the lazy dog'.repeat(5)]
+	needles := ['a', 'b', 'ab', 'abd', 'aab', 'xy', 'xxy', 'x'.repeat(40) + 'y', 'lazy dog', 'dog the',
+		'fox jumps!', 'the quick brown fox jumps over the lazy dog'.repeat(2)]
+	for h in haystacks {
+		for n in needles {
+			expected := if n.len > h.len { -1 } else { naive_index_after(h, n, 0) }
+			assert h.index(n) or { -1 } == expected, 'h: ${h} | n: ${n}'
+			assert h.contains(n) == (expected != -1)
+			for start in [1, 3, 40] {
+				if start < h.len {
+					after := if n.len > h.len { -1 } else { naive_index_after(h, n, start) }
+					assert h.index_after(n, start) or { -1 } == after, 'h: ${h} | n: ${n} | start: ${start}'
+				}
+			}
+		}
+	}
+	// many candidates, that pass the first and last byte filter, but do not match
+	pathological := 'ab'.repeat(20000) + 'aab'
+	assert pathological.index('a' + 'ba'.repeat(100) + 'ab') or { -1 } == 40000 - 200
+	assert 'aa'.repeat(10000).count('aa') == 10000
+	assert 'a,b,,c'.split(',') == ['a', 'b', '', 'c']
+	assert 'a<>b<><>c<>'.split('<>') == ['a', 'b', '', 'c', '']
+	assert 'a<>b<><>c'.split_nth('<>', 2) == ['a', 'b<><>c']
+	assert 'x-y-z'.replace('-', '--') == 'x--y--z'
+}
+
 fn test_last_index() {
 	assert 'abcabca'.last_index('ca')? == 5
 	assert 'abcabca'.last_index('ab')? == 3
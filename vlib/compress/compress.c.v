@@ -52,6 +52,51 @@ pub fn decompress(data []u8, flags int) ![]u8 {
 	}
 }
 
+// decompress_prefix decompresses the compressed stream at the start of `data`, based on the provided flags.
+// It returns the decompressed bytes, and the number of bytes of `data`, that the compressed stream used.
+// The bytes after the end of the compressed stream are ignored, which is useful for formats that
+// concatenate several compressed streams, like multi-member gzip files.
+// NB: this is a low level api, a high level implementation like zlib/gzip should be preferred
+pub fn decompress_prefix(data []u8, flags int) !([]u8, int) {
+	decomp := C.tinfl_decompressor_alloc()
+	if decomp == unsafe { nil } {
+		return error('cannot allocate the decompressor')
+	}
+	defer {
+		C.tinfl_decompressor_free(decomp)
+	}
+	dflags := (u32(flags) | tinfl_flag_using_non_wrapping_output_buf) & ~tinfl_flag_has_more_input
+	initial_len := if data.len < dict_size || u64(data.len) > max_size / 4 {
+		dict_size
+	} else {
+		data.len * 2
+	}
+	mut out := []u8{len: initial_len}
+	mut in_pos := 0
+	mut out_pos := 0
+	for {
+		mut in_size := usize(data.len - in_pos)
+		mut out_size := usize(out.len - out_pos)
+		status := unsafe {
+			C.tinfl_decompress(decomp, &u8(data.data) + in_pos, &in_size, &u8(out.data),
+				&u8(out.data) + out_pos, &out_size, dflags)
+		}
+		in_pos += int(in_size)
+		out_pos += int(out_size)
+		if status == tinfl_status_done {
+			break
+		}
+		if status != tinfl_status_has_more_output {
+			return error('decompression failed')
+		}
+		if u64(out.len) * 2 > max_size {
+			return error('decompressed data is too large (> ${max_size})')
+		}
+		unsafe { out.grow_len(out.len) }
+	}
+	return out[..out_pos], in_pos
+}
+
 // ChunkCallback is used to receive decompressed chunks of maximum 32768 bytes.
 // After processing the chunk this function should return the chunk's length to indicate
 // the decompressor to send more chunks, otherwise the decompression stops.
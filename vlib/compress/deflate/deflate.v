@@ -1,5 +1,6 @@
 module deflate
 
+import io
 import compress as compr
 
 // compresses an array of bytes using deflate and returns the compressed bytes in a new array
@@ -13,3 +14,21 @@ pub fn compress(data []u8) ![]u8 {
 pub fn decompress(data []u8) ![]u8 {
 	return compr.decompress(data, 0)
 }
+
+// WriterParams set the compression level of a deflate writer, in the range 0..10 (see compress.default_compression)
+@[params]
+pub struct WriterParams {
+pub:
+	level int = compr.default_compression
+}
+
+// new_writer returns a writer, that compresses the data written to it using deflate, and writes the result to `w`,
+// without keeping the whole input or output in memory. Call `close()` after the last write.
+pub fn new_writer(w io.Writer, params WriterParams) !&compr.DeflateWriter {
+	return compr.new_deflate_writer(w, compr.deflate_flags(params.level, false)!)
+}
+
+// new_reader returns a reader, that decompresses the raw deflate data read from `r`
+pub fn new_reader(r io.Reader) !&compr.InflateReader {
+	return compr.new_inflate_reader(r, 0)
+}
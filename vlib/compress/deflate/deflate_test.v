@@ -1,5 +1,7 @@
 module deflate
 
+import io
+
 const gzip_magic_numbers = [u8(0x1f), 0x8b]
 
 fn test_gzip() {
@@ -10,3 +12,43 @@ fn test_gzip() {
 	decompressed := decompress(compressed)!
 	assert decompressed == uncompressed.bytes()
 }
+
+struct TestWriter {
+mut:
+	bytes []u8
+}
+
+fn (mut w TestWriter) write(buf []u8) !int {
+	w.bytes << buf
+	return buf.len
+}
+
+struct TestReader {
+	data []u8
+mut:
+	pos int
+}
+
+fn (mut r TestReader) read(mut buf []u8) !int {
+	if r.pos >= r.data.len {
+		return io.Eof{}
+	}
+	n := copy(mut buf, r.data[r.pos..])
+	r.pos += n
+	return n
+}
+
+fn test_deflate_stream() {
+	data := 'Hello streaming world! '.repeat(10_000).bytes()
+	mut tw := TestWriter{}
+	mut w := new_writer(tw, level: 9)!
+	for i := 0; i < data.len; i += 1000 {
+		w.write(data[i..i + 1000])!
+	}
+	w.close()!
+	assert tw.bytes.len < data.len / 100
+	assert decompress(tw.bytes)! == data
+	mut r := new_reader(TestReader{ data: tw.bytes })!
+	assert io.read_all(reader: r, read_to_end_of_stream: true)! == data
+	r.close()
+}
@@ -204,28 +204,47 @@ pub fn validate(data []u8, params DecompressParams) !GzipHeader {
 }
 
 // decompress an array of bytes using zlib and returns the decompressed bytes in a new array.
+// Concatenated gzip members, like the ones produced by compress_parallel/2, are decompressed one after another.
 // Example: b := 'abcdef'.repeat(1000).bytes(); cmpr := gzip.compress(b)!; decmpr := gzip.decompress(cmpr)!; assert cmpr.len < b.len; assert b == decmpr
 pub fn decompress(data []u8, params DecompressParams) ![]u8 {
-	gzip_header := validate(data, params)!
-	header_length := gzip_header.length
-
-	decompressed := compr.decompress(data[header_length..data.len - 8], 0)!
-	length_expected := (u32(data[data.len - 1]) << 24) | (u32(data[data.len - 2]) << 16) | (u32(data[data.len - 3]) << 8) | data[data.len - 4]
-	if params.verify_length && decompressed.len != length_expected {
-		return error('length verification failed, got ${decompressed.len}, expected ${length_expected}')
-	}
-	checksum := crc32.sum(decompressed)
-	checksum_expected := (u32(data[data.len - 5]) << 24) | (u32(data[data.len - 6]) << 16) | (u32(data[data.len - 7]) << 8) | data[data.len - 8]
-	if params.verify_checksum && checksum != checksum_expected {
-		return error('checksum verification failed')
+	mut result := []u8{}
+	mut pos := 0
+	for {
+		member := data[pos..]
+		gzip_header := validate(member, params)!
+		decompressed, used := compr.decompress_prefix(member[gzip_header.length..], 0)!
+		trailer := gzip_header.length + used
+		if trailer + 8 > member.len {
+			return error('data too short')
+		}
+		length_expected := (u32(member[trailer + 7]) << 24) | (u32(member[trailer + 6]) << 16) | (u32(member[
+			trailer + 5]) << 8) | member[trailer + 4]
+		if params.verify_length && decompressed.len != length_expected {
+			return error('length verification failed, got ${decompressed.len}, expected ${length_expected}')
+		}
+		checksum := crc32.sum(decompressed)
+		checksum_expected := (u32(member[trailer + 3]) << 24) | (u32(member[trailer + 2]) << 16) | (u32(member[
+			trailer + 1]) << 8) | member[trailer]
+		if params.verify_checksum && checksum != checksum_expected {
+			return error('checksum verification failed')
+		}
+		pos += trailer + 8
+		if pos >= data.len && result.len == 0 {
+			return decompressed
+		}
+		result << decompressed
+		if pos >= data.len {
+			break
+		}
 	}
-	return decompressed
+	return result
 }
 
 // decompress_with_callback decompresses the given `data`, using zlib. It calls `cb` with each chunk of decompressed bytes.
 // A chunk is usually 32 KB or less. Note: the chunk data received by `cb` should be cloned, if you need to store it for later,
 // and not process it right away.
 // The callback function should return the chunk length, if it wants to continue decompressing, or 0, if it wants to abort the decompression early.
+// Only single member gzip data is supported; use decompress/2 or new_reader/2 for concatenated members.
 // See also compress.ChunkCallback for more details.
 pub fn decompress_with_callback(data []u8, cb compr.ChunkCallback, userdata voidptr, params DecompressParams) !int {
 	gzip_header := validate(data, params)!
@@ -1,5 +1,7 @@
 module gzip
 
+import io
+import compress as compr
 import hash.crc32
 
 fn test_gzip() {
@@ -147,3 +149,132 @@ fn test_gzip_decompress_callback() {
 	assert decoded == size
 	assert decoded == uncompressed.len
 }
+
+struct TestWriter {
+mut:
+	bytes []u8
+}
+
+fn (mut w TestWriter) write(buf []u8) !int {
+	w.bytes << buf
+	return buf.len
+}
+
+// TestReader returns its data in small pieces, to exercise the buffering of the stream readers
+struct TestReader {
+	data  []u8
+	chunk int = 7
+mut:
+	pos int
+}
+
+fn (mut r TestReader) read(mut buf []u8) !int {
+	if r.pos >= r.data.len {
+		return io.Eof{}
+	}
+	end := if r.pos + r.chunk < r.data.len { r.pos + r.chunk } else { r.data.len }
+	n := copy(mut buf, r.data[r.pos..end])
+	r.pos += n
+	return n
+}
+
+fn stream_test_data() []u8 {
+	mut data := []u8{cap: 300_000}
+	for i in 0 .. 300_000 {
+		data << u8((i * i) % 251 + i / 1000)
+	}
+	return data
+}
+
+fn test_gzip_stream_round_trip() {
+	data := stream_test_data()
+	for level in [compr.no_compression, compr.best_speed, compr.default_compression, compr.best_compression] {
+		mut tw := TestWriter{}
+		mut w := new_writer(tw, level: level)!
+		for i := 0; i < data.len; i += 10_000 {
+			w.write(data[i..i + 10_000])!
+		}
+		w.close()!
+		assert decompress(tw.bytes)! == data
+		mut r := new_reader(TestReader{ data: tw.bytes, chunk: 1000 })!
+		assert io.read_all(reader: r, read_to_end_of_stream: true)! == data
+		r.close()
+	}
+}
+
+fn test_gzip_stream_reader_small_chunks() {
+	uncompressed := 'Hello streaming world! '.repeat(100).bytes()
+	compressed := compress(uncompressed)!
+	mut r := new_reader(TestReader{ data: compressed })!
+	mut buf := []u8{len: 5}
+	mut res := []u8{}
+	for {
+		n := r.read(mut buf) or { break }
+		res << buf[..n]
+	}
+	assert res == uncompressed
+}
+
+fn test_gzip_stream_reader_errors() {
+	mut compressed := compress('Hello world!'.bytes())!
+	compressed[compressed.len - 5] += 1
+	mut r := new_reader(TestReader{ data: compressed })!
+	mut buf := []u8{len: 100}
+	for {
+		r.read(mut buf) or {
+			assert err.msg() == 'checksum verification failed'
+			return
+		}
+	}
+}
+
+fn test_gzip_stream_writer_flush() {
+	mut tw := TestWriter{}
+	mut w := new_writer(tw)!
+	w.write('first part'.bytes())!
+	w.flush()!
+	// everything written before the flush can be decompressed already
+	mut r := new_reader(TestReader{ data: tw.bytes })!
+	mut buf := []u8{len: 100}
+	n := r.read(mut buf)!
+	assert buf[..n].bytestr() == 'first part'
+	r.close()
+	w.write(', second part'.bytes())!
+	w.close()!
+	assert decompress(tw.bytes)!.bytestr() == 'first part, second part'
+}
+
+fn test_gzip_compress_parallel() {
+	data := stream_test_data()
+	compressed := compress_parallel(data, block_size: 50_000, workers: 4)!
+	assert compressed.len < data.len
+	// 6 concatenated members:
+	assert decompress(compressed)! == data
+	mut r := new_reader(TestReader{ data: compressed, chunk: 4096 })!
+	assert io.read_all(reader: r, read_to_end_of_stream: true)! == data
+	r.close()
+	// a single block is the same as the output of compress:
+	assert compress_parallel(data[..1000])! == compress(data[..1000])!
+	mut failed := false
+	compress_parallel(data, block_size: 0) or {
+		failed = true
+		[]u8{}
+	}
+	assert failed
+}
+
+fn test_gzip_parallel_writer() {
+	data := stream_test_data()
+	mut tw := TestWriter{}
+	mut w := new_parallel_writer(tw, block_size: 30_000, workers: 3)!
+	for i := 0; i < data.len; i += 7_000 {
+		end := if i + 7_000 < data.len { i + 7_000 } else { data.len }
+		w.write(data[i..end])!
+	}
+	w.close()!
+	assert decompress(tw.bytes)! == data
+	mut empty := TestWriter{}
+	mut ew := new_parallel_writer(empty)!
+	ew.close()!
+	assert decompress(empty.bytes)! == []u8{}
+}
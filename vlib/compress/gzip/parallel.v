@@ -0,0 +1,56 @@
+module gzip
+
+import io
+import compress as compr
+
+// default_block_size is the size of the independently compressed blocks, used by compress_parallel/2
+// and new_parallel_writer/2 by default
+pub const default_block_size = 1024 * 1024
+
+// ParallelCompressParams set the compression parameters of compress_parallel/2 and new_parallel_writer/2.
+// `compression_level` and `flags` have the same meaning as in CompressParams.
+@[params]
+pub struct ParallelCompressParams {
+pub:
+	compression_level int = 128 // 0~4095
+	flags             CompressFlags
+	block_size        int = default_block_size // the input is split into blocks of this size, that are compressed independently
+	workers           int // 0 by default, so that VJOBS will be used, through runtime.nr_jobs()
+}
+
+// block_compressor returns the function, that compresses each block into a gzip member
+fn (params ParallelCompressParams) block_compressor() !compr.BlockCompressor {
+	if params.compression_level !in 0..4096 {
+		return error('compression level should in [0,4095]')
+	}
+	block_params := CompressParams{
+		compression_level: params.compression_level
+		flags:             params.flags
+	}
+	return fn [block_params] (block []u8) ![]u8 {
+		return compress(block, block_params)
+	}
+}
+
+fn (params ParallelCompressParams) parallel_params() compr.ParallelParams {
+	return compr.ParallelParams{
+		block_size: params.block_size
+		workers:    params.workers
+	}
+}
+
+// compress_parallel splits `data` into blocks of `params.block_size` bytes, and compresses each block
+// into a separate gzip member, on several threads. The result is the concatenation of the members,
+// which gzip tools, decompress/2 and Reader decompress as a single stream.
+// Since the blocks do not share their history, the result is a bit larger than the one of compress/2.
+// Example: b := 'abcde'.repeat(100_000).bytes(); c := gzip.compress_parallel(b, block_size: 65536)!; assert gzip.decompress(c)! == b
+pub fn compress_parallel(data []u8, params ParallelCompressParams) ![]u8 {
+	return compr.compress_blocks(data, params.block_compressor()!, params.parallel_params())
+}
+
+// new_parallel_writer returns a compress.ParallelWriter, that compresses the data written to it like
+// compress_parallel/2, and writes the gzip members to `w`, in order.
+// Call `close()` after the last write, to compress and write the remaining data.
+pub fn new_parallel_writer(w io.Writer, params ParallelCompressParams) !&compr.ParallelWriter {
+	return compr.new_parallel_writer(w, params.block_compressor()!, params.parallel_params())
+}
@@ -1,4 +1,5 @@
 import os
+import io
 import compress.gzip
 
 const samples_folder = os.join_path(os.dir(@FILE), 'samples')
@@ -60,3 +61,15 @@ fn test_compress_with_deferent_level() {
 	assert content9 == decompress_128
 	assert content9 == decompress_4095
 }
+
+fn test_stream_decoding_all_samples_files() {
+	for gz_file in os.walk_ext(samples_folder, '.gz') {
+		_, content := read_and_decode_file(gz_file)!
+		mut f := os.open(gz_file)!
+		mut r := gzip.new_reader(f)!
+		streamed := io.read_all(reader: r, read_to_end_of_stream: true)!
+		r.close()
+		f.close()
+		assert streamed.bytestr() == content, 'stream decoding of ${gz_file} differs'
+	}
+}
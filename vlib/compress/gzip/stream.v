@@ -0,0 +1,241 @@
+module gzip
+
+import io
+import compress as compr
+import hash.crc32
+
+const header_size = 10
+const trailer_size = 8
+
+// WriterParams set the compression level of a gzip Writer, in the range 0..10 (see compress.default_compression)
+@[params]
+pub struct WriterParams {
+pub:
+	level int = compr.default_compression
+}
+
+// Writer compresses the data written to it using gzip, and writes the result to another writer.
+// Unlike compress/2, it does not need the whole input or output in memory.
+@[heap]
+pub struct Writer {
+mut:
+	w      io.Writer
+	d      &compr.DeflateWriter
+	crc    u32
+	length u32
+	closed bool
+}
+
+// new_writer returns a Writer, that writes gzip compressed data to `w`.
+// Call `close()` after the last write, to write the end of the gzip stream.
+pub fn new_writer(w io.Writer, params WriterParams) !&Writer {
+	flags := compr.deflate_flags(params.level, false)!
+	mut res := &Writer{
+		w: w
+		d: compr.new_deflate_writer(w, flags)!
+	}
+	res.write_raw([
+		u8(0x1f), // magic numbers (1F 8B)
+		0x8b,
+		0x08, // deflate
+		0x00, // header flags
+		0x00, // 4-byte timestamp, 0 = no timestamp (00 00 00 00)
+		0x00,
+		0x00,
+		0x00,
+		0x00, // extra flags
+		0xff, // operating system id (0xff = unknown)
+	])!
+	return res
+}
+
+// write compresses the bytes in `buf`
+pub fn (mut w Writer) write(buf []u8) !int {
+	if w.closed {
+		return error('the gzip stream is already closed')
+	}
+	n := w.d.write(buf)!
+	w.crc = crc32.update(w.crc, buf)
+	w.length += u32(buf.len)
+	return n
+}
+
+// flush writes all pending compressed output to the underlying writer
+pub fn (mut w Writer) flush() ! {
+	w.d.flush()!
+}
+
+// close writes the end of the compressed data and the gzip trailer. It does not close the underlying writer.
+pub fn (mut w Writer) close() ! {
+	if w.closed {
+		return
+	}
+	w.closed = true
+	w.d.close()!
+	w.write_raw([
+		u8(w.crc),
+		u8(w.crc >> 8),
+		u8(w.crc >> 16),
+		u8(w.crc >> 24),
+		u8(w.length),
+		u8(w.length >> 8),
+		u8(w.length >> 16),
+		u8(w.length >> 24),
+	])!
+}
+
+fn (mut w Writer) write_raw(buf []u8) ! {
+	mut written := 0
+	for written < buf.len {
+		n := w.w.write(buf[written..])!
+		if n <= 0 {
+			return error('the underlying writer accepted no data')
+		}
+		written += n
+	}
+}
+
+// Reader reads gzip compressed data from another reader, and returns the decompressed data.
+// Unlike decompress/2, it does not need the whole input or output in memory.
+@[heap]
+pub struct Reader {
+mut:
+	d      &compr.InflateReader
+	params DecompressParams
+	crc    u32
+	length u32
+	done   bool
+pub:
+	header GzipHeader
+}
+
+// new_reader reads and validates the gzip header from `r`, and returns a Reader,
+// that decompresses the rest of the data. The checksum and the length in the trailer
+// are verified, when the end of the compressed data is reached.
+pub fn new_reader(r io.Reader, params DecompressParams) !&Reader {
+	mut d := compr.new_inflate_reader(r, 0)!
+	header := read_header(mut d, params) or {
+		d.close()
+		return err
+	}
+	return &Reader{
+		d:      d
+		params: params
+		header: header
+	}
+}
+
+// read decompresses data into `buf`, and returns the number of bytes written to it.
+// Concatenated gzip members are decompressed one after another.
+// It returns io.Eof after the end of the last gzip member.
+pub fn (mut r Reader) read(mut buf []u8) !int {
+	for !r.done {
+		n := r.d.read(mut buf) or {
+			if err !is io.Eof {
+				return err
+			}
+			r.verify_trailer()!
+			if r.d.raw_eof()! {
+				r.done = true
+				break
+			}
+			r.d.reset()!
+			read_header(mut r.d, r.params)!
+			r.crc = 0
+			r.length = 0
+			continue
+		}
+		r.crc = crc32.update(r.crc, buf[..n])
+		r.length += u32(n)
+		return n
+	}
+	return io.Eof{}
+}
+
+// close frees the decompressor. It does not close the underlying reader.
+pub fn (mut r Reader) close() {
+	r.done = true
+	r.d.close()
+}
+
+fn (mut r Reader) verify_trailer() ! {
+	trailer := read_raw_bytes(mut r.d, trailer_size)!
+	checksum_expected := u32(trailer[0]) | (u32(trailer[1]) << 8) | (u32(trailer[2]) << 16) | (u32(trailer[3]) << 24)
+	length_expected := u32(trailer[4]) | (u32(trailer[5]) << 8) | (u32(trailer[6]) << 16) | (u32(trailer[7]) << 24)
+	if r.params.verify_length && r.length != length_expected {
+		return error('length verification failed, got ${r.length}, expected ${length_expected}')
+	}
+	if r.params.verify_checksum && r.crc != checksum_expected {
+		return error('checksum verification failed')
+	}
+}
+
+// read_header reads the gzip header through the raw input of `d`, so that the following
+// compressed data stays in its input buffer
+@[direct_array_access]
+fn read_header(mut d compr.InflateReader, params DecompressParams) !GzipHeader {
+	mut raw := read_raw_bytes(mut d, header_size) or {
+		return error('data is too short, not gzip compressed?')
+	}
+	if raw[0] != 0x1f || raw[1] != 0x8b {
+		return error('wrong magic numbers, not gzip compressed?')
+	} else if raw[2] != 0x08 {
+		return error('gzip data is not compressed with DEFLATE')
+	}
+	flags := raw[3]
+	if flags & reserved_bits > 0 {
+		return error('reserved flags are set, unsupported field detected')
+	}
+	mut header := GzipHeader{
+		modification_time: u32(raw[4]) | (u32(raw[5]) << 8) | (u32(raw[6]) << 16) | (u32(raw[7]) << 24)
+		operating_system:  raw[9]
+	}
+	if flags & fextra > 0 {
+		xlen_bytes := read_raw_bytes(mut d, 2)!
+		raw << xlen_bytes
+		header.extra = read_raw_bytes(mut d, int(xlen_bytes[0]) | (int(xlen_bytes[1]) << 8))!
+		raw << header.extra
+	}
+	if flags & fname > 0 {
+		header.filename = read_raw_zero_terminated(mut d)!
+		raw << header.filename
+		raw << 0
+	}
+	if flags & fcomment > 0 {
+		header.comment = read_raw_zero_terminated(mut d)!
+		raw << header.comment
+		raw << 0
+	}
+	if flags & fhcrc > 0 {
+		crc16 := read_raw_bytes(mut d, 2)!
+		expected := u32(crc16[0]) | (u32(crc16[1]) << 8)
+		if params.verify_header_checksum && crc32.sum(raw) & 0xffff != expected {
+			return error('header checksum verification failed')
+		}
+		raw << crc16
+	}
+	header.length = raw.len
+	return header
+}
+
+fn read_raw_bytes(mut d compr.InflateReader, n int) ![]u8 {
+	mut res := []u8{len: n}
+	mut pos := 0
+	for pos < n {
+		pos += d.read_raw(mut res[pos..]) or { return error('data too short') }
+	}
+	return res
+}
+
+fn read_raw_zero_terminated(mut d compr.InflateReader) ![]u8 {
+	mut res := []u8{}
+	mut b := []u8{len: 1}
+	for {
+		d.read_raw(mut b) or { return error('data too short') }
+		if b[0] == 0 {
+			break
+		}
+		res << b[0]
+	}
+	return res
+}
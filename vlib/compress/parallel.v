@@ -0,0 +1,196 @@
+module compress
+
+import io
+import runtime
+import arrays.parallel
+
+// BlockCompressor compresses one block of the input into a self contained unit, like a gzip member
+// or a zstd frame, so that the units of consecutive blocks can be concatenated into a single stream.
+pub type BlockCompressor = fn (block []u8) ![]u8
+
+// ParallelParams set how compress_blocks/3 and ParallelWriter split the work between the threads.
+@[params]
+pub struct ParallelParams {
+pub:
+	block_size int = 1024 * 1024 // the input is split into blocks of this size, that are compressed independently
+	workers    int // 0 by default, so that VJOBS will be used, through runtime.nr_jobs()
+}
+
+// BlockResult is the output of a BlockCompressor for one block
+struct BlockResult {
+	data []u8
+	err  string // the message of the error of the BlockCompressor, when it failed
+}
+
+fn compress_block_result(block []u8, compress_block BlockCompressor) BlockResult {
+	data := compress_block(block) or {
+		return BlockResult{
+			err: err.msg()
+		}
+	}
+	return BlockResult{
+		data: data
+	}
+}
+
+// compress_blocks splits `data` into blocks of `params.block_size` bytes, compresses them with
+// `compress_block` on several threads, and returns the concatenation of the results, in order.
+// It is the shared implementation of the `compress_parallel` functions of the gzip and zstd modules.
+pub fn compress_blocks(data []u8, compress_block BlockCompressor, params ParallelParams) ![]u8 {
+	if params.block_size <= 0 {
+		return error('block size should be positive')
+	}
+	if data.len <= params.block_size {
+		return compress_block(data)
+	}
+	block_size := params.block_size
+	nblocks := (data.len + block_size - 1) / block_size
+	starts := []int{len: nblocks, init: index * block_size}
+	results := parallel.amap(starts, fn [data, compress_block, block_size] (start int) BlockResult {
+		end := if data.len - start > block_size { start + block_size } else { data.len }
+		return compress_block_result(data[start..end], compress_block)
+	}, workers: params.workers, grain: 1)
+	mut total := 0
+	for r in results {
+		if r.err != '' {
+			return error(r.err)
+		}
+		total += r.data.len
+	}
+	mut result := []u8{cap: total}
+	for r in results {
+		result << r.data
+	}
+	return result
+}
+
+struct BlockJob {
+	block  []u8
+	result chan BlockResult
+}
+
+// ParallelWriter compresses the data written to it in blocks, like compress_blocks/3, and writes the
+// compressed blocks to another writer, in order. Its worker threads are started once, and compress
+// the blocks while the next ones are buffered, and the previous ones are written. At most 2 blocks
+// per worker are in flight, so it can compress inputs, that are much larger than the available memory.
+@[heap]
+pub struct ParallelWriter {
+mut:
+	w          io.Writer
+	block_size int
+	max_queued int
+	pending    []u8 // the input of the next block
+	jobs       chan BlockJob
+	queue      []chan BlockResult // the results of the blocks, that were not written yet, in order
+	workers    []thread
+	submitted  bool
+	closed     bool
+}
+
+// new_parallel_writer returns a ParallelWriter, that compresses the blocks with `compress_block`,
+// and writes them to `w`. Call `close()` after the last write (or after an error), to write the
+// remaining data, and to stop the worker threads.
+pub fn new_parallel_writer(w io.Writer, compress_block BlockCompressor, params ParallelParams) !&ParallelWriter {
+	if params.block_size <= 0 {
+		return error('block size should be positive')
+	}
+	nworkers := if params.workers > 0 { params.workers } else { runtime.nr_jobs() }
+	mut pw := &ParallelWriter{
+		w:          w
+		block_size: params.block_size
+		max_queued: 2 * nworkers
+		pending:    []u8{cap: params.block_size}
+		jobs:       chan BlockJob{cap: nworkers}
+	}
+	for _ in 0 .. nworkers {
+		pw.workers << spawn block_worker(pw.jobs, compress_block)
+	}
+	return pw
+}
+
+// block_worker compresses the blocks, that it receives from `jobs`, until `jobs` is closed
+fn block_worker(jobs chan BlockJob, compress_block BlockCompressor) {
+	for {
+		job := <-jobs or { break }
+		job.result <- compress_block_result(job.block, compress_block)
+	}
+}
+
+// write buffers the bytes in `buf`. Each full block is handed to a worker thread, and the
+// compressed blocks, that are ready, are written to the underlying writer.
+pub fn (mut pw ParallelWriter) write(buf []u8) !int {
+	if pw.closed {
+		return error('the parallel writer is already closed')
+	}
+	mut pos := 0
+	for pos < buf.len {
+		n := if buf.len - pos < pw.block_size - pw.pending.len {
+			buf.len - pos
+		} else {
+			pw.block_size - pw.pending.len
+		}
+		pw.pending << buf[pos..pos + n]
+		pos += n
+		if pw.pending.len == pw.block_size {
+			pw.submit()!
+		}
+	}
+	return buf.len
+}
+
+// close compresses and writes the remaining buffered data, and stops the worker threads.
+// It does not close the underlying writer.
+pub fn (mut pw ParallelWriter) close() ! {
+	if pw.closed {
+		return
+	}
+	pw.closed = true
+	defer {
+		pw.jobs.close()
+		pw.workers.wait()
+	}
+	if pw.pending.len > 0 || !pw.submitted {
+		// even an empty input produces a valid gzip member, or zstd frame
+		pw.submit()!
+	}
+	for pw.queue.len > 0 {
+		pw.write_oldest()!
+	}
+}
+
+// submit hands the pending block to the workers. When too many blocks are in flight, it waits for
+// the oldest ones first. Then it writes the compressed blocks, that are already done, in order.
+fn (mut pw ParallelWriter) submit() ! {
+	for pw.queue.len >= pw.max_queued {
+		pw.write_oldest()!
+	}
+	result := chan BlockResult{cap: 1}
+	pw.jobs <- BlockJob{
+		block:  pw.pending
+		result: result
+	}
+	pw.queue << result
+	pw.pending = []u8{cap: pw.block_size}
+	pw.submitted = true
+	for pw.queue.len > 0 && pw.queue[0].len > 0 {
+		pw.write_oldest()!
+	}
+}
+
+// write_oldest waits for the oldest block in flight, and writes it to the underlying writer
+fn (mut pw ParallelWriter) write_oldest() ! {
+	result := pw.queue[0]
+	pw.queue.delete(0)
+	r := <-result
+	if r.err != '' {
+		return error(r.err)
+	}
+	mut written := 0
+	for written < r.data.len {
+		n := pw.w.write(r.data[written..])!
+		if n <= 0 {
+			return error('the underlying writer accepted no data')
+		}
+		written += n
+	}
+}
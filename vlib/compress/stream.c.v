@@ -0,0 +1,343 @@
+module compress
+
+import io
+
+// The streaming compressor and decompressor use fixed size buffers, so the memory they need
+// does not depend on the size of the data, that passes through them.
+const stream_buffer_size = 64 * 1024
+// TINFL_LZ_DICT_SIZE; the decompressor writes its output into a wrapping buffer of this size
+const dict_size = 32768
+
+// tdefl_flush
+const tdefl_no_flush = 0
+const tdefl_sync_flush = 2
+const tdefl_finish = 4
+
+// tdefl_status
+const tdefl_status_okay = 0
+const tdefl_status_done = 1
+
+// tinfl_status
+const tinfl_status_failed_cannot_make_progress = -4
+const tinfl_status_adler32_mismatch = -2
+const tinfl_status_done = 0
+const tinfl_status_has_more_output = 2
+
+// TINFL_FLAG_HAS_MORE_INPUT, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF
+const tinfl_flag_has_more_input = u32(2)
+const tinfl_flag_using_non_wrapping_output_buf = u32(4)
+
+// no_compression, best_speed, best_compression and default_compression are the usual
+// zlib compression levels. Level 10 is also accepted; it is slower than 9, but may compress a bit better.
+pub const no_compression = 0
+pub const best_speed = 1
+pub const best_compression = 9
+pub const default_compression = 6
+
+@[typedef]
+struct C.tdefl_compressor {}
+
+@[typedef]
+struct C.tinfl_decompressor {}
+
+fn C.tdefl_compressor_alloc() &C.tdefl_compressor
+fn C.tdefl_compressor_free(d &C.tdefl_compressor)
+fn C.tdefl_init(d &C.tdefl_compressor, put_buf_func voidptr, put_buf_user voidptr, flags int) int
+fn C.tdefl_compress(d &C.tdefl_compressor, in_buf voidptr, in_buf_size &usize, out_buf voidptr, out_buf_size &usize, flush int) int
+fn C.tdefl_create_comp_flags_from_zip_params(level int, window_bits int, strategy int) u32
+fn C.tinfl_decompressor_alloc() &C.tinfl_decompressor
+fn C.tinfl_decompressor_free(r &C.tinfl_decompressor)
+fn C.tinfl_init(r &C.tinfl_decompressor)
+fn C.tinfl_decompress(r &C.tinfl_decompressor, in_buf_next &u8, in_buf_size &usize, out_buf_start &u8, out_buf_next &u8, out_buf_size &usize, flags u32) int
+
+// deflate_flags returns the compressor flags for the given compression `level` (0..10).
+// When `zlib_header` is true, the compressed data will be wrapped in a zlib header and an Adler-32 trailer.
+pub fn deflate_flags(level int, zlib_header bool) !int {
+	if level !in 0..11 {
+		return error('compression level should be in [0,10]')
+	}
+	window_bits := if zlib_header { 15 } else { -15 }
+	return int(C.tdefl_create_comp_flags_from_zip_params(level, window_bits, 0))
+}
+
+// DeflateWriter compresses the data written to it, and writes the compressed data to another writer,
+// in chunks of at most 64KB. Call `finish()` or `close()` after the last write, to end the compressed stream.
+// NB: this is a low level api, the writers from zlib/gzip/deflate should be preferred
+@[heap]
+pub struct DeflateWriter {
+mut:
+	w        io.Writer
+	comp     &C.tdefl_compressor = unsafe { nil }
+	out      []u8
+	finished bool
+}
+
+// new_deflate_writer returns a writer, that compresses the data written to it based on the provided `flags`,
+// and writes the result to `w`. See also deflate_flags/2 .
+pub fn new_deflate_writer(w io.Writer, flags int) !&DeflateWriter {
+	comp := C.tdefl_compressor_alloc()
+	if comp == unsafe { nil } {
+		return error('cannot allocate the compressor')
+	}
+	if C.tdefl_init(comp, unsafe { nil }, unsafe { nil }, flags) != tdefl_status_okay {
+		C.tdefl_compressor_free(comp)
+		return error('invalid compression flags')
+	}
+	return &DeflateWriter{
+		w:    w
+		comp: comp
+		out:  []u8{len: stream_buffer_size}
+	}
+}
+
+// write compresses the bytes in `buf`. Some of the compressed output may be kept in the compressor,
+// until the next write, flush or finish call.
+pub fn (mut d DeflateWriter) write(buf []u8) !int {
+	if d.finished {
+		return error('the compressed stream is already finished')
+	}
+	d.deflate(buf, tdefl_no_flush)!
+	return buf.len
+}
+
+// flush writes all pending compressed output to the underlying writer, aligned to a byte boundary,
+// so that a reader can decompress everything written so far. Frequent flushes hurt the compression ratio.
+pub fn (mut d DeflateWriter) flush() ! {
+	if d.finished {
+		return
+	}
+	d.deflate([]u8{}, tdefl_sync_flush)!
+}
+
+// finish writes the remaining compressed output and the end of the compressed stream.
+// It does not close the underlying writer.
+pub fn (mut d DeflateWriter) finish() ! {
+	if d.finished {
+		return
+	}
+	d.deflate([]u8{}, tdefl_finish)!
+	d.finished = true
+}
+
+// close finishes the compressed stream, and frees the compressor. It does not close the underlying writer.
+pub fn (mut d DeflateWriter) close() ! {
+	defer {
+		unsafe { d.free() }
+	}
+	d.finish()!
+}
+
+// free frees the memory used by the compressor
+@[unsafe]
+pub fn (mut d DeflateWriter) free() {
+	if d.comp != unsafe { nil } {
+		C.tdefl_compressor_free(d.comp)
+		d.comp = unsafe { nil }
+	}
+	d.finished = true
+}
+
+fn (mut d DeflateWriter) deflate(buf []u8, flush int) ! {
+	if d.comp == unsafe { nil } {
+		return error('the compressor is closed')
+	}
+	mut pos := 0
+	for {
+		mut in_size := usize(buf.len - pos)
+		mut out_size := usize(d.out.len)
+		status := C.tdefl_compress(d.comp, unsafe { &u8(buf.data) + pos }, &in_size, d.out.data,
+			&out_size, flush)
+		pos += int(in_size)
+		if status < tdefl_status_okay {
+			return error('compression failed')
+		}
+		if out_size > 0 {
+			write_all(mut d.w, d.out[..int(out_size)])!
+		}
+		if status == tdefl_status_done {
+			break
+		}
+		if out_size == usize(d.out.len) {
+			// the output buffer was filled, so there may be more output pending
+			continue
+		}
+		if pos == buf.len && flush != tdefl_finish {
+			break
+		}
+	}
+}
+
+fn write_all(mut w io.Writer, buf []u8) ! {
+	mut written := 0
+	for written < buf.len {
+		n := w.write(buf[written..])!
+		if n <= 0 {
+			return error('the underlying writer accepted no data')
+		}
+		written += n
+	}
+}
+
+// InflateReader reads compressed data from another reader, and returns the decompressed data.
+// It keeps only a 64KB input buffer and the 32KB window of the decompressor in memory.
+// NB: this is a low level api, the readers from zlib/gzip/deflate should be preferred
+@[heap]
+pub struct InflateReader {
+mut:
+	r         io.Reader
+	decomp    &C.tinfl_decompressor = unsafe { nil }
+	flags     u32
+	in_buf    []u8
+	in_pos    int
+	in_len    int
+	in_eof    bool
+	dict      []u8
+	dict_ofs  int // the position in `dict`, where the decompressor will write its next output
+	avail_pos int // the start of the decompressed bytes in `dict`, that were not returned by read yet
+	avail     int
+	done      bool
+}
+
+// new_inflate_reader returns a reader, that decompresses the data read from `r`, based on the provided `flags`
+pub fn new_inflate_reader(r io.Reader, flags int) !&InflateReader {
+	decomp := C.tinfl_decompressor_alloc()
+	if decomp == unsafe { nil } {
+		return error('cannot allocate the decompressor')
+	}
+	return &InflateReader{
+		r:      r
+		decomp: decomp
+		flags:  u32(flags) & ~(tinfl_flag_has_more_input | tinfl_flag_using_non_wrapping_output_buf)
+		in_buf: []u8{len: stream_buffer_size}
+		dict:   []u8{len: dict_size}
+	}
+}
+
+// read decompresses data into `buf`, and returns the number of bytes written to it.
+// It returns io.Eof, after the end of the compressed stream.
+pub fn (mut d InflateReader) read(mut buf []u8) !int {
+	if buf.len == 0 {
+		return 0
+	}
+	for d.avail == 0 {
+		if d.done {
+			return io.Eof{}
+		}
+		d.inflate()!
+	}
+	n := if buf.len < d.avail { buf.len } else { d.avail }
+	copy(mut buf, d.dict[d.avail_pos..d.avail_pos + n])
+	d.avail_pos += n
+	d.avail -= n
+	return n
+}
+
+// read_raw reads the bytes of the underlying reader as they are, without decompressing them.
+// It is useful for reading the headers and trailers of formats like gzip, that wrap
+// the compressed stream. It returns io.Eof, when the underlying reader has no more data.
+pub fn (mut d InflateReader) read_raw(mut buf []u8) !int {
+	if buf.len == 0 {
+		return 0
+	}
+	if d.in_pos == d.in_len {
+		d.fill()!
+		if d.in_len == 0 {
+			return io.Eof{}
+		}
+	}
+	n := copy(mut buf, d.in_buf[d.in_pos..d.in_len])
+	d.in_pos += n
+	return n
+}
+
+// raw_eof returns true, when all the bytes of the underlying reader were consumed
+pub fn (mut d InflateReader) raw_eof() !bool {
+	if d.in_pos == d.in_len {
+		d.fill()!
+	}
+	return d.in_pos == d.in_len
+}
+
+// reset prepares the decompressor for a new compressed stream, that follows the end of the current one
+// in the underlying reader. Any decompressed bytes that were not read yet are discarded.
+pub fn (mut d InflateReader) reset() ! {
+	if d.decomp == unsafe { nil } {
+		return error('the decompressor is closed')
+	}
+	C.tinfl_init(d.decomp)
+	d.dict_ofs = 0
+	d.avail_pos = 0
+	d.avail = 0
+	d.done = false
+}
+
+// close frees the decompressor. It does not close the underlying reader.
+pub fn (mut d InflateReader) close() {
+	unsafe { d.free() }
+}
+
+// free frees the memory used by the decompressor
+@[unsafe]
+pub fn (mut d InflateReader) free() {
+	if d.decomp != unsafe { nil } {
+		C.tinfl_decompressor_free(d.decomp)
+		d.decomp = unsafe { nil }
+	}
+	d.done = true
+	d.avail = 0
+}
+
+fn (mut d InflateReader) fill() ! {
+	d.in_pos = 0
+	d.in_len = 0
+	if d.in_eof {
+		return
+	}
+	n := d.r.read(mut d.in_buf) or {
+		if err !is io.Eof {
+			return err
+		}
+		0
+	}
+	if n <= 0 {
+		d.in_eof = true
+		return
+	}
+	d.in_len = n
+}
+
+fn (mut d InflateReader) inflate() ! {
+	if d.decomp == unsafe { nil } {
+		return error('the decompressor is closed')
+	}
+	if d.in_pos == d.in_len {
+		d.fill()!
+	}
+	flags := if d.in_eof { d.flags } else { d.flags | tinfl_flag_has_more_input }
+	mut in_size := usize(d.in_len - d.in_pos)
+	mut out_size := usize(dict_size - d.dict_ofs)
+	status := unsafe {
+		C.tinfl_decompress(d.decomp, &u8(d.in_buf.data) + d.in_pos, &in_size, &u8(d.dict.data),
+			&u8(d.dict.data) + d.dict_ofs, &out_size, flags)
+	}
+	d.in_pos += int(in_size)
+	d.avail_pos = d.dict_ofs
+	d.avail = int(out_size)
+	d.dict_ofs = (d.dict_ofs + int(out_size)) & (dict_size - 1)
+	if status < tinfl_status_done {
+		if status == tinfl_status_adler32_mismatch {
+			return error('checksum verification failed')
+		}
+		if status == tinfl_status_failed_cannot_make_progress {
+			if d.avail > 0 {
+				// return the data decompressed so far first; the next call reports the error again
+				return
+			}
+			return error('unexpected end of the compressed data')
+		}
+		return error('decompression failed')
+	}
+	if status == tinfl_status_done {
+		d.done = true
+	}
+}
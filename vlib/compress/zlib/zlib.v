@@ -1,5 +1,6 @@
 module zlib
 
+import io
 import compress as compr
 
 // compresses an array of bytes using zlib and returns the compressed bytes in a new array
@@ -15,3 +16,22 @@ pub fn decompress(data []u8) ![]u8 {
 	// flags = TINFL_FLAG_PARSE_ZLIB_HEADER (0x1)
 	return compr.decompress(data, 0x1)
 }
+
+// WriterParams set the compression level of a zlib writer, in the range 0..10 (see compress.default_compression)
+@[params]
+pub struct WriterParams {
+pub:
+	level int = compr.default_compression
+}
+
+// new_writer returns a writer, that compresses the data written to it using zlib, and writes the result to `w`,
+// without keeping the whole input or output in memory. Call `close()` after the last write.
+pub fn new_writer(w io.Writer, params WriterParams) !&compr.DeflateWriter {
+	return compr.new_deflate_writer(w, compr.deflate_flags(params.level, true)!)
+}
+
+// new_reader returns a reader, that decompresses the zlib data read from `r`, and verifies its Adler-32 checksum at the end
+pub fn new_reader(r io.Reader) !&compr.InflateReader {
+	// flags = TINFL_FLAG_PARSE_ZLIB_HEADER (0x1) | TINFL_FLAG_COMPUTE_ADLER32 (0x8)
+	return compr.new_inflate_reader(r, 0x1 | 0x8)
+}
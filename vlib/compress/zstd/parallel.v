@@ -0,0 +1,57 @@
+module zstd
+
+import io
+import compress as compr
+
+// default_block_size is the size of the independently compressed blocks, used by compress_parallel/2
+// and new_parallel_writer/2 by default
+pub const default_block_size = 4 * 1024 * 1024
+
+// ParallelCompressParams set the compression parameters of compress_parallel/2 and new_parallel_writer/2.
+// `compression_level`, `checksum_flag` and `strategy` have the same meaning as in CompressParams.
+@[params]
+pub struct ParallelCompressParams {
+pub:
+	compression_level int = default_c_level()
+	checksum_flag     bool     = true
+	strategy          Strategy = .default
+	block_size        int      = default_block_size // the input is split into blocks of this size, that are compressed independently
+	workers           int // 0 by default, so that VJOBS will be used, through runtime.nr_jobs()
+}
+
+// block_compressor returns the function, that compresses each block into a zstd frame
+fn (params ParallelCompressParams) block_compressor() compr.BlockCompressor {
+	block_params := CompressParams{
+		compression_level: params.compression_level
+		nb_threads:        1
+		checksum_flag:     params.checksum_flag
+		strategy:          params.strategy
+	}
+	return fn [block_params] (block []u8) ![]u8 {
+		return compress(block, block_params)
+	}
+}
+
+fn (params ParallelCompressParams) parallel_params() compr.ParallelParams {
+	return compr.ParallelParams{
+		block_size: params.block_size
+		workers:    params.workers
+	}
+}
+
+// compress_parallel splits `data` into blocks of `params.block_size` bytes, and compresses each block
+// into a separate zstd frame, on several threads. The result is the concatenation of the frames,
+// which zstd tools and decompress/2 decompress as a single stream.
+// Unlike the `nb_threads` parameter of compress/2, the blocks do not share their history, so the work
+// can be split between any number of threads, at the cost of a slightly larger result.
+// Example: b := 'abcde'.repeat(100_000).bytes(); c := zstd.compress_parallel(b, block_size: 65536)!; assert zstd.decompress(c)! == b
+pub fn compress_parallel(data []u8, params ParallelCompressParams) ![]u8 {
+	return compr.compress_blocks(data, params.block_compressor(), params.parallel_params())
+}
+
+// new_parallel_writer returns a compress.ParallelWriter, that compresses the data written to it like
+// compress_parallel/2, and writes the zstd frames to `w`, in order.
+// Call `close()` after the last write, to compress and write the remaining data.
+pub fn new_parallel_writer(w io.Writer, params ParallelCompressParams) !&compr.ParallelWriter {
+	return compr.new_parallel_writer(w, params.block_compressor(), params.parallel_params())
+}
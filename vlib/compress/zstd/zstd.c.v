@@ -439,12 +439,8 @@ pub:
 // extra decompression parameters can be set by `params`
 // Example: b := 'abcdef'.repeat(1000).bytes(); cmpr := zstd.compress(b, compression_level: 10)!; assert cmpr.len < b.len; dc := zstd.decompress(cmpr)!; assert b == dc
 pub fn decompress(data []u8, params DecompressParams) ![]u8 {
-	dst_capacity := C.ZSTD_getFrameContentSize(data.data, frame_header_size_max)
-	if dst_capacity == content_size_unknown {
-		return error('The size cannot be determined, try use streaming mode to decompress data?')
-	} else if dst_capacity == content_size_error {
-		return error('An error occurred (e.g. invalid magic number, srcSize too small)')
-	} else if dst_capacity == 0 {
+	dst_capacity := decompressed_size(data)!
+	if dst_capacity == 0 {
 		return error('The frame is valid but empty')
 	}
 	mut dst := []u8{len: int(dst_capacity)}
@@ -453,6 +449,52 @@ pub fn decompress(data []u8, params DecompressParams) ![]u8 {
 	return dst[..decompressed_size]
 }
 
+// decompressed_size returns the sum of the content sizes of all the frames in `data`.
+// Several frames are produced, when independent blocks are compressed separately, like in compress_parallel/2 .
+// When the size of a frame can not be determined (or the data is corrupted), it returns the content size
+// of the first frame instead, like for a single frame, so that ZSTD_decompress reports the actual error.
+fn decompressed_size(data []u8) !u64 {
+	return frames_content_size(data) or { first_frame_content_size(data)! }
+}
+
+// first_frame_content_size returns the content size, that is stored in the header of the first frame
+fn first_frame_content_size(data []u8) !u64 {
+	size := C.ZSTD_getFrameContentSize(data.data, frame_header_size_max)
+	if size == content_size_unknown {
+		return error('The size cannot be determined, try use streaming mode to decompress data?')
+	} else if size == content_size_error {
+		return error('An error occurred (e.g. invalid magic number, srcSize too small)')
+	}
+	return size
+}
+
+// frames_content_size returns the sum of the content sizes of the frames in `data`, or an error,
+// when one of them is unknown, or when the frames can not be found
+fn frames_content_size(data []u8) !u64 {
+	mut total := u64(0)
+	mut pos := 0
+	for {
+		src := unsafe { &u8(data.data) + pos }
+		remaining := data.len - pos
+		size := C.ZSTD_getFrameContentSize(src, if remaining < frame_header_size_max {
+			usize(remaining)
+		} else {
+			usize(frame_header_size_max)
+		})
+		if size == content_size_unknown || size == content_size_error {
+			return error('the content size of the frame at ${pos} can not be determined')
+		}
+		total += size
+		frame_len := C.ZSTD_findFrameCompressedSize(src, usize(remaining))
+		check_error(frame_len)!
+		pos += int(frame_len)
+		if pos >= data.len {
+			break
+		}
+	}
+	return total
+}
+
 pub struct CCtx {
 mut:
 	ctx &C.ZSTD_CCtx
@@ -359,3 +359,28 @@ fn test_zstd_with_corruption7() {
 	compressed[compressed.len - 1] += 1
 	assert_decompress_error(compressed, "Restored data doesn't match checksum")!
 }
+
+struct TestWriter {
+mut:
+	bytes []u8
+}
+
+fn (mut w TestWriter) write(buf []u8) !int {
+	w.bytes << buf
+	return buf.len
+}
+
+fn test_zstd_compress_parallel() {
+	uncompressed := 'Hello parallel world!'.repeat(20_000).bytes()
+	compressed := compress_parallel(uncompressed, block_size: 65536, workers: 4)!
+	assert compressed.len < uncompressed.len / 10
+	// the frames are decompressed one after another:
+	assert decompress(compressed)! == uncompressed
+	mut tw := TestWriter{}
+	mut w := new_parallel_writer(tw, block_size: 30_000, workers: 3)!
+	for i := 0; i < uncompressed.len; i += 10_000 {
+		w.write(uncompressed[i..i + 10_000])!
+	}
+	w.close()!
+	assert decompress(tw.bytes)! == uncompressed
+}
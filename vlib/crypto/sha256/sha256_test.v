@@ -57,3 +57,17 @@ fn test_crypto_sha256_224() {
 	chksum := digest.sum([])
 	assert chksum.hex() == expected
 }
+
+fn test_crypto_sha256_hash_many() {
+	mut messages := [][]u8{}
+	for n in [0, 1, 55, 56, 63, 64, 65, 119, 120, 1000, 3, 200, 64, 7, 511, 2, 128] {
+		messages << []u8{len: n, init: u8(index * 7 + n)}
+	}
+	sums := sha256.hash_many(messages)
+	assert sums.len == messages.len
+	for i, m in messages {
+		assert sums[i] == sha256.sum256(m)
+	}
+	assert sha256.hash_many([]).len == 0
+	assert sha256.hash_many(['This is a sha256 checksum.'.bytes()])[0].hex() == 'dc7163299659529eae29683eb1ffec50d6c8fc7275ecb10c145fde0e125b8727'
+}
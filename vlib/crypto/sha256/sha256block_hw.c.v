@@ -0,0 +1,126 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+// SHA256 block steps, that use the SHA extensions and the AVX2 instructions of x86-64 CPUs,
+// when the running CPU has them. See sha256block_x86.h for the kernels.
+module sha256
+
+import encoding.binary
+
+#include "@VEXEROOT/vlib/crypto/sha256/sha256block_x86.h"
+
+fn C.v_sha256_cpu_features() int
+fn C.v_sha256_block_shani(state &u32, p &u8, len int)
+fn C.v_sha256_blocks_avx2_x8(state &u32, blocks &&u8)
+
+// the CPU features, that the kernels need, see V_SHA256_SHA_NI and V_SHA256_AVX2
+const hw_features = C.v_sha256_cpu_features()
+const hw_sha_ni = 1
+const hw_avx2 = 2
+
+// the number of messages, that hash_many_hw hashes at the same time
+const lanes = 8
+
+// block_hw hashes the blocks in `p` with the SHA extensions. It returns false,
+// when the CPU does not have them, and block_generic should be used instead.
+@[inline]
+fn block_hw(mut dig Digest, p []u8) bool {
+	if hw_features & hw_sha_ni == 0 {
+		return false
+	}
+	C.v_sha256_block_shani(&u32(dig.h.data), p.data, p.len)
+	return true
+}
+
+// Lane is a message in one of the lanes of hash_many_hw.
+struct Lane {
+mut:
+	msg  int = -1 // the index of the message, -1 when the lane is idle
+	pos  int // the offset of the next block of the message
+	full int // the length of the complete blocks of the message, hashed in place
+	end  int // full + the length of the padded blocks in `tail`
+	tail [128]u8
+}
+
+// start puts the message `m` in the lane, and pads its last (one or two) blocks in `tail`
+@[direct_array_access]
+fn (mut lane Lane) start(idx int, m []u8) {
+	lane.msg = idx
+	lane.pos = 0
+	lane.full = m.len & ~(chunk - 1)
+	rest := m.len - lane.full
+	lane.tail = [128]u8{}
+	for i in 0 .. rest {
+		lane.tail[i] = m[lane.full + i]
+	}
+	lane.tail[rest] = 0x80
+	tail_len := if rest < 56 { chunk } else { 2 * chunk }
+	lane.end = lane.full + tail_len
+	len := u64(m.len) << 3
+	for i in 0 .. 8 {
+		lane.tail[tail_len - 1 - i] = u8(len >> (8 * i))
+	}
+}
+
+// block returns the next block of the message `m` in the lane
+@[inline]
+fn (lane &Lane) block(m []u8) &u8 {
+	if lane.pos < lane.full {
+		return unsafe { &m[lane.pos] }
+	}
+	return unsafe { &lane.tail[lane.pos - lane.full] }
+}
+
+// hash_many_hw hashes the `messages` 8 at a time, in the lanes of the AVX2 registers.
+// When a message is done, the next one takes its lane, so messages of different lengths
+// keep all the lanes busy. It returns none, when the CPU does not have AVX2.
+@[direct_array_access]
+fn hash_many_hw(messages [][]u8) ?[][]u8 {
+	if hw_features & hw_avx2 == 0 || messages.len < 2 {
+		return none
+	}
+	iv := [init0, init1, init2, init3, init4, init5, init6, init7]!
+	idle := [chunk]u8{}
+	mut res := [][]u8{len: messages.len}
+	mut state := []u32{len: 8 * lanes}
+	mut blocks := []&u8{len: lanes, init: unsafe { nil }}
+	mut ls := []Lane{len: lanes}
+	mut next := 0
+	for {
+		mut active := 0
+		for l in 0 .. lanes {
+			if ls[l].msg < 0 && next < messages.len {
+				ls[l].start(next, messages[next])
+				for w in 0 .. 8 {
+					state[w * lanes + l] = iv[w]
+				}
+				next++
+			}
+			if ls[l].msg < 0 {
+				blocks[l] = &idle[0]
+				continue
+			}
+			blocks[l] = ls[l].block(messages[ls[l].msg])
+			active++
+		}
+		if active == 0 {
+			break
+		}
+		C.v_sha256_blocks_avx2_x8(&u32(state.data), &&u8(blocks.data))
+		for l in 0 .. lanes {
+			if ls[l].msg < 0 {
+				continue
+			}
+			ls[l].pos += chunk
+			if ls[l].pos == ls[l].end {
+				mut digest := []u8{len: size}
+				for w in 0 .. 8 {
+					binary.big_endian_put_u32(mut digest[w * 4..], state[w * lanes + l])
+				}
+				res[ls[l].msg] = digest
+				ls[l].msg = -1
+			}
+		}
+	}
+	return res
+}
@@ -0,0 +1,11 @@
+module sha256
+
+// block_hw always returns false on the JS backend, so block_generic is used.
+fn block_hw(mut dig Digest, p []u8) bool {
+	return false
+}
+
+// hash_many_hw always returns none on the JS backend, so the messages are hashed one by one.
+fn hash_many_hw(messages [][]u8) ?[][]u8 {
+	return none
+}
@@ -0,0 +1,204 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+// SHA256 block steps, that use the SHA extensions and AVX2 of x86-64 CPUs.
+// The kernels are compiled for their instruction sets with target attributes,
+// so that the rest of the program does not need them; v_sha256_cpu_features
+// tells which ones the running CPU supports. On other targets and compilers
+// (like tcc), the features are 0 and the kernels are never called.
+#ifndef V_SHA256BLOCK_X86_H
+#define V_SHA256BLOCK_X86_H
+
+#include <stdint.h>
+
+#define V_SHA256_SHA_NI 1
+#define V_SHA256_AVX2 2
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__TINYC__)
+	#define V_SHA256_X86 1
+	#include <cpuid.h>
+	#include <immintrin.h>
+	#define V_SHA256_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+	#define V_SHA256_X86 1
+	#include <intrin.h>
+	#include <immintrin.h>
+	#define V_SHA256_TARGET(isa)
+#endif
+
+#ifdef V_SHA256_X86
+
+static const uint32_t v_sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void v_sha256_cpuid(uint32_t leaf, uint32_t sub, uint32_t r[4]) {
+#ifdef _MSC_VER
+	int regs[4];
+	__cpuidex(regs, (int)leaf, (int)sub);
+	r[0] = (uint32_t)regs[0]; r[1] = (uint32_t)regs[1]; r[2] = (uint32_t)regs[2]; r[3] = (uint32_t)regs[3];
+#else
+	__cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static int v_sha256_cpu_features(void) {
+	uint32_t r[4];
+	int features = 0;
+	v_sha256_cpuid(0, 0, r);
+	if (r[0] < 7) {
+		return 0;
+	}
+	v_sha256_cpuid(1, 0, r);
+	uint32_t ecx1 = r[2];
+	v_sha256_cpuid(7, 0, r);
+	uint32_t ebx7 = r[1];
+	int ssse3 = (ecx1 >> 9) & 1;
+	int sse41 = (ecx1 >> 19) & 1;
+	if ((ebx7 >> 29) & 1 && ssse3 && sse41) {
+		features |= V_SHA256_SHA_NI;
+	}
+	// AVX2 also needs the OS to save the ymm registers, on context switches
+	if ((ecx1 >> 27) & 1 && (ecx1 >> 28) & 1 && (ebx7 >> 5) & 1) {
+#ifdef _MSC_VER
+		uint64_t xcr0 = _xgetbv(0);
+#else
+		uint32_t lo, hi;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		uint64_t xcr0 = ((uint64_t)hi << 32) | lo;
+#endif
+		if ((xcr0 & 6) == 6) {
+			features |= V_SHA256_AVX2;
+		}
+	}
+	return features;
+}
+
+// rounds 4*i .. 4*i+3, with the message words `m` (w[4*i .. 4*i+3])
+#define V_SHA256_RNDS(m, i) \
+	msg = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *)&v_sha256_k[4 * (i)])); \
+	s1 = _mm_sha256rnds2_epu32(s1, s0, msg); \
+	msg = _mm_shuffle_epi32(msg, 0x0E); \
+	s0 = _mm_sha256rnds2_epu32(s0, s1, msg);
+// finishes the next message words `next`, from `cur` and `prev`
+#define V_SHA256_MSG2(next, cur, prev) \
+	next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4)), cur);
+// starts the message words 3 steps ahead, in `prev`
+#define V_SHA256_MSG1(prev, cur) prev = _mm_sha256msg1_epu32(prev, cur);
+
+// v_sha256_block_shani hashes the `len` bytes (a multiple of 64) at `p` into `state`
+V_SHA256_TARGET("sha,sse4.1,ssse3")
+static void v_sha256_block_shani(uint32_t *state, const uint8_t *p, int len) {
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i msg, m0, m1, m2, m3;
+	// the rounds instructions need the state as ABEF and CDGH
+	__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);
+	__m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B);
+	__m128i s0 = _mm_alignr_epi8(tmp, s1, 8);
+	s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+	for (; len >= 64; len -= 64, p += 64) {
+		__m128i abef = s0;
+		__m128i cdgh = s1;
+		m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), mask);
+		m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), mask);
+		m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), mask);
+		m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), mask);
+		V_SHA256_RNDS(m0, 0)
+		V_SHA256_RNDS(m1, 1) V_SHA256_MSG1(m0, m1)
+		V_SHA256_RNDS(m2, 2) V_SHA256_MSG1(m1, m2)
+		V_SHA256_RNDS(m3, 3) V_SHA256_MSG2(m0, m3, m2) V_SHA256_MSG1(m2, m3)
+		V_SHA256_RNDS(m0, 4) V_SHA256_MSG2(m1, m0, m3) V_SHA256_MSG1(m3, m0)
+		V_SHA256_RNDS(m1, 5) V_SHA256_MSG2(m2, m1, m0) V_SHA256_MSG1(m0, m1)
+		V_SHA256_RNDS(m2, 6) V_SHA256_MSG2(m3, m2, m1) V_SHA256_MSG1(m1, m2)
+		V_SHA256_RNDS(m3, 7) V_SHA256_MSG2(m0, m3, m2) V_SHA256_MSG1(m2, m3)
+		V_SHA256_RNDS(m0, 8) V_SHA256_MSG2(m1, m0, m3) V_SHA256_MSG1(m3, m0)
+		V_SHA256_RNDS(m1, 9) V_SHA256_MSG2(m2, m1, m0) V_SHA256_MSG1(m0, m1)
+		V_SHA256_RNDS(m2, 10) V_SHA256_MSG2(m3, m2, m1) V_SHA256_MSG1(m1, m2)
+		V_SHA256_RNDS(m3, 11) V_SHA256_MSG2(m0, m3, m2) V_SHA256_MSG1(m2, m3)
+		V_SHA256_RNDS(m0, 12) V_SHA256_MSG2(m1, m0, m3) V_SHA256_MSG1(m3, m0)
+		V_SHA256_RNDS(m1, 13) V_SHA256_MSG2(m2, m1, m0)
+		V_SHA256_RNDS(m2, 14) V_SHA256_MSG2(m3, m2, m1)
+		V_SHA256_RNDS(m3, 15)
+		s0 = _mm_add_epi32(s0, abef);
+		s1 = _mm_add_epi32(s1, cdgh);
+	}
+	tmp = _mm_shuffle_epi32(s0, 0x1B);
+	s1 = _mm_shuffle_epi32(s1, 0xB1);
+	_mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, s1, 0xF0));
+	_mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(s1, tmp, 8));
+}
+
+#define V_SHA256_ROR8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define V_SHA256_BE32(b, i) \
+	((uint32_t)(b)[4 * (i)] << 24 | (uint32_t)(b)[4 * (i) + 1] << 16 | (uint32_t)(b)[4 * (i) + 2] << 8 | (uint32_t)(b)[4 * (i) + 3])
+
+// v_sha256_blocks_avx2_x8 hashes one 64 byte block of 8 independent messages, one in each
+// 32 bit lane. `state` has the words of the 8 states interleaved: word i of lane l is at 8*i+l.
+V_SHA256_TARGET("avx2")
+static void v_sha256_blocks_avx2_x8(uint32_t *state, const uint8_t **blocks) {
+	__m256i w[16];
+	__m256i s[8];
+	for (int i = 0; i < 16; i++) {
+		w[i] = _mm256_setr_epi32((int)V_SHA256_BE32(blocks[0], i), (int)V_SHA256_BE32(blocks[1], i),
+			(int)V_SHA256_BE32(blocks[2], i), (int)V_SHA256_BE32(blocks[3], i),
+			(int)V_SHA256_BE32(blocks[4], i), (int)V_SHA256_BE32(blocks[5], i),
+			(int)V_SHA256_BE32(blocks[6], i), (int)V_SHA256_BE32(blocks[7], i));
+	}
+	for (int i = 0; i < 8; i++) {
+		s[i] = _mm256_loadu_si256((const __m256i *)&state[8 * i]);
+	}
+	__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+	for (int i = 0; i < 64; i++) {
+		if (i >= 16) {
+			__m256i v1 = w[(i - 2) & 15];
+			__m256i v2 = w[(i - 15) & 15];
+			__m256i t1 = _mm256_xor_si256(_mm256_xor_si256(V_SHA256_ROR8(v1, 17), V_SHA256_ROR8(v1, 19)), _mm256_srli_epi32(v1, 10));
+			__m256i t2 = _mm256_xor_si256(_mm256_xor_si256(V_SHA256_ROR8(v2, 7), V_SHA256_ROR8(v2, 18)), _mm256_srli_epi32(v2, 3));
+			w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(t1, w[(i - 7) & 15]), _mm256_add_epi32(t2, w[i & 15]));
+		}
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(V_SHA256_ROR8(e, 6), V_SHA256_ROR8(e, 11)), V_SHA256_ROR8(e, 25));
+		__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32((int)v_sha256_k[i]), w[i & 15])));
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(V_SHA256_ROR8(a, 2), V_SHA256_ROR8(a, 13)), V_SHA256_ROR8(a, 22));
+		__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, t1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(t1, _mm256_add_epi32(s0, maj));
+	}
+	_mm256_storeu_si256((__m256i *)&state[0], _mm256_add_epi32(s[0], a));
+	_mm256_storeu_si256((__m256i *)&state[8], _mm256_add_epi32(s[1], b));
+	_mm256_storeu_si256((__m256i *)&state[16], _mm256_add_epi32(s[2], c));
+	_mm256_storeu_si256((__m256i *)&state[24], _mm256_add_epi32(s[3], d));
+	_mm256_storeu_si256((__m256i *)&state[32], _mm256_add_epi32(s[4], e));
+	_mm256_storeu_si256((__m256i *)&state[40], _mm256_add_epi32(s[5], f));
+	_mm256_storeu_si256((__m256i *)&state[48], _mm256_add_epi32(s[6], g));
+	_mm256_storeu_si256((__m256i *)&state[56], _mm256_add_epi32(s[7], h));
+}
+
+#else
+
+static int v_sha256_cpu_features(void) {
+	return 0;
+}
+
+static void v_sha256_block_shani(uint32_t *state, const uint8_t *p, int len) {
+}
+
+static void v_sha256_blocks_avx2_x8(uint32_t *state, const uint8_t **blocks) {
+}
+
+#endif
+
+#endif
@@ -312,6 +312,17 @@ fn block(mut dig Digest, p []u8) {
 	block_generic(mut dig, p)
 }
 
+// hash_many returns the SHA512 checksums of all the `messages`, in the same order.
+// On CPUs with AVX2, it hashes 4 messages at the same time, which is much faster
+// than calling sum512 for each one, when there are many short messages.
+// Example: assert sha512.hash_many(['V'.bytes()])[0].hex() == sha512.hexhash('V')
+pub fn hash_many(messages [][]u8) [][]u8 {
+	if res := hash_many_hw(messages) {
+		return res
+	}
+	return messages.map(sum512(it))
+}
+
 // size returns the size of the checksum in bytes.
 pub fn (d &Digest) size() int {
 	match d.function {
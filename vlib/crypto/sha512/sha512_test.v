@@ -90,3 +90,17 @@ fn test_crypto_sha512_256() {
 	chksum := d.sum([])
 	assert chksum.hex() == expected
 }
+
+fn test_crypto_sha512_hash_many() {
+	mut messages := [][]u8{}
+	for n in [0, 1, 111, 112, 127, 128, 129, 239, 240, 1000, 3, 300, 128, 7] {
+		messages << []u8{len: n, init: u8(index * 7 + n)}
+	}
+	sums := sha512.hash_many(messages)
+	assert sums.len == messages.len
+	for i, m in messages {
+		assert sums[i] == sha512.sum512(m)
+	}
+	assert sha512.hash_many([]).len == 0
+	assert sha512.hash_many(['This is a sha512 checksum.'.bytes()])[0].hex() == final_result
+}
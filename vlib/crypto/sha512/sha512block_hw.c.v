@@ -0,0 +1,114 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+// SHA512 multi-buffer block step, that uses the AVX2 instructions of x86-64 CPUs,
+// when the running CPU has them. See sha512block_x86.h for the kernel.
+module sha512
+
+import encoding.binary
+
+#include "@VEXEROOT/vlib/crypto/sha512/sha512block_x86.h"
+
+fn C.v_sha512_cpu_features() int
+fn C.v_sha512_blocks_avx2_x4(state &u64, blocks &&u8)
+
+// the CPU features, that the kernel needs, see V_SHA512_AVX2
+const hw_features = C.v_sha512_cpu_features()
+const hw_avx2 = 2
+
+// the number of messages, that hash_many_hw hashes at the same time
+const lanes = 4
+
+// Lane is a message in one of the lanes of hash_many_hw.
+struct Lane {
+mut:
+	msg  int = -1 // the index of the message, -1 when the lane is idle
+	pos  int // the offset of the next block of the message
+	full int // the length of the complete blocks of the message, hashed in place
+	end  int // full + the length of the padded blocks in `tail`
+	tail [256]u8
+}
+
+// start puts the message `m` in the lane, and pads its last (one or two) blocks in `tail`
+@[direct_array_access]
+fn (mut lane Lane) start(idx int, m []u8) {
+	lane.msg = idx
+	lane.pos = 0
+	lane.full = m.len & ~(chunk - 1)
+	rest := m.len - lane.full
+	lane.tail = [256]u8{}
+	for i in 0 .. rest {
+		lane.tail[i] = m[lane.full + i]
+	}
+	lane.tail[rest] = 0x80
+	tail_len := if rest < 112 { chunk } else { 2 * chunk }
+	lane.end = lane.full + tail_len
+	// the length in bits is 128 bits long, but the upper 64 bits are always 0 here
+	len := u64(m.len) << 3
+	for i in 0 .. 8 {
+		lane.tail[tail_len - 1 - i] = u8(len >> (8 * i))
+	}
+}
+
+// block returns the next block of the message `m` in the lane
+@[inline]
+fn (lane &Lane) block(m []u8) &u8 {
+	if lane.pos < lane.full {
+		return unsafe { &m[lane.pos] }
+	}
+	return unsafe { &lane.tail[lane.pos - lane.full] }
+}
+
+// hash_many_hw hashes the `messages` 4 at a time, in the lanes of the AVX2 registers.
+// When a message is done, the next one takes its lane, so messages of different lengths
+// keep all the lanes busy. It returns none, when the CPU does not have AVX2.
+@[direct_array_access]
+fn hash_many_hw(messages [][]u8) ?[][]u8 {
+	if hw_features & hw_avx2 == 0 || messages.len < 2 {
+		return none
+	}
+	iv := [init0, init1, init2, init3, init4, init5, init6, init7]!
+	idle := [chunk]u8{}
+	mut res := [][]u8{len: messages.len}
+	mut state := []u64{len: 8 * lanes}
+	mut blocks := []&u8{len: lanes, init: unsafe { nil }}
+	mut ls := []Lane{len: lanes}
+	mut next := 0
+	for {
+		mut active := 0
+		for l in 0 .. lanes {
+			if ls[l].msg < 0 && next < messages.len {
+				ls[l].start(next, messages[next])
+				for w in 0 .. 8 {
+					state[w * lanes + l] = iv[w]
+				}
+				next++
+			}
+			if ls[l].msg < 0 {
+				blocks[l] = &idle[0]
+				continue
+			}
+			blocks[l] = ls[l].block(messages[ls[l].msg])
+			active++
+		}
+		if active == 0 {
+			break
+		}
+		C.v_sha512_blocks_avx2_x4(&u64(state.data), &&u8(blocks.data))
+		for l in 0 .. lanes {
+			if ls[l].msg < 0 {
+				continue
+			}
+			ls[l].pos += chunk
+			if ls[l].pos == ls[l].end {
+				mut digest := []u8{len: size}
+				for w in 0 .. 8 {
+					binary.big_endian_put_u64(mut digest[w * 8..], state[w * lanes + l])
+				}
+				res[ls[l].msg] = digest
+				ls[l].msg = -1
+			}
+		}
+	}
+	return res
+}
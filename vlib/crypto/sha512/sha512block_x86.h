@@ -0,0 +1,151 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+// SHA512 block step, that hashes 4 messages at the same time with the AVX2 instructions
+// of x86-64 CPUs. The kernel is compiled for AVX2 with a target attribute, so that the rest
+// of the program does not need it; v_sha512_cpu_features tells if the running CPU has it.
+// On other targets and compilers (like tcc), the features are 0 and the kernel is never called.
+#ifndef V_SHA512BLOCK_X86_H
+#define V_SHA512BLOCK_X86_H
+
+#include <stdint.h>
+
+#define V_SHA512_AVX2 2
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(__TINYC__)
+	#define V_SHA512_X86 1
+	#include <cpuid.h>
+	#include <immintrin.h>
+	#define V_SHA512_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+	#define V_SHA512_X86 1
+	#include <intrin.h>
+	#include <immintrin.h>
+	#define V_SHA512_TARGET(isa)
+#endif
+
+#ifdef V_SHA512_X86
+
+static const uint64_t v_sha512_k[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static void v_sha512_cpuid(uint32_t leaf, uint32_t sub, uint32_t r[4]) {
+#ifdef _MSC_VER
+	int regs[4];
+	__cpuidex(regs, (int)leaf, (int)sub);
+	r[0] = (uint32_t)regs[0]; r[1] = (uint32_t)regs[1]; r[2] = (uint32_t)regs[2]; r[3] = (uint32_t)regs[3];
+#else
+	__cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static int v_sha512_cpu_features(void) {
+	uint32_t r[4];
+	v_sha512_cpuid(0, 0, r);
+	if (r[0] < 7) {
+		return 0;
+	}
+	v_sha512_cpuid(1, 0, r);
+	uint32_t ecx1 = r[2];
+	v_sha512_cpuid(7, 0, r);
+	uint32_t ebx7 = r[1];
+	// AVX2 also needs the OS to save the ymm registers, on context switches
+	if ((ecx1 >> 27) & 1 && (ecx1 >> 28) & 1 && (ebx7 >> 5) & 1) {
+#ifdef _MSC_VER
+		uint64_t xcr0 = _xgetbv(0);
+#else
+		uint32_t lo, hi;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		uint64_t xcr0 = ((uint64_t)hi << 32) | lo;
+#endif
+		if ((xcr0 & 6) == 6) {
+			return V_SHA512_AVX2;
+		}
+	}
+	return 0;
+}
+
+#define V_SHA512_ROR4(x, n) _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define V_SHA512_BE64(b, i) \
+	((uint64_t)(b)[8 * (i)] << 56 | (uint64_t)(b)[8 * (i) + 1] << 48 | (uint64_t)(b)[8 * (i) + 2] << 40 | \
+	(uint64_t)(b)[8 * (i) + 3] << 32 | (uint64_t)(b)[8 * (i) + 4] << 24 | (uint64_t)(b)[8 * (i) + 5] << 16 | \
+	(uint64_t)(b)[8 * (i) + 6] << 8 | (uint64_t)(b)[8 * (i) + 7])
+
+// v_sha512_blocks_avx2_x4 hashes one 128 byte block of 4 independent messages, one in each
+// 64 bit lane. `state` has the words of the 4 states interleaved: word i of lane l is at 4*i+l.
+V_SHA512_TARGET("avx2")
+static void v_sha512_blocks_avx2_x4(uint64_t *state, const uint8_t **blocks) {
+	__m256i w[16];
+	__m256i s[8];
+	for (int i = 0; i < 16; i++) {
+		w[i] = _mm256_setr_epi64x((long long)V_SHA512_BE64(blocks[0], i), (long long)V_SHA512_BE64(blocks[1], i),
+			(long long)V_SHA512_BE64(blocks[2], i), (long long)V_SHA512_BE64(blocks[3], i));
+	}
+	for (int i = 0; i < 8; i++) {
+		s[i] = _mm256_loadu_si256((const __m256i *)&state[4 * i]);
+	}
+	__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+	for (int i = 0; i < 80; i++) {
+		if (i >= 16) {
+			__m256i v1 = w[(i - 2) & 15];
+			__m256i v2 = w[(i - 15) & 15];
+			__m256i t1 = _mm256_xor_si256(_mm256_xor_si256(V_SHA512_ROR4(v1, 19), V_SHA512_ROR4(v1, 61)), _mm256_srli_epi64(v1, 6));
+			__m256i t2 = _mm256_xor_si256(_mm256_xor_si256(V_SHA512_ROR4(v2, 1), V_SHA512_ROR4(v2, 8)), _mm256_srli_epi64(v2, 7));
+			w[i & 15] = _mm256_add_epi64(_mm256_add_epi64(t1, w[(i - 7) & 15]), _mm256_add_epi64(t2, w[i & 15]));
+		}
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(V_SHA512_ROR4(e, 14), V_SHA512_ROR4(e, 18)), V_SHA512_ROR4(e, 41));
+		__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i t1 = _mm256_add_epi64(_mm256_add_epi64(h, s1), _mm256_add_epi64(ch, _mm256_add_epi64(_mm256_set1_epi64x((long long)v_sha512_k[i]), w[i & 15])));
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(V_SHA512_ROR4(a, 28), V_SHA512_ROR4(a, 34)), V_SHA512_ROR4(a, 39));
+		__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi64(d, t1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi64(t1, _mm256_add_epi64(s0, maj));
+	}
+	_mm256_storeu_si256((__m256i *)&state[0], _mm256_add_epi64(s[0], a));
+	_mm256_storeu_si256((__m256i *)&state[4], _mm256_add_epi64(s[1], b));
+	_mm256_storeu_si256((__m256i *)&state[8], _mm256_add_epi64(s[2], c));
+	_mm256_storeu_si256((__m256i *)&state[12], _mm256_add_epi64(s[3], d));
+	_mm256_storeu_si256((__m256i *)&state[16], _mm256_add_epi64(s[4], e));
+	_mm256_storeu_si256((__m256i *)&state[20], _mm256_add_epi64(s[5], f));
+	_mm256_storeu_si256((__m256i *)&state[24], _mm256_add_epi64(s[6], g));
+	_mm256_storeu_si256((__m256i *)&state[28], _mm256_add_epi64(s[7], h));
+}
+
+#else
+
+static int v_sha512_cpu_features(void) {
+	return 0;
+}
+
+static void v_sha512_blocks_avx2_x4(uint64_t *state, const uint8_t **blocks) {
+}
+
+#endif
+
+#endif
@@ -3,6 +3,8 @@
 // that can be found in the LICENSE file.
 module csv
 
+import os
+
 // Once interfaces are further along the idea would be to have something similar to
 // go's io.reader & bufio.reader rather than reading the whole file into string, this
 // would then satisfy that interface. I designed it this way to be easily adapted.
@@ -48,6 +50,7 @@ struct Reader {
 mut:
 	is_mac_pre_osx_le bool
 	row_pos           int
+	mapped            &os.MmapFile = unsafe { nil } // set by new_mmap_reader_from_file
 }
 
 @[params]
@@ -74,6 +77,16 @@ pub fn (mut r Reader) read() ![]string {
 	return l
 }
 
+// close unmaps the file of a reader, created by new_mmap_reader_from_file/2 .
+// The rows that were already read stay valid, but reading more rows returns an end of file error.
+pub fn (mut r Reader) close() {
+	if r.mapped != unsafe { nil } {
+		r.mapped.close() or {}
+		r.mapped = unsafe { nil }
+	}
+	r.row_pos = r.data.len
+}
+
 // Once we have multi dimensional array
 // pub fn (mut r Reader) read_all() ?[][]string {
 // 	mut records := []string{}
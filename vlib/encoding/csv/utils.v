@@ -10,3 +10,23 @@ pub fn new_reader_from_file(csv_file_path string, config ReaderConfig) !&Reader
 	csv_file_content := os.read_file(csv_file_path)!
 	return new_reader(csv_file_content, config)
 }
+
+// new_mmap_reader_from_file creates a csv reader from a file, that is mapped into memory read-only,
+// instead of being copied to the heap, so only the parts that are being parsed need to be in RAM.
+// Call `close()` on the reader, when you are done with it, to unmap the file. Until then, the file
+// should not be truncated (on POSIX systems, reading the missing part would raise SIGBUS), and on
+// Windows it can not be deleted or replaced.
+pub fn new_mmap_reader_from_file(csv_file_path string, config ReaderConfig) !&Reader {
+	mut m := os.mmap_file(csv_file_path, .read_only) or {
+		return new_reader_from_file(csv_file_path, config)
+	}
+	if m.size == 0 || m.size > u64(max_i32) {
+		// special files like the ones in /proc have no size, but still have content
+		m.close()!
+		return new_reader_from_file(csv_file_path, config)
+	}
+	m.advise(.sequential) or {}
+	mut r := new_reader(m.str(), config)
+	r.mapped = m
+	return r
+}
@@ -23,3 +23,25 @@ fn test_new_reader_from_file() {
 
 	os.rm(test_file_path_for_reader)!
 }
+
+fn test_new_mmap_reader_from_file() {
+	test_file_path_for_reader := os.join_path(os.temp_dir(), 'test_new_mmap_reader_from_file.csv')
+
+	text := 'id,bonus,amount,yes\n1,bomb,1,true\n2,rocket,1,false,\n3,lightning,2,2\n'
+	os.write_file(test_file_path_for_reader, text)!
+
+	mut reader := new_mmap_reader_from_file(test_file_path_for_reader)!
+	mut writer := new_writer()
+
+	for {
+		row := reader.read() or { break }
+		writer.write(row) or { panic(err) }
+	}
+
+	assert text == writer.str()
+	reader.close()
+	// the rows were copied, so they are still valid, but no more rows can be read:
+	assert reader.read() or { ['eof'] } == ['eof']
+
+	os.rm(test_file_path_for_reader)!
+}
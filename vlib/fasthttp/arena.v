@@ -0,0 +1,112 @@
+module fasthttp
+
+// Arena is a growable byte buffer, owned by a single server worker.
+// Handlers can build their responses in `req.arena`, and return `arena.bytes()`
+// as the response content. The server calls `begin` before each handler, so that
+// `bytes()` returns only the response of that handler, even when several pipelined
+// responses are kept in the arena until they are sent together. The server resets
+// the arena in O(1) after the responses have been written, so its memory is reused,
+// and a handler that fits in the arena does not allocate at all.
+@[heap]
+pub struct Arena {
+mut:
+	data  &u8 = unsafe { nil }
+	start int // the start of the current response, see `begin`
+	len   int
+	cap   int
+}
+
+// new_arena creates an arena with an initial capacity of `cap` bytes
+pub fn new_arena(cap int) &Arena {
+	return &Arena{
+		data: unsafe { malloc_noscan(cap) }
+		cap:  cap
+	}
+}
+
+// reserve makes sure, that `n` more bytes can be written without growing the arena
+pub fn (mut a Arena) reserve(n int) {
+	if a.len + n <= a.cap {
+		return
+	}
+	mut new_cap := if a.cap > 0 { a.cap * 2 } else { 4096 }
+	for new_cap < a.len + n {
+		new_cap *= 2
+	}
+	unsafe {
+		new_data := malloc_noscan(new_cap)
+		if a.len > 0 {
+			vmemcpy(new_data, a.data, a.len)
+		}
+		// the old block may still be referenced by a response that was returned
+		// from `bytes()`, so it is left to the GC
+		a.data = new_data
+	}
+	a.cap = new_cap
+}
+
+// write appends the bytes `b` to the arena
+pub fn (mut a Arena) write(b []u8) {
+	if b.len == 0 {
+		return
+	}
+	a.reserve(b.len)
+	unsafe { vmemcpy(a.data + a.len, b.data, b.len) }
+	a.len += b.len
+}
+
+// write_string appends the string `s` to the arena
+pub fn (mut a Arena) write_string(s string) {
+	if s.len == 0 {
+		return
+	}
+	a.reserve(s.len)
+	unsafe { vmemcpy(a.data + a.len, s.str, s.len) }
+	a.len += s.len
+}
+
+// write_decimal appends the decimal representation of `n` to the arena, without allocating
+pub fn (mut a Arena) write_decimal(n i64) {
+	if n == 0 {
+		a.reserve(1)
+		unsafe {
+			a.data[a.len] = `0`
+		}
+		a.len++
+		return
+	}
+	mut digits := [20]u8{}
+	mut x := if n < 0 { u64(-n) } else { u64(n) }
+	mut i := digits.len
+	for x > 0 {
+		i--
+		digits[i] = u8(`0` + x % 10)
+		x /= 10
+	}
+	if n < 0 {
+		i--
+		digits[i] = `-`
+	}
+	a.reserve(digits.len - i)
+	unsafe { vmemcpy(a.data + a.len, &digits[i], digits.len - i) }
+	a.len += digits.len - i
+}
+
+// bytes returns the bytes written since the last `begin` or `reset`.
+// Note: the data is *not* copied, and is only valid until the arena is reset.
+pub fn (a &Arena) bytes() []u8 {
+	return unsafe { (a.data + a.start).vbytes(a.len - a.start) }
+}
+
+// begin starts a new response after the written bytes, which stay valid until the arena is reset
+@[inline]
+pub fn (mut a Arena) begin() {
+	a.start = a.len
+}
+
+// reset discards the content of the arena, keeping its memory for reuse
+@[inline]
+pub fn (mut a Arena) reset() {
+	a.start = 0
+	a.len = 0
+}
@@ -0,0 +1,73 @@
+// Measures the heap allocations and the time per request of a hello world
+// handler, that uses only the borrowed request views and the worker arena.
+// The requests are decoded and handled in process, without any sockets, so
+// that only the request path of fasthttp itself is measured.
+// Run it with: `v -prod run vlib/fasthttp/bench/bench_hello_world_allocations.v`
+module main
+
+import fasthttp
+import time
+
+const hello_request = 'GET /hello?name=world HTTP/1.1\r\nHost: localhost:3000\r\nUser-Agent: bench\r\nConnection: keep-alive\r\n\r\n'.bytes()
+
+const iterations = 1_000_000
+
+fn hello_handler(req fasthttp.HttpRequest) !fasthttp.HttpResponse {
+	mut arena := unsafe { req.arena }
+	if req.method_str() != 'GET' || req.path_str() != '/hello' {
+		arena.write_string('HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n')
+		return fasthttp.HttpResponse{
+			content: arena.bytes()
+		}
+	}
+	name := req.query('name') or { 'stranger' }
+	connection := req.header('connection') or { 'close' }
+	arena.write_string('HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nConnection: ')
+	arena.write_string(connection)
+	arena.write_string('\r\nContent-Length: ')
+	arena.write_decimal('Hello, !'.len + name.len)
+	arena.write_string('\r\n\r\nHello, ')
+	arena.write_string(name)
+	arena.write_string('!')
+	return fasthttp.HttpResponse{
+		content: arena.bytes()
+	}
+}
+
+// allocated_bytes returns the total number of bytes, that were allocated on the heap so far
+fn allocated_bytes() u64 {
+	$if gcboehm ? {
+		return u64(gc_heap_usage().total_bytes)
+	}
+	return 0
+}
+
+fn main() {
+	$if !gcboehm ? {
+		eprintln('note: allocations are counted with the GC statistics, run without `-gc none`')
+	}
+	mut arena := fasthttp.new_arena(4096)
+	mut total_len := 0
+	// warm up, and check the response once
+	mut first := fasthttp.decode_http_request(hello_request) or { panic(err) }
+	first.arena = arena
+	response := hello_handler(first) or { panic(err) }
+	assert response.content.bytestr().ends_with('\r\n\r\nHello, world!')
+
+	before := allocated_bytes()
+	sw := time.new_stopwatch()
+	for _ in 0 .. iterations {
+		mut req := fasthttp.decode_http_request(hello_request) or { panic(err) }
+		arena.reset()
+		req.arena = arena
+		resp := hello_handler(req) or { panic(err) }
+		total_len += resp.content.len
+	}
+	elapsed := sw.elapsed()
+	allocated := allocated_bytes() - before
+	println('requests:              ${iterations}')
+	println('response bytes:        ${total_len}')
+	println('time per request:      ${f64(elapsed.nanoseconds()) / iterations:.1f} ns')
+	println('heap bytes allocated:  ${allocated}')
+	println('heap bytes / request:  ${f64(allocated) / iterations:.3f}')
+}
@@ -17,6 +17,9 @@ $if !windows {
 
 const max_thread_pool_size = runtime.nr_cpus()
 const max_connection_size = 65536 // Max events per epoll_wait
+const arena_initial_size = 16384 // Initial size of the per-worker response arena
+const max_pipelined_responses = 64 // Responses of pipelined requests, sent with a single writev
+const max_write_buffer_size = 1048576 // Queued response bytes, before they are written
 
 const tiny_bad_request_response = 'HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n'.bytes()
 const status_444_response = 'HTTP/1.1 444 No Response\r\nContent-Length: 0\r\nConnection: close\r\n\r\n'.bytes()
@@ -52,7 +55,7 @@ pub:
 // TODO make fields immutable
 pub struct HttpRequest {
 pub mut:
-	buffer         []u8 // A V slice of the read buffer for convenience
+	buffer         []u8 // A view of the read buffer; it is reused after the handler returns
 	method         Slice
 	path           Slice
 	version        Slice
@@ -60,6 +63,9 @@ pub mut:
 	body           Slice
 	client_conn_fd int
 	user_data      voidptr // User-defined context data
+	// arena is owned by the worker that handles the request. It is reset
+	// after the response is written, see `Arena`.
+	arena &Arena = unsafe { nil }
 }
 
 pub struct HttpResponse {
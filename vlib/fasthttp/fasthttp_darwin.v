@@ -60,6 +60,7 @@ pub mut:
 	poll_fd         int // kqueue fd
 	user_data       voidptr
 	request_handler fn (HttpRequest) !HttpResponse @[required]
+	arena           &Arena = unsafe { nil }
 }
 
 // new_server creates and initializes a new Server instance.
@@ -68,6 +69,7 @@ pub fn new_server(config ServerConfig) !&Server {
 		port:            config.port
 		user_data:       config.user_data
 		request_handler: config.handler
+		arena:           new_arena(arena_initial_size)
 	}
 	return server
 }
@@ -203,26 +205,44 @@ fn handle_read(mut s Server, kq int, c_ptr voidptr) {
 		return
 	}
 
-	mut req_buf := []u8{cap: c.read_len}
-	unsafe {
-		req_buf.push_many(&c.read_buf[0], c.read_len)
-	}
-
-	mut decoded := decode_http_request(req_buf) or {
+	// The request borrows the connection read buffer, instead of copying it.
+	// It is valid only until the handler returns.
+	mut decoded := decode_http_request(unsafe { (&c.read_buf[0]).vbytes(c.read_len) }) or {
 		send_bad_request(c.fd)
 		close_conn(kq, c_ptr)
 		return
 	}
 	decoded.client_conn_fd = c.fd
 	decoded.user_data = s.user_data
+	decoded.arena = s.arena
 
 	resp := s.request_handler(decoded) or {
+		s.arena.reset()
 		send_bad_request(c.fd)
 		close_conn(kq, c_ptr)
 		return
 	}
 
-	c.write_buf = resp.content.clone()
+	// Send the response straight from the handler's buffer (often the arena), and copy
+	// only the part, that the socket does not accept without blocking.
+	mut sent := 0
+	if resp.content.len > 0 {
+		n_sent := C.send(c.fd, resp.content.data, resp.content.len, 0)
+		if n_sent < 0 && C.errno != C.EAGAIN && C.errno != C.EWOULDBLOCK {
+			s.arena.reset()
+			close_conn(kq, c_ptr)
+			return
+		}
+		if n_sent > 0 {
+			sent = n_sent
+		}
+	}
+	c.write_buf.clear()
+	if sent < resp.content.len {
+		c.write_buf << resp.content[sent..]
+	}
+	// the rest of the response was copied for the pending writes, so the arena can be reused now
+	s.arena.reset()
 	if resp.file_path != '' {
 		fd := C.open(resp.file_path.str, C.O_RDONLY)
 		if fd != -1 {
@@ -6,6 +6,7 @@ import net
 #include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <netinet/tcp.h>
+#include <sys/uio.h>
 
 fn C.accept4(sockfd int, addr &net.Addr, addrlen &u32, flags int) int
 
@@ -19,6 +20,8 @@ fn C.sendfile(out_fd int, in_fd int, offset &i64, count usize) int
 
 fn C.fstat(fd int, buf &C.stat) int
 
+fn C.writev(fd int, iov &C.iovec, iovcnt int) isize
+
 @[typedef]
 union C.epoll_data_t {
 	ptr voidptr
@@ -32,6 +35,11 @@ struct C.epoll_event {
 	data   C.epoll_data_t
 }
 
+struct C.iovec {
+	iov_base voidptr
+	iov_len  usize
+}
+
 struct Server {
 pub:
 	port                    int = 3000
@@ -193,11 +201,389 @@ fn handle_client_closure(epoll_fd int, client_fd int) {
 	close_socket(client_fd)
 }
 
+// Conn keeps the state of a client connection between events. It is allocated
+// only for connections with an incomplete request, or with output that could
+// not be written without blocking.
+@[heap]
+struct Conn {
+mut:
+	read_buf     []u8 // the start of an incomplete request, from the previous read
+	write_buf    []u8 // response bytes, waiting for the socket to become writable
+	write_pos    int
+	pending_file string // a file response, that is sent after `write_buf`
+}
+
+enum FlushResult {
+	done
+	blocked // the rest of the output was moved to `Conn.write_buf`
+	failed  // the connection was closed
+}
+
+// Worker is the state of one event loop thread
+@[heap]
+struct Worker {
+	epoll_fd int
+mut:
+	request_buffer []u8
+	arena          &Arena
+	conns          []&Conn
+	// the responses to the pipelined requests of one read, sent with a single writev
+	iovs      [max_pipelined_responses]C.iovec
+	iov_count int
+	iov_bytes int
+}
+
+fn (w &Worker) conn(fd int) &Conn {
+	if fd < w.conns.len {
+		return w.conns[fd]
+	}
+	return unsafe { nil }
+}
+
+fn (mut w Worker) conn_state(fd int) &Conn {
+	for fd >= w.conns.len {
+		w.conns << &Conn(unsafe { nil })
+	}
+	if isnil(w.conns[fd]) {
+		w.conns[fd] = &Conn{}
+	}
+	return w.conns[fd]
+}
+
+fn (mut w Worker) close_conn(fd int) {
+	if fd < w.conns.len {
+		w.conns[fd] = unsafe { nil }
+	}
+	handle_client_closure(w.epoll_fd, fd)
+}
+
+// watch_writable enables or disables EPOLLOUT notifications for `fd`
+fn (w &Worker) watch_writable(fd int, enable bool) {
+	mut ev := C.epoll_event{
+		events: if enable {
+			u32(C.EPOLLIN | C.EPOLLOUT | C.EPOLLET)
+		} else {
+			u32(C.EPOLLIN | C.EPOLLET)
+		}
+	}
+	ev.data.fd = fd
+	if C.epoll_ctl(w.epoll_fd, C.EPOLL_CTL_MOD, fd, &ev) == -1 {
+		eprintln('ERROR: epoll_ctl(MOD, fd=${fd}) failed with errno=${C.errno}')
+	}
+}
+
+// save_input keeps the bytes `start..end` of the request buffer for the next read
+fn (mut w Worker) save_input(fd int, start int, end int) {
+	if start >= end {
+		return
+	}
+	mut c := w.conn_state(fd)
+	c.read_buf.clear()
+	unsafe { c.read_buf.push_many(&w.request_buffer[start], end - start) }
+}
+
+// queue adds `content` to the output of the current batch. It is not copied,
+// so it has to stay valid until the next `flush`.
+fn (mut w Worker) queue(content []u8) {
+	if content.len == 0 {
+		return
+	}
+	w.iovs[w.iov_count] = C.iovec{
+		iov_base: content.data
+		iov_len:  usize(content.len)
+	}
+	w.iov_count++
+	w.iov_bytes += content.len
+}
+
+// flush writes the queued output with a single writev. The part that the socket
+// does not accept without blocking is copied to the connection's `write_buf`.
+fn (mut w Worker) flush(fd int) FlushResult {
+	if w.iov_count == 0 {
+		return .done
+	}
+	mut written := C.writev(fd, &w.iovs[0], w.iov_count)
+	for written < 0 && C.errno == C.EINTR {
+		written = C.writev(fd, &w.iovs[0], w.iov_count)
+	}
+	if written < 0 && C.errno != C.EAGAIN && C.errno != C.EWOULDBLOCK {
+		eprintln('ERROR: writev() failed with errno=${C.errno}')
+		w.iov_count = 0
+		w.iov_bytes = 0
+		w.close_conn(fd)
+		return .failed
+	}
+	if written == isize(w.iov_bytes) {
+		w.iov_count = 0
+		w.iov_bytes = 0
+		return .done
+	}
+	mut c := w.conn_state(fd)
+	mut skip := if written > 0 { int(written) } else { 0 }
+	for i in 0 .. w.iov_count {
+		n := int(w.iovs[i].iov_len)
+		if skip >= n {
+			skip -= n
+			continue
+		}
+		unsafe { c.write_buf.push_many(&u8(w.iovs[i].iov_base) + skip, n - skip) }
+		skip = 0
+	}
+	w.iov_count = 0
+	w.iov_bytes = 0
+	w.watch_writable(fd, true)
+	return .blocked
+}
+
+// handle_readable reads from `fd` until the socket is drained, and handles
+// every complete request. The reading stops while the connection has output,
+// that could not be written yet (back-pressure); `handle_writable` resumes it.
+fn (mut w Worker) handle_readable(mut server Server, fd int) {
+	for {
+		mut c := w.conn(fd)
+		mut have := 0
+		if !isnil(c) {
+			if c.write_pos < c.write_buf.len || c.pending_file != '' {
+				return
+			}
+			if c.read_buf.len > 0 {
+				// continue the incomplete request from the previous read
+				have = c.read_buf.len
+				unsafe { vmemcpy(&w.request_buffer[0], c.read_buf.data, have) }
+				c.read_buf.clear()
+			}
+		}
+		space := w.request_buffer.len - 1 - have
+		bytes_read := C.recv(fd, unsafe { &w.request_buffer[have] }, space, 0)
+		if bytes_read == 0 {
+			// Normal client closure (FIN received)
+			w.close_conn(fd)
+			return
+		}
+		if bytes_read < 0 && C.errno != C.EAGAIN && C.errno != C.EWOULDBLOCK {
+			// Unexpected recv error - send 444 No Response
+			C.send(fd, status_444_response.data, status_444_response.len, C.MSG_NOSIGNAL)
+			w.close_conn(fd)
+			return
+		}
+		n := if bytes_read > 0 { int(bytes_read) } else { 0 }
+		if have + n > 0 && !w.handle_requests(mut server, fd, have + n) {
+			return
+		}
+		if n < space {
+			// the socket has no more data for now
+			return
+		}
+	}
+}
+
+// handle_requests handles all complete requests in the first `total` bytes of
+// the request buffer, and sends their responses together. It returns false,
+// when the connection was closed, or when its output is blocked.
+fn (mut w Worker) handle_requests(mut server Server, fd int, total int) bool {
+	// the responses of the previous batch were already sent, or copied
+	w.arena.reset()
+	mut offset := 0
+	for offset < total {
+		len := request_len(w.request_buffer[offset..total]) or {
+			w.queue(tiny_bad_request_response)
+			if w.flush(fd) != .failed {
+				w.close_conn(fd)
+			}
+			return false
+		}
+		if len == 0 {
+			break
+		}
+		// The request borrows the worker's read buffer, instead of copying it.
+		// It is valid only until the handler returns.
+		mut decoded_http_request := decode_http_request(w.request_buffer[offset..offset + len]) or {
+			eprintln('Error decoding request ${err}')
+			w.queue(tiny_bad_request_response)
+			if w.flush(fd) != .failed {
+				w.close_conn(fd)
+			}
+			return false
+		}
+		decoded_http_request.client_conn_fd = fd
+		decoded_http_request.user_data = server.user_data
+		decoded_http_request.arena = w.arena
+		// the responses queued before stay in the arena, until they are sent
+		w.arena.begin()
+		response := server.request_handler(decoded_http_request) or {
+			eprintln('Error handling request ${err}')
+			w.queue(tiny_bad_request_response)
+			if w.flush(fd) != .failed {
+				w.close_conn(fd)
+			}
+			return false
+		}
+		offset += len
+		w.queue(response.content)
+		if response.file_path != '' {
+			// the file has to follow the queued responses
+			match w.flush(fd) {
+				.done {
+					if !send_file(fd, response.file_path) {
+						w.close_conn(fd)
+						return false
+					}
+				}
+				.blocked {
+					mut c := w.conn_state(fd)
+					c.pending_file = response.file_path
+					w.save_input(fd, offset, total)
+					return false
+				}
+				.failed {
+					return false
+				}
+			}
+		}
+		if w.iov_count == max_pipelined_responses || w.iov_bytes >= max_write_buffer_size {
+			match w.flush(fd) {
+				.done {}
+				.blocked {
+					w.save_input(fd, offset, total)
+					return false
+				}
+				.failed {
+					return false
+				}
+			}
+		}
+	}
+	match w.flush(fd) {
+		.done {}
+		.blocked {
+			w.save_input(fd, offset, total)
+			return false
+		}
+		.failed {
+			return false
+		}
+	}
+	if offset == 0 && total >= w.request_buffer.len - 1 {
+		// the buffer is full, without a complete request in it
+		C.send(fd, status_413_response.data, status_413_response.len, C.MSG_NOSIGNAL)
+		w.close_conn(fd)
+		return false
+	}
+	w.save_input(fd, offset, total)
+	return true
+}
+
+// handle_writable sends the output, that was blocked before. It returns `.done`,
+// when all of it was sent, and the paused requests can be resumed.
+fn (mut w Worker) handle_writable(fd int) FlushResult {
+	mut c := w.conn(fd)
+	if isnil(c) {
+		return .done
+	}
+	for c.write_pos < c.write_buf.len {
+		sent := C.send(fd, unsafe { &c.write_buf[c.write_pos] }, c.write_buf.len - c.write_pos,
+			C.MSG_NOSIGNAL)
+		if sent < 0 {
+			if C.errno == C.EINTR {
+				continue
+			}
+			if C.errno == C.EAGAIN || C.errno == C.EWOULDBLOCK {
+				return .blocked
+			}
+			eprintln('ERROR: send() failed with errno=${C.errno}')
+			w.close_conn(fd)
+			return .failed
+		}
+		c.write_pos += sent
+	}
+	c.write_buf.clear()
+	c.write_pos = 0
+	if c.pending_file != '' {
+		path := c.pending_file
+		c.pending_file = ''
+		if !send_file(fd, path) {
+			w.close_conn(fd)
+			return .failed
+		}
+	}
+	w.watch_writable(fd, false)
+	return .done
+}
+
+// send_file sends the content of the file at `path` to `client_fd`
+fn send_file(client_fd int, path string) bool {
+	fd := C.open(path.str, C.O_RDONLY)
+	if fd == -1 {
+		eprintln('ERROR: open file failed')
+		return false
+	}
+	defer {
+		C.close(fd)
+	}
+	mut st := C.stat{}
+	if C.fstat(fd, &st) != 0 {
+		eprintln('ERROR: fstat failed')
+		return false
+	}
+	mut offset := i64(0)
+	mut remaining := i64(st.st_size)
+	mut sf_retries := 0
+	for remaining > 0 {
+		ssize := C.sendfile(client_fd, fd, &offset, usize(remaining))
+		if ssize > 0 {
+			remaining -= i64(ssize)
+			sf_retries = 0
+			continue
+		}
+		errno_val := C.errno
+		match errno_val {
+			C.EAGAIN, C.EWOULDBLOCK, C.EINTR {
+				if sf_retries < 3 {
+					sf_retries++
+					continue
+				}
+				eprintln('ERROR: sendfile() transient failure after ${sf_retries} retries (errno=${errno_val})')
+			}
+			C.EBADF {
+				eprintln('ERROR: sendfile() EBADF: input fd or socket not open for required access (errno=${errno_val})')
+			}
+			C.EFAULT {
+				eprintln('ERROR: sendfile() EFAULT: bad address for offset (errno=${errno_val})')
+			}
+			C.EINVAL {
+				eprintln('ERROR: sendfile() EINVAL: invalid descriptor state or non-seekable input (errno=${errno_val})')
+			}
+			C.EIO {
+				eprintln('ERROR: sendfile() EIO: I/O error while reading input file (errno=${errno_val})')
+			}
+			C.ENOMEM {
+				eprintln('ERROR: sendfile() ENOMEM: insufficient kernel memory (errno=${errno_val})')
+			}
+			C.EOVERFLOW {
+				eprintln('ERROR: sendfile() EOVERFLOW: count exceeds file/socket limits (errno=${errno_val})')
+			}
+			C.ESPIPE {
+				eprintln('ERROR: sendfile() ESPIPE: input file not seekable with offset (errno=${errno_val})')
+			}
+			else {
+				eprintln('ERROR: sendfile() failed with errno=${errno_val}')
+			}
+		}
+		return false
+	}
+	return true
+}
+
 fn process_events(mut server Server, epoll_fd int, listen_fd int) {
 	mut events := [max_connection_size]C.epoll_event{}
-	mut request_buffer := []u8{len: server.max_request_buffer_size, cap: server.max_request_buffer_size}
+	mut w := &Worker{
+		epoll_fd:       epoll_fd
+		request_buffer: []u8{len: server.max_request_buffer_size, cap: server.max_request_buffer_size}
+		arena:          new_arena(arena_initial_size)
+		conns:          []&Conn{len: max_connection_size, init: unsafe { nil }}
+	}
 	unsafe {
-		request_buffer.flags.set(.noslices | .nogrow | .noshrink)
+		w.request_buffer.flags.set(.noslices | .nogrow | .noshrink)
 	}
 	for {
 		num_events := C.epoll_wait(epoll_fd, &events[0], max_connection_size, -1)
@@ -210,146 +596,29 @@ fn process_events(mut server Server, epoll_fd int, listen_fd int) {
 			}
 
 			if events[i].events & u32((C.EPOLLHUP | C.EPOLLERR)) != 0 {
-				if client_fd == listen_fd {
-					eprintln('ERROR: listen fd had HUP/ERR')
-					continue
-				}
 				if client_fd > 0 {
 					// Try to send 444 No Response before closing abnormal connection
 					C.send(client_fd, status_444_response.data, status_444_response.len,
 						C.MSG_NOSIGNAL)
-					handle_client_closure(epoll_fd, client_fd)
+					w.close_conn(client_fd)
 				} else {
 					eprintln('ERROR: Invalid FD from epoll: ${client_fd}')
 				}
 				continue
 			}
-			if events[i].events & u32(C.EPOLLIN) != 0 {
-				bytes_read := C.recv(client_fd, unsafe { &request_buffer[0] }, server.max_request_buffer_size - 1,
-					0)
-				if bytes_read > 0 {
-					// Check if request exceeds buffer size
-					if bytes_read >= server.max_request_buffer_size - 1 {
-						C.send(client_fd, status_413_response.data, status_413_response.len,
-							C.MSG_NOSIGNAL)
-						handle_client_closure(epoll_fd, client_fd)
-						continue
-					}
-					mut readed_request_buffer := []u8{cap: bytes_read}
-					unsafe {
-						readed_request_buffer.push_many(&request_buffer[0], bytes_read)
-					}
-					mut decoded_http_request := decode_http_request(readed_request_buffer) or {
-						eprintln('Error decoding request ${err}')
-						C.send(client_fd, tiny_bad_request_response.data, tiny_bad_request_response.len,
-							C.MSG_NOSIGNAL)
-						handle_client_closure(epoll_fd, client_fd)
-						continue
-					}
-					decoded_http_request.client_conn_fd = client_fd
-					decoded_http_request.user_data = server.user_data
-					response := server.request_handler(decoded_http_request) or {
-						eprintln('Error handling request ${err}')
-						C.send(client_fd, tiny_bad_request_response.data, tiny_bad_request_response.len,
-							C.MSG_NOSIGNAL)
-						handle_client_closure(epoll_fd, client_fd)
-						continue
-					}
-					// Send response content (headers/body)
-					if response.content.len > 0 {
-						mut send_error := false
-						mut pos := 0
-						for pos < response.content.len {
-							sent := C.send(client_fd, unsafe { &response.content[pos] },
-								response.content.len - pos, C.MSG_NOSIGNAL)
-							if sent <= 0 {
-								eprintln('ERROR: send() failed with errno=${C.errno}')
-								send_error = true
-								break
-							}
-							pos += sent
-						}
-						if send_error {
-							handle_client_closure(epoll_fd, client_fd)
-							continue
-						}
-					}
-
-					// Send file if present
-					if response.file_path != '' {
-						fd := C.open(response.file_path.str, C.O_RDONLY)
-						if fd == -1 {
-							eprintln('ERROR: open file failed')
-							handle_client_closure(epoll_fd, client_fd)
-							continue
-						}
-						mut st := C.stat{}
-						if C.fstat(fd, &st) != 0 {
-							eprintln('ERROR: fstat failed')
-							handle_client_closure(epoll_fd, client_fd)
-							continue
-						}
-						mut offset := i64(0)
-						mut remaining := i64(st.st_size)
-						mut sf_retries := 0
-						for remaining > 0 {
-							ssize := C.sendfile(client_fd, fd, &offset, usize(remaining))
-							if ssize > 0 {
-								remaining -= i64(ssize)
-								sf_retries = 0
-								continue
-							}
-							errno_val := C.errno
-							match errno_val {
-								C.EAGAIN, C.EWOULDBLOCK, C.EINTR {
-									if sf_retries < 3 {
-										sf_retries++
-										continue
-									}
-									eprintln('ERROR: sendfile() transient failure after ${sf_retries} retries (errno=${errno_val})')
-								}
-								C.EBADF {
-									eprintln('ERROR: sendfile() EBADF: input fd or socket not open for required access (errno=${errno_val})')
-								}
-								C.EFAULT {
-									eprintln('ERROR: sendfile() EFAULT: bad address for offset (errno=${errno_val})')
-								}
-								C.EINVAL {
-									eprintln('ERROR: sendfile() EINVAL: invalid descriptor state or non-seekable input (errno=${errno_val})')
-								}
-								C.EIO {
-									eprintln('ERROR: sendfile() EIO: I/O error while reading input file (errno=${errno_val})')
-								}
-								C.ENOMEM {
-									eprintln('ERROR: sendfile() ENOMEM: insufficient kernel memory (errno=${errno_val})')
-								}
-								C.EOVERFLOW {
-									eprintln('ERROR: sendfile() EOVERFLOW: count exceeds file/socket limits (errno=${errno_val})')
-								}
-								C.ESPIPE {
-									eprintln('ERROR: sendfile() ESPIPE: input file not seekable with offset (errno=${errno_val})')
-								}
-								else {
-									eprintln('ERROR: sendfile() failed with errno=${errno_val}')
-								}
-							}
-							handle_client_closure(epoll_fd, client_fd)
-							break
-						}
-
-						C.close(fd)
-					}
-					// Leave the connection open; closure is driven by client FIN or errors
-				} else if bytes_read == 0 {
-					// Normal client closure (FIN received)
-					handle_client_closure(epoll_fd, client_fd)
-				} else if bytes_read < 0 && C.errno != C.EAGAIN && C.errno != C.EWOULDBLOCK {
-					// Unexpected recv error - send 444 No Response
-					C.send(client_fd, status_444_response.data, status_444_response.len,
-						C.MSG_NOSIGNAL)
-					handle_client_closure(epoll_fd, client_fd)
+			mut readable := events[i].events & u32(C.EPOLLIN) != 0
+			if events[i].events & u32(C.EPOLLOUT) != 0 {
+				match w.handle_writable(client_fd) {
+					// resume the requests, that were paused while the output was blocked
+					.done { readable = true }
+					.blocked { readable = false }
+					.failed { continue }
 				}
 			}
+			if readable {
+				// Leave the connection open; closure is driven by client FIN or errors
+				w.handle_readable(mut server, client_fd)
+			}
 		}
 	}
 }
@@ -360,6 +629,10 @@ pub fn (mut server Server) run() ! {
 		eprintln('Windows is not supported yet')
 		return
 	}
+	$if fasthttp_io_uring ? {
+		server.run_io_uring()!
+		return
+	}
 	for i := 0; i < max_thread_pool_size; i++ {
 		server.listen_fds[i] = create_server_socket(server.port)
 		if server.listen_fds[i] < 0 {
@@ -0,0 +1,46 @@
+module fasthttp
+
+fn C.socketpair(domain int, typ int, protocol int, sv &int) int
+
+// path_handler responds with the path of the request, built in the arena
+fn path_handler(req HttpRequest) !HttpResponse {
+	mut arena := unsafe { req.arena }
+	path := req.buffer[req.path.start..req.path.start + req.path.len]
+	arena.write_string('HTTP/1.1 200 OK\r\nContent-Length: ')
+	arena.write_decimal(path.len)
+	arena.write_string('\r\n\r\n')
+	arena.write(path)
+	return HttpResponse{
+		content: arena.bytes()
+	}
+}
+
+fn test_pipelined_responses_from_the_arena() {
+	$if linux {
+		mut fds := [2]int{}
+		assert C.socketpair(C.AF_UNIX, C.SOCK_STREAM, 0, &fds[0]) == 0
+		defer {
+			C.close(fds[0])
+			C.close(fds[1])
+		}
+		mut server := new_server(ServerConfig{
+			handler: path_handler
+		}) or { panic(err) }
+		mut w := &Worker{
+			epoll_fd:       -1
+			request_buffer: []u8{len: 8192}
+			// small, so that it grows while the responses are queued
+			arena: new_arena(16)
+		}
+		requests := 'GET /a HTTP/1.1\r\nHost: x\r\n\r\nGET /bb HTTP/1.1\r\nHost: x\r\n\r\nGET /ccc HTTP/1.1\r\nHost: x\r\n\r\n'
+		copy(mut w.request_buffer, requests.bytes())
+		// all three requests are handled in one batch, and their responses sent with one writev
+		assert w.handle_requests(mut server, fds[0], requests.len)
+		mut buf := []u8{len: 1024}
+		n := C.recv(fds[1], &buf[0], buf.len, 0)
+		assert n > 0
+		assert buf[..n].bytestr() == 'HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n/a' +
+			'HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\n/bb' +
+			'HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\n/ccc'
+	}
+}
@@ -0,0 +1,584 @@
+module fasthttp
+
+// This is an alternative event loop for Linux, based on io_uring instead of epoll.
+// It is opt-in, since it needs liburing (2.4 or later), and a 6.0+ kernel:
+// `v -d fasthttp_io_uring run server.v` . This file is compiled only with that define.
+// The `_d_` suffix has to be the last one, and V does not apply the OS suffixes to such
+// files, so the file is guarded explicitly below.
+// The `ServerConfig` and the request handler contract are the same as for epoll.
+//
+// Each worker thread owns one ring, and a listening socket (SO_REUSEPORT), and uses:
+// - one multishot accept for all incoming connections,
+// - one multishot recv per connection, reading into a ring of provided buffers,
+//   so no read buffer is tied to idle connections,
+// - sends, that are queued while handling a whole batch of completions, and are
+//   then submitted together with a single `io_uring_enter` syscall,
+// - `IORING_OP_SPLICE` through a per connection pipe for `HttpResponse.file_path`.
+$if !linux {
+	$compile_error('fasthttp: `-d fasthttp_io_uring` is supported only on Linux')
+}
+
+#flag -luring
+#include <liburing.h>
+
+struct C.io_uring {}
+
+struct C.io_uring_buf_ring {}
+
+struct C.io_uring_sqe {
+mut:
+	flags     u8
+	buf_group u16
+}
+
+struct C.io_uring_cqe {
+	user_data u64
+	res       int
+	flags     u32
+}
+
+struct C.__kernel_timespec {
+mut:
+	tv_sec  i64
+	tv_nsec i64
+}
+
+fn C.io_uring_queue_init(entries u32, ring &C.io_uring, flags u32) int
+
+fn C.io_uring_queue_exit(ring &C.io_uring)
+
+fn C.io_uring_get_sqe(ring &C.io_uring) &C.io_uring_sqe
+
+fn C.io_uring_submit(ring &C.io_uring) int
+
+fn C.io_uring_submit_and_wait(ring &C.io_uring, wait_nr u32) int
+
+fn C.io_uring_peek_batch_cqe(ring &C.io_uring, cqes voidptr, count u32) u32
+
+fn C.io_uring_cq_advance(ring &C.io_uring, nr u32)
+
+fn C.io_uring_sqe_set_data64(sqe &C.io_uring_sqe, data u64)
+
+fn C.io_uring_prep_multishot_accept(sqe &C.io_uring_sqe, fd int, addr voidptr, addrlen voidptr, flags int)
+
+fn C.io_uring_prep_recv_multishot(sqe &C.io_uring_sqe, sockfd int, buf voidptr, len usize, flags int)
+
+fn C.io_uring_prep_send(sqe &C.io_uring_sqe, sockfd int, buf voidptr, len usize, flags int)
+
+fn C.io_uring_prep_splice(sqe &C.io_uring_sqe, fd_in int, off_in i64, fd_out int, off_out i64, nbytes u32, splice_flags u32)
+
+fn C.io_uring_setup_buf_ring(ring &C.io_uring, nentries u32, bgid int, flags u32, ret &int) &C.io_uring_buf_ring
+
+fn C.io_uring_buf_ring_add(br &C.io_uring_buf_ring, addr voidptr, len u32, bid u16, mask int, buf_offset int)
+
+fn C.io_uring_buf_ring_advance(br &C.io_uring_buf_ring, count int)
+
+fn C.io_uring_buf_ring_mask(ring_entries u32) int
+
+fn C.io_uring_prep_timeout(sqe &C.io_uring_sqe, ts &C.__kernel_timespec, count u32, flags u32)
+
+fn C.shutdown(socket int, how int) int
+
+const uring_entries = 4096 // submission queue entries per worker
+const uring_cqe_batch = 256 // completions handled per loop iteration
+const uring_buffer_count = 512 // provided recv buffers per worker, a power of 2
+const uring_buffer_group = 1
+const uring_splice_chunk = 65536 // the default pipe capacity
+const uring_accept_backoff_ms = 50 // the pause of the accepts, after accept failed
+
+enum UringOp {
+	accept = 1
+	accept_retry // the timeout, that re-arms the accept after a failure
+	recv
+	send
+	splice_in
+	splice_out
+}
+
+// UringFile is a `HttpResponse.file_path`, that has to be sent after the
+// bytes of the output buffer before `offset`
+struct UringFile {
+	offset int
+	path   string
+}
+
+@[heap]
+struct UringConn {
+	fd int
+mut:
+	read_buf []u8 // the start of an incomplete request, from the previous recv
+	// `out` is being sent, while the responses of the following requests
+	// are appended to `next`. The buffers are swapped, when `out` is done.
+	out        []u8
+	out_files  []UringFile
+	next       []u8
+	next_files []UringFile
+	pos        int // bytes of `out` already sent
+	file_idx   int // index of the next entry in `out_files`
+	sending    bool
+	// the file that is currently spliced to the socket
+	file_fd  int = -1
+	file_pos i64
+	file_len i64
+	pipe_r   int = -1
+	pipe_w   int = -1
+	in_pipe  int // bytes spliced into the pipe, but not yet to the socket
+	// number of submitted operations, that did not complete yet
+	ops         int
+	closed      bool
+	close_after bool
+}
+
+struct UringWorker {
+	listen_fd int
+	buf_size  int
+	user_data voidptr
+	handler   fn (HttpRequest) !HttpResponse @[required]
+mut:
+	ring     C.io_uring
+	buf_ring &C.io_uring_buf_ring = unsafe { nil }
+	buffers  &u8                  = unsafe { nil }
+	conns    []&UringConn
+	arena    &Arena = unsafe { nil }
+	// the connections, whose recv stopped, because all provided buffers were in use;
+	// `recycle_buffer` re-arms them, one per returned buffer, in order
+	starved []&UringConn
+	// the pause of the accepts after a failure; it has to stay valid until the timeout is submitted
+	accept_pause   C.__kernel_timespec
+	accept_failure bool // the last accept failed, so it is re-armed after `accept_pause`
+}
+
+@[inline]
+fn uring_data(op UringOp, fd int) u64 {
+	return (u64(op) << 32) | u64(u32(fd))
+}
+
+// run_io_uring starts one io_uring worker per CPU, each with its own listening socket
+fn (mut server Server) run_io_uring() ! {
+	for i := 0; i < max_thread_pool_size; i++ {
+		server.listen_fds[i] = create_server_socket(server.port)
+		if server.listen_fds[i] < 0 {
+			return error('failed to create the listening socket for port ${server.port}')
+		}
+		server.threads[i] = spawn uring_worker_loop(mut server, server.listen_fds[i])
+	}
+	println('listening on http://localhost:${server.port}/ (io_uring)')
+	for i in 0 .. max_thread_pool_size {
+		server.threads[i].wait()
+	}
+}
+
+fn uring_worker_loop(mut server Server, listen_fd int) {
+	mut w := &UringWorker{
+		listen_fd: listen_fd
+		buf_size:  server.max_request_buffer_size
+		user_data: server.user_data
+		handler:   server.request_handler
+		conns:     []&UringConn{len: max_connection_size, init: unsafe { nil }}
+		arena:     new_arena(arena_initial_size)
+	}
+	ret := C.io_uring_queue_init(uring_entries, &w.ring, 0)
+	if ret < 0 {
+		eprintln('ERROR: io_uring_queue_init failed with errno=${-ret}')
+		return
+	}
+	defer {
+		C.io_uring_queue_exit(&w.ring)
+	}
+	mut br_ret := 0
+	w.buf_ring = C.io_uring_setup_buf_ring(&w.ring, uring_buffer_count, uring_buffer_group,
+		0, &br_ret)
+	if isnil(w.buf_ring) {
+		eprintln('ERROR: io_uring_setup_buf_ring failed with errno=${-br_ret}')
+		return
+	}
+	w.buffers = unsafe { malloc_noscan(uring_buffer_count * w.buf_size) }
+	mask := C.io_uring_buf_ring_mask(uring_buffer_count)
+	for i in 0 .. uring_buffer_count {
+		C.io_uring_buf_ring_add(w.buf_ring, unsafe { w.buffers + i * w.buf_size },
+			u32(w.buf_size), u16(i), mask, i)
+	}
+	C.io_uring_buf_ring_advance(w.buf_ring, uring_buffer_count)
+	w.arm_accept()
+
+	mut cqes := [uring_cqe_batch]voidptr{}
+	for {
+		// all operations queued while handling the previous batch, are submitted together
+		submitted := C.io_uring_submit_and_wait(&w.ring, 1)
+		if submitted < 0 && submitted != -C.EINTR {
+			eprintln('ERROR: io_uring_submit_and_wait failed with errno=${-submitted}')
+			break
+		}
+		count := C.io_uring_peek_batch_cqe(&w.ring, &cqes[0], uring_cqe_batch)
+		for i in 0 .. count {
+			cqe := unsafe { &C.io_uring_cqe(cqes[i]) }
+			w.dispatch(cqe.user_data, cqe.res, cqe.flags)
+		}
+		C.io_uring_cq_advance(&w.ring, count)
+	}
+}
+
+// get_sqe returns a free submission queue entry, submitting the queued ones, if the queue is full
+fn (mut w UringWorker) get_sqe() &C.io_uring_sqe {
+	mut sqe := C.io_uring_get_sqe(&w.ring)
+	for isnil(sqe) {
+		C.io_uring_submit(&w.ring)
+		sqe = C.io_uring_get_sqe(&w.ring)
+	}
+	return sqe
+}
+
+fn (mut w UringWorker) arm_accept() {
+	mut sqe := w.get_sqe()
+	C.io_uring_prep_multishot_accept(sqe, w.listen_fd, unsafe { nil }, unsafe { nil },
+		0)
+	C.io_uring_sqe_set_data64(sqe, uring_data(.accept, w.listen_fd))
+}
+
+// pause_accept re-arms the accept after `uring_accept_backoff_ms`
+fn (mut w UringWorker) pause_accept() {
+	w.accept_pause.tv_sec = 0
+	w.accept_pause.tv_nsec = i64(uring_accept_backoff_ms) * 1_000_000
+	mut sqe := w.get_sqe()
+	C.io_uring_prep_timeout(sqe, &w.accept_pause, 0, 0)
+	C.io_uring_sqe_set_data64(sqe, uring_data(.accept_retry, w.listen_fd))
+}
+
+fn (mut w UringWorker) arm_recv(mut c UringConn) {
+	mut sqe := w.get_sqe()
+	C.io_uring_prep_recv_multishot(sqe, c.fd, unsafe { nil }, 0, 0)
+	sqe.flags |= u8(C.IOSQE_BUFFER_SELECT)
+	sqe.buf_group = uring_buffer_group
+	C.io_uring_sqe_set_data64(sqe, uring_data(.recv, c.fd))
+	c.ops++
+}
+
+fn (mut w UringWorker) recycle_buffer(bid u16) {
+	C.io_uring_buf_ring_add(w.buf_ring, unsafe { w.buffers + int(bid) * w.buf_size },
+		u32(w.buf_size), bid, C.io_uring_buf_ring_mask(uring_buffer_count), 0)
+	C.io_uring_buf_ring_advance(w.buf_ring, 1)
+	for w.starved.len > 0 {
+		mut c := w.starved[0]
+		w.starved.delete(0)
+		if !c.closed {
+			w.arm_recv(mut c)
+			break
+		}
+	}
+}
+
+fn (mut w UringWorker) dispatch(user_data u64, res int, flags u32) {
+	op := unsafe { UringOp(int(user_data >> 32)) }
+	fd := int(u32(user_data))
+	more := flags & u32(C.IORING_CQE_F_MORE) != 0
+	if op == .accept {
+		w.on_accept(res)
+		if !more {
+			if w.accept_failure {
+				// errors like EMFILE or ENFILE persist, while the connection waits in the
+				// backlog, so accepting again right away would spin; pause it instead
+				w.pause_accept()
+			} else {
+				w.arm_accept()
+			}
+		}
+		return
+	}
+	if op == .accept_retry {
+		w.arm_accept()
+		return
+	}
+	mut c := w.conns[fd]
+	if isnil(c) {
+		return
+	}
+	if !more {
+		c.ops--
+	}
+	has_buffer := flags & u32(C.IORING_CQE_F_BUFFER) != 0
+	bid := u16(flags >> C.IORING_CQE_BUFFER_SHIFT)
+	if c.closed {
+		if has_buffer {
+			w.recycle_buffer(bid)
+		}
+		w.release(mut c)
+		return
+	}
+	match op {
+		.recv {
+			if res > 0 && has_buffer {
+				w.on_recv(mut c, unsafe { (w.buffers + int(bid) * w.buf_size).vbytes(res) })
+				w.recycle_buffer(bid)
+				if !more && !c.closed {
+					w.arm_recv(mut c)
+				}
+			} else if res == -C.ENOBUFS {
+				// all provided buffers are in use; re-arming right away would spin, until
+				// the other connections return some, so wait for `recycle_buffer` instead
+				w.starved << c
+			} else {
+				// FIN from the client, or an error
+				if has_buffer {
+					w.recycle_buffer(bid)
+				}
+				w.close(mut c)
+			}
+		}
+		.send {
+			if res <= 0 {
+				w.close(mut c)
+				return
+			}
+			c.pos += res
+			w.send_next(mut c)
+		}
+		.splice_in {
+			if res < 0 {
+				w.close(mut c)
+				return
+			}
+			if res == 0 {
+				// the file is shorter than reported by fstat
+				c.file_len = c.file_pos
+				w.send_next(mut c)
+				return
+			}
+			c.file_pos += res
+			c.in_pipe = res
+			w.splice_out(mut c)
+		}
+		.splice_out {
+			if res <= 0 {
+				w.close(mut c)
+				return
+			}
+			c.in_pipe -= res
+			if c.in_pipe > 0 {
+				w.splice_out(mut c)
+				return
+			}
+			w.send_next(mut c)
+		}
+		else {}
+	}
+}
+
+fn (mut w UringWorker) on_accept(client_fd int) {
+	if client_fd < 0 {
+		eprintln('ERROR: io_uring accept failed with errno=${-client_fd}')
+		w.accept_failure = true
+		return
+	}
+	w.accept_failure = false
+	if client_fd >= w.conns.len {
+		C.send(client_fd, status_444_response.data, status_444_response.len, C.MSG_NOSIGNAL)
+		close_socket(client_fd)
+		return
+	}
+	opt := 1
+	C.setsockopt(client_fd, C.IPPROTO_TCP, C.TCP_NODELAY, &opt, sizeof(opt))
+	mut c := &UringConn{
+		fd: client_fd
+	}
+	w.conns[client_fd] = c
+	w.arm_recv(mut c)
+}
+
+fn (mut w UringWorker) on_recv(mut c UringConn, data []u8) {
+	if c.close_after {
+		// the connection is closed after the pending responses, ignore further requests
+		return
+	}
+	mut buffer := data
+	if c.read_buf.len > 0 {
+		// continue the incomplete request from the previous recv
+		c.read_buf << data
+		buffer = c.read_buf
+	}
+	// handle every complete (pipelined) request; their responses are sent together
+	mut offset := 0
+	for offset < buffer.len && !c.close_after {
+		len := request_len(buffer[offset..]) or {
+			w.queue_bytes(mut c, tiny_bad_request_response)
+			c.close_after = true
+			break
+		}
+		if len == 0 {
+			break
+		}
+		w.handle_request(mut c, buffer[offset..offset + len])
+		offset += len
+	}
+	if c.close_after || offset == buffer.len {
+		c.read_buf.clear()
+	} else if buffer.len - offset >= w.buf_size - 1 {
+		c.read_buf.clear()
+		w.queue_bytes(mut c, status_413_response)
+		c.close_after = true
+	} else if offset > 0 || c.read_buf.len == 0 {
+		c.read_buf = buffer[offset..].clone()
+	}
+	w.flush(mut c)
+}
+
+// handle_request calls the handler for the request in `buffer`, and queues its response.
+// The request borrows `buffer`, which is reused after the handler returns.
+fn (mut w UringWorker) handle_request(mut c UringConn, buffer []u8) {
+	mut req := decode_http_request(buffer) or {
+		w.queue_bytes(mut c, tiny_bad_request_response)
+		c.close_after = true
+		return
+	}
+	req.client_conn_fd = c.fd
+	req.user_data = w.user_data
+	w.arena.reset()
+	req.arena = w.arena
+	resp := w.handler(req) or {
+		eprintln('Error handling request ${err}')
+		w.queue_bytes(mut c, tiny_bad_request_response)
+		c.close_after = true
+		return
+	}
+	// the content may point into the arena, so it is copied to the output buffer
+	c.next << resp.content
+	if resp.file_path != '' {
+		c.next_files << UringFile{
+			offset: c.next.len
+			path:   resp.file_path
+		}
+	}
+}
+
+fn (mut w UringWorker) queue_bytes(mut c UringConn, content []u8) {
+	c.next << content
+}
+
+// flush starts sending the queued responses, unless a send is already in flight.
+// The send is only queued here; it is submitted with the rest of the batch.
+fn (mut w UringWorker) flush(mut c UringConn) {
+	if c.sending {
+		return
+	}
+	c.sending = true
+	w.send_next(mut c)
+}
+
+fn (mut w UringWorker) send_next(mut c UringConn) {
+	for {
+		limit := if c.file_idx < c.out_files.len {
+			c.out_files[c.file_idx].offset
+		} else {
+			c.out.len
+		}
+		if c.pos < limit {
+			mut sqe := w.get_sqe()
+			C.io_uring_prep_send(sqe, c.fd, unsafe { &c.out[c.pos] }, usize(limit - c.pos),
+				C.MSG_NOSIGNAL)
+			C.io_uring_sqe_set_data64(sqe, uring_data(.send, c.fd))
+			c.ops++
+			return
+		}
+		if c.file_idx < c.out_files.len {
+			if c.file_fd == -1 && !w.open_file(mut c, c.out_files[c.file_idx].path) {
+				w.close(mut c)
+				return
+			}
+			if c.file_pos < c.file_len {
+				w.splice_in(mut c)
+				return
+			}
+			C.close(c.file_fd)
+			c.file_fd = -1
+			c.file_idx++
+			continue
+		}
+		// everything in `out` was sent
+		c.out.clear()
+		c.out_files.clear()
+		c.pos = 0
+		c.file_idx = 0
+		if c.next.len == 0 && c.next_files.len == 0 {
+			c.sending = false
+			if c.close_after {
+				w.close(mut c)
+			}
+			return
+		}
+		c.out, c.next = c.next, c.out
+		c.out_files, c.next_files = c.next_files, c.out_files
+	}
+}
+
+fn (mut w UringWorker) open_file(mut c UringConn, path string) bool {
+	fd := C.open(&char(path.str), C.O_RDONLY)
+	if fd == -1 {
+		eprintln('ERROR: open file failed')
+		return false
+	}
+	mut st := C.stat{}
+	if C.fstat(fd, &st) != 0 {
+		eprintln('ERROR: fstat failed')
+		C.close(fd)
+		return false
+	}
+	if c.pipe_r == -1 {
+		mut fds := [2]int{}
+		if C.pipe(&fds[0]) != 0 {
+			eprintln('ERROR: pipe failed with errno=${C.errno}')
+			C.close(fd)
+			return false
+		}
+		c.pipe_r = fds[0]
+		c.pipe_w = fds[1]
+	}
+	c.file_fd = fd
+	c.file_pos = 0
+	c.file_len = i64(st.st_size)
+	return true
+}
+
+fn (mut w UringWorker) splice_in(mut c UringConn) {
+	remaining := c.file_len - c.file_pos
+	chunk := if remaining < uring_splice_chunk { u32(remaining) } else { u32(uring_splice_chunk) }
+	mut sqe := w.get_sqe()
+	C.io_uring_prep_splice(sqe, c.file_fd, c.file_pos, c.pipe_w, -1, chunk, 0)
+	C.io_uring_sqe_set_data64(sqe, uring_data(.splice_in, c.fd))
+	c.ops++
+}
+
+fn (mut w UringWorker) splice_out(mut c UringConn) {
+	mut sqe := w.get_sqe()
+	C.io_uring_prep_splice(sqe, c.pipe_r, -1, c.fd, -1, u32(c.in_pipe), 0)
+	C.io_uring_sqe_set_data64(sqe, uring_data(.splice_out, c.fd))
+	c.ops++
+}
+
+// close shuts the connection down. The file descriptor itself is closed by
+// `release`, only after all operations on it have completed, so that it is
+// not reused by a new connection, while the kernel still refers to it.
+fn (mut w UringWorker) close(mut c UringConn) {
+	if c.closed {
+		return
+	}
+	c.closed = true
+	C.shutdown(c.fd, C.SHUT_RDWR)
+	w.release(mut c)
+}
+
+fn (mut w UringWorker) release(mut c UringConn) {
+	if c.ops > 0 {
+		return
+	}
+	if c.file_fd != -1 {
+		C.close(c.file_fd)
+		c.file_fd = -1
+	}
+	if c.pipe_r != -1 {
+		C.close(c.pipe_r)
+		C.close(c.pipe_w)
+		c.pipe_r = -1
+		c.pipe_w = -1
+	}
+	w.conns[c.fd] = unsafe { nil }
+	close_socket(c.fd)
+}
@@ -145,3 +145,84 @@ fn (slice Slice) to_string(buffer []u8) string {
 	}
 	return buffer[slice.start..slice.start + slice.len].bytestr()
 }
+
+// request_len returns the length of the first complete request in `buf`, including
+// the body declared by its `Content-Length` header, or 0 when `buf` does not contain
+// a complete request yet. It is used to split pipelined requests, that arrive in a
+// single read. Requests with a `Transfer-Encoding` are not split, their length is `buf.len`.
+@[direct_array_access]
+pub fn request_len(buf []u8) !int {
+	mut content_length := 0
+	mut line_start := 0
+	for line_start < buf.len {
+		nl := unsafe { find_byte(&buf[line_start], buf.len - line_start, lf_char) }
+		if nl < 0 {
+			return 0
+		}
+		line_end := line_start + nl
+		if line_start > 0 && (nl == 0 || (nl == 1 && buf[line_start] == cr_char)) {
+			// the empty line, that ends the header fields
+			total := line_end + 1 + content_length
+			return if total <= buf.len { total } else { 0 }
+		}
+		// the first line is the request line
+		if line_start > 0 {
+			if equal_fold_at(buf, line_start, 'content-length:') {
+				content_length = parse_content_length(buf, line_start + 'content-length:'.len,
+					line_end)!
+			} else if equal_fold_at(buf, line_start, 'transfer-encoding:') {
+				return buf.len
+			}
+		}
+		line_start = line_end + 1
+	}
+	return 0
+}
+
+@[direct_array_access]
+fn parse_content_length(buf []u8, start int, end int) !int {
+	mut i := start
+	for i < end && (buf[i] == empty_space || buf[i] == `\t`) {
+		i++
+	}
+	mut n := i64(0)
+	mut digits := 0
+	for i < end && buf[i] >= `0` && buf[i] <= `9` {
+		n = n * 10 + i64(buf[i] - `0`)
+		if n > max_i32 {
+			return error('Content-Length is too large')
+		}
+		digits++
+		i++
+	}
+	for i < end && (buf[i] == empty_space || buf[i] == `\t` || buf[i] == cr_char) {
+		i++
+	}
+	if digits == 0 || i != end {
+		return error('Invalid Content-Length')
+	}
+	return int(n)
+}
+
+// equal_fold_at returns true, when the bytes of `buf` starting at `start` are equal
+// to `name`, ignoring the case of ASCII letters
+@[direct_array_access]
+fn equal_fold_at(buf []u8, start int, name string) bool {
+	if start + name.len > buf.len {
+		return false
+	}
+	for i in 0 .. name.len {
+		mut a := buf[start + i]
+		mut b := name[i]
+		if a >= `A` && a <= `Z` {
+			a += 32
+		}
+		if b >= `A` && b <= `Z` {
+			b += 32
+		}
+		if a != b {
+			return false
+		}
+	}
+	return true
+}
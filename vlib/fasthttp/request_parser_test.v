@@ -86,3 +86,26 @@ fn test_decode_http_request_malformed_no_double_crlf() {
 	assert req.body.len == 0
 	assert req.header_fields.to_string(req.buffer) == 'Host: example.com'
 }
+
+fn test_request_len() {
+	get := 'GET / HTTP/1.1\r\nHost: example.com\r\n\r\n'
+	assert request_len(get.bytes())! == get.len
+	// incomplete header fields
+	assert request_len('GET / HTTP/1.1\r\nHost: exa'.bytes())! == 0
+	// the body is part of the request
+	post := 'POST /submit HTTP/1.1\r\ncontent-length: 4\r\n\r\nbody'
+	assert request_len(post.bytes())! == post.len
+	assert request_len(post[..post.len - 1].bytes())! == 0
+	// pipelined requests are split at the end of the first one
+	assert request_len((post + get + get).bytes())! == post.len
+	assert request_len((get + post).bytes())! == get.len
+}
+
+fn test_request_len_invalid_content_length() {
+	if _ := request_len('POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n'.bytes()) {
+		assert false, 'invalid Content-Length was accepted'
+	}
+	if _ := request_len('POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n'.bytes()) {
+		assert false, 'too large Content-Length was accepted'
+	}
+}
@@ -0,0 +1,129 @@
+module fasthttp
+
+// The functions in this file return strings, that borrow their memory from
+// the request buffer, instead of copying it. The server reuses that buffer
+// for the next request, so the returned strings are only valid until the
+// handler returns. Call `.clone()` on them, if you need to keep them longer.
+
+// view returns the part of the request buffer described by `slice`, without copying it
+@[direct_array_access; inline]
+pub fn (req &HttpRequest) view(slice Slice) string {
+	if slice.len <= 0 || slice.start < 0 || slice.start + slice.len > req.buffer.len {
+		return ''
+	}
+	return unsafe { tos(&req.buffer[slice.start], slice.len) }
+}
+
+// method_str returns the HTTP method of the request, i.e. `GET` or `POST`
+@[inline]
+pub fn (req &HttpRequest) method_str() string {
+	return req.view(req.method)
+}
+
+// target returns the full request target, including the query string, i.e. `/users?page=2`
+@[inline]
+pub fn (req &HttpRequest) target() string {
+	return req.view(req.path)
+}
+
+// path_str returns the request target without the query string, i.e. `/users`
+pub fn (req &HttpRequest) path_str() string {
+	qpos := req.query_pos()
+	if qpos < 0 {
+		return req.target()
+	}
+	return req.view(Slice{req.path.start, qpos - req.path.start})
+}
+
+// query_str returns the raw query string of the request target, without the leading `?`
+pub fn (req &HttpRequest) query_str() string {
+	qpos := req.query_pos()
+	if qpos < 0 {
+		return ''
+	}
+	return req.view(Slice{qpos + 1, req.path.start + req.path.len - qpos - 1})
+}
+
+// body_str returns the part of the request body, that is in the request buffer
+@[inline]
+pub fn (req &HttpRequest) body_str() string {
+	return req.view(req.body)
+}
+
+// header returns the value of the first header field named `name`.
+// The header fields are not parsed in advance; each call scans them, and
+// compares the field names case insensitively.
+@[direct_array_access]
+pub fn (req &HttpRequest) header(name string) ?string {
+	if req.header_fields.len <= 0 || name.len == 0 {
+		return none
+	}
+	end := req.header_fields.start + req.header_fields.len
+	mut line_start := req.header_fields.start
+	for line_start < end {
+		mut line_end := unsafe { find_byte(&req.buffer[line_start], end - line_start, lf_char) }
+		line_end = if line_end < 0 { end } else { line_start + line_end }
+		colon := line_start + name.len
+		if colon < line_end && req.buffer[colon] == `:`
+			&& equal_fold_at(req.buffer, line_start, name) {
+			mut vstart := colon + 1
+			mut vend := line_end
+			for vstart < vend && (req.buffer[vstart] == empty_space || req.buffer[vstart] == `\t`) {
+				vstart++
+			}
+			for vend > vstart && (req.buffer[vend - 1] == cr_char
+				|| req.buffer[vend - 1] == empty_space || req.buffer[vend - 1] == `\t`) {
+				vend--
+			}
+			return req.view(Slice{vstart, vend - vstart})
+		}
+		line_start = line_end + 1
+	}
+	return none
+}
+
+// query returns the raw (not percent decoded) value of the first query
+// parameter named `name`. A parameter without `=` has an empty value.
+@[direct_array_access]
+pub fn (req &HttpRequest) query(name string) ?string {
+	qpos := req.query_pos()
+	if qpos < 0 || name.len == 0 {
+		return none
+	}
+	end := req.path.start + req.path.len
+	mut start := qpos + 1
+	for start <= end {
+		mut param_end := if start < end {
+			unsafe { find_byte(&req.buffer[start], end - start, `&`) }
+		} else {
+			-1
+		}
+		param_end = if param_end < 0 { end } else { start + param_end }
+		key_end := start + name.len
+		if key_end <= param_end
+			&& unsafe { vmemcmp(&req.buffer[start], name.str, name.len) } == 0 {
+			if key_end == param_end {
+				return ''
+			}
+			if req.buffer[key_end] == `=` {
+				return req.view(Slice{key_end + 1, param_end - key_end - 1})
+			}
+		}
+		start = param_end + 1
+	}
+	return none
+}
+
+// query_pos returns the index of the `?` in the request buffer, or -1 when the
+// request target has no query string
+@[inline]
+fn (req &HttpRequest) query_pos() int {
+	if req.path.len <= 0 {
+		return -1
+	}
+	pos := unsafe { find_byte(&req.buffer[req.path.start], req.path.len, `?`) }
+	if pos < 0 {
+		return -1
+	}
+	return req.path.start + pos
+}
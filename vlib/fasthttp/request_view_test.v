@@ -0,0 +1,51 @@
+module fasthttp
+
+const view_request = 'POST /search?q=v+lang&page=2&debug HTTP/1.1\r\nHost: example.com\r\nContent-Type:  text/plain \r\nX-Empty:\r\n\r\nbody'.bytes()
+
+fn test_request_views() {
+	req := decode_http_request(view_request) or { panic(err) }
+	assert req.method_str() == 'POST'
+	assert req.target() == '/search?q=v+lang&page=2&debug'
+	assert req.path_str() == '/search'
+	assert req.query_str() == 'q=v+lang&page=2&debug'
+	assert req.body_str() == 'body'
+	// the views point into the request buffer
+	assert req.method_str().str == unsafe { &req.buffer[0] }
+}
+
+fn test_request_header() {
+	req := decode_http_request(view_request) or { panic(err) }
+	assert req.header('Host') or { '' } == 'example.com'
+	assert req.header('host') or { '' } == 'example.com'
+	assert req.header('CONTENT-TYPE') or { '' } == 'text/plain'
+	assert req.header('x-empty') or { 'missing' } == ''
+	assert req.header('Content') == none
+	assert req.header('Accept') == none
+}
+
+fn test_request_query() {
+	req := decode_http_request(view_request) or { panic(err) }
+	assert req.query('q') or { '' } == 'v+lang'
+	assert req.query('page') or { '' } == '2'
+	assert req.query('debug') or { 'missing' } == ''
+	assert req.query('pag') == none
+	assert req.query('x') == none
+	plain := decode_http_request('GET / HTTP/1.1\r\n\r\n'.bytes()) or { panic(err) }
+	assert plain.path_str() == '/'
+	assert plain.query_str() == ''
+	assert plain.query('q') == none
+}
+
+fn test_arena() {
+	mut arena := new_arena(4)
+	arena.write_string('len: ')
+	arena.write_decimal(0)
+	arena.write_string(', ')
+	arena.write_decimal(-1234567890)
+	arena.write(' ok'.bytes())
+	assert arena.bytes().bytestr() == 'len: 0, -1234567890 ok'
+	arena.reset()
+	assert arena.bytes().len == 0
+	arena.write_string('reused')
+	assert arena.bytes().bytestr() == 'reused'
+}
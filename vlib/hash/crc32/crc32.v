@@ -35,13 +35,17 @@ fn (mut c Crc32) generate_table(poly int) {
 	}
 }
 
-@[direct_array_access]
 fn (c &Crc32) sum32(b []u8) u32 {
-	mut crc := ~u32(0)
+	return c.update32(0, b)
+}
+
+@[direct_array_access]
+fn (c &Crc32) update32(crc u32, b []u8) u32 {
+	mut res := ~crc
 	for i in 0 .. b.len {
-		crc = c.table[u8(crc) ^ b[i]] ^ (crc >> 8)
+		res = c.table[u8(res) ^ b[i]] ^ (res >> 8)
 	}
-	return ~crc
+	return ~res
 }
 
 // checksum returns the CRC-32 checksum of data `b` by using the polynomial represented by `c`'s table.
@@ -49,6 +53,12 @@ pub fn (c &Crc32) checksum(b []u8) u32 {
 	return c.sum32(b)
 }
 
+// update returns the CRC-32 checksum of the data, that had the checksum `crc`, with `b` appended to it.
+// It allows computing the checksum of data, that arrives in chunks. Start with a `crc` of 0.
+pub fn (c &Crc32) update(crc u32, b []u8) u32 {
+	return c.update32(crc, b)
+}
+
 // new creates a `Crc32` polynomial.
 pub fn new(poly int) &Crc32 {
 	mut c := &Crc32{}
@@ -62,3 +72,9 @@ const ieee_poly = new(int(ieee))
 pub fn sum(b []u8) u32 {
 	return ieee_poly.sum32(b)
 }
+
+// update returns the IEEE CRC-32 checksum of the data, that had the checksum `crc`, with `b` appended to it.
+// Example: assert crc32.update(crc32.sum('hello '.bytes()), 'world'.bytes()) == crc32.sum('hello world'.bytes())
+pub fn update(crc u32, b []u8) u32 {
+	return ieee_poly.update32(crc, b)
+}
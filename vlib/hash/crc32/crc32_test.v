@@ -12,3 +12,14 @@ fn test_hash_crc32() {
 	assert sum2 == u32(1420327025)
 	assert sum2.hex() == '54a87871'
 }
+
+fn test_hash_crc32_update() {
+	b := 'testing crc32 again'.bytes()
+	mut crc := u32(0)
+	for i in 0 .. b.len {
+		crc = crc32.update(crc, b[i..i + 1])
+	}
+	assert crc == crc32.sum(b)
+	c := crc32.new(int(crc32.castagnoli))
+	assert c.update(c.checksum(b[..7]), b[7..]) == c.checksum(b)
+}
@@ -0,0 +1,365 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+module json
+
+fn C.strtod(nptr &char, endptr &&char) f64
+
+// the nesting limit of cJSON, see CJSON_NESTING_LIMIT in cJSON.h
+const stream_max_depth = 1000
+
+// Stream is the state of the streaming decoder. For the structs and arrays, that it can decode,
+// the compiler generates `json__stream_T` functions, that parse the JSON text with it, directly
+// into the V values, without building a cJSON tree first.
+// It accepts only the input, that cJSON accepts, and that the cJSON based decoders decode to the
+// same values. Its methods return false (or -1) for anything else (invalid JSON, a `null`, a value
+// of an unexpected type...), and then json.decode decodes the whole text again with cJSON, so that
+// the results and the error messages do not change.
+@[markused]
+struct Stream {
+	text string
+mut:
+	pos   int
+	depth int // the number of the arrays and objects, that are not closed yet
+}
+
+@[markused]
+fn new_stream(text string) Stream {
+	return Stream{
+		text: text
+	}
+}
+
+// skip_whitespace skips the bytes, that cJSON skips between the tokens
+@[direct_array_access; inline]
+fn (mut s Stream) skip_whitespace() {
+	for s.pos < s.text.len && s.text[s.pos] <= ` ` && s.text[s.pos] != 0 {
+		s.pos++
+	}
+}
+
+// begin skips the `opening` `{` or `[` of an object or an array. It returns 1, when the object or
+// array has members or items, 0 when it is empty (after skipping its `closing` too), and -1 on errors.
+@[direct_array_access; markused]
+fn (mut s Stream) begin(opening u8, closing u8) int {
+	s.skip_whitespace()
+	if s.pos >= s.text.len || s.text[s.pos] != opening || s.depth >= stream_max_depth {
+		return -1
+	}
+	s.pos++
+	s.skip_whitespace()
+	if s.pos < s.text.len && s.text[s.pos] == closing {
+		s.pos++
+		return 0
+	}
+	s.depth++
+	return 1
+}
+
+// next skips the `,` after a member of an object or an item of an array, and returns 1, or the
+// `closing` `}` or `]` of the object or array, and returns 0. It returns -1 on errors.
+@[direct_array_access; markused]
+fn (mut s Stream) next(closing u8) int {
+	s.skip_whitespace()
+	if s.pos < s.text.len {
+		c := s.text[s.pos]
+		s.pos++
+		if c == `,` {
+			return 1
+		}
+		if c == closing {
+			s.depth--
+			return 0
+		}
+	}
+	return -1
+}
+
+// key parses the key of an object member, and the `:` after it. The key points into the text,
+// when it has no escapes, so it is valid only until the next call.
+@[direct_array_access; markused]
+fn (mut s Stream) key(mut name string) bool {
+	if !s.parse_string(mut name, true) {
+		return false
+	}
+	s.skip_whitespace()
+	if s.pos >= s.text.len || s.text[s.pos] != `:` {
+		return false
+	}
+	s.pos++
+	return true
+}
+
+// string_value parses a string value into a new string
+@[markused]
+fn (mut s Stream) string_value(mut value string) bool {
+	return s.parse_string(mut value, false)
+}
+
+// bool_value parses a `true` or `false` value
+@[markused]
+fn (mut s Stream) bool_value(mut value bool) bool {
+	s.skip_whitespace()
+	if s.literal('true') {
+		value = true
+		return true
+	}
+	if s.literal('false') {
+		value = false
+		return true
+	}
+	return false
+}
+
+// number parses a number value like cJSON's parse_number does: it converts the longest prefix
+// (of at most 63 bytes) made of digits, signs, exponents and dots, with strtod. It sets the
+// valuedouble and valueint of `node`, so that the decode_T functions convert them to the V types.
+@[direct_array_access; markused]
+fn (mut s Stream) number(mut node C.cJSON) bool {
+	s.skip_whitespace()
+	if s.pos >= s.text.len {
+		return false
+	}
+	first := s.text[s.pos]
+	if first != `-` && (first < `0` || first > `9`) {
+		return false
+	}
+	mut buf := [64]u8{}
+	mut n := 0
+	for n < buf.len - 1 && s.pos + n < s.text.len {
+		c := s.text[s.pos + n]
+		if (c >= `0` && c <= `9`) || c == `+` || c == `-` || c == `e` || c == `E` || c == `.` {
+			buf[n] = c
+			n++
+		} else {
+			break
+		}
+	}
+	start := &char(&buf[0])
+	mut end := start
+	number := C.strtod(start, &end)
+	consumed := int(unsafe { end - start })
+	if consumed == 0 {
+		return false
+	}
+	node.valuedouble = number
+	// saturated, like in cJSON
+	node.valueint = if number >= f64(max_i32) {
+		int(max_i32)
+	} else if number <= f64(min_i32) {
+		int(min_i32)
+	} else {
+		int(number)
+	}
+	s.pos += consumed
+	return true
+}
+
+// skip parses a value, that is not decoded, like the value of a member with an unknown key
+@[direct_array_access; markused]
+fn (mut s Stream) skip() bool {
+	s.skip_whitespace()
+	if s.pos >= s.text.len {
+		return false
+	}
+	match s.text[s.pos] {
+		`"` {
+			mut value := ''
+			return s.parse_string(mut value, true)
+		}
+		`{` {
+			mut more := s.begin(`{`, `}`)
+			for more > 0 {
+				mut key := ''
+				if !s.key(mut key) || !s.skip() {
+					return false
+				}
+				more = s.next(`}`)
+			}
+			return more == 0
+		}
+		`[` {
+			mut more := s.begin(`[`, `]`)
+			for more > 0 {
+				if !s.skip() {
+					return false
+				}
+				more = s.next(`]`)
+			}
+			return more == 0
+		}
+		`t` {
+			return s.literal('true')
+		}
+		`f` {
+			return s.literal('false')
+		}
+		`n` {
+			return s.literal('null')
+		}
+		else {
+			mut node := C.cJSON{}
+			return s.number(mut node)
+		}
+	}
+}
+
+// literal skips `word`, when the text continues with it
+@[inline]
+fn (mut s Stream) literal(word string) bool {
+	if s.pos + word.len > s.text.len || unsafe { vmemcmp(s.text.str + s.pos, word.str, word.len) } != 0 {
+		return false
+	}
+	s.pos += word.len
+	return true
+}
+
+// parse_string parses a string. When `view` is true, and the string has no escapes, `value`
+// points into the text, otherwise it is a new string.
+@[direct_array_access]
+fn (mut s Stream) parse_string(mut value string, view bool) bool {
+	s.skip_whitespace()
+	if s.pos >= s.text.len || s.text[s.pos] != `"` {
+		return false
+	}
+	start := s.pos + 1
+	for i in start .. s.text.len {
+		c := s.text[i]
+		if c == `"` {
+			value = if view { s.text.substr_unsafe(start, i) } else { s.text[start..i] }
+			s.pos = i + 1
+			return true
+		}
+		if c == `\\` {
+			return s.parse_escaped_string(mut value, start)
+		}
+		if c == 0 {
+			// cJSON would end the string there
+			return false
+		}
+	}
+	return false
+}
+
+// parse_escaped_string parses the rest of a string with escapes, that starts at `start`
+@[direct_array_access]
+fn (mut s Stream) parse_escaped_string(mut value string, start int) bool {
+	mut buf := []u8{cap: 64}
+	mut i := start
+	for i < s.text.len {
+		c := s.text[i]
+		if c == `"` {
+			value = buf.bytestr()
+			s.pos = i + 1
+			return true
+		}
+		if c == 0 {
+			return false
+		}
+		if c != `\\` {
+			buf << c
+			i++
+			continue
+		}
+		if i + 1 >= s.text.len {
+			return false
+		}
+		match s.text[i + 1] {
+			`b` {
+				buf << `\b`
+			}
+			`f` {
+				buf << `\f`
+			}
+			`n` {
+				buf << `\n`
+			}
+			`r` {
+				buf << `\r`
+			}
+			`t` {
+				buf << `\t`
+			}
+			`"`, `\\`, `/` {
+				buf << s.text[i + 1]
+			}
+			`u` {
+				len := s.utf16_literal(mut buf, i)
+				if len == 0 {
+					return false
+				}
+				i += len
+				continue
+			}
+			else {
+				return false
+			}
+		}
+		i += 2
+	}
+	return false
+}
+
+// utf16_literal appends the UTF-8 encoding of the `\uXXXX` (or of the surrogate pair `\uXXXX\uXXXX`)
+// at `i` to `buf`, and returns its length in the text. It returns 0, when it is invalid, or is a NUL,
+// which would end the string for cJSON.
+@[direct_array_access]
+fn (s &Stream) utf16_literal(mut buf []u8, i int) int {
+	first := s.hex4(i + 2)
+	if first <= 0 || (first >= 0xDC00 && first <= 0xDFFF) {
+		return 0
+	}
+	mut codepoint := u32(first)
+	mut len := 6
+	if first >= 0xD800 && first <= 0xDBFF {
+		if i + 7 >= s.text.len || s.text[i + 6] != `\\` || s.text[i + 7] != `u` {
+			return 0
+		}
+		second := s.hex4(i + 8)
+		if second < 0xDC00 || second > 0xDFFF {
+			return 0
+		}
+		codepoint = 0x10000 + ((u32(first) & 0x3FF) << 10 | (u32(second) & 0x3FF))
+		len = 12
+	}
+	if codepoint < 0x80 {
+		buf << u8(codepoint)
+	} else if codepoint < 0x800 {
+		buf << u8(0xC0 | (codepoint >> 6))
+		buf << u8(0x80 | (codepoint & 0x3F))
+	} else if codepoint < 0x10000 {
+		buf << u8(0xE0 | (codepoint >> 12))
+		buf << u8(0x80 | ((codepoint >> 6) & 0x3F))
+		buf << u8(0x80 | (codepoint & 0x3F))
+	} else {
+		buf << u8(0xF0 | (codepoint >> 18))
+		buf << u8(0x80 | ((codepoint >> 12) & 0x3F))
+		buf << u8(0x80 | ((codepoint >> 6) & 0x3F))
+		buf << u8(0x80 | (codepoint & 0x3F))
+	}
+	return len
+}
+
+// hex4 returns the value of the 4 hex digits at `i`, or -1
+@[direct_array_access]
+fn (s &Stream) hex4(i int) int {
+	if i + 4 > s.text.len {
+		return -1
+	}
+	mut h := 0
+	for j in i .. i + 4 {
+		c := s.text[j]
+		mut d := 0
+		if c >= `0` && c <= `9` {
+			d = int(c - `0`)
+		} else if c >= `a` && c <= `f` {
+			d = int(c - `a`) + 10
+		} else if c >= `A` && c <= `F` {
+			d = int(c - `A`) + 10
+		} else {
+			return -1
+		}
+		h = h << 4 | d
+	}
+	return h
+}
@@ -0,0 +1,75 @@
+module json
+
+fn C.cJSON_Delete(&C.cJSON)
+
+fn test_stream_numbers_like_cjson() {
+	for text in ['0', '-0', '12', '-12', '1.5', '-2.25e3', '1E2', '3000000000', '-3000000000',
+		'1e400', '0.1', '01', '1.', '12345678901234567890123456789', '2x', '-'] {
+		mut s := new_stream(text)
+		mut node := C.cJSON{}
+		ok := s.number(mut node)
+		root := C.cJSON_Parse(&char(text.str))
+		assert ok == (root != unsafe { nil }), text
+		if ok {
+			assert node.valuedouble == root.valuedouble, text
+			assert node.valueint == root.valueint, text
+			C.cJSON_Delete(root)
+		}
+	}
+}
+
+fn test_stream_objects_and_arrays() {
+	mut s := new_stream(' { "a" : [1, "x", {}], "b\\u00e9": null } ')
+	assert s.begin(`{`, `}`) == 1
+	mut key := ''
+	assert s.key(mut key)
+	assert key == 'a'
+	assert s.begin(`[`, `]`) == 1
+	mut node := C.cJSON{}
+	assert s.number(mut node)
+	assert node.valueint == 1
+	assert s.next(`]`) == 1
+	mut value := ''
+	assert s.string_value(mut value)
+	assert value == 'x'
+	assert s.next(`]`) == 1
+	assert s.begin(`{`, `}`) == 0
+	assert s.next(`]`) == 0
+	assert s.next(`}`) == 1
+	assert s.key(mut key)
+	assert key == 'bé'
+	assert s.skip()
+	assert s.next(`}`) == 0
+	assert s.depth == 0
+}
+
+fn test_stream_strings() {
+	mut value := ''
+	mut s := new_stream('"a\\"b\\\\c\\/d\\n\\u0041\\u00e9\\u20ac\\ud83d\\ude00"')
+	assert s.string_value(mut value)
+	assert value == 'a"b\\c/d\nAé€😀'
+	// what cJSON rejects, or would end at a NUL
+	for text in ['"abc', '"\\x"', '"\\u12"', '"\\ud83d"', '"\\ude00"', '"\\u0000"', '"a\\'] {
+		s = new_stream(text)
+		assert !s.string_value(mut value), text
+	}
+}
+
+fn test_stream_skip_rejects_invalid_json() {
+	for text in ['[1, 2', '[1, ]', '{"a" 1}', '{"a": 1,}', '{1: 2}', 'nul', 'tru', '+1', '.5',
+		'[1 2]', ''] {
+		mut s := new_stream(text)
+		assert !s.skip(), text
+	}
+	for text in ['null', 'true', 'false', '[]', '{}', '[[[]]]', '{"a": {"b": [null]}}', '-1.5e3'] {
+		mut s := new_stream(text)
+		assert s.skip(), text
+	}
+}
+
+fn test_stream_nesting_limit() {
+	mut s := new_stream('['.repeat(stream_max_depth) + ']'.repeat(stream_max_depth))
+	assert s.skip()
+	s = new_stream('['.repeat(stream_max_depth + 1) + ']'.repeat(stream_max_depth + 1))
+	assert !s.skip()
+}
@@ -0,0 +1,49 @@
+import json
+
+struct LookupInner {
+	id   int
+	name string
+}
+
+struct LookupEmbed {
+	kind string
+}
+
+struct Lookup {
+	LookupEmbed
+	a     int
+	ab    int
+	ba    int
+	title string @[json: 'Title']
+	inner LookupInner
+	opt   ?int
+	raw   string @[raw]
+	skip  int    @[skip]
+}
+
+fn test_decode_fields_in_any_order() {
+	data := json.decode(Lookup, '{"raw": [1, 2], "inner": {"name": "x", "id": 3}, "Title": "t", "ba": 3, "ab": 2, "a": 1, "kind": "k", "skip": 5, "unknown": true}')!
+	assert data.a == 1
+	assert data.ab == 2
+	assert data.ba == 3
+	assert data.title == 't'
+	assert data.inner.id == 3
+	assert data.inner.name == 'x'
+	assert data.kind == 'k'
+	assert data.opt == none
+	assert data.raw == '[1,2]'
+	assert data.skip == 0
+}
+
+fn test_decode_duplicate_keys_use_the_first_one() {
+	data := json.decode(Lookup, '{"a": 1, "a": 2, "title": "lower", "Title": "upper", "Title": "last"}')!
+	assert data.a == 1
+	assert data.title == 'upper'
+}
+
+fn test_decode_empty_object() {
+	data := json.decode(Lookup, '{}')!
+	assert data.a == 0
+	assert data.title == ''
+	assert data.opt == none
+}
@@ -0,0 +1,153 @@
+import json
+
+// StreamUser is decoded by the streaming decoder, CjsonUser has the same fields, and an option
+// one, so it is decoded only with cJSON. Both must decode any text to the same values.
+struct StreamPet {
+	name string
+	age  u8
+}
+
+struct StreamUser {
+	id     int
+	big    i64
+	score  f32
+	name   string @[json: 'Name']
+	active bool
+	tags   []string
+	grid   [][]int
+	pets   []StreamPet
+	level  int = 7
+	secret string @[skip]
+}
+
+struct CjsonUser {
+	id     int
+	big    i64
+	score  f32
+	name   string @[json: 'Name']
+	active bool
+	tags   []string
+	grid   [][]int
+	pets   []StreamPet
+	level  int = 7
+	secret string @[skip]
+	opt    ?int
+}
+
+const stream_texts = [
+	'{"id": 1, "big": 12345678901, "score": 1.5, "Name": "Bob", "active": true, "tags": ["a", "b"], "grid": [[1, 2], [], [3]], "pets": [{"name": "Rex", "age": 3}], "level": 2}',
+	' \t\n{ "Name" : "with \\"escapes\\" \\\\ \\/ \\b\\f\\n\\r\\t \\u00e9 \\u20AC \\ud83d\\ude00" } ',
+	'{"unknown": {"deep": [1, {"x": null}, "s", true, false, -1.5e3]}, "id": 5, "other": null}',
+	'{"id": 1, "id": 2, "Name": "first", "Name": "second"}',
+	'{"id": 3000000000, "big": -1e15, "score": 1e-50}',
+	'{"pets": [{"age": 300}, {"name": "x", "name": "y"}], "tags": []}',
+	'{}',
+	'{"secret": "s", "name": "lower"}',
+	'{"id": 1} trailing text',
+	'{"grid": [[1, 2, ], [3]]}',
+	'{"id": "12"}',
+	'{"id": null}',
+	'{"Name": 5}',
+	'{"active": 1}',
+	'{"tags": "not an array"}',
+	'{"pets": [1, 2]}',
+	'[1, 2]',
+	'{"id": 1,}',
+	'{"Name": "bad \\x escape"}',
+	'{"Name": "\\ud83d alone"}',
+	'{"id": 1',
+	'',
+]
+
+fn test_stream_decoder_matches_the_cjson_decoder() {
+	for text in stream_texts {
+		stream_res := json.decode(StreamUser, text) or {
+			mut cjson_msg := ''
+			json.decode(CjsonUser, text) or { cjson_msg = err.msg() }
+			assert err.msg() == cjson_msg, text
+			continue
+		}
+		cjson_res := json.decode(CjsonUser, text) or { panic('${text}: ${err}') }
+		assert stream_res.id == cjson_res.id, text
+		assert stream_res.big == cjson_res.big, text
+		assert stream_res.score == cjson_res.score, text
+		assert stream_res.name == cjson_res.name, text
+		assert stream_res.active == cjson_res.active, text
+		assert stream_res.tags == cjson_res.tags, text
+		assert stream_res.grid == cjson_res.grid, text
+		assert stream_res.pets == cjson_res.pets, text
+		assert stream_res.level == cjson_res.level, text
+		assert stream_res.secret == cjson_res.secret, text
+	}
+}
+
+fn test_stream_decoder() {
+	user := json.decode(StreamUser, stream_texts[0])!
+	assert user.id == 1
+	assert user.big == 12345678901
+	assert user.score == 1.5
+	assert user.name == 'Bob'
+	assert user.active
+	assert user.tags == ['a', 'b']
+	assert user.grid == [[1, 2], [], [3]]
+	assert user.pets == [StreamPet{
+		name: 'Rex'
+		age:  3
+	}]
+	assert user.level == 2
+	escaped := json.decode(StreamUser, stream_texts[1])!
+	assert escaped.name == 'with "escapes" \\ / \b\f\n\r\t é € 😀'
+	assert escaped.level == 7
+	// the first member with a given key wins
+	duplicates := json.decode(StreamUser, stream_texts[3])!
+	assert duplicates.id == 1
+	assert duplicates.name == 'first'
+	// saturated, like cJSON's valueint
+	assert json.decode(StreamUser, stream_texts[4])!.id == int(max_i32)
+}
+
+fn test_stream_decoder_arrays() {
+	assert json.decode([]int, '[1, 2, 3]')! == [1, 2, 3]
+	assert json.decode([]StreamPet, '[{"name": "a"}, {"age": 2}]')! == [
+		StreamPet{
+			name: 'a'
+		},
+		StreamPet{
+			age: 2
+		},
+	]
+	assert json.decode([][]string, '[["a"], [], ["b", "c"]]')! == [['a'], []string{}, ['b', 'c']]
+	// decoded with cJSON, when the items do not have the right type
+	assert json.decode([]int, '[1, "2", null]')! == [1, 0, 0]
+}
+
+struct StreamNode {
+	name     string
+	children []StreamNode
+}
+
+fn test_stream_decoder_recursive_types() {
+	node := json.decode(StreamNode, '{"name": "root", "children": [{"name": "a", "children": [{"name": "b"}]}, {"name": "c"}]}')!
+	assert node.name == 'root'
+	assert node.children.len == 2
+	assert node.children[0].children[0].name == 'b'
+	assert node.children[1].children.len == 0
+}
+
+struct StreamRequired {
+	name     string @[required]
+	lastname string
+}
+
+fn test_stream_decoder_errors_come_from_cjson() {
+	json.decode(StreamRequired, '{"lastname": "Parker"}') or {
+		assert err.msg() == "expected field 'name' is missing"
+	}
+	json.decode(StreamRequired, '{"name": null}') or {
+		assert err.msg() == "type mismatch for field 'name', expecting `string` type, got: null"
+	}
+	json.decode(StreamRequired, '{"name": "Peter"') or {
+		assert err.msg().starts_with('failed to decode JSON string')
+	}
+	assert json.decode(StreamRequired, '{"name": "Peter"}')!.name == 'Peter'
+}
@@ -0,0 +1,523 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+module http
+
+import io
+import net
+import net.ssl
+import net.urllib
+import strconv
+import strings
+import sync
+import time
+
+// ClientConfig holds the limits of the connection pool of a Client.
+@[params]
+pub struct ClientConfig {
+pub:
+	max_idle_conns          int = 100 // the maximum number of idle connections, kept open for all hosts together
+	max_idle_conns_per_host int = 16  // the maximum number of idle connections, kept open for a single host
+	max_conns_per_host      int // the maximum number of connections (busy and idle) to a single host; 0 means no limit. Requests over the limit wait for a free connection.
+	idle_timeout            time.Duration = 90 * time.second // idle connections older than this are closed, instead of reused
+}
+
+// Client sends HTTP/1.1 requests over persistent (keep-alive) connections.
+// After a response has been read completely, its connection goes back to a
+// per host pool, and the next request to the same scheme, host and port reuses
+// it, instead of dialing (and doing a TLS handshake) again.
+// A Client can be shared by several threads.
+// Note: requests through a proxy are sent like with `Request.do()`, without pooling.
+@[heap]
+pub struct Client {
+	ClientConfig
+mut:
+	mu    &sync.Mutex = sync.new_mutex()
+	hosts map[string]&ClientHost
+	nidle int // the number of idle connections in all hosts
+}
+
+@[heap]
+struct ClientHost {
+mut:
+	idle  []&ClientConn     // the idle connections, the most recently used one is last
+	slots &sync.Semaphore = unsafe { nil } // limits the connections to max_conns_per_host, when it is > 0
+}
+
+// ClientConn is a TCP or TLS connection, owned by a Client
+@[heap]
+struct ClientConn {
+mut:
+	tcp_conn   &net.TcpConn = unsafe { nil }
+	ssl_conn   &ssl.SSLConn = unsafe { nil }
+	pending    []u8 // bytes that were received after the end of the previous response
+	rbuf       []u8 = []u8{len: 16 * 1024}
+	idle_since time.Time
+	reused     bool // the connection was taken from the pool
+	nread      int  // bytes received for the current response
+}
+
+// new_client creates a Client, with the connection pool limits in `config`
+pub fn new_client(config ClientConfig) &Client {
+	return &Client{
+		ClientConfig: config
+	}
+}
+
+// do sends the request `req` over a pooled connection, and returns its response.
+// Redirects are followed like with `Request.do()`.
+// Note: the `on_progress_body` callback and the `stop_copying_limit` and
+// `stop_receiving_limit` fields are not supported, since the response body has to
+// be read completely, before the connection can be reused.
+pub fn (mut c Client) do(req &Request) !Response {
+	return req.do_with_client(&c)
+}
+
+// fetch sends an HTTP request to the `url` with the given method and configuration,
+// over a pooled connection
+pub fn (mut c Client) fetch(config FetchConfig) !Response {
+	req := prepare(config)!
+	return c.do(req)
+}
+
+// get sends a GET HTTP request to the given `url`, over a pooled connection
+pub fn (mut c Client) get(url string) !Response {
+	return c.fetch(method: .get, url: url)
+}
+
+// post sends the string `data` as an HTTP POST request to the given `url`, over a pooled connection
+pub fn (mut c Client) post(url string, data string) !Response {
+	return c.fetch(
+		method: .post
+		url:    url
+		data:   data
+		header: new_header(key: .content_type, value: content_type_default)
+	)
+}
+
+// post_json sends the JSON `data` as an HTTP POST request to the given `url`, over a pooled connection
+pub fn (mut c Client) post_json(url string, data string) !Response {
+	return c.fetch(
+		method: .post
+		url:    url
+		data:   data
+		header: new_header(key: .content_type, value: 'application/json')
+	)
+}
+
+// close_idle_connections closes all idle connections in the pool.
+// Connections, that are in use by running requests, are not affected.
+pub fn (mut c Client) close_idle_connections() {
+	mut conns := []&ClientConn{}
+	c.mu.lock()
+	for _, mut h in c.hosts {
+		conns << h.idle
+		h.idle.clear()
+	}
+	c.nidle = 0
+	c.mu.unlock()
+	for mut conn in conns {
+		conn.close()
+	}
+}
+
+fn (mut c Client) method_and_url_to_response(req &Request, url urllib.URL) !Response {
+	scheme := url.scheme
+	if req.proxy != unsafe { nil } || scheme !in ['http', 'https'] {
+		return req.method_and_url_to_response(req.method, url)
+	}
+	host_name := url.hostname()
+	p := url.escaped_path().trim_left('/')
+	path := if url.query().len > 0 { '/${p}?${url.query().encode()}' } else { '/${p}' }
+	mut port := url.port().int()
+	if port == 0 {
+		port = if scheme == 'https' { 443 } else { 80 }
+	}
+	mut key := '${scheme}://${host_name}:${port}'
+	if scheme == 'https' {
+		// connections made with different certificates can not be shared
+		key += '|${req.validate}|${req.in_memory_verification}|${req.verify}|${req.cert}|${req.cert_key}'
+	}
+	head := req.build_request_headers_for(req.method, host_name, port, path, true)
+	$if trace_http_request ? {
+		eprint('> ')
+		eprint(head)
+		eprintln('')
+	}
+	mut retries := 0
+	for {
+		mut conn := c.get_conn(key, scheme == 'https', host_name, port, req) or {
+			retries++
+			if retries >= req.max_retries || is_no_need_retry_error(err.code()) {
+				return err
+			}
+			continue
+		}
+		resp, keep_alive := conn.round_trip(req, head) or {
+			was_reused := conn.reused && conn.nread == 0
+			c.put_conn(key, mut conn, false)
+			// the server may have closed an idle connection, just before it was reused;
+			// a request, for which nothing was received, can then be sent again on a new one
+			if was_reused && req.method in idempotent_methods {
+				continue
+			}
+			retries++
+			if retries >= req.max_retries || is_no_need_retry_error(err.code()) {
+				return err
+			}
+			continue
+		}
+		c.put_conn(key, mut conn, keep_alive)
+		return resp
+	}
+	return error('http.Client: unreachable')
+}
+
+const idempotent_methods = [Method.get, .head, .put, .delete, .options, .trace]
+
+// get_conn returns an idle connection for `key` from the pool, or dials a new one
+fn (mut c Client) get_conn(key string, is_ssl bool, host_name string, port int, req &Request) !&ClientConn {
+	c.mu.lock()
+	mut h := c.hosts[key] or {
+		mut nh := &ClientHost{}
+		if c.max_conns_per_host > 0 {
+			nh.slots = sync.new_semaphore_init(u32(c.max_conns_per_host))
+		}
+		c.hosts[key] = nh
+		nh
+	}
+	c.mu.unlock()
+	if h.slots != unsafe { nil } {
+		h.slots.wait()
+	}
+	mut expired := []&ClientConn{}
+	mut found := &ClientConn(unsafe { nil })
+	now := time.now()
+	c.mu.lock()
+	for h.idle.len > 0 {
+		conn := h.idle.pop()
+		c.nidle--
+		if now - conn.idle_since > c.idle_timeout {
+			expired << conn
+			continue
+		}
+		found = conn
+		break
+	}
+	c.mu.unlock()
+	for mut conn in expired {
+		conn.close()
+	}
+	if found != unsafe { nil } {
+		found.reused = true
+		found.set_timeouts(req)
+		return found
+	}
+	conn := dial_client_conn(is_ssl, host_name, port, req) or {
+		if h.slots != unsafe { nil } {
+			h.slots.post()
+		}
+		return err
+	}
+	return conn
+}
+
+// put_conn returns `conn` to the pool of `key`, or closes it, when it can not be reused,
+// or when the pool is full
+fn (mut c Client) put_conn(key string, mut conn ClientConn, reusable bool) {
+	mut expired := []&ClientConn{}
+	mut pooled := false
+	now := time.now()
+	c.mu.lock()
+	mut h := c.hosts[key] or {
+		c.mu.unlock()
+		conn.close()
+		return
+	}
+	// the oldest connections are first
+	mut nexpired := 0
+	for nexpired < h.idle.len && now - h.idle[nexpired].idle_since > c.idle_timeout {
+		expired << h.idle[nexpired]
+		nexpired++
+	}
+	if nexpired > 0 {
+		h.idle.delete_many(0, nexpired)
+		c.nidle -= nexpired
+	}
+	if reusable && h.idle.len < c.max_idle_conns_per_host && c.nidle < c.max_idle_conns {
+		conn.idle_since = now
+		h.idle << &conn
+		c.nidle++
+		pooled = true
+	}
+	c.mu.unlock()
+	if h.slots != unsafe { nil } {
+		h.slots.post()
+	}
+	if !pooled {
+		conn.close()
+	}
+	for mut old in expired {
+		old.close()
+	}
+}
+
+fn dial_client_conn(is_ssl bool, host_name string, port int, req &Request) !&ClientConn {
+	mut conn := &ClientConn{}
+	if is_ssl {
+		mut ssl_conn := ssl.new_ssl_conn(
+			verify:                 req.verify
+			cert:                   req.cert
+			cert_key:               req.cert_key
+			validate:               req.validate
+			in_memory_verification: req.in_memory_verification
+		)!
+		ssl_conn.dial(host_name, port)!
+		conn.ssl_conn = ssl_conn
+	} else {
+		conn.tcp_conn = net.dial_tcp('${host_name}:${port}')!
+	}
+	conn.set_timeouts(req)
+	return conn
+}
+
+fn (mut conn ClientConn) set_timeouts(req &Request) {
+	if conn.tcp_conn != unsafe { nil } {
+		conn.tcp_conn.set_read_timeout(req.read_timeout)
+		conn.tcp_conn.set_write_timeout(req.write_timeout)
+	}
+}
+
+fn (mut conn ClientConn) close() {
+	if conn.ssl_conn != unsafe { nil } {
+		conn.ssl_conn.shutdown() or {}
+	}
+	if conn.tcp_conn != unsafe { nil } {
+		conn.tcp_conn.close() or {}
+	}
+}
+
+fn (mut conn ClientConn) write_string(s string) ! {
+	if conn.ssl_conn != unsafe { nil } {
+		conn.ssl_conn.write_string(s)!
+	} else {
+		conn.tcp_conn.write_string(s)!
+	}
+}
+
+// read appends the next received bytes to `buf`, and returns their count; 0 means, that
+// the server closed the connection. Other read errors (timeouts, TLS errors) are returned.
+fn (mut conn ClientConn) read(mut buf []u8, req &Request) !int {
+	n := if conn.ssl_conn != unsafe { nil } {
+		conn.ssl_conn.socket_read_into_ptr(conn.rbuf.data, conn.rbuf.len) or {
+			if err !is io.Eof {
+				return err
+			}
+			0
+		}
+	} else {
+		conn.tcp_conn.read_ptr(conn.rbuf.data, conn.rbuf.len) or {
+			if err.code() == net.err_timed_out_code {
+				return err
+			}
+			0
+		}
+	}
+	if n <= 0 {
+		return 0
+	}
+	chunk := conn.rbuf[..n]
+	buf << chunk
+	conn.nread += n
+	if req.on_progress != unsafe { nil } {
+		req.on_progress(req, chunk, u64(conn.nread))!
+	}
+	return n
+}
+
+// round_trip writes the request `head` and reads its response. It also returns, whether
+// the connection can be used for another request.
+fn (mut conn ClientConn) round_trip(req &Request, head string) !(Response, bool) {
+	conn.nread = 0
+	conn.write_string(head)!
+	mut buf := conn.pending
+	conn.pending = []u8{}
+	for {
+		mut hend := find_headers_end(buf, 0)
+		for hend < 0 {
+			from := if buf.len > 3 { buf.len - 3 } else { 0 }
+			if conn.read(mut buf, req)! == 0 {
+				return error('http.Client: the connection was closed before a response was received')
+			}
+			hend = find_headers_end(buf, from)
+		}
+		head_text := buf[..hend - 4].bytestr()
+		status_line := head_text.all_before('\r\n')
+		version, status_code, status_msg := parse_status_line(status_line)!
+		header := if status_line.len < head_text.len {
+			parse_headers(head_text[status_line.len + 2..])!
+		} else {
+			new_header()
+		}
+		if status_code >= 100 && status_code < 200 && status_code != 101 {
+			// an interim response (i.e. `100 Continue`), the final one follows it
+			buf = buf[hend..].clone()
+			continue
+		}
+		mut keep_alive := version == '1.1'
+		if connection := header.get(.connection) {
+			lconnection := connection.to_lower()
+			if lconnection.contains('close') {
+				keep_alive = false
+			} else if lconnection.contains('keep-alive') {
+				keep_alive = true
+			}
+		}
+		transfer_encoding := header.get(.transfer_encoding) or { '' }
+		mut body := ''
+		mut end := hend
+		if req.method == .head || status_code == 204 || status_code == 304 || status_code == 101 {
+			keep_alive = keep_alive && status_code != 101
+		} else if transfer_encoding.to_lower().contains('chunked') {
+			mut chunked := ChunkedBody{
+				pos: hend
+			}
+			for !chunked.scan(buf)! {
+				if conn.read(mut buf, req)! == 0 {
+					return error('http.Client: the connection was closed in the middle of a chunked response')
+				}
+			}
+			end = chunked.pos
+			body = chunked.body.str()
+		} else if clen := header.get(.content_length) {
+			n := strconv.atoi(clen.trim_space()) or {
+				return error('http.Client: invalid Content-Length: `${clen}`')
+			}
+			if n < 0 {
+				return error('http.Client: invalid Content-Length: `${clen}`')
+			}
+			end = hend + n
+			for buf.len < end {
+				if conn.read(mut buf, req)! == 0 {
+					return error('http.Client: the connection was closed before the end of the response body')
+				}
+			}
+			body = buf[hend..end].bytestr()
+		} else {
+			// the body ends, when the server closes the connection
+			for conn.read(mut buf, req)! > 0 {
+			}
+			end = buf.len
+			body = buf[hend..end].bytestr()
+			keep_alive = false
+		}
+		if keep_alive && end < buf.len {
+			conn.pending = buf[end..].clone()
+		}
+		$if trace_http_response ? {
+			eprint('< ')
+			eprint(buf[..end].bytestr())
+			eprintln('')
+		}
+		if req.on_finish != unsafe { nil } {
+			req.on_finish(req, u64(end))!
+		}
+		return Response{
+			http_version: version
+			status_code:  status_code
+			status_msg:   status_msg
+			header:       header
+			body:         body
+		}, keep_alive
+	}
+	return error('http.Client: unreachable')
+}
+
+// find_headers_end returns the index after the `\r\n\r\n`, that ends the response head
+// in `buf`, searching from `from`, or -1, when the head is not complete yet
+@[direct_array_access]
+fn find_headers_end(buf []u8, from int) int {
+	for i := from; i + 3 < buf.len; i++ {
+		if buf[i] == `\r` && buf[i + 1] == `\n` && buf[i + 2] == `\r` && buf[i + 3] == `\n` {
+			return i + 4
+		}
+	}
+	return -1
+}
+
+// find_crlf returns the index of the first `\r\n` in `buf` at or after `from`, or -1
+@[direct_array_access]
+fn find_crlf(buf []u8, from int) int {
+	for i := from; i + 1 < buf.len; i++ {
+		if buf[i] == `\r` && buf[i + 1] == `\n` {
+			return i
+		}
+	}
+	return -1
+}
+
+// ChunkedBody is the state of the parsing of a chunked body, that is received in parts.
+// The parsed chunks are not scanned again, when more data is received.
+struct ChunkedBody {
+mut:
+	pos     int  // the start of the next chunk size line (or trailer field), or the end of the body
+	trailer bool // the last chunk was parsed, only the trailer fields are left
+	body    strings.Builder = strings.new_builder(0)
+}
+
+// scan parses the complete chunks after `cb.pos` in `buf`, and writes their data to `cb.body`.
+// It returns true, when the body is complete, and `cb.pos` is then the index after its end.
+// Chunk extensions and trailer fields are skipped.
+@[direct_array_access]
+fn (mut cb ChunkedBody) scan(buf []u8) !bool {
+	for !cb.trailer {
+		line_end := find_crlf(buf, cb.pos)
+		if line_end < 0 {
+			return false
+		}
+		mut size := i64(0)
+		mut i := cb.pos
+		for i < line_end && buf[i].is_hex_digit() {
+			size = size * 16 + i64(hex_digit_value(buf[i]))
+			if size > max_i32 {
+				return error('http.Client: too large chunk size')
+			}
+			i++
+		}
+		if i == cb.pos {
+			return error('http.Client: invalid chunk size')
+		}
+		if size == 0 {
+			cb.pos = line_end + 2
+			cb.trailer = true
+			break
+		}
+		data := line_end + 2
+		if i64(data) + size + 2 > buf.len {
+			return false
+		}
+		unsafe { cb.body.write_ptr(&buf[data], int(size)) }
+		cb.pos = data + int(size) + 2
+	}
+	// the optional trailer fields end with an empty line
+	for {
+		trailer_end := find_crlf(buf, cb.pos)
+		if trailer_end < 0 {
+			return false
+		}
+		if trailer_end == cb.pos {
+			cb.pos += 2
+			return true
+		}
+		cb.pos = trailer_end + 2
+	}
+	return false
+}
+
+fn hex_digit_value(c u8) u8 {
+	return match c {
+		`0`...`9` { c - `0` }
+		`a`...`f` { c - `a` + 10 }
+		else { c - `A` + 10 }
+	}
+}
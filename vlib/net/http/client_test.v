@@ -0,0 +1,88 @@
+module http
+
+import net
+
+fn test_find_headers_end() {
+	assert find_headers_end('HTTP/1.1 200 OK\r\n\r\n'.bytes(), 0) == 19
+	assert find_headers_end('HTTP/1.1 200 OK\r\nA: b\r\n\r\nbody'.bytes(), 10) == 25
+	assert find_headers_end('HTTP/1.1 200 OK\r\nA: b\r\n'.bytes(), 0) == -1
+}
+
+fn test_chunked_body_scan() ! {
+	data := 'HEAD5;ext=1\r\nhello\r\n6\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\nnext'.bytes()
+	end := data.len - 'next'.len
+	mut whole := ChunkedBody{
+		pos: 4
+	}
+	assert whole.scan(data)!
+	assert whole.pos == end
+	assert whole.body.str() == 'hello world'
+	// received one byte at a time, with the state kept between the reads
+	mut parts := ChunkedBody{
+		pos: 4
+	}
+	for n in 4 .. end {
+		assert !parts.scan(data[..n])!
+	}
+	assert parts.scan(data[..end])!
+	assert parts.pos == end
+	assert parts.body.str() == 'hello world'
+	mut invalid := ChunkedBody{}
+	mut failed := false
+	invalid.scan('x\r\n'.bytes()) or {
+		failed = true
+		false
+	}
+	assert failed
+}
+
+fn test_client_reuses_connections() ! {
+	// port 0 lets the OS pick a free port
+	mut l := net.listen_tcp(.ip, '127.0.0.1:0')!
+	port := l.addr()!.port()!
+	t := spawn serve_keep_alive_requests(mut l, 4)
+	mut client := new_client()
+	for _ in 0 .. 4 {
+		resp := client.get('http://127.0.0.1:${port}/')!
+		assert resp.status_code == 200
+		assert resp.body == 'hello world'
+	}
+	assert t.wait() == 1
+	client.close_idle_connections()
+	l.close()!
+}
+
+// serve_keep_alive_requests answers `nrequests` requests, alternating between responses with
+// a Content-Length and chunked ones, and returns the number of accepted connections
+fn serve_keep_alive_requests(mut l net.TcpListener, nrequests int) int {
+	mut naccepted := 0
+	mut served := 0
+	mut buf := []u8{len: 4096}
+	for served < nrequests {
+		mut conn := l.accept() or { break }
+		naccepted++
+		mut pending := ''
+		for served < nrequests {
+			for !pending.contains('\r\n\r\n') {
+				n := conn.read(mut buf) or { 0 }
+				if n <= 0 {
+					break
+				}
+				pending += buf[..n].bytestr()
+			}
+			if !pending.contains('\r\n\r\n') {
+				break
+			}
+			pending = pending.all_after('\r\n\r\n')
+			served++
+			response := if served % 2 == 0 {
+				'HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5;ext=1\r\nhello\r\n6\r\n world\r\n0\r\n\r\n'
+			} else {
+				'HTTP/1.1 200 OK\r\nContent-Length: 11\r\n\r\nhello world'
+			}
+			conn.write_string(response) or { break }
+		}
+		conn.close() or {}
+	}
+	return naccepted
+}
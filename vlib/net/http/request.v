@@ -94,6 +94,12 @@ pub fn (req &Request) cookie(name string) ?Cookie {
 
 // do will send the HTTP request and returns `http.Response` as soon as the response is received
 pub fn (req &Request) do() !Response {
+	return req.do_with_client(unsafe { nil })
+}
+
+// do_with_client sends the request and follows its redirects. When `client` is not nil,
+// the requests are sent over the pooled connections of `client`.
+fn (req &Request) do_with_client(client &Client) !Response {
 	mut url := urllib.parse(req.url) or { return error('http.Request.do: invalid url ${req.url}') }
 	mut rurl := url
 	mut resp := Response{}
@@ -102,7 +108,12 @@ pub fn (req &Request) do() !Response {
 		if nredirects == max_redirects {
 			return error('http.request.do: maximum number of redirects reached (${max_redirects})')
 		}
-		qresp := req.method_and_url_to_response(req.method, rurl)!
+		qresp := if client == unsafe { nil } {
+			req.method_and_url_to_response(req.method, rurl)!
+		} else {
+			mut c := unsafe { client }
+			c.method_and_url_to_response(req, rurl)!
+		}
 		resp = qresp
 		if !req.allow_redirect {
 			break
@@ -183,6 +194,13 @@ fn (req &Request) method_and_url_to_response(method Method, url urllib.URL) !Res
 }
 
 fn (req &Request) build_request_headers(method Method, host_name string, port int, path string) string {
+	return req.build_request_headers_for(method, host_name, port, path, false)
+}
+
+// build_request_headers_for builds the request head and body. When `keep_alive` is true, the
+// request asks the server to keep the connection open, unless its header already has a
+// `Connection` field.
+fn (req &Request) build_request_headers_for(method Method, host_name string, port int, path string, keep_alive bool) string {
 	mut sb := strings.new_builder(4096)
 	version := if req.version == .unknown { Version.v1_1 } else { req.version }
 	sb.write_string(method.str())
@@ -225,7 +243,11 @@ fn (req &Request) build_request_headers(method Method, host_name string, port in
 		sb.write_string('\r\n')
 	}
 	sb.write_string(req.build_request_cookies_header())
-	sb.write_string('Connection: close\r\n')
+	if !keep_alive {
+		sb.write_string('Connection: close\r\n')
+	} else if !req.header.contains(.connection) {
+		sb.write_string('Connection: keep-alive\r\n')
+	}
 	sb.write_string('\r\n')
 	sb.write_string(req.data)
 	return sb.str()
@@ -0,0 +1,120 @@
+module os
+
+// MmapMode is the access mode of a memory mapped file, see mmap_file/2 .
+pub enum MmapMode {
+	read_only     // the mapped memory can only be read; writing to it crashes the program
+	read_write    // changes to the mapped memory are written back to the file
+	copy_on_write // the mapped memory can be changed, but the changes are private, and are never written to the file
+}
+
+// MmapAdvice tells the OS how the mapped memory will be accessed, so that it can read ahead,
+// or drop the pages, that are no longer needed. It is only a hint, and it is ignored on Windows.
+pub enum MmapAdvice {
+	normal
+	sequential
+	random
+	will_need
+	dont_need
+}
+
+// MmapFile is a file, that is mapped into the memory of the process, see mmap_file/2 .
+@[heap]
+pub struct MmapFile {
+pub:
+	path string
+	mode MmapMode
+	size u64
+mut:
+	data   &u8 = unsafe { nil }
+	closed bool
+}
+
+// mmap_file maps the whole file at `path` into memory, without reading it. The OS loads the pages
+// of the file on demand, when they are accessed, and can drop them again, when memory is needed
+// elsewhere, so files much larger than the available RAM can be processed.
+// The file should not be truncated by another process, while it is mapped.
+// Example: mut m := os.mmap_file('data.csv', .read_only)!; m.advise(.sequential)!; println(m.str().count('\n')); m.close()!
+pub fn mmap_file(path string, mode MmapMode) !&MmapFile {
+	size := stat(path)!.size
+	if size == 0 {
+		// empty files can not be mapped, but their views are just empty
+		return &MmapFile{
+			path: path
+			mode: mode
+		}
+	}
+	return &MmapFile{
+		path: path
+		mode: mode
+		size: size
+		data: map_file(path, mode, size)!
+	}
+}
+
+// bytes returns all the mapped memory as an array, without copying it. The array is valid until
+// close() is called, and must not be modified in .read_only mode. Files of 2GB and more do not fit
+// in a single array; use view/2 for them.
+pub fn (m &MmapFile) bytes() []u8 {
+	if m.size > u64(max_i32) {
+		panic('os.MmapFile.bytes: ${m.path} is too large for a single array, use .view() instead')
+	}
+	return m.view(0, int(m.size))
+}
+
+// view returns `len` bytes of the mapped memory, starting at `offset`, without copying them.
+// Like bytes(), the result is valid until close() is called.
+pub fn (m &MmapFile) view(offset u64, len int) []u8 {
+	if len < 0 || offset > m.size || u64(len) > m.size - offset {
+		panic('os.MmapFile.view: ${offset}+${len} is out of the bounds of ${m.path}, which has ${m.size} bytes')
+	}
+	if m.closed {
+		panic('os.MmapFile.view: ${m.path} is already closed')
+	}
+	if len == 0 {
+		return []u8{}
+	}
+	mut res := unsafe { voidptr(m.data + offset).vbytes(len) }
+	// the memory belongs to the mapping, so the array should never free or reallocate it
+	res.flags.set(.noshrink | .nogrow | .nofree)
+	return res
+}
+
+// str returns all the mapped memory as a string, without copying it. The string is valid until
+// close() is called. Note, that unlike most V strings, it is not terminated by a 0 byte.
+pub fn (m &MmapFile) str() string {
+	b := m.bytes()
+	if b.len == 0 {
+		return ''
+	}
+	return unsafe { tos(b.data, b.len) }
+}
+
+// advise tells the OS how the mapped memory will be accessed. For example, `.sequential` makes it
+// read ahead more aggressively, and drop the pages, that were already processed, sooner.
+pub fn (m &MmapFile) advise(advice MmapAdvice) ! {
+	if m.closed || m.size == 0 {
+		return
+	}
+	advise_mapping(m.data, m.size, advice)!
+}
+
+// sync writes the changes in the mapped memory back to the file, in .read_write mode
+pub fn (m &MmapFile) sync() ! {
+	if m.closed || m.size == 0 || m.mode != .read_write {
+		return
+	}
+	sync_mapping(m.data, m.size)!
+}
+
+// close unmaps the file. All views returned by bytes(), view() and str() become invalid.
+pub fn (mut m MmapFile) close() ! {
+	if m.closed {
+		return
+	}
+	m.closed = true
+	if m.size == 0 {
+		return
+	}
+	unmap_file(m.data, m.size)!
+	m.data = unsafe { nil }
+}
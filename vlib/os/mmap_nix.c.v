@@ -0,0 +1,52 @@
+module os
+
+#include <sys/mman.h>
+
+fn C.mmap(addr voidptr, len usize, prot int, flags int, fd int, offset i64) voidptr
+fn C.munmap(addr voidptr, len usize) int
+fn C.madvise(addr voidptr, len usize, advice int) int
+fn C.msync(addr voidptr, len usize, flags int) int
+
+fn map_file(path string, mode MmapMode, size u64) !&u8 {
+	oflags := if mode == .read_write { C.O_RDWR } else { C.O_RDONLY }
+	fd := C.open(&char(path.str), oflags)
+	if fd == -1 {
+		return error_posix()
+	}
+	defer {
+		// the mapping stays valid after the file descriptor is closed
+		C.close(fd)
+	}
+	prot := if mode == .read_only { C.PROT_READ } else { C.PROT_READ | C.PROT_WRITE }
+	flags := if mode == .read_write { C.MAP_SHARED } else { C.MAP_PRIVATE }
+	addr := C.mmap(unsafe { nil }, usize(size), prot, flags, fd, 0)
+	if addr == voidptr(-1) {
+		return error_posix()
+	}
+	return &u8(addr)
+}
+
+fn unmap_file(data &u8, size u64) ! {
+	if C.munmap(data, usize(size)) != 0 {
+		return error_posix()
+	}
+}
+
+fn advise_mapping(data &u8, size u64, advice MmapAdvice) ! {
+	cadvice := match advice {
+		.normal { C.MADV_NORMAL }
+		.sequential { C.MADV_SEQUENTIAL }
+		.random { C.MADV_RANDOM }
+		.will_need { C.MADV_WILLNEED }
+		.dont_need { C.MADV_DONTNEED }
+	}
+	if C.madvise(data, usize(size), cadvice) != 0 {
+		return error_posix()
+	}
+}
+
+fn sync_mapping(data &u8, size u64) ! {
+	if C.msync(data, usize(size), C.MS_SYNC) != 0 {
+		return error_posix()
+	}
+}
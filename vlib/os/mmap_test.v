@@ -0,0 +1,64 @@
+import os
+
+const tfolder = os.join_path(os.vtmp_dir(), 'mmap_tests')
+
+fn testsuite_begin() {
+	os.rmdir_all(tfolder) or {}
+	os.mkdir_all(tfolder) or { panic(err) }
+}
+
+fn testsuite_end() {
+	os.rmdir_all(tfolder) or {}
+}
+
+fn test_mmap_file_read_only() {
+	path := os.join_path(tfolder, 'read_only.txt')
+	content := 'line 1\nline 2\n'.repeat(1000)
+	os.write_file(path, content)!
+	mut m := os.mmap_file(path, .read_only)!
+	assert m.size == u64(content.len)
+	m.advise(.sequential)!
+	assert m.str() == content
+	assert m.bytes() == content.bytes()
+	assert m.view(7, 6).bytestr() == 'line 2'
+	m.close()!
+	m.close()!
+}
+
+fn test_mmap_file_read_write() {
+	path := os.join_path(tfolder, 'read_write.txt')
+	os.write_file(path, 'hello world')!
+	mut m := os.mmap_file(path, .read_write)!
+	mut b := m.bytes()
+	b[0] = `H`
+	m.sync()!
+	m.close()!
+	assert os.read_file(path)! == 'Hello world'
+}
+
+fn test_mmap_file_copy_on_write() {
+	path := os.join_path(tfolder, 'copy_on_write.txt')
+	os.write_file(path, 'hello world')!
+	mut m := os.mmap_file(path, .copy_on_write)!
+	mut b := m.bytes()
+	b[0] = `H`
+	assert m.str() == 'Hello world'
+	m.close()!
+	// the changes are not written to the file
+	assert os.read_file(path)! == 'hello world'
+}
+
+fn test_mmap_empty_file() {
+	path := os.join_path(tfolder, 'empty.txt')
+	os.write_file(path, '')!
+	mut m := os.mmap_file(path, .read_only)!
+	assert m.size == 0
+	assert m.str() == ''
+	assert m.bytes().len == 0
+	m.close()!
+}
+
+fn test_mmap_missing_file() {
+	os.mmap_file(os.join_path(tfolder, 'missing.txt'), .read_only) or { return }
+	assert false
+}
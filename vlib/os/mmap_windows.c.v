@@ -0,0 +1,58 @@
+module os
+
+fn C.CreateFileMappingW(file voidptr, attributes voidptr, protect u32, max_size_high u32, max_size_low u32, name &u16) voidptr
+fn C.MapViewOfFile(mapping voidptr, access u32, offset_high u32, offset_low u32, size usize) voidptr
+fn C.UnmapViewOfFile(addr voidptr) bool
+fn C.FlushViewOfFile(addr voidptr, size usize) bool
+
+fn map_file(path string, mode MmapMode, size u64) !&u8 {
+	access := if mode == .read_write { u32(C.GENERIC_READ | C.GENERIC_WRITE) } else { u32(C.GENERIC_READ) }
+	h_file := C.CreateFileW(path.to_wide(), access, u32(C.FILE_SHARE_READ | C.FILE_SHARE_WRITE),
+		unsafe { nil }, u32(C.OPEN_EXISTING), u32(C.FILE_ATTRIBUTE_NORMAL), unsafe { nil })
+	if h_file == C.INVALID_HANDLE_VALUE {
+		return error_win32(code: int(C.GetLastError()))
+	}
+	defer {
+		// the view keeps the file, and the mapping object alive, after their handles are closed
+		C.CloseHandle(h_file)
+	}
+	protect := match mode {
+		.read_only { u32(C.PAGE_READONLY) }
+		.read_write { u32(C.PAGE_READWRITE) }
+		.copy_on_write { u32(C.PAGE_WRITECOPY) }
+	}
+	h_mapping := C.CreateFileMappingW(h_file, unsafe { nil }, protect, u32(size >> 32), u32(size),
+		unsafe { nil })
+	if h_mapping == unsafe { nil } {
+		return error_win32(code: int(C.GetLastError()))
+	}
+	defer {
+		C.CloseHandle(h_mapping)
+	}
+	view_access := match mode {
+		.read_only { u32(C.FILE_MAP_READ) }
+		.read_write { u32(C.FILE_MAP_WRITE) }
+		.copy_on_write { u32(C.FILE_MAP_COPY) }
+	}
+	addr := C.MapViewOfFile(h_mapping, view_access, 0, 0, 0)
+	if addr == unsafe { nil } {
+		return error_win32(code: int(C.GetLastError()))
+	}
+	return &u8(addr)
+}
+
+fn unmap_file(data &u8, size u64) ! {
+	if !C.UnmapViewOfFile(data) {
+		return error_win32(code: int(C.GetLastError()))
+	}
+}
+
+fn advise_mapping(data &u8, size u64, advice MmapAdvice) ! {
+	// there is no direct equivalent of madvise for mapped files on Windows
+}
+
+fn sync_mapping(data &u8, size u64) ! {
+	if !C.FlushViewOfFile(data, usize(size)) {
+		return error_win32(code: int(C.GetLastError()))
+	}
+}
@@ -317,6 +317,8 @@ pub mut:
 	debug    int // enable in order to have the unroll of the code 0 = NO_DEBUG, 1 = LIGHT 2 = VERBOSE
 	log_func FnLog = simple_log // log function, can be customized by the user
 	query    string // query string
+mut:
+	dfa &DfaProg = unsafe { nil } // automata based finder, nil if the pattern is not supported, see regex_dfa.v
 }
 
 // Reset RE object
@@ -995,6 +997,7 @@ fn (mut re RE) impl_compile(in_txt string) (int, int) {
 	mut group_stack_index := -1
 
 	re.query = in_txt // save the query string
+	re.dfa = unsafe { nil }
 
 	i = 0
 	for i < in_txt.len {
@@ -1520,6 +1523,8 @@ fn (mut re RE) impl_compile(in_txt string) (int, int) {
 		pc1++
 	}
 
+	re.build_dfa()
+
 	//******************************************
 	// DEBUG PRINT REGEX GENERATED CODE
 	//******************************************
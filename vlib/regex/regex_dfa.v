@@ -0,0 +1,439 @@
+module regex
+
+/******************************************************************************
+*
+* Automata based finder
+*
+* match_base interprets the program token by token, and find_all/find_from
+* call it at every index of the text, so a search can take quadratic time.
+* For the patterns, where it gives the same results as a leftmost longest
+* matcher, the program is also compiled to an NFA, that is run as a lazily
+* built DFA, in time linear in the length of the text:
+* - only ASCII chars, positive char classes, `\w \s \d \a \A` and OR chains
+*   of single tokens, with greedy quantifiers; no dots, groups or anchors
+* - the chars, that a quantified token matches, can not start the rest of
+*   the pattern, so the backtracker never has to give back a char.
+*
+* The linear time is guaranteed only for this subset. For all the other
+* patterns, re.dfa is nil (groups, dots, negated classes, lazy quantifiers...),
+* or use_dfa returns false (anchors, flags), and the searches still call
+* match_base at every index, which can take quadratic time.
+*
+******************************************************************************/
+const dfa_max_slots = 512 // max NFA positions, after the bounded quantifiers are expanded
+const dfa_max_states = 2048 // max cached DFA states, the cache is flushed when it is full
+const dfa_positive_bsls = [`w`, `s`, `d`, `a`, `A`]
+
+enum DfaSlotKind as u8 {
+	one  // matches exactly once
+	opt  // matches zero or one time
+	star // matches any number of times
+}
+
+// DfaSlot is a position of the NFA: a set of bytes and how many times it is matched
+struct DfaSlot {
+mut:
+	kind DfaSlotKind
+	set  [256]bool
+}
+
+// Dfa is a lazily built DFA. Its states are sets of NFA positions, the transitions are
+// computed on the first use and cached, for each class of bytes, that the slots do not
+// tell apart.
+struct Dfa {
+mut:
+	kinds      []DfaSlotKind
+	matches    []bool // slot * nr_classes + class => the slot matches the class
+	classes    [256]u8
+	nr_classes int
+	nr_words   int  // u64 words in a set of positions
+	unanchored bool // a match can start at any byte
+	init       []u64 // the closure of the first position
+	// the cache of the states
+	sets   []u64 // the positions of each state, nr_words for each
+	accept []bool
+	empty  []bool
+	trans  []int // state * nr_classes + class => the next state, -1 when not computed yet
+	index  map[string]int
+	start  int
+}
+
+// DfaProg finds the leftmost longest matches with three DFAs: the unanchored one finds the end
+// of the first match, that ends, the reversed one its leftmost start, and the last one the end
+// of the longest match from there. Each byte is read a bounded number of times.
+struct DfaProg {
+mut:
+	fwd     Dfa
+	rev     Dfa
+	longest Dfa
+	prefix  string    // the bytes, that every match starts with
+	first   [256]bool // the bytes, that a match can start with
+}
+
+// build_dfa compiles the program to a DfaProg, when the pattern is supported
+fn (mut re RE) build_dfa() {
+	re.dfa = unsafe { nil }
+	slots := re.dfa_slots() or { return }
+	// the quantified slots must not match the first byte of the rest of the pattern
+	for k, slot in slots {
+		if slot.kind == .one {
+			continue
+		}
+		for j in k + 1 .. slots.len {
+			for b in 0 .. 256 {
+				if slot.set[b] && slots[j].set[b] {
+					return
+				}
+			}
+			if slots[j].kind == .one {
+				break
+			}
+		}
+	}
+	// the classes of bytes, that all the slots match in the same way
+	mut classes := [256]u8{}
+	mut nr_classes := 1
+	for slot in slots {
+		mut remap := []int{len: nr_classes * 2, init: -1}
+		mut n := 0
+		for b in 0 .. 256 {
+			key := int(classes[b]) * 2 + int(slot.set[b])
+			if remap[key] < 0 {
+				remap[key] = n
+				n++
+			}
+			classes[b] = u8(remap[key])
+		}
+		nr_classes = n
+	}
+	mut p := &DfaProg{
+		fwd:     new_dfa(slots, classes, nr_classes, true)
+		rev:     new_dfa(slots.reverse(), classes, nr_classes, false)
+		longest: new_dfa(slots, classes, nr_classes, false)
+	}
+	for slot in slots {
+		if slot.kind != .one {
+			break
+		}
+		mut only := -1
+		for b in 0 .. 256 {
+			if slot.set[b] {
+				only = if only == -1 { b } else { -2 }
+			}
+		}
+		if only < 0 {
+			break
+		}
+		p.prefix += u8(only).ascii_str()
+	}
+	for slot in slots {
+		for b in 0 .. 256 {
+			p.first[b] = p.first[b] || slot.set[b]
+		}
+		if slot.kind == .one {
+			break
+		}
+	}
+	re.dfa = p
+}
+
+// dfa_slots expands the tokens of the program to NFA positions, or returns none, when the
+// pattern is not supported
+fn (re &RE) dfa_slots() ?[]DfaSlot {
+	if re.group_count > 0 {
+		return none
+	}
+	mut slots := []DfaSlot{}
+	mut pc := 0
+	for pc < re.prog_len {
+		tk := re.prog[pc]
+		if tk.greedy || tk.rep_max < 1 || tk.rep_min > tk.rep_max {
+			return none
+		}
+		mut slot := DfaSlot{}
+		if !re.dfa_token_set(pc, mut slot.set) {
+			return none
+		}
+		// an OR chain of single tokens matches the union of their chars
+		mut last := pc
+		for last + 2 < re.prog_len && re.prog[last + 1].ist == ist_or_branch {
+			if !re.prog[last].next_is_or || re.prog[last].rep_min != 1
+				|| re.prog[last].rep_max != 1 {
+				return none
+			}
+			last += 2
+			if !re.dfa_token_set(last, mut slot.set) {
+				return none
+			}
+		}
+		if last > pc {
+			if re.prog[last].rep_min != 1 || re.prog[last].rep_max != 1 || re.prog[last].greedy {
+				return none
+			}
+			// every OR must jump after the chain, when the token before it matched
+			for o := pc + 1; o < last; o += 2 {
+				mut target := re.prog[o].rep_max
+				for target > o && target < last && re.prog[target].ist == ist_or_branch {
+					target = re.prog[target].rep_max
+				}
+				if re.prog[o].rep_min != o + 1 || target != last + 1 {
+					return none
+				}
+			}
+		}
+		for _ in 0 .. tk.rep_min {
+			slots << DfaSlot{
+				...slot
+				kind: .one
+			}
+		}
+		if tk.rep_max == max_quantifier {
+			slots << DfaSlot{
+				...slot
+				kind: .star
+			}
+		} else {
+			for _ in tk.rep_min .. tk.rep_max {
+				slots << DfaSlot{
+					...slot
+					kind: .opt
+				}
+			}
+		}
+		if slots.len > dfa_max_slots {
+			return none
+		}
+		pc = last + 1
+	}
+	if slots.len == 0 {
+		return none
+	}
+	return slots
+}
+
+// dfa_token_set adds the bytes, that the token at `pc` matches, to `set`. It returns false for
+// the tokens, that the DFA does not support: the ones, that can match non ASCII chars or the end
+// of the text, and the ones, that match more than a char.
+fn (re &RE) dfa_token_set(pc int, mut set [256]bool) bool {
+	tk := re.prog[pc]
+	if tk.ist == ist_simple_char {
+		if tk.ch < 1 || tk.ch > 0x7f {
+			return false
+		}
+		set[int(tk.ch)] = true
+		return true
+	}
+	if tk.ist == ist_bsls_char {
+		if tk.ch !in dfa_positive_bsls {
+			return false
+		}
+		for b in 1 .. 0x80 {
+			set[b] = set[b] || tk.validator(u8(b))
+		}
+		return true
+	}
+	if tk.ist == ist_char_class_pos {
+		mut cc_i := tk.cc_index
+		for cc_i >= 0 && cc_i < re.cc.len && re.cc[cc_i].cc_type != cc_end {
+			c := re.cc[cc_i]
+			if c.cc_type == cc_bsls {
+				if c.ch0 !in dfa_positive_bsls {
+					return false
+				}
+			} else if c.ch0 < 1 || c.ch1 > 0x7f {
+				return false
+			}
+			cc_i++
+		}
+		for b in 1 .. 0x80 {
+			set[b] = set[b] || re.check_char_class(pc, rune(b))
+		}
+		return true
+	}
+	return false
+}
+
+fn new_dfa(slots []DfaSlot, classes [256]u8, nr_classes int, unanchored bool) Dfa {
+	mut d := Dfa{
+		kinds:      slots.map(it.kind)
+		matches:    []bool{len: slots.len * nr_classes}
+		classes:    classes
+		nr_classes: nr_classes
+		nr_words:   (slots.len + 1 + 63) / 64
+		unanchored: unanchored
+	}
+	for j, slot in slots {
+		for b in 0 .. 256 {
+			if slot.set[b] {
+				d.matches[j * nr_classes + classes[b]] = true
+			}
+		}
+	}
+	mut init := []u64{len: d.nr_words}
+	init[0] = 1
+	d.closure(mut init)
+	d.init = init
+	d.reset_cache()
+	return d
+}
+
+// reset_cache drops all the states, and adds the start one. When the search is unanchored,
+// the first position is added before each step, so the start state is empty.
+fn (mut d Dfa) reset_cache() {
+	d.sets.clear()
+	d.accept.clear()
+	d.empty.clear()
+	d.trans.clear()
+	d.index.clear()
+	d.start = d.add_state(if d.unanchored { []u64{len: d.nr_words} } else { d.init })
+}
+
+// closure adds the positions, that can be reached by skipping the optional slots
+@[direct_array_access]
+fn (d &Dfa) closure(mut set []u64) {
+	for j in 0 .. d.kinds.len {
+		if set[j >> 6] & (u64(1) << (j & 63)) != 0 && d.kinds[j] != .one {
+			set[(j + 1) >> 6] |= u64(1) << ((j + 1) & 63)
+		}
+	}
+}
+
+fn (mut d Dfa) add_state(set []u64) int {
+	key := dfa_key(set)
+	if st := d.index[key] {
+		return st
+	}
+	st := d.accept.len
+	n := d.kinds.len
+	d.sets << set
+	d.accept << set[n >> 6] & (u64(1) << (n & 63)) != 0
+	d.empty << set.all(it == 0)
+	d.trans << []int{len: d.nr_classes, init: -1}
+	d.index[key] = st
+	return st
+}
+
+fn dfa_key(set []u64) string {
+	return unsafe { tos(&u8(set.data), set.len * 8) }.clone()
+}
+
+// next returns the state after reading the byte `b` in the state `st`
+@[direct_array_access; inline]
+fn (mut d Dfa) next(st int, b u8) int {
+	cls := d.classes[b]
+	next := d.trans[st * d.nr_classes + cls]
+	if next >= 0 {
+		return next
+	}
+	return d.compute(st, int(cls))
+}
+
+@[direct_array_access]
+fn (mut d Dfa) compute(st int, cls int) int {
+	mut set := []u64{len: d.nr_words}
+	base := st * d.nr_words
+	for j, kind in d.kinds {
+		mut word := d.sets[base + (j >> 6)]
+		if d.unanchored {
+			word |= d.init[j >> 6]
+		}
+		if word & (u64(1) << (j & 63)) != 0 && d.matches[j * d.nr_classes + cls] {
+			set[(j + 1) >> 6] |= u64(1) << ((j + 1) & 63)
+			if kind == .star {
+				set[j >> 6] |= u64(1) << (j & 63)
+			}
+		}
+	}
+	d.closure(mut set)
+	if d.index.len >= dfa_max_states && dfa_key(set) !in d.index {
+		// `st` does not survive the flush, so the transition is not cached
+		d.reset_cache()
+		return d.add_state(set)
+	}
+	next := d.add_state(set)
+	d.trans[st * d.nr_classes + cls] = next
+	return next
+}
+
+// skip returns the first index at or after `i`, where a match can start, or -1
+@[direct_array_access]
+fn (p &DfaProg) skip(s string, i int) int {
+	if p.prefix.len > 0 {
+		return s.index_after_(p.prefix, i)
+	}
+	for j in i .. s.len {
+		if p.first[s[j]] {
+			return j
+		}
+	}
+	return -1
+}
+
+// find returns the bounds of the leftmost longest non empty match, that starts at or after
+// `start`, or -1, -1
+@[direct_array_access]
+fn (mut p DfaProg) find(s string, start int) (int, int) {
+	// the end of the first match, that ends
+	mut end := -1
+	mut st := p.fwd.start
+	mut i := start
+	for i < s.len {
+		if st == p.fwd.start {
+			// no match is in progress
+			i = p.skip(s, i)
+			if i < 0 {
+				break
+			}
+		}
+		st = p.fwd.next(st, s[i])
+		i++
+		if p.fwd.accept[st] {
+			end = i
+			break
+		}
+	}
+	if end < 0 {
+		return -1, -1
+	}
+	// the leftmost start of the matches, that end there
+	mut first := end - 1
+	st = p.rev.start
+	for j := end - 1; j >= start; j-- {
+		st = p.rev.next(st, s[j])
+		if p.rev.empty[st] {
+			break
+		}
+		if p.rev.accept[st] {
+			first = j
+		}
+	}
+	// the longest match from there: once a match is found, the state stays accepting, until
+	// the longest one ends
+	st = p.longest.start
+	for j in first .. end {
+		st = p.longest.next(st, s[j])
+	}
+	for i = end; i < s.len; i++ {
+		st = p.longest.next(st, s[i])
+		if !p.longest.accept[st] {
+			break
+		}
+	}
+	return first, i
+}
+
+// find_all returns the bounds of all the non overlapping matches, like RE.find_all
+fn (mut p DfaProg) find_all(s string) []int {
+	mut res := []int{}
+	mut i := 0
+	for i < s.len {
+		start, end := p.find(s, i)
+		if start < 0 {
+			break
+		}
+		res << start
+		res << end
+		i = end
+	}
+	return res
+}
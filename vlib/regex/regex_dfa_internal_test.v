@@ -0,0 +1,26 @@
+module regex
+
+// the queries of dfa_queries in regex_dfa_test.v, that are found with the automata
+const dfa_supported_queries = [r'\d+', r'[Tt]o\w+', r'f|t[eo]+', r'a{2,3}b', r'x?y+', r'p[iplut]+o',
+	r'#[.#]{4}##', r'[a-c]+\s*=\s*\d{1,3}']
+
+fn test_dfa_is_built_for_the_supported_queries() {
+	for q in dfa_supported_queries {
+		re := regex_opt(q) or { panic(err) }
+		assert re.dfa != unsafe { nil }, 'query: ${q}'
+		assert re.use_dfa(), 'query: ${q}'
+	}
+}
+
+fn test_dfa_is_not_built_for_the_other_queries() {
+	// groups, dots, negated classes, and a quantified token, that could give back a char
+	for q in [r'(\d+)-(\d+)', r'Aa.+Aaf', r'[^a]+b', r'\d+1'] {
+		re := regex_opt(q) or { panic(err) }
+		assert re.dfa == unsafe { nil }, 'query: ${q}'
+	}
+	// the anchors are checked by the backtracker
+	for q in [r'^\w+', r'\d+$'] {
+		re := regex_opt(q) or { panic(err) }
+		assert !re.use_dfa(), 'query: ${q}'
+	}
+}
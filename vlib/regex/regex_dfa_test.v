@@ -0,0 +1,70 @@
+import regex
+
+// find_all_base finds all the matches calling match_base at every index,
+// like find_all does, when the pattern can not use the automata
+fn find_all_base(mut re regex.RE, txt string) []int {
+	mut res := []int{}
+	mut i := 0
+	for i < txt.len {
+		s, e := unsafe { re.match_base(txt.str + i, txt.len + 1 - i) }
+		if s >= 0 && e > s {
+			res << i + s
+			res << i + e
+			i += e
+			continue
+		}
+		i++
+	}
+	return res
+}
+
+const dfa_queries = [r'\d+', r'[Tt]o\w+', r'f|t[eo]+', r'a{2,3}b', r'x?y+', r'p[iplut]+o',
+	r'#[.#]{4}##', r'[a-c]+\s*=\s*\d{1,3}']
+
+const dfa_texts = ['abcd 1234 efgh 1234 ghkl1234 ab34546df', 'Today it is a good day and tomorrow',
+	'foobar boo steelbar toolbox foot tooooot', 'ab aab aaab aaaab aaaaab b', 'xy xxyy yyy x y xyz',
+	'pippo pluto paperino pio', '#.#.### #.#.## ####.##', 'a = 1, bb=22 ccc  =  4444 d=5', '']
+
+fn test_dfa_matches_the_backtracker() {
+	for q in dfa_queries {
+		mut re := regex.regex_opt(q) or { panic(err) }
+		for txt in dfa_texts {
+			res := re.find_all(txt)
+			assert res == find_all_base(mut re, txt), 'query: ${q} text: ${txt}'
+			start, end := re.find(txt)
+			if res.len > 0 {
+				assert start == res[0] && end == res[1]
+			} else {
+				assert start == -1
+			}
+		}
+	}
+}
+
+fn test_dfa_find_from() {
+	mut re := regex.regex_opt(r'\d+') or { panic(err) }
+	txt := 'ab 12 cd 345'
+	mut start, mut end := re.find_from(txt, 4)
+	assert start == 4 && end == 5
+	start, end = re.find_from(txt, 5)
+	assert start == 9 && end == 12
+	start, end = re.find_from(txt, 12)
+	assert start == -1
+}
+
+fn test_dfa_linear_time() {
+	// quadratic with match_base at every index
+	txt := 'a'.repeat(200_000)
+	mut re := regex.regex_opt(r'[a-z]+\d') or { panic(err) }
+	assert re.find_all(txt) == []
+	start, _ := re.find(txt + '7')
+	assert start == 0
+}
+
+fn test_dfa_fallback() {
+	// dots and groups use the backtracker
+	mut re := regex.regex_opt(r'Aa.+Aaf') or { panic(err) }
+	assert re.find_all('xAabAafx') == [1, 7]
+	re = regex.regex_opt(r'(\d+)-(\d+)') or { panic(err) }
+	assert re.find_all_str('1-2 34-56') == ['1-2', '34-56']
+}
@@ -179,11 +179,22 @@ fn (mut re RE) find_imp(in_txt string) (int,int) {
 }
 */
 
+// use_dfa returns true, when the finders can use the automata based engine in regex_dfa.v,
+// that runs in linear time, instead of calling match_base at every index
+@[inline]
+fn (re &RE) use_dfa() bool {
+	return re.dfa != unsafe { nil } && re.debug == 0
+		&& (re.flag & (f_nl | f_ms | f_me | f_efm | f_src)) == 0
+}
+
 // find try to find the first match in the input string
 @[direct_array_access]
 pub fn (mut re RE) find(in_txt string) (int, int) {
 	// old_flag := re.flag
 	// re.flag |= f_src  // enable search mode
+	if re.use_dfa() {
+		return re.dfa.find(in_txt, 0)
+	}
 
 	mut i := 0
 	for i < in_txt.len {
@@ -229,6 +240,9 @@ pub fn (mut re RE) find_from(in_txt string, start int) (int, int) {
 	if i < 0 {
 		return -1, -1
 	}
+	if re.use_dfa() {
+		return re.dfa.find(in_txt, start)
+	}
 	for i < in_txt.len {
 		//--- speed references ---
 
@@ -271,6 +285,9 @@ pub fn (mut re RE) find_from(in_txt string, start int) (int, int) {
 pub fn (mut re RE) find_all(in_txt string) []int {
 	// old_flag := re.flag
 	// re.flag |= f_src // enable search mode
+	if re.use_dfa() {
+		return re.dfa.find_all(in_txt)
+	}
 
 	mut i := 0
 	mut res := []int{}
@@ -335,6 +352,14 @@ pub fn (mut re RE) split(in_txt string) []string {
 pub fn (mut re RE) find_all_str(in_txt string) []string {
 	// old_flag := re.flag
 	// re.flag |= f_src // enable search mode
+	if re.use_dfa() {
+		pos := re.dfa.find_all(in_txt)
+		mut res := []string{cap: pos.len / 2}
+		for j := 0; j < pos.len; j += 2 {
+			res << in_txt[pos[j]..pos[j + 1]]
+		}
+		return res
+	}
 
 	mut i := 0
 	mut res := []string{}
@@ -5,6 +5,10 @@
 //
 // The receive threads add all received numbers and send them to the
 // main thread where the total sum is compare to the expected value.
+//
+// With the optional `batch` argument > 1, the objects are sent with
+// `ch.push_many()` and received with `ch.pop_many()`, in batches of up
+// to `batch` objects.
 import time
 import os
 
@@ -23,22 +27,58 @@ fn do_send(ch chan int, start int, end int) {
 	}
 }
 
+fn do_rec_batch(ch chan int, resch chan i64, n int, batch int) {
+	mut sum := i64(0)
+	mut buf := []int{len: batch}
+	mut received := 0
+	for received < n {
+		if n - received < batch {
+			// do not take objects, that the other receivers should count
+			buf = []int{len: n - received}
+		}
+		got := ch.pop_many(mut buf)
+		for i in 0 .. got {
+			sum += buf[i]
+		}
+		received += got
+	}
+	println(sum)
+	resch <- sum
+}
+
+fn do_send_batch(ch chan int, start int, end int, batch int) {
+	mut buf := []int{cap: batch}
+	for i in start .. end {
+		buf << i
+		if buf.len == batch {
+			ch.push_many(buf)
+			buf.clear()
+		}
+	}
+	ch.push_many(buf)
+}
+
 fn main() {
-	if os.args.len != 5 {
-		eprintln('usage:\n\t${os.args[0]} <nsend> <nrec> <buflen> <nobj>')
+	if os.args.len !in [5, 6] {
+		eprintln('usage:\n\t${os.args[0]} <nsend> <nrec> <buflen> <nobj> [batch]')
 		exit(1)
 	}
 	nsend := os.args[1].int()
 	nrec := os.args[2].int()
 	buflen := os.args[3].int()
 	nobj := os.args[4].int()
+	batch := if os.args.len > 5 { os.args[5].int() } else { 1 }
 	stopwatch := time.new_stopwatch()
 	ch := chan int{cap: buflen}
 	resch := chan i64{}
 	mut no := nobj
 	for i in 0 .. nrec {
 		n := no / (nrec - i)
-		spawn do_rec(ch, resch, n)
+		if batch > 1 {
+			spawn do_rec_batch(ch, resch, n, batch)
+		} else {
+			spawn do_rec(ch, resch, n)
+		}
 		no -= n
 	}
 	$if debug {
@@ -49,7 +89,11 @@ fn main() {
 		n := no / (nsend - i)
 		end := no
 		no -= n
-		spawn do_send(ch, no, end)
+		if batch > 1 {
+			spawn do_send_batch(ch, no, end, batch)
+		} else {
+			spawn do_send(ch, no, end)
+		}
 	}
 	assert no == 0
 	mut sum := i64(0)
@@ -13,11 +13,16 @@ const compilers = [
 const run_iterations = 10
 
 const nobj = 10000000
+// nsend, nrec, buflen, batch
 const run_settings = [
-	[1, 1, 0],
-	[1, 1, 100],
-	[4, 4, 0],
-	[4, 4, 100],
+	[1, 1, 0, 1],
+	[1, 1, 100, 1],
+	[4, 4, 0, 1],
+	[4, 4, 100, 1],
+	[1, 1, 100, 16],
+	[1, 1, 1000, 256],
+	[4, 4, 100, 16],
+	[4, 4, 1000, 256],
 ]
 
 fn get_perf_from_result(result string) !f32 {
@@ -45,7 +50,7 @@ fn main() {
 
 		// 2. run
 		for s in run_settings {
-			run_cmd := './channel_bench_v ${s[0]:-3} ${s[1]:-3} ${s[2]:-3} ${nobj}'
+			run_cmd := './channel_bench_v ${s[0]:-3} ${s[1]:-3} ${s[2]:-4} ${nobj} ${s[3]}'
 			println('-----------------------------------------------------------')
 			mut iteration_result := []f32{}
 			for i in 0 .. run_iterations {
@@ -62,18 +67,18 @@ fn main() {
 
 	// 3. output result
 	mut sb := strings.new_builder(8192)
-	sb.write_string('\n| nsend | nrec | buflen |')
+	sb.write_string('\n| nsend | nrec | buflen | batch |')
 	for cc in compilers {
 		sb.write_string(' **V (${cc:-5})** |')
 	}
 	sb.writeln('')
-	sb.write_string('| :---: | :---:| :---:  |')
+	sb.write_string('| :---: | :---:| :---:  | :---: |')
 	for _ in 0 .. compilers.len {
 		sb.write_string('     :---:     |')
 	}
 	sb.writeln('')
 	for i, s in run_settings {
-		sb.write_string('|  ${s[0]:-3}  |  ${s[1]:-3} |   ${s[2]:-3}  |')
+		sb.write_string('|  ${s[0]:-3}  |  ${s[1]:-3} |  ${s[2]:-4}  |  ${s[3]:-3}  |')
 		for j in 0 .. compilers.len {
 			sb.write_string('     ${perf_result[j * run_settings.len + i]:-5.2}     |')
 		}
@@ -0,0 +1,60 @@
+fn send_many(ch chan int, start int, end int, batch int) {
+	mut buf := []int{cap: batch}
+	for i in start .. end {
+		buf << i
+		if buf.len == batch {
+			assert ch.push_many(buf) == batch
+			buf.clear()
+		}
+	}
+	assert ch.push_many(buf) == buf.len
+}
+
+fn receive_many(ch chan int, batch int) i64 {
+	mut sum := i64(0)
+	mut buf := []int{len: batch}
+	for {
+		n := ch.pop_many(mut buf)
+		if n == 0 {
+			break
+		}
+		for i in 0 .. n {
+			sum += buf[i]
+		}
+	}
+	return sum
+}
+
+fn test_channel_push_many_pop_many() {
+	for cap in [0, 1, 7, 100] {
+		ch := chan int{cap: cap}
+		nobj := 20_000
+		senders := [spawn send_many(ch, 0, nobj / 2, 13), spawn send_many(ch, nobj / 2, nobj, 64)]
+		r1 := spawn receive_many(ch, 32)
+		r2 := spawn receive_many(ch, 5)
+		senders.wait()
+		ch.close()
+		assert r1.wait() + r2.wait() == i64(nobj) * (nobj - 1) / 2
+	}
+}
+
+fn test_channel_try_pop_many() {
+	ch := chan int{cap: 10}
+	mut buf := []int{len: 4}
+	assert ch.try_pop_many(mut buf) == 0
+	assert ch.push_many([1, 2, 3, 4, 5, 6]) == 6
+	assert ch.try_pop_many(mut buf) == 4
+	assert buf == [1, 2, 3, 4]
+	assert ch.try_pop_many(mut buf) == 2
+	assert buf[..2] == [5, 6]
+	assert ch.try_pop_many(mut buf) == 0
+	// the single object operations see the objects pushed in batches, and vice versa:
+	ch <- 7
+	assert ch.push_many([8, 9]) == 2
+	assert <-ch == 7
+	assert ch.pop_many(mut buf) == 2
+	assert buf[..2] == [8, 9]
+	ch.close()
+	assert ch.push_many([10]) == 0
+	assert ch.pop_many(mut buf) == 0
+}
@@ -43,10 +43,14 @@ mut:
 	read_adr           C.atomic_uintptr_t // if != NULL an obj can be read from here without wait
 	adr_read           C.atomic_uintptr_t // used to identify origin of writesem
 	adr_written        C.atomic_uintptr_t // used to identify origin of readsem
-	write_free         u32                // for queue state
-	read_avail         u32
+	// the queue state; the part updated by the writers, and the part updated by the readers,
+	// are on separate cache lines, so that a writer and a reader do not slow each other down
+	write_free         u32
 	buf_elem_write_idx u32
+	pad_write          [56]u8
+	read_avail         u32
 	buf_elem_read_idx  u32
+	pad_read           [56]u8
 	// for select
 	write_subscriber &Subscription = unsafe { nil }
 	read_subscriber  &Subscription = unsafe { nil }
@@ -522,6 +526,246 @@ fn (mut ch Channel) try_pop_priv(dest voidptr, no_block bool) ChanState {
 	return .success
 }
 
+// push_many pushes all the objects in `objs`, that should be an array of the element type
+// of the channel, and waits for free space in the queue when needed.
+// For buffered channels, the objects are transferred in batches. Each batch reserves
+// its slots in the queue, and makes them available to the readers, with one update of
+// the queue state, instead of one per object.
+// It returns the number of pushed objects, which is less than `objs.len` only when
+// the channel was closed.
+pub fn (mut ch Channel) push_many(objs array) int {
+	n := u32(objs.len)
+	mut done := u32(0)
+	if ch.cap == 0 {
+		for done < n {
+			if ch.try_push_priv(unsafe { &u8(objs.data) + done * ch.objsize }, false) != .success {
+				break
+			}
+			done++
+		}
+		return int(done)
+	}
+	for done < n {
+		pushed := ch.push_batch(unsafe { &u8(objs.data) + done * ch.objsize }, n - done, false)
+		if pushed < 0 {
+			break
+		}
+		done += u32(pushed)
+	}
+	return int(done)
+}
+
+// pop_many waits until there is at least one object in the channel, then pops as many
+// objects as are available, up to `objs.len`, in a single batch, into `objs`.
+// It returns the number of popped objects, which is 0 only when the channel is closed,
+// and there are no objects left in it.
+pub fn (mut ch Channel) pop_many(mut objs array) int {
+	return ch.pop_many_priv(mut objs, false)
+}
+
+// try_pop_many is like pop_many, but it does not wait. It returns 0, when there are
+// no objects in the channel.
+pub fn (mut ch Channel) try_pop_many(mut objs array) int {
+	return ch.pop_many_priv(mut objs, true)
+}
+
+fn (mut ch Channel) pop_many_priv(mut objs array, no_block bool) int {
+	n := u32(objs.len)
+	if n == 0 {
+		return 0
+	}
+	if ch.cap == 0 {
+		// unbuffered channel: wait only for the first object
+		if ch.try_pop_priv(objs.data, no_block) != .success {
+			return 0
+		}
+		mut done := u32(1)
+		for done < n {
+			if ch.try_pop_priv(unsafe { &u8(objs.data) + done * ch.objsize }, true) != .success {
+				break
+			}
+			done++
+		}
+		return int(done)
+	}
+	popped := ch.pop_batch(objs.data, n, no_block)
+	return if popped < 0 { 0 } else { popped }
+}
+
+// claim_batch atomically decreases the counter at `adr` by up to `n`, and returns by how much
+fn claim_batch(adr &u32, n u32) u32 {
+	mut avail := C.atomic_load_u32(adr)
+	for avail > 0 {
+		k := if avail < n { avail } else { n }
+		if C.atomic_compare_exchange_weak_u32(adr, &avail, avail - k) {
+			return k
+		}
+	}
+	return 0
+}
+
+// advance_batch atomically moves the ring buffer index at `adr` forward by `n` slots,
+// and returns the first of them
+fn (ch &Channel) advance_batch(adr &u32, n u32) u32 {
+	mut idx := C.atomic_load_u32(adr)
+	for {
+		mut new_idx := idx + n
+		for new_idx >= ch.cap {
+			new_idx -= ch.cap
+		}
+		if C.atomic_compare_exchange_strong_u32(adr, &idx, new_idx) {
+			return idx
+		}
+	}
+	return 0
+}
+
+// push_batch pushes up to `n` objects from `src` to a buffered channel. It waits for the
+// first free slot, unless `no_block` is true. It returns the number of pushed objects,
+// or -1 when the channel is closed.
+fn (mut ch Channel) push_batch(src voidptr, n u32, no_block bool) int {
+	for {
+		if C.atomic_load_u16(&ch.closed) != 0 {
+			return -1
+		}
+		// get the tokens for the free slots; only the first one is waited for
+		mut tokens := u32(0)
+		for tokens < n && ch.writesem.try_wait() {
+			tokens++
+		}
+		if tokens == 0 {
+			if no_block {
+				return 0
+			}
+			ch.writesem.wait()
+			tokens = 1
+			for tokens < n && ch.writesem.try_wait() {
+				tokens++
+			}
+		}
+		if C.atomic_load_u16(&ch.closed) != 0 {
+			for _ in 0 .. tokens {
+				ch.writesem.post()
+			}
+			return -1
+		}
+		k := claim_batch(&ch.write_free, tokens)
+		for _ in k .. tokens {
+			ch.writesem.post()
+		}
+		if k == 0 {
+			if no_block {
+				return 0
+			}
+			continue
+		}
+		wr_idx := ch.advance_batch(&ch.buf_elem_write_idx, k)
+		for i in 0 .. k {
+			mut idx := wr_idx + i
+			if idx >= ch.cap {
+				idx -= ch.cap
+			}
+			mut wr_ptr := ch.ringbuf
+			mut status_adr := ch.statusbuf
+			unsafe {
+				wr_ptr += idx * ch.objsize
+				status_adr += idx * sizeof(u16)
+			}
+			mut expected_status := u16(BufferElemStat.unused)
+			for !C.atomic_compare_exchange_weak_u16(status_adr, &expected_status,
+				u16(BufferElemStat.writing)) {
+				expected_status = u16(BufferElemStat.unused)
+			}
+			unsafe {
+				C.memcpy(wr_ptr, &u8(src) + i * ch.objsize, ch.objsize)
+			}
+			C.atomic_store_u16(unsafe { &u16(status_adr) }, u16(BufferElemStat.written))
+		}
+		C.atomic_fetch_add_u32(voidptr(&ch.read_avail), k)
+		for _ in 0 .. k {
+			ch.readsem.post()
+		}
+		ch.read_sub_mtx.lock()
+		if ch.read_subscriber != unsafe { nil } {
+			ch.read_subscriber.sem.post()
+		}
+		ch.read_sub_mtx.unlock()
+		return int(k)
+	}
+	return -1
+}
+
+// pop_batch pops up to `n` objects from a buffered channel into `dest`. It waits for the
+// first object, unless `no_block` is true. It returns the number of popped objects,
+// or -1 when the channel is closed and empty.
+fn (mut ch Channel) pop_batch(dest voidptr, n u32, no_block bool) int {
+	for {
+		// get the tokens for the available objects; only the first one is waited for
+		mut tokens := u32(0)
+		for tokens < n && ch.readsem.try_wait() {
+			tokens++
+		}
+		if tokens == 0 {
+			if C.atomic_load_u16(&ch.closed) != 0 && C.atomic_load_u32(&ch.read_avail) == 0 {
+				return -1
+			}
+			if no_block {
+				return 0
+			}
+			ch.readsem.wait()
+			tokens = 1
+			for tokens < n && ch.readsem.try_wait() {
+				tokens++
+			}
+		}
+		k := claim_batch(&ch.read_avail, tokens)
+		// give back the tokens, that were not used, including the one posted by `close()`,
+		// so that the other readers can see it too:
+		for _ in k .. tokens {
+			ch.readsem.post()
+		}
+		if k == 0 {
+			if no_block || C.atomic_load_u16(&ch.closed) != 0 {
+				return if C.atomic_load_u16(&ch.closed) != 0 { -1 } else { 0 }
+			}
+			continue
+		}
+		rd_idx := ch.advance_batch(&ch.buf_elem_read_idx, k)
+		for i in 0 .. k {
+			mut idx := rd_idx + i
+			if idx >= ch.cap {
+				idx -= ch.cap
+			}
+			mut rd_ptr := ch.ringbuf
+			mut status_adr := ch.statusbuf
+			unsafe {
+				rd_ptr += idx * ch.objsize
+				status_adr += idx * sizeof(u16)
+			}
+			mut expected_status := u16(BufferElemStat.written)
+			for !C.atomic_compare_exchange_weak_u16(status_adr, &expected_status,
+				u16(BufferElemStat.reading)) {
+				expected_status = u16(BufferElemStat.written)
+			}
+			unsafe {
+				C.memcpy(&u8(dest) + i * ch.objsize, rd_ptr, ch.objsize)
+			}
+			C.atomic_store_u16(unsafe { &u16(status_adr) }, u16(BufferElemStat.unused))
+		}
+		C.atomic_fetch_add_u32(voidptr(&ch.write_free), k)
+		for _ in 0 .. k {
+			ch.writesem.post()
+		}
+		ch.write_sub_mtx.lock()
+		if ch.write_subscriber != unsafe { nil } {
+			ch.write_subscriber.sem.post()
+		}
+		ch.write_sub_mtx.unlock()
+		return int(k)
+	}
+	return -1
+}
+
 // Wait `timeout` on any of `channels[i]` until one of them can push (`is_push[i] = true`) or pop (`is_push[i] = false`)
 // object referenced by `objrefs[i]`. `timeout = time.infinite` means wait unlimited time. `timeout <= 0` means return
 // immediately if no transaction can be performed without waiting.
@@ -4,17 +4,45 @@ import sync
 import runtime
 
 @[trusted]
-fn C.atomic_fetch_add_u32(voidptr, u32) u32
+fn C.atomic_load_u64(voidptr) u64
+
+@[trusted]
+fn C.atomic_store_u64(voidptr, u64)
+
+@[trusted]
+fn C.atomic_compare_exchange_strong_u64(voidptr, voidptr, u64) bool
 
 pub const no_result = unsafe { nil }
 
+// range_stride is the distance in u64s between the ranges of 2 workers.
+// It keeps each range on its own cache line, so that the workers do not
+// slow each other down, when they update their own ranges.
+const range_stride = 8
+
+// chunk_divisor controls how much of its own range a worker takes at once.
+// Small ranges are processed one item at a time, so that slow items can not
+// hold back the items after them, while another worker is idle.
+const chunk_divisor = 8
+
+// PoolProcessor is a pool of worker threads.
+// Each call to work_on_items/work_on_pointers splits the indexes of the items
+// in even ranges, one per worker. The workers take small chunks from the front
+// of their own range, and when it is exhausted, they steal the upper half of
+// the range of another worker. By default, the threads are started by each call,
+// and end before it returns. When the pool is `persistent`, they are started on
+// the first call, and are reused by the next calls, until pool.close() is called.
 pub struct PoolProcessor {
-	thread_cb voidptr
+	persistent bool
 mut:
+	thread_cb       voidptr
 	njobs           int
 	items           []voidptr
-	results         shared []voidptr
-	ntask           u32 // reading/writing to this should be atomic
+	results         []voidptr // each slot is written only by the worker, that processed its item
+	ranges          []u64     // the packed [lo, hi) index range of each worker, modified atomically
+	active          int       // the number of workers, that take part in the current call
+	workers         []thread
+	wakeups         []&sync.Semaphore
+	stopped         bool
 	waitgroup       sync.WaitGroup
 	shared_context  voidptr
 	thread_contexts []voidptr
@@ -30,14 +58,17 @@ fn empty_cb(mut _p PoolProcessor, _idx int, _task_id int) voidptr {
 
 pub struct PoolProcessorConfig {
 pub:
-	maxjobs  int
-	callback ThreadCB = empty_cb
+	maxjobs    int
+	callback   ThreadCB = empty_cb
+	persistent bool // keep the worker threads between the calls, until pool.close() is called
 }
 
 // new_pool_processor returns a new PoolProcessor instance.
 // The parameters of new_pool_processor are:
 //    context.maxjobs: when 0 (the default), the PoolProcessor will use a
 //      number of threads, that is optimal for your system to process your items.
+//    context.persistent: when true, the worker threads are kept parked between
+//      the calls to work_on_items, and have to be stopped with pool.close().
 //    context.callback: this should be a callback function, that each worker
 //      thread in the pool will run for each item.
 //      The callback function will receive as parameters:
@@ -56,8 +87,8 @@ pub fn new_pool_processor(context PoolProcessorConfig) &PoolProcessor {
 		shared_context:  unsafe { nil }
 		thread_contexts: []
 		njobs:           context.maxjobs
-		ntask:           0
 		thread_cb:       voidptr(context.callback)
+		persistent:      context.persistent
 	}
 	pool.waitgroup.init()
 	return &pool
@@ -69,6 +100,16 @@ pub fn (mut pool PoolProcessor) set_max_jobs(njobs int) {
 	pool.njobs = njobs
 }
 
+// set_callback changes the callback, that the worker threads run for each item, for the
+// next calls to work_on_items/work_on_pointers. It allows the same threads to be reused
+// for different kinds of work.
+pub fn (mut pool PoolProcessor) set_callback(callback ThreadCB) {
+	if callback == unsafe { nil } {
+		panic('You need to pass a valid callback to PoolProcessor.set_callback.')
+	}
+	pool.thread_cb = voidptr(callback)
+}
+
 // work_on_items receives a list of items of type T,
 // then starts a work pool of pool.njobs threads, each running
 // pool.thread_cb in a loop, until all items in the list,
@@ -81,48 +122,175 @@ pub fn (mut pool PoolProcessor) work_on_items[T](items []T) {
 	pool.work_on_pointers(unsafe { items.pointers() })
 }
 
+// work_on_pointers is like work_on_items, but for a list of pointers to the items.
+// The pool can be reused for several calls. Each call resets the results and
+// the thread contexts of the previous one.
 pub fn (mut pool PoolProcessor) work_on_pointers(items []voidptr) {
 	mut njobs := runtime.nr_jobs()
 	if pool.njobs > 0 {
 		njobs = pool.njobs
 	}
-	unsafe {
-		pool.thread_contexts = []voidptr{len: items.len}
-		lock pool.results {
-			pool.results = []voidptr{len: items.len}
+	if njobs > items.len {
+		njobs = items.len
+	}
+	if njobs < 1 {
+		njobs = 1
+	}
+	pool.items = items.clone()
+	pool.results = []voidptr{len: items.len}
+	pool.thread_contexts = []voidptr{len: if items.len > njobs { items.len } else { njobs }}
+	if items.len == 0 {
+		return
+	}
+	if pool.ranges.len < njobs * range_stride {
+		pool.ranges = []u64{len: njobs * range_stride}
+	}
+	// split the indexes evenly; the remainder goes to the first workers:
+	n := items.len
+	mut lo := 0
+	for wid in 0 .. njobs {
+		hi := lo + n / njobs + if wid < n % njobs { 1 } else { 0 }
+		pool.ranges[wid * range_stride] = pack_range(u32(lo), u32(hi))
+		lo = hi
+	}
+	pool.active = njobs
+	if njobs == 1 {
+		// do not run concurrently, just use the same thread:
+		pool.run_worker(0)
+		return
+	}
+	if !pool.persistent {
+		mut threads := []thread{cap: njobs - 1}
+		for wid in 1 .. njobs {
+			threads << spawn worker_once(mut pool, wid)
 		}
-		pool.items = []voidptr{cap: items.len}
-		pool.items << items
-		pool.waitgroup.add(njobs)
-		for i := 0; i < njobs; i++ {
-			if njobs > 1 {
-				spawn process_in_thread(mut pool, i)
-			} else {
-				// do not run concurrently, just use the same thread:
-				process_in_thread(mut pool, i)
-			}
+		pool.run_worker(0)
+		threads.wait()
+		return
+	}
+	if pool.stopped {
+		panic('PoolProcessor.work_on_pointers called after PoolProcessor.close()')
+	}
+	for pool.wakeups.len < njobs {
+		// the calling thread is always worker 0, so it does not need a semaphore:
+		wid := pool.wakeups.len
+		mut wakeup := sync.new_semaphore()
+		pool.wakeups << wakeup
+		if wid > 0 {
+			pool.workers << spawn worker_loop(mut pool, wid, mut wakeup)
 		}
 	}
+	pool.waitgroup.add(njobs - 1)
+	for wid in 1 .. njobs {
+		pool.wakeups[wid].post()
+	}
+	pool.run_worker(0)
 	pool.waitgroup.wait()
 }
 
-// process_in_thread does the actual work of worker thread.
-// It is a workaround for the current inability to pass a
-// method in a callback.
-fn process_in_thread(mut pool PoolProcessor, task_id int) {
+// close stops the worker threads of a persistent pool, and waits for them to exit.
+// The pool can not be used for more work after that. For the other pools, it does nothing.
+pub fn (mut pool PoolProcessor) close() {
+	if pool.stopped {
+		return
+	}
+	pool.stopped = true
+	for wid in 1 .. pool.wakeups.len {
+		pool.wakeups[wid].post()
+	}
+	pool.workers.wait()
+	pool.workers.clear()
+}
+
+// worker_once is run by the worker threads (except worker 0, which is the calling
+// thread) of a pool, that is not persistent, for a single call of work_on_pointers
+fn worker_once(mut pool PoolProcessor, wid int) {
+	pool.run_worker(wid)
+}
+
+// worker_loop is run by each of the persistent worker threads (except worker 0,
+// which is the calling thread). It sleeps until work_on_pointers wakes it up.
+// The semaphore is passed directly, since pool.wakeups can grow concurrently.
+fn worker_loop(mut pool PoolProcessor, wid int, mut wakeup sync.Semaphore) {
+	for {
+		wakeup.wait()
+		if pool.stopped {
+			break
+		}
+		pool.run_worker(wid)
+		pool.waitgroup.done()
+	}
+}
+
+// run_worker processes chunks of the range of worker `wid`, and then steals
+// from the other workers, until there is nothing left to process.
+// It is a workaround for the current inability to pass a method in a callback.
+fn (mut pool PoolProcessor) run_worker(wid int) {
 	cb := ThreadCB(pool.thread_cb)
-	ilen := pool.items.len
 	for {
-		idx := int(C.atomic_fetch_add_u32(voidptr(&pool.ntask), 1))
-		if idx >= ilen {
+		lo, hi := pool.take_chunk(wid)
+		if lo >= hi {
+			if pool.steal_range(wid) {
+				continue
+			}
 			break
 		}
-		res := cb(mut pool, idx, task_id)
-		lock pool.results {
-			pool.results[idx] = res
+		for idx in lo .. hi {
+			pool.results[idx] = cb(mut pool, idx, wid)
+		}
+	}
+}
+
+// take_chunk removes a chunk from the front of the range of worker `wid`, and returns it.
+// Only the owner of a range moves its front; the other workers can only shrink it from the back.
+fn (mut pool PoolProcessor) take_chunk(wid int) (int, int) {
+	slot := unsafe { &pool.ranges[wid * range_stride] }
+	for {
+		mut r := C.atomic_load_u64(slot)
+		lo, hi := unpack_range(r)
+		if lo >= hi {
+			return 0, 0
+		}
+		rem := hi - lo
+		take := if rem >= 2 * u32(chunk_divisor) { rem / u32(chunk_divisor) } else { u32(1) }
+		if C.atomic_compare_exchange_strong_u64(slot, &r, pack_range(lo + take, hi)) {
+			return int(lo), int(lo + take)
 		}
 	}
-	pool.waitgroup.done()
+	return 0, 0
+}
+
+// steal_range moves the upper half of the range of another worker, to the
+// (exhausted) range of worker `wid`. It returns false, when all ranges are empty.
+fn (mut pool PoolProcessor) steal_range(wid int) bool {
+	for i in 1 .. pool.active {
+		victim := (wid + i) % pool.active
+		slot := unsafe { &pool.ranges[victim * range_stride] }
+		for {
+			mut r := C.atomic_load_u64(slot)
+			lo, hi := unpack_range(r)
+			if lo >= hi {
+				break
+			}
+			mid := hi - (hi - lo + 1) / 2
+			if C.atomic_compare_exchange_strong_u64(slot, &r, pack_range(lo, mid)) {
+				C.atomic_store_u64(unsafe { &pool.ranges[wid * range_stride] }, pack_range(mid,
+					hi))
+				return true
+			}
+		}
+	}
+	return false
+}
+
+@[inline]
+fn pack_range(lo u32, hi u32) u64 {
+	return (u64(hi) << 32) | u64(lo)
+}
+
+@[inline]
+fn unpack_range(r u64) (u32, u32) {
+	return u32(r & 0xFFFF_FFFF), u32(r >> 32)
 }
 
 // get_item - called by the worker callback.
@@ -134,18 +302,14 @@ pub fn (pool &PoolProcessor) get_item[T](idx int) T {
 // get_result - called by the main thread to get a specific result.
 // Retrieves a type safe instance of the produced result.
 pub fn (pool &PoolProcessor) get_result[T](idx int) T {
-	rlock pool.results {
-		return unsafe { *(&T(pool.results[idx])) }
-	}
+	return unsafe { *(&T(pool.results[idx])) }
 }
 
 // get_results - get a list of type safe results in the main thread.
 pub fn (pool &PoolProcessor) get_results[T]() []T {
 	mut res := []T{cap: pool.results.len}
 	for i in 0 .. pool.results.len {
-		rlock pool.results {
-			res << unsafe { *(&T(pool.results[i])) }
-		}
+		res << unsafe { *(&T(pool.results[i])) }
 	}
 	return res
 }
@@ -154,9 +318,7 @@ pub fn (pool &PoolProcessor) get_results[T]() []T {
 pub fn (pool &PoolProcessor) get_results_ref[T]() []&T {
 	mut res := []&T{cap: pool.results.len}
 	for i in 0 .. pool.results.len {
-		rlock pool.results {
-			res << unsafe { &T(pool.results[i]) }
-		}
+		res << unsafe { &T(pool.results[i]) }
 	}
 	return res
 }
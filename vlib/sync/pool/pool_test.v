@@ -60,3 +60,54 @@ fn test_work_on_ints() {
 		assert x.i > 100
 	}
 }
+
+fn worker_square(mut p pool.PoolProcessor, idx int, worker_id int) &IResult {
+	item := p.get_item[int](idx)
+	if item % 97 == 0 {
+		// a few slow items, so that the other workers have to steal the rest of the range
+		time.sleep(2 * time.millisecond)
+	}
+	return &IResult{item * item}
+}
+
+fn test_reuse_with_uneven_work() {
+	mut pool_r := pool.new_pool_processor(
+		callback:   worker_square
+		maxjobs:    4
+		persistent: true
+	)
+	for n in [1000, 0, 3, 777] {
+		items := []int{len: n, init: index}
+		pool_r.work_on_items(items)
+		results := pool_r.get_results[IResult]()
+		assert results.len == n
+		for i, x in results {
+			assert x.i == i * i
+		}
+	}
+	pool_r.set_max_jobs(8)
+	pool_r.work_on_items([]int{len: 100, init: index})
+	assert pool_r.get_result[IResult](99).i == 99 * 99
+	pool_r.close()
+}
+
+fn worker_double(mut p pool.PoolProcessor, idx int, worker_id int) &IResult {
+	return &IResult{2 * p.get_item[int](idx)}
+}
+
+fn test_reuse_with_another_callback() {
+	mut pool_c := pool.new_pool_processor(
+		callback:   worker_square
+		maxjobs:    4
+		persistent: true
+	)
+	items := []int{len: 50, init: index}
+	pool_c.work_on_items(items)
+	assert pool_c.get_result[IResult](7).i == 49
+	pool_c.set_callback(worker_double)
+	pool_c.work_on_items(items)
+	for i, x in pool_c.get_results[IResult]() {
+		assert x.i == 2 * i
+	}
+	pool_c.close()
+}
@@ -43,6 +43,7 @@ pub mut:
 	used_attr_noreturn bool // @[noreturn]
 	used_attr_hidden   bool // @[hidden]
 	used_attr_weak     bool // @[weak]
+	used_thread_local  bool // @[thread_local] globals
 }
 
 @[unsafe]
@@ -2,6 +2,9 @@ module cbuilder
 
 import os
 import time
+import hash
+import math.bits
+import strings
 import v.util
 import v.builder
 import sync.pool
@@ -27,30 +30,19 @@ fn parallel_cc(mut b builder.Builder, result c.GenOutput) ! {
 	// out.h
 	os.write_file('${tmp_dir}/out.h', result.header) or { panic(err) }
 
+	mut o_postfixes := ['0', 'x']
+	mut sources := []string{}
+
 	// out_0.c
 	out0 := '//out0\n' + result.out_str[..result.out_fn_start_pos[0]]
-	os.write_file('${tmp_dir}/out_0.c', '#include "out.h"\n' + out0 + '\n//X:\n' + result.out0_str) or {
-		panic(err)
-	}
+	sources << '#include "out.h"\n' + out0 + '\n//X:\n' + result.out0_str
 
 	// out_x.c
-	os.write_file('${tmp_dir}/out_x.c', '#include "out.h"\n\n' + result.extern_str + '\n' +
-		result.out_str[result.out_fn_start_pos.last()..]) or { panic(err) }
+	sources << '#include "out.h"\n\n' + result.extern_str + '\n' +
+		result.out_str[result.out_fn_start_pos.last()..]
 
 	mut prev_fn_pos := 0
-	mut out_files := []os.File{len: c_files}
-	mut fnames := []string{}
-
-	for i in 0 .. c_files {
-		fname := '${tmp_dir}/out_${i + 1}.c'
-		fnames << fname
-		out_files[i] = os.create(fname) or { panic(err) }
-
-		// Common .c file code
-		out_files[i].writeln('#include "out.h"\n') or { panic(err) }
-		out_files[i].writeln(result.extern_str) or { panic(err) }
-	}
-
+	mut fn_texts := []string{cap: result.out_fn_start_pos.len}
 	for i, fn_pos in result.out_fn_start_pos {
 		if prev_fn_pos >= result.out_str.len || fn_pos >= result.out_str.len || prev_fn_pos > fn_pos {
 			eprintln('> EXITING i=${i} out of ${result.out_fn_start_pos.len} prev_pos=${prev_fn_pos} fn_pos=${fn_pos}')
@@ -61,12 +53,28 @@ fn parallel_cc(mut b builder.Builder, result c.GenOutput) ! {
 			prev_fn_pos = fn_pos
 			continue
 		}
-		fn_text := result.out_str[prev_fn_pos..fn_pos]
-		out_files[i % c_files].writeln(fn_text) or { panic(err) }
+		fn_texts << result.out_str[prev_fn_pos..fn_pos]
 		prev_fn_pos = fn_pos
 	}
+	shards := partition_fns(fn_texts, c_files)
+	mut shard_bytes := []int{len: c_files}
+	mut shard_fns := []int{len: c_files}
+	mut out_files := []strings.Builder{len: c_files}
 	for i in 0 .. c_files {
-		out_files[i].close()
+		o_postfixes << (i + 1).str()
+		// Common .c file code
+		out_files[i] = strings.new_builder(result.extern_str.len + 1024)
+		out_files[i].writeln('#include "out.h"\n')
+		out_files[i].writeln(result.extern_str)
+	}
+	for i, fn_text in fn_texts {
+		shard := shards[i]
+		out_files[shard].writeln(fn_text)
+		shard_bytes[shard] += fn_text.len
+		shard_fns[shard]++
+	}
+	for i in 0 .. c_files {
+		sources << out_files[i].str()
 	}
 
 	mut cc_path := cc_compiler
@@ -86,42 +94,65 @@ fn parallel_cc(mut b builder.Builder, result c.GenOutput) ! {
 	slinker_args := linker_args.join(' ')
 	scompile_args_for_linker := compile_args.filter(it != '-x objective-c').join(' ')
 
-	mut o_postfixes := ['0', 'x']
-	mut cmds := []string{}
-	for i in 0 .. c_files {
-		o_postfixes << (i + 1).str()
-	}
-	for postfix in o_postfixes {
-		cmds << '${cc} ${cc_cflags} ${cc_cflags_opt} ${scompile_args} -w -o ${tmp_dir}/out_${postfix}.o -c ${tmp_dir}/out_${postfix}.c'
+	// The objects are cached by the hash of their .c file, of out.h, and of the C compiler
+	// options, so after a small edit, only the shards that changed are compiled again.
+	cc_options := '${cc} ${cc_cflags} ${cc_cflags_opt} ${scompile_args} -w'
+	header_hash := hash.sum64_string(result.header, 7).hex_full()
+	mut ofiles := []string{}
+	mut cached_ofiles := []string{}
+	mut cmds := []CcJob{}
+	for i, postfix in o_postfixes {
+		ofile := '${tmp_dir}/out_${postfix}.o'
+		cache_key := 'parallel_cc|${cc_options}|${header_hash}|' +
+			hash.sum64_string(sources[i], 7).hex_full()
+		cached_ofile := b.pref.cache_manager.postfix_with_key2cpath('.o', cache_key)
+		cached_ofiles << cached_ofile
+		if os.exists(cached_ofile) {
+			ofiles << cached_ofile
+			continue
+		}
+		ofiles << ofile
+		cfile := '${tmp_dir}/out_${postfix}.c'
+		os.write_file(cfile, sources[i]) or { panic(err) }
+		cmds << CcJob{
+			idx:          i
+			cmd:          '${cc_options} -o ${os.quoted_path(ofile)} -c ${os.quoted_path(cfile)}'
+			ofile:        ofile
+			cached_ofile: cached_ofile
+		}
 	}
 	mut failed := 0
 	sw := time.new_stopwatch()
-	mut pp := pool.new_pool_processor(callback: build_parallel_o_cb)
-	pp.set_max_jobs(util.nr_jobs)
-	pp.work_on_items(cmds)
-	for x in pp.get_results[os.Result]() {
-		failed += if x.exit_code == 0 { 0 } else { 1 }
+	if cmds.len > 0 {
+		mut pp := util.build_pool(build_parallel_o_cb)
+		pp.set_max_jobs(util.nr_jobs)
+		pp.work_on_items(cmds)
+		for j, x in pp.get_results[CcResult]() {
+			failed += if x.res.exit_code == 0 { 0 } else { 1 }
+			i := cmds[j].idx
+			if i < 2 {
+				eprintln('> ${x.elapsed.milliseconds():5} ms, cc out_${o_postfixes[i]}.c')
+			} else {
+				eprintln('> ${x.elapsed.milliseconds():5} ms, cc out_${o_postfixes[i]}.c, ${shard_fns[i - 2]:6} fns, ${shard_bytes[i - 2] / 1024:6} KB')
+			}
+		}
 	}
-	eprint_time(sw, 'C compilation on ${util.nr_jobs} thread(s), processing ${cmds.len} commands, failed: ${failed}')
+	eprint_time(sw, 'C compilation on ${util.nr_jobs} thread(s), processing ${cmds.len} commands, reused ${o_postfixes.len - cmds.len} cached objects, failed: ${failed}')
 	if failed > 0 {
 		return error_with_code('failed parallel C compilation', failed)
 	}
+	evict_cached_objects(mut b, cached_ofiles)
 
-	mut ofiles := []string{}
-	for f in fnames {
-		fo := f.replace('.c', '.o')
-		ofiles << os.quoted_path(fo)
-	}
-	obj_files := ofiles.join(' ')
-
+	// link in the same order as before the caching: out_0.o, the shards, then out_x.o
+	mut link_ofiles := [ofiles[0]]
+	link_ofiles << ofiles[2..]
+	link_ofiles << ofiles[1]
 	alink := [
 		cc,
 		scompile_args_for_linker,
 		'-o',
 		os.quoted_path(b.pref.out_name),
-		os.quoted_path('${tmp_dir}/out_0.o'),
-		obj_files,
-		os.quoted_path('${tmp_dir}/out_x.o'),
+		link_ofiles.map(os.quoted_path(it)).join(' '),
 		slinker_args,
 		cc_ldflags,
 	]
@@ -135,14 +166,137 @@ fn parallel_cc(mut b builder.Builder, result c.GenOutput) ! {
 	}
 }
 
-fn build_parallel_o_cb(mut p pool.PoolProcessor, idx int, _wid int) &os.Result {
-	cmd := p.get_item[string](idx)
+// evict_cached_objects removes the cached objects, that the previous build of the same output
+// used, but the current one does not, so the cache holds only the current set of shards for each
+// output, instead of an object for every version of every shard. The set is stored in the cache too.
+// If another output uses one of the removed objects, it is just compiled again.
+fn evict_cached_objects(mut b builder.Builder, cached_ofiles []string) {
+	key := 'parallel_cc|objects|' + os.real_path(b.pref.out_name)
+	current := cached_ofiles.join('\n')
+	previous := b.pref.cache_manager.load('.objects', key) or { '' }
+	if previous == current {
+		return
+	}
+	for ofile in previous.split_into_lines() {
+		if ofile !in cached_ofiles && ofile.starts_with(b.pref.cache_manager.basepath) {
+			os.rm(ofile) or {}
+		}
+	}
+	b.pref.cache_manager.save('.objects', key, current) or {}
+}
+
+struct CcJob {
+	idx          int    // the index of the .c file in o_postfixes
+	cmd          string // the cc command, that compiles it to `ofile`
+	ofile        string
+	cached_ofile string // where the object is stored, after a successful compilation
+}
+
+struct CcResult {
+	res     os.Result
+	elapsed time.Duration
+}
+
+fn build_parallel_o_cb(mut p pool.PoolProcessor, idx int, _wid int) &CcResult {
+	job := p.get_item[CcJob](idx)
 	sw := time.new_stopwatch()
-	res := os.execute(cmd)
-	eprint_result_time(sw, 'cc_cmd', cmd, res)
-	return &os.Result{
-		...res
+	res := os.execute(job.cmd)
+	elapsed := sw.elapsed()
+	eprint_result_time(sw, 'cc_cmd', job.cmd, res)
+	if res.exit_code == 0 {
+		// copy, instead of compiling directly to the cache, so that a failed compilation
+		// can not leave a broken object there
+		os.cp(job.ofile, job.cached_ofile) or {}
+	}
+	return &CcResult{
+		res:     res
+		elapsed: elapsed
+	}
+}
+
+// partition_fns returns the index of the out_N.c shard for each function, so that all shards
+// take about the same time to compile, and an edit changes as few shards as possible:
+// - the big functions (a json decoder, a big match) are placed first, from the longest to the
+//   shortest, each in the shard with the smallest total length so far, so that a single huge
+//   function gets a shard of its own, instead of keeping one cc process busy with many others;
+// - all the other functions are placed by the hash of their name, in the shards, that the big
+//   functions did not fill already. An edit (or a new function) changes only the shard of that
+//   function, and the out_N.o files of all the other shards can be reused from the cache.
+// Whether a function is big is decided on its length rounded to a power of 2, compared to the
+// average shard length, also rounded, so that small edits do not change it.
+fn partition_fns(fn_texts []string, nr_shards int) []int {
+	mut shards := []int{len: fn_texts.len}
+	if nr_shards <= 1 {
+		return shards
+	}
+	mut total := i64(0)
+	for fn_text in fn_texts {
+		total += fn_text.len
+	}
+	target := total / nr_shards
+	big_bucket := bits.len_64(u64(target)) - 1
+	mut big := []FnCost{}
+	for i, fn_text in fn_texts {
+		if big_bucket > 0 && bits.len_32(u32(fn_text.len)) >= big_bucket {
+			big << FnCost{
+				idx: i
+				len: fn_text.len
+				key: hash.sum64_string(fn_name(fn_text), 0)
+			}
+		}
+	}
+	big.sort_with_compare(compare_fn_costs)
+	mut loads := []i64{len: nr_shards}
+	mut is_big := []bool{len: fn_texts.len}
+	for cost in big {
+		mut best := 0
+		for shard in 1 .. nr_shards {
+			if loads[shard] < loads[best] {
+				best = shard
+			}
+		}
+		shards[cost.idx] = best
+		loads[best] += cost.len
+		is_big[cost.idx] = true
+	}
+	mut open_shards := []int{cap: nr_shards}
+	for shard in 0 .. nr_shards {
+		if loads[shard] < target {
+			open_shards << shard
+		}
+	}
+	if open_shards.len == 0 {
+		open_shards = []int{len: nr_shards, init: index}
+	}
+	for i, fn_text in fn_texts {
+		if !is_big[i] {
+			key := hash.sum64_string(fn_name(fn_text), 0)
+			shards[i] = open_shards[int(key % u64(open_shards.len))]
+		}
+	}
+	return shards
+}
+
+// fn_name returns the text before the `(`, that contains the return type and the C name of the function
+fn fn_name(fn_text string) string {
+	name_end := fn_text.index_u8(`(`)
+	return if name_end > 0 { fn_text[..name_end] } else { fn_text }
+}
+
+struct FnCost {
+	idx int
+	len int
+	key u64 // the hash of the function name
+}
+
+fn compare_fn_costs(a &FnCost, b &FnCost) int {
+	if a.len != b.len {
+		return if a.len > b.len { -1 } else { 1 }
+	}
+	if a.key != b.key {
+		return if a.key < b.key { -1 } else { 1 }
 	}
+	return if a.idx < b.idx { -1 } else { 1 }
 }
 
 fn eprint_result_time(sw time.StopWatch, label string, cmd string, res os.Result) {
@@ -0,0 +1,72 @@
+module cbuilder
+
+fn shard_texts(fn_texts []string, nr_shards int) []string {
+	mut texts := []string{len: nr_shards}
+	for i, shard in partition_fns(fn_texts, nr_shards) {
+		texts[shard] += fn_texts[i]
+	}
+	return texts
+}
+
+fn test_partition_fns_uses_all_the_shards() {
+	mut fn_texts := []string{}
+	for i in 0 .. 100 {
+		fn_texts << 'void f${i}() {\n' + 'x;'.repeat(50) + '\n}'
+	}
+	shards := partition_fns(fn_texts, 4)
+	assert shards.len == fn_texts.len
+	for shard in 0 .. 4 {
+		assert shard in shards
+	}
+	// the assignments do not depend on anything else than the functions
+	assert partition_fns(fn_texts, 4) == shards
+}
+
+fn test_partition_fns_an_edit_changes_only_its_own_shard() {
+	mut fn_texts := ['void big() {\n' + 'x;'.repeat(5000) + '\n}']
+	for i in 0 .. 100 {
+		fn_texts << 'void f${i}() {\n' + 'x;'.repeat(50) + '\n}'
+	}
+	before := shard_texts(fn_texts, 4)
+	edited := 37
+	edited_shard := partition_fns(fn_texts, 4)[edited]
+	// a longer body, that would change the place of many functions, if the exact sizes mattered
+	fn_texts[edited] = 'void f${edited}() {\n' + 'y;'.repeat(200) + '\n}'
+	assert partition_fns(fn_texts, 4)[edited] == edited_shard
+	after := shard_texts(fn_texts, 4)
+	for shard in 0 .. 4 {
+		if shard == edited_shard {
+			assert after[shard] != before[shard]
+		} else {
+			assert after[shard] == before[shard]
+		}
+	}
+	// a new function changes only the shard, where it is placed
+	fn_texts << 'void new_fn() {\n}'
+	new_shard := partition_fns(fn_texts, 4).last()
+	with_new := shard_texts(fn_texts, 4)
+	for shard in 0 .. 4 {
+		if shard != new_shard {
+			assert with_new[shard] == after[shard]
+		}
+	}
+}
+
+fn test_partition_fns_gives_a_huge_function_its_own_shard() {
+	mut fn_texts := []string{}
+	for i in 0 .. 100 {
+		fn_texts << 'void f${i}() {\n' + 'x;'.repeat(50) + '\n}'
+	}
+	fn_texts << 'void huge() {\n' + 'x;'.repeat(20_000) + '\n}'
+	shards := partition_fns(fn_texts, 4)
+	huge_shard := shards.last()
+	for shard in shards[..100] {
+		assert shard != huge_shard
+	}
+	// the other functions are still spread over all the other shards
+	for shard in 0 .. 4 {
+		if shard != huge_shard {
+			assert shard in shards
+		}
+	}
+}
@@ -5,6 +5,7 @@ import hash
 import time
 import rand
 import strings
+import v.ast
 import v.util
 import v.pref
 import v.vcache
@@ -30,32 +31,54 @@ pub fn (mut b Builder) rebuild_modules() {
 	}
 }
 
+// find_invalidated_modules_by_files returns the folders of the cached modules, that have
+// to be rebuilt. A module is rebuilt when the content of one of its files changed. The
+// modules that import it are rebuilt too, but only when its interface hash changed, i.e.
+// edits inside the bodies of non generic functions do not invalidate the dependents.
 pub fn (mut b Builder) find_invalidated_modules_by_files(all_files []string) []string {
 	util.timing_start('${@METHOD} source_hashing')
 	mut new_hashes := map[string]string{}
 	mut old_hashes := map[string]string{}
+	mut new_interfaces := map[string]string{}
+	mut old_interfaces := map[string]string{}
 	mut sb_new_hashes := strings.new_builder(1024)
 
+	mut files_by_path := map[string]&ast.File{}
+	for file in b.parsed_files {
+		files_by_path[file.path] = file
+	}
 	mut cm := vcache.new_cache_manager(all_files)
-	sold_hashes := cm.load('.hashes', 'all_files') or { ' ' }
+	sold_hashes := cm.load('.hashes', 'all_files_and_interfaces') or { ' ' }
 	// eprintln(sold_hashes)
 	sold_hashes_lines := sold_hashes.split('\n')
 	for line in sold_hashes_lines {
 		if line.len == 0 {
 			continue
 		}
-		x := line.split(' ')
-		chash := x[0]
-		cpath := x[1]
-		old_hashes[cpath] = chash
+		// each line is: `content_hash interface_hash path`
+		x := line.split_nth(' ', 3)
+		if x.len != 3 {
+			continue
+		}
+		cpath := x[2]
+		old_hashes[cpath] = x[0]
+		old_interfaces[cpath] = x[1]
 	}
 	// eprintln('old_hashes: $old_hashes')
 	for cpath in all_files {
 		ccontent := util.read_file(cpath) or { '' }
 		chash := hash.sum64_string(ccontent, 7).hex_full()
+		ihash := if file := files_by_path[cpath] {
+			interface_hash(file, ccontent)
+		} else {
+			chash
+		}
 		new_hashes[cpath] = chash
+		new_interfaces[cpath] = ihash
 		sb_new_hashes.write_string(chash)
 		sb_new_hashes.write_u8(` `)
+		sb_new_hashes.write_string(ihash)
+		sb_new_hashes.write_u8(` `)
 		sb_new_hashes.write_string(cpath)
 		sb_new_hashes.write_u8(`\n`)
 	}
@@ -63,7 +86,7 @@ pub fn (mut b Builder) find_invalidated_modules_by_files(all_files []string) []s
 	// eprintln('new_hashes: $new_hashes')
 	// eprintln('> new_hashes != old_hashes: ' + ( old_hashes != new_hashes ).str())
 	// eprintln(snew_hashes)
-	cm.save('.hashes', 'all_files', snew_hashes) or {}
+	cm.save('.hashes', 'all_files_and_interfaces', snew_hashes) or {}
 	util.timing_measure('${@METHOD} source_hashing')
 
 	mut invalidations := []string{}
@@ -84,26 +107,22 @@ pub fn (mut b Builder) find_invalidated_modules_by_files(all_files []string) []s
 				}
 			}
 		}
+		// the paths, whose interface changed, invalidate the modules that import them;
+		// the paths, where only the function bodies changed, invalidate just their own module
 		mut invalidated_paths := map[string]int{}
 		mut invalidated_mod_paths := map[string]int{}
 		for npath, nhash in new_hashes {
-			if npath !in old_hashes {
+			if npath !in old_hashes || old_interfaces[npath] != new_interfaces[npath] {
 				invalidated_paths[npath]++
 				continue
 			}
-			if old_hashes[npath] != nhash {
-				invalidated_paths[npath]++
-				continue
+			if old_hashes[npath] != nhash && b.path_invalidates_mods[npath] != ['main'] {
+				invalidated_mod_paths[os.dir(npath)]++
 			}
 		}
-		for opath, ohash in old_hashes {
+		for opath, _ in old_hashes {
 			if opath !in new_hashes {
 				invalidated_paths[opath]++
-				continue
-			}
-			if new_hashes[opath] != ohash {
-				invalidated_paths[opath]++
-				continue
 			}
 		}
 		$if trace_invalidations ? {
@@ -280,16 +299,6 @@ pub fn (mut b Builder) should_rebuild() bool {
 	v_program_files.sort() // ensure stable keys for the dependencies cache
 	b.crun_cache_keys = v_program_files
 	b.crun_cache_keys << exe_name
-	// just check the timestamps for now:
-	exe_stamp := os.file_last_mod_unix(exe_name)
-	source_stamp := most_recent_timestamp(v_program_files)
-	if exe_stamp <= source_stamp {
-		return true
-	}
-	////////////////////////////////////////////////////////////////////////////
-	// The timestamps for the top level files were found ok,
-	// however we want to *also* make sure that a full rebuild will be done
-	// if any of the dependencies (if we know them) are changed.
 	mut cm := vcache.new_cache_manager(b.crun_cache_keys)
 	// always rebuild, when the compilation options changed between 2 sequential cruns:
 	sbuild_options := cm.load('.build_options', '.crun') or { return true }
@@ -301,13 +310,55 @@ pub fn (mut b Builder) should_rebuild() bool {
 		// rebuild, which will fill in the dependencies cache for the next crun
 		return true
 	}
-	dependencies := sdependencies.split('\n')
 	// we have already compiled these source files, and have their dependencies
-	dependencies_stamp := most_recent_timestamp(dependencies)
-	if dependencies_stamp < exe_stamp {
+	dependencies := sdependencies.split('\n')
+	// the timestamps are cheap to check, and are enough, when nothing was touched since:
+	exe_stamp := os.file_last_mod_unix(exe_name)
+	if most_recent_timestamp(v_program_files) < exe_stamp
+		&& most_recent_timestamp(dependencies) < exe_stamp {
 		return false
 	}
-	return true
+	// A fresh checkout, or a `touch`, makes the files newer than the executable, without
+	// changing them. Rebuild only when their content differs from the last compilation:
+	sold_hashes := cm.load('.source_hashes', '.crun') or { return true }
+	return sold_hashes != content_hashes(dependencies)
+}
+
+// content_hashes returns the hashes of the content of `files`, one per line
+fn content_hashes(files []string) string {
+	mut sb := strings.new_builder(files.len * 17)
+	for f in files {
+		content := util.read_file(f) or { '' }
+		sb.write_string(hash.sum64_string(content, 7).hex_full())
+		sb.write_u8(`\n`)
+	}
+	return sb.str()
+}
+
+// interface_hash returns a hash of the parts of `file`, that the modules importing it can
+// depend on. The bodies of the functions are left out, except for the generic and the
+// inline ones, since those are compiled in the importing modules too.
+fn interface_hash(file &ast.File, content string) string {
+	mut sb := strings.new_builder(content.len)
+	mut start := 0
+	for stmt in file.stmts {
+		if stmt is ast.FnDecl {
+			if stmt.no_body || stmt.generic_names.len > 0 || stmt.receiver.typ.has_flag(.generic)
+				|| stmt.attrs.any(it.name == 'inline') {
+				continue
+			}
+			body_start := stmt.body_pos.pos
+			body_end := stmt.end_pos.pos
+			if body_start < start || body_start >= body_end || body_end > content.len
+				|| content[body_start] != `{` {
+				continue
+			}
+			unsafe { sb.write_ptr(content.str + start, body_start - start) }
+			start = body_end
+		}
+	}
+	unsafe { sb.write_ptr(content.str + start, content.len - start) }
+	return hash.sum64_string(sb.str(), 7).hex_full()
 }
 
 fn most_recent_timestamp(files []string) i64 {
@@ -330,6 +381,7 @@ pub fn (mut b Builder) rebuild(backend_cb FnBackend) {
 		dependency_files := b.parsed_files.map(it.path)
 		cm.save('.dependencies', '.crun', dependency_files.join('\n')) or {}
 		cm.save('.build_options', '.crun', b.pref.build_options.join('\n')) or {}
+		cm.save('.source_hashes', '.crun', content_hashes(dependency_files)) or {}
 	}
 	mut timers := util.get_timers()
 	timers.show_remaining()
@@ -0,0 +1,25 @@
+module builder
+
+import v.ast
+import v.parser
+import v.pref
+
+fn interface_hash_of(source string) string {
+	mut table := ast.new_table()
+	file := parser.parse_text(source, 'm.v', mut table, .skip_comments, pref.new_preferences())
+	return interface_hash(file, source)
+}
+
+fn test_interface_hash_ignores_function_bodies() {
+	base := interface_hash_of('module m\n\npub fn f() int {\n\treturn 1\n}\n')
+	assert interface_hash_of('module m\n\npub fn f() int {\n\treturn 2\n}\n') == base
+	assert interface_hash_of('module m\n\npub fn f() i64 {\n\treturn 1\n}\n') != base
+	assert interface_hash_of('module m\n\npub fn f() int {\n\treturn 1\n}\n\npub const c = 1\n') != base
+}
+
+fn test_interface_hash_keeps_generic_and_inline_bodies() {
+	generic := interface_hash_of('module m\n\npub fn f[T](x T) T {\n\treturn x\n}\n')
+	assert interface_hash_of('module m\n\npub fn f[T](x T) T {\n\treturn x + x\n}\n') != generic
+	inline := interface_hash_of('module m\n\n@[inline]\npub fn f() int {\n\treturn 1\n}\n')
+	assert interface_hash_of('module m\n\n@[inline]\npub fn f() int {\n\treturn 2\n}\n') != inline
+}
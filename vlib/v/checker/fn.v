@@ -2549,6 +2549,11 @@ fn (mut c Checker) method_call(mut node ast.CallExpr, mut continue_check &bool)
 			exp_arg_typ = left_sym.info.elem_type
 			param_is_mut = true
 			no_type_promotion = true
+		} else if method_name in ['push_many', 'pop_many', 'try_pop_many'] {
+			// the objects are copied in and out of the array with the size of the element type of the channel
+			exp_arg_typ = ast.new_type(c.table.find_or_register_array(left_sym.info.elem_type))
+			param_is_mut = method_name != 'push_many'
+			no_type_promotion = true
 		}
 	}
 
@@ -0,0 +1,144 @@
+module eval
+
+import v.ast
+
+// Functions, that only work with numbers and bools, are compiled to a register based bytecode
+// (see compiler.v), and run by the VM in vm.v, instead of walking their AST. Their locals
+// and temporaries live in numbered slots of two register files, one for integers (and bools)
+// and one for floats, so the values are not boxed in `Object`s, and there are no map lookups.
+// Everything else is still run by the AST walker; the two can call each other.
+
+// SlotKind is the kind of value, that a register holds. Unsigned integers and bools use the
+// integer registers too, but need different instructions for some operations.
+enum SlotKind {
+	none_ // not supported by the bytecode
+	int_
+	uint_
+	float_
+	bool_
+}
+
+enum BcOp as u8 {
+	// a = imm
+	iconst
+	fconst // imm holds the bits of the f64
+	// a = b
+	imov
+	fmov
+	// a = b op c
+	iadd
+	isub
+	imul
+	idiv
+	imod
+	udiv
+	umod
+	iand
+	ior
+	ixor
+	ishl
+	ishr
+	ushr
+	fadd
+	fsub
+	fmul
+	fdiv
+	// a = b + imm
+	iaddi
+	// a = op b
+	ineg
+	inot // bitwise
+	lnot // logical
+	fneg
+	i2f
+	u2f
+	f2i
+	f2u
+	// a = b op c, the result is a bool in an integer register
+	ilt
+	ile
+	ieq
+	ine
+	ult
+	ule
+	flt
+	fle
+	feq
+	fne
+	// control flow; the target is in imm
+	jmp
+	jz  // if a == 0
+	jnz // if a != 0
+	jlt // if a < b
+	jle
+	jeq
+	jne
+	jult
+	jule
+	// calls; imm is the index of the call site in BcFunc.calls
+	call  // a compiled function
+	hcall // a function, that is run by the AST walker
+	ret
+	iret // return a
+	fret
+}
+
+struct BcInstr {
+	op  BcOp
+	a   int
+	b   int
+	c   int
+	imm i64
+}
+
+struct BcParam {
+	reg  int
+	kind SlotKind
+	typ  ast.Type
+}
+
+struct BcCallSite {
+	fn_idx int        // for .call
+	decl   ast.FnDecl // for .hcall
+	args   []BcParam  // the registers, that hold the arguments
+	ret    SlotKind
+	ret_t  ast.Type
+	// dst is the register for the result, or -1, when it is not used
+	dst int = -1
+}
+
+// BcFunc is a compiled function
+struct BcFunc {
+	name     string
+	params   []BcParam
+	ret      SlotKind
+	ret_t    ast.Type
+	code     []BcInstr
+	calls    []BcCallSite
+	nr_iregs int
+	nr_fregs int
+}
+
+fn slot_kind(typ ast.Type) SlotKind {
+	if typ.is_ptr() || typ.has_option_or_result() {
+		return .none_
+	}
+	return match typ.idx() {
+		ast.i8_type_idx, ast.i16_type_idx, ast.i32_type_idx, ast.int_type_idx, ast.i64_type_idx,
+		ast.int_literal_type_idx {
+			.int_
+		}
+		ast.u8_type_idx, ast.u16_type_idx, ast.u32_type_idx, ast.u64_type_idx {
+			.uint_
+		}
+		ast.f32_type_idx, ast.f64_type_idx, ast.float_literal_type_idx {
+			.float_
+		}
+		ast.bool_type_idx {
+			.bool_
+		}
+		else {
+			.none_
+		}
+	}
+}
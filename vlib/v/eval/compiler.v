@@ -0,0 +1,848 @@
+module eval
+
+import v.ast
+import v.token
+import math
+import strconv
+
+// BcCompiler compiles the checked AST of a single function to bytecode. Any construct, that it
+// does not support, makes the compilation fail with an error, and the function is then run by
+// the AST walker, as before.
+struct BcCompiler {
+mut:
+	e         &Eval = unsafe { nil }
+	name      string
+	mod       string
+	self_idx  int
+	ret       SlotKind
+	code      []BcInstr
+	calls     []BcCallSite
+	scopes    []map[string]BcLocal
+	loops     []BcLoop
+	nr_iregs  int // the next free integer register
+	nr_fregs  int
+	max_iregs int
+	max_fregs int
+	// last_label is the last position, that is the target of a jump
+	last_label int
+}
+
+struct BcLocal {
+	reg  int
+	kind SlotKind
+}
+
+struct BcLoop {
+mut:
+	breaks    []int // the jumps to patch with the end of the loop
+	continues []int
+}
+
+// BcMark is the state of the register allocation, see mark() and release()
+struct BcMark {
+	iregs int
+	fregs int
+}
+
+// compile_fn returns the index of the compiled `func` in `e.bc_funcs`, compiling it on the first
+// call, or -1, when it can not be compiled
+fn (mut e Eval) compile_fn(func ast.FnDecl) int {
+	if idx := e.bc_index[func.name] {
+		// -2 means, that it is being compiled, and the caller is a mutually recursive function
+		return if idx >= 0 { idx } else { -1 }
+	}
+	if e.no_bytecode || func.is_method || func.is_variadic || func.is_main || func.no_body
+		|| func.language != .v || func.generic_names.len > 0 || func.defer_stmts.len > 0 {
+		e.bc_index[func.name] = -1
+		return -1
+	}
+	e.bc_index[func.name] = -2
+	idx := e.bc_funcs.len
+	e.bc_funcs << BcFunc{}
+	mut c := BcCompiler{
+		e:        unsafe { &e }
+		name:     func.name
+		mod:      func.mod
+		self_idx: idx
+	}
+	compiled := c.func(func) or {
+		if e.pref.is_verbose {
+			println('eval: running `${func.name}` without bytecode: ${err}')
+		}
+		e.bc_index[func.name] = -1
+		return -1
+	}
+	e.bc_funcs[idx] = compiled
+	e.bc_index[func.name] = idx
+	return idx
+}
+
+fn (mut c BcCompiler) func(func ast.FnDecl) !BcFunc {
+	ret_t := func.return_type
+	if ret_t != ast.void_type {
+		c.ret = slot_kind(ret_t)
+		if c.ret == .none_ {
+			return error('unsupported return type')
+		}
+	}
+	c.open_scope()
+	mut params := []BcParam{cap: func.params.len}
+	for param in func.params {
+		kind := slot_kind(param.typ)
+		if kind == .none_ || param.is_mut {
+			return error('unsupported parameter `${param.name}`')
+		}
+		reg := c.new_reg(kind)
+		c.declare(param.name, reg, kind)
+		params << BcParam{
+			reg:  reg
+			kind: kind
+			typ:  param.typ
+		}
+	}
+	c.stmts(func.stmts)!
+	c.emit(op: .ret)
+	c.close_scope()
+	return BcFunc{
+		name:     func.name
+		params:   params
+		ret:      c.ret
+		ret_t:    ret_t
+		code:     c.code
+		calls:    c.calls
+		nr_iregs: c.max_iregs
+		nr_fregs: c.max_fregs
+	}
+}
+
+// Registers and scopes
+
+fn (mut c BcCompiler) new_reg(kind SlotKind) int {
+	if kind == .float_ {
+		c.nr_fregs++
+		if c.nr_fregs > c.max_fregs {
+			c.max_fregs = c.nr_fregs
+		}
+		return c.nr_fregs - 1
+	}
+	c.nr_iregs++
+	if c.nr_iregs > c.max_iregs {
+		c.max_iregs = c.nr_iregs
+	}
+	return c.nr_iregs - 1
+}
+
+// mark returns the current state of the register allocation; release() frees all the registers,
+// that were allocated after it, which is how the temporaries of a statement are freed
+fn (c &BcCompiler) mark() BcMark {
+	return BcMark{c.nr_iregs, c.nr_fregs}
+}
+
+fn (mut c BcCompiler) release(m BcMark) {
+	c.nr_iregs = m.iregs
+	c.nr_fregs = m.fregs
+}
+
+fn (mut c BcCompiler) open_scope() {
+	c.scopes << map[string]BcLocal{}
+}
+
+// close_scope frees the registers of the locals of the innermost scope. They were allocated
+// after the locals of the outer scopes, so the registers are still allocated like a stack.
+fn (mut c BcCompiler) close_scope() {
+	scope := c.scopes.pop()
+	mut iregs := c.nr_iregs
+	mut fregs := c.nr_fregs
+	for _, local in scope {
+		if local.kind == .float_ {
+			fregs = math.min(fregs, local.reg)
+		} else {
+			iregs = math.min(iregs, local.reg)
+		}
+	}
+	c.release(BcMark{iregs, fregs})
+}
+
+fn (mut c BcCompiler) declare(name string, reg int, kind SlotKind) {
+	c.scopes[c.scopes.len - 1][name] = BcLocal{
+		reg:  reg
+		kind: kind
+	}
+}
+
+fn (c &BcCompiler) lookup(name string) !BcLocal {
+	for i := c.scopes.len - 1; i >= 0; i-- {
+		if local := c.scopes[i][name] {
+			return local
+		}
+	}
+	return error('unknown local `${name}`')
+}
+
+fn (mut c BcCompiler) emit(instr BcInstr) int {
+	c.code << instr
+	return c.code.len - 1
+}
+
+// patch sets the target of the jump at `pos` to the next instruction
+fn (mut c BcCompiler) patch(pos int) {
+	c.code[pos] = BcInstr{
+		...c.code[pos]
+		imm: c.label()
+	}
+}
+
+// label returns the position of the next instruction, which is the target of a jump
+fn (mut c BcCompiler) label() int {
+	c.last_label = c.code.len
+	return c.code.len
+}
+
+// mov copies `src` to `dst`. When `src` is a temporary, that was just computed, the instruction,
+// that computed it, writes to `dst` directly instead.
+fn (mut c BcCompiler) mov(dst int, src int, kind SlotKind, m BcMark) {
+	if dst == src {
+		return
+	}
+	temp_start := if kind == .float_ { m.fregs } else { m.iregs }
+	// not when a jump lands right here, since the value may come from elsewhere then
+	if src >= temp_start && c.code.len > 0 && c.last_label < c.code.len {
+		last := c.code.last()
+		if last.a == src && last.op in retargetable_ops
+			&& c.is_float_result(last.op) == (kind == .float_) {
+			c.code[c.code.len - 1] = BcInstr{
+				...last
+				a: dst
+			}
+			return
+		}
+	}
+	c.emit(op: if kind == .float_ { .fmov } else { .imov }, a: dst, b: src)
+}
+
+// retargetable_ops are the instructions, that only write their result to register `a`
+const retargetable_ops = [BcOp.iconst, .fconst, .imov, .fmov, .iadd, .isub, .imul, .idiv, .imod,
+	.udiv, .umod, .iand, .ior, .ixor, .ishl, .ishr, .ushr, .fadd, .fsub, .fmul, .fdiv, .iaddi,
+	.ineg, .inot, .lnot, .fneg, .i2f, .u2f, .f2i, .f2u, .ilt, .ile, .ieq, .ine, .ult, .ule, .flt,
+	.fle, .feq, .fne]
+
+fn (c &BcCompiler) is_float_result(op BcOp) bool {
+	return op in [.fconst, .fmov, .fadd, .fsub, .fmul, .fdiv, .fneg, .i2f, .u2f]
+}
+
+// Statements
+
+fn (mut c BcCompiler) stmts(stmts []ast.Stmt) ! {
+	c.open_scope()
+	for stmt in stmts {
+		c.stmt(stmt)!
+	}
+	c.close_scope()
+}
+
+fn (mut c BcCompiler) stmt(stmt ast.Stmt) ! {
+	if stmt is ast.AssignStmt && stmt.op == .decl_assign {
+		// the new locals outlive the statement
+		c.decl_assign(stmt)!
+		return
+	}
+	m := c.mark()
+	match stmt {
+		ast.ExprStmt {
+			c.expr_stmt(stmt.expr)!
+		}
+		ast.AssignStmt {
+			c.assign(stmt)!
+		}
+		ast.Return {
+			if stmt.exprs.len == 0 {
+				c.emit(op: .ret)
+			} else if stmt.exprs.len == 1 && c.ret != .none_ {
+				r := c.expr(stmt.exprs[0], c.ret)!
+				c.emit(op: if c.ret == .float_ { .fret } else { .iret }, a: r)
+			} else {
+				return error('unsupported return')
+			}
+		}
+		ast.Block {
+			c.stmts(stmt.stmts)!
+		}
+		ast.ForStmt {
+			if stmt.label != '' {
+				return error('unsupported labelled loop')
+			}
+			top := c.label()
+			c.loops << BcLoop{}
+			mut exit_jump := -1
+			if !stmt.is_inf {
+				exit_jump = c.cond_jump(stmt.cond, false)!
+			}
+			c.stmts(stmt.stmts)!
+			c.end_loop(top, top, exit_jump)
+		}
+		ast.ForCStmt {
+			if stmt.label != '' || stmt.is_multi {
+				return error('unsupported for loop')
+			}
+			c.open_scope()
+			if stmt.has_init {
+				c.stmt(stmt.init)!
+			}
+			top := c.label()
+			c.loops << BcLoop{}
+			mut exit_jump := -1
+			if stmt.has_cond {
+				exit_jump = c.cond_jump(stmt.cond, false)!
+			}
+			c.stmts(stmt.stmts)!
+			next := c.label()
+			if stmt.has_inc {
+				c.stmt(stmt.inc)!
+			}
+			c.end_loop(top, next, exit_jump)
+			c.close_scope()
+		}
+		ast.ForInStmt {
+			c.for_in(stmt)!
+		}
+		ast.BranchStmt {
+			if stmt.label != '' || c.loops.len == 0 {
+				return error('unsupported branch statement')
+			}
+			pos := c.emit(op: .jmp)
+			if stmt.kind == .key_break {
+				c.loops[c.loops.len - 1].breaks << pos
+			} else {
+				c.loops[c.loops.len - 1].continues << pos
+			}
+		}
+		else {
+			return error('unsupported statement ${stmt.type_name()}')
+		}
+	}
+	c.release(m)
+}
+
+// end_loop closes the innermost loop, that starts at `top`. `continue` jumps to `next`.
+fn (mut c BcCompiler) end_loop(top int, next int, exit_jump int) {
+	loop := c.loops.pop()
+	c.emit(op: .jmp, imm: top)
+	if exit_jump >= 0 {
+		c.patch(exit_jump)
+	}
+	for pos in loop.breaks {
+		c.patch(pos)
+	}
+	for pos in loop.continues {
+		c.code[pos] = BcInstr{
+			...c.code[pos]
+			imm: next
+		}
+	}
+}
+
+// for_in compiles `for i in a .. b {`. Like the AST walker, it evaluates `b` only once.
+fn (mut c BcCompiler) for_in(stmt ast.ForInStmt) ! {
+	kind := slot_kind(stmt.val_type)
+	if !stmt.is_range || stmt.key_var != '' || stmt.label != '' || kind !in [.int_, .uint_] {
+		return error('unsupported for in loop')
+	}
+	c.open_scope()
+	i := c.new_reg(kind)
+	end := c.new_reg(kind)
+	m := c.mark()
+	c.mov(i, c.expr(stmt.cond, kind)!, kind, m)
+	c.release(m)
+	c.mov(end, c.expr(stmt.high, kind)!, kind, m)
+	c.release(m)
+	// the names, that can not clash with real locals, make close_scope() free the registers
+	c.declare(if stmt.val_var == '_' { '.i' } else { stmt.val_var }, i, kind)
+	c.declare('.end', end, kind)
+	top := c.label()
+	c.loops << BcLoop{}
+	exit_jump := c.emit(op: if kind == .uint_ { .jule } else { .jle }, a: end, b: i)
+	c.stmts(stmt.stmts)!
+	next := c.label()
+	c.emit(op: .iaddi, a: i, b: i, imm: 1)
+	c.end_loop(top, next, exit_jump)
+	c.close_scope()
+}
+
+fn (mut c BcCompiler) expr_stmt(expr ast.Expr) ! {
+	match expr {
+		ast.CallExpr {
+			c.call(expr, true)!
+		}
+		ast.PostfixExpr {
+			if expr.op !in [.inc, .dec] {
+				return error('unsupported postfix expression')
+			}
+			local := c.local_ident(expr.expr)!
+			if local.kind !in [.int_, .uint_] {
+				return error('unsupported postfix expression')
+			}
+			c.emit(op: .iaddi, a: local.reg, b: local.reg, imm: if expr.op == .inc { 1 } else { -1 })
+		}
+		ast.IfExpr {
+			c.if_stmt(expr)!
+		}
+		ast.ParExpr {
+			c.expr_stmt(expr.expr)!
+		}
+		else {
+			return error('unsupported expression statement ${expr.type_name()}')
+		}
+	}
+}
+
+fn (mut c BcCompiler) if_stmt(node ast.IfExpr) ! {
+	if node.is_comptime {
+		return error('unsupported comptime if')
+	}
+	mut end_jumps := []int{}
+	for i, branch in node.branches {
+		if node.has_else && i == node.branches.len - 1 {
+			c.stmts(branch.stmts)!
+			break
+		}
+		m := c.mark()
+		next_jump := c.cond_jump(branch.cond, false)!
+		c.release(m)
+		c.stmts(branch.stmts)!
+		if i < node.branches.len - 1 {
+			end_jumps << c.emit(op: .jmp)
+		}
+		c.patch(next_jump)
+	}
+	for pos in end_jumps {
+		c.patch(pos)
+	}
+}
+
+fn (mut c BcCompiler) local_ident(expr ast.Expr) !BcLocal {
+	if expr is ast.Ident && expr.kind == .variable {
+		return c.lookup(expr.name)
+	}
+	return error('unsupported assignment target')
+}
+
+fn (mut c BcCompiler) decl_assign(stmt ast.AssignStmt) ! {
+	if stmt.left.len != stmt.right.len {
+		return error('unsupported multi value assignment')
+	}
+	// allocate the locals first, so that the temporaries of the values can be freed
+	mut locals := []BcLocal{cap: stmt.left.len}
+	for i, left in stmt.left {
+		kind := slot_kind(stmt.left_types[i])
+		if left !is ast.Ident || kind == .none_ {
+			return error('unsupported declaration')
+		}
+		locals << BcLocal{
+			reg:  c.new_reg(kind)
+			kind: kind
+		}
+	}
+	m := c.mark()
+	for i, right in stmt.right {
+		c.mov(locals[i].reg, c.expr(right, locals[i].kind)!, locals[i].kind, m)
+	}
+	c.release(m)
+	for i, left in stmt.left {
+		name := (left as ast.Ident).name
+		if name != '_' {
+			c.declare(name, locals[i].reg, locals[i].kind)
+		}
+	}
+}
+
+fn (mut c BcCompiler) assign(stmt ast.AssignStmt) ! {
+	if stmt.left.len != stmt.right.len {
+		return error('unsupported multi value assignment')
+	}
+	if stmt.left.len > 1 {
+		if stmt.op != .assign {
+			return error('unsupported assignment')
+		}
+		// `a, b = b, a`: all values are computed, before any of the locals changes
+		mut locals := []BcLocal{}
+		mut temps := []int{}
+		for i, left in stmt.left {
+			local := c.local_ident(left)!
+			m := c.mark()
+			r := c.expr(stmt.right[i], local.kind)!
+			c.release(m)
+			temp := c.new_reg(local.kind)
+			c.mov(temp, r, local.kind, m)
+			locals << local
+			temps << temp
+		}
+		for i, local in locals {
+			c.emit(op: if local.kind == .float_ { .fmov } else { .imov }, a: local.reg, b: temps[i])
+		}
+		return
+	}
+	left := stmt.left[0]
+	if left is ast.Ident && left.kind == .blank_ident {
+		c.expr_stmt(stmt.right[0])!
+		return
+	}
+	local := c.local_ident(left)!
+	m := c.mark()
+	if stmt.op == .assign {
+		c.mov(local.reg, c.expr(stmt.right[0], local.kind)!, local.kind, m)
+		return
+	}
+	op := token.assign_op_to_infix_op(stmt.op)
+	if op in [.plus, .minus] && local.kind in [.int_, .uint_] {
+		if value := c.int_literal(stmt.right[0]) {
+			c.emit(op: .iaddi, a: local.reg, b: local.reg, imm: if op == .plus { value } else { -value })
+			return
+		}
+	}
+	rkind := if op in [.left_shift, .right_shift, .unsigned_right_shift] { SlotKind.int_ } else { local.kind }
+	r := c.expr(stmt.right[0], rkind)!
+	c.emit(op: c.arith_op(op, local.kind)!, a: local.reg, b: local.reg, c: r)
+}
+
+// cond_jump emits a jump, that is taken, when `cond` is `when`, and returns its position for patch().
+// Integer comparisons are fused with the jump.
+fn (mut c BcCompiler) cond_jump(cond ast.Expr, when bool) !int {
+	if cond is ast.ParExpr {
+		return c.cond_jump(cond.expr, when)
+	}
+	if cond is ast.InfixExpr && cond.op in [.lt, .gt, .le, .ge, .eq, .ne] {
+		kind := operand_kind(cond.left_type, cond.right_type)!
+		if kind != .float_ {
+			mut op := cond.op
+			if !when {
+				op = match op {
+					.lt { token.Kind.ge }
+					.gt { token.Kind.le }
+					.le { token.Kind.gt }
+					.ge { token.Kind.lt }
+					.eq { token.Kind.ne }
+					else { token.Kind.eq }
+				}
+			}
+			l := c.expr(cond.left, kind)!
+			r := c.expr(cond.right, kind)!
+			unsigned := kind == .uint_
+			return match op {
+				.lt { c.emit(op: if unsigned { .jult } else { .jlt }, a: l, b: r) }
+				.le { c.emit(op: if unsigned { .jule } else { .jle }, a: l, b: r) }
+				.gt { c.emit(op: if unsigned { .jult } else { .jlt }, a: r, b: l) }
+				.ge { c.emit(op: if unsigned { .jule } else { .jle }, a: r, b: l) }
+				.eq { c.emit(op: .jeq, a: l, b: r) }
+				else { c.emit(op: .jne, a: l, b: r) }
+			}
+		}
+	}
+	r := c.expr(cond, .bool_)!
+	return c.emit(op: if when { .jnz } else { .jz }, a: r)
+}
+
+// Expressions
+
+// operand_kind returns the kind, that the operands of a binary operation are converted to
+fn operand_kind(left_type ast.Type, right_type ast.Type) !SlotKind {
+	l := slot_kind(left_type)
+	r := slot_kind(right_type)
+	if l == .none_ || r == .none_ {
+		return error('unsupported operand types')
+	}
+	if l == .float_ || r == .float_ {
+		return .float_
+	}
+	if l == .uint_ || r == .uint_ {
+		return .uint_
+	}
+	if l == .bool_ && r == .bool_ {
+		return .bool_
+	}
+	return .int_
+}
+
+fn (c &BcCompiler) int_literal(expr ast.Expr) ?i64 {
+	if expr is ast.IntegerLiteral {
+		return strconv.parse_int(expr.val, 0, 64) or { return none }
+	}
+	return none
+}
+
+// expr compiles `expr`, converted to `want`, and returns the register with its value.
+// The register is either a local, or a new temporary.
+fn (mut c BcCompiler) expr(expr ast.Expr, want SlotKind) !int {
+	match expr {
+		ast.IntegerLiteral {
+			value := c.int_literal(expr) or { return error('unsupported integer literal') }
+			if want == .float_ {
+				return c.fconst(f64(value))
+			}
+			r := c.new_reg(want)
+			c.emit(op: .iconst, a: r, imm: value)
+			return r
+		}
+		ast.FloatLiteral {
+			value := strconv.atof64(expr.val) or { return error('invalid float literal') }
+			if want != .float_ {
+				return error('unsupported float literal')
+			}
+			return c.fconst(value)
+		}
+		ast.BoolLiteral {
+			if want == .float_ {
+				return error('unsupported bool conversion')
+			}
+			r := c.new_reg(want)
+			c.emit(op: .iconst, a: r, imm: if expr.val { 1 } else { 0 })
+			return r
+		}
+		ast.Ident {
+			if expr.kind == .constant {
+				return c.constant(expr, want)
+			}
+			local := c.local_ident(expr)!
+			return c.convert(local.reg, local.kind, want)
+		}
+		ast.ParExpr {
+			return c.expr(expr.expr, want)
+		}
+		ast.UnsafeExpr {
+			return c.expr(expr.expr, want)
+		}
+		ast.CastExpr {
+			from := slot_kind(expr.expr_type)
+			to := slot_kind(expr.typ)
+			if from == .none_ || to == .none_ || (from == .bool_) != (to == .bool_) {
+				return error('unsupported cast')
+			}
+			r := c.expr(expr.expr, from)!
+			return c.convert(c.convert(r, from, to)!, to, want)
+		}
+		ast.PrefixExpr {
+			kind := slot_kind(expr.right_type)
+			r := c.expr(expr.right, kind)!
+			dst := c.new_reg(kind)
+			match expr.op {
+				.minus {
+					c.emit(op: if kind == .float_ { .fneg } else { .ineg }, a: dst, b: r)
+				}
+				.not {
+					c.emit(op: .lnot, a: dst, b: r)
+				}
+				.bit_not {
+					if kind == .float_ {
+						return error('unsupported operator `~`')
+					}
+					c.emit(op: .inot, a: dst, b: r)
+				}
+				else {
+					return error('unsupported prefix expression ${expr.op}')
+				}
+			}
+			return c.convert(dst, kind, want)
+		}
+		ast.InfixExpr {
+			return c.infix(expr, want)
+		}
+		ast.CallExpr {
+			r := c.call(expr, false)!
+			return c.convert(r, slot_kind(expr.return_type), want)
+		}
+		else {
+			return error('unsupported expression ${expr.type_name()}')
+		}
+	}
+}
+
+fn (mut c BcCompiler) fconst(value f64) int {
+	r := c.new_reg(.float_)
+	c.emit(op: .fconst, a: r, imm: i64(math.f64_bits(value)))
+	return r
+}
+
+// constant loads the value of a const, which was evaluated, before any function ran
+fn (mut c BcCompiler) constant(expr ast.Ident, want SlotKind) !int {
+	key := expr.name.all_after_last('.')
+	mod := if expr.name.contains('.') { expr.name.all_before_last('.') } else { c.mod }
+	sym := c.e.mods[mod][key] or { c.e.mods['builtin'][key] or { return error('unknown const') } }
+	if sym !is Object {
+		return error('unsupported const')
+	}
+	obj := sym as Object
+	match obj {
+		Int, Uint, i64 {
+			if want == .float_ {
+				return c.fconst(f64(obj.int_val()))
+			}
+			r := c.new_reg(want)
+			c.emit(op: .iconst, a: r, imm: obj.int_val())
+			return r
+		}
+		Float, f64 {
+			if want != .float_ {
+				return error('unsupported const conversion')
+			}
+			return c.fconst(obj.float_val())
+		}
+		bool {
+			r := c.new_reg(want)
+			c.emit(op: .iconst, a: r, imm: if obj { 1 } else { 0 })
+			return r
+		}
+		else {
+			return error('unsupported const')
+		}
+	}
+}
+
+// convert returns a register with the value of `r` converted from `from` to `to`. Integers,
+// unsigned integers and bools share the integer registers, and need no conversion. Like the AST
+// walker, it does not truncate integers to the size of their type.
+fn (mut c BcCompiler) convert(r int, from SlotKind, to SlotKind) !int {
+	if from == to || (from != .float_ && to != .float_) {
+		return r
+	}
+	if from == .bool_ || to == .bool_ {
+		return error('unsupported bool conversion')
+	}
+	dst := c.new_reg(to)
+	op := if from == .int_ {
+		BcOp.i2f
+	} else if from == .uint_ {
+		BcOp.u2f
+	} else if to == .int_ {
+		BcOp.f2i
+	} else {
+		BcOp.f2u
+	}
+	c.emit(op: op, a: dst, b: r)
+	return dst
+}
+
+fn (mut c BcCompiler) infix(expr ast.InfixExpr, want SlotKind) !int {
+	if expr.op in [.and, .logical_or] {
+		// short circuit: dst = left; if dst is already decided, skip the right side
+		dst := c.new_reg(.bool_)
+		m := c.mark()
+		c.mov(dst, c.expr(expr.left, .bool_)!, .bool_, m)
+		skip := c.emit(op: if expr.op == .and { .jz } else { .jnz }, a: dst)
+		c.mov(dst, c.expr(expr.right, .bool_)!, .bool_, m)
+		c.patch(skip)
+		c.release(m)
+		return c.convert(dst, .bool_, want)
+	}
+	is_shift := expr.op in [.left_shift, .right_shift, .unsigned_right_shift]
+	kind := if is_shift { slot_kind(expr.left_type) } else { operand_kind(expr.left_type, expr.right_type)! }
+	if kind == .none_ {
+		return error('unsupported operand types')
+	}
+	l := c.expr(expr.left, kind)!
+	r := c.expr(expr.right, if is_shift { SlotKind.int_ } else { kind })!
+	if expr.op in [.lt, .gt, .le, .ge, .eq, .ne] {
+		dst := c.new_reg(.bool_)
+		strict := expr.op in [.lt, .gt]
+		op := match expr.op {
+			.eq {
+				if kind == .float_ { BcOp.feq } else { BcOp.ieq }
+			}
+			.ne {
+				if kind == .float_ { BcOp.fne } else { BcOp.ine }
+			}
+			else {
+				match kind {
+					.float_ { if strict { BcOp.flt } else { BcOp.fle } }
+					.uint_ { if strict { BcOp.ult } else { BcOp.ule } }
+					else { if strict { BcOp.ilt } else { BcOp.ile } }
+				}
+			}
+		}
+		// `a > b` is `b < a`
+		swap := expr.op in [.gt, .ge]
+		a := if swap { r } else { l }
+		b := if swap { l } else { r }
+		c.emit(op: op, a: dst, b: a, c: b)
+		return c.convert(dst, .bool_, want)
+	}
+	dst := c.new_reg(kind)
+	c.emit(op: c.arith_op(expr.op, kind)!, a: dst, b: l, c: r)
+	return c.convert(dst, kind, want)
+}
+
+fn (c &BcCompiler) arith_op(op token.Kind, kind SlotKind) !BcOp {
+	if kind == .float_ {
+		return match op {
+			.plus { BcOp.fadd }
+			.minus { BcOp.fsub }
+			.mul { BcOp.fmul }
+			.div { BcOp.fdiv }
+			else { error('unsupported float operator ${op}') }
+		}
+	}
+	unsigned := kind == .uint_
+	return match op {
+		.plus { BcOp.iadd }
+		.minus { BcOp.isub }
+		.mul { BcOp.imul }
+		.div { if unsigned { BcOp.udiv } else { BcOp.idiv } }
+		.mod { if unsigned { BcOp.umod } else { BcOp.imod } }
+		.amp { BcOp.iand }
+		.pipe { BcOp.ior }
+		.xor { BcOp.ixor }
+		.left_shift { BcOp.ishl }
+		.right_shift { if unsigned { BcOp.ushr } else { BcOp.ishr } }
+		.unsigned_right_shift { BcOp.ushr }
+		else { error('unsupported operator ${op}') }
+	}
+}
+
+// call compiles a call of a V function. Functions, that can be compiled too, are called
+// directly by the VM; the others are run by the AST walker, with boxed arguments.
+// It returns the register with the result, or -1, when `discard` is true.
+fn (mut c BcCompiler) call(expr ast.CallExpr, discard bool) !int {
+	if expr.is_method || expr.language != .v || expr.or_block.kind != .absent
+		|| expr.name == 'main.host_pop' {
+		return error('unsupported call of `${expr.name}`')
+	}
+	name := expr.name.all_after_last('.')
+	sym := c.e.mods[expr.mod][name] or {
+		c.e.mods['builtin'][name] or { return error('unknown function `${expr.name}`') }
+	}
+	if sym !is ast.FnDecl {
+		return error('unsupported call of `${expr.name}`')
+	}
+	decl := sym as ast.FnDecl
+	if decl.is_variadic || decl.params.len != expr.args.len {
+		return error('unsupported call of `${expr.name}`')
+	}
+	fn_idx := if decl.name == c.name { c.self_idx } else { c.e.compile_fn(decl) }
+	ret := if decl.return_type == ast.void_type { SlotKind.none_ } else { slot_kind(decl.return_type) }
+	if ret == .none_ && !discard {
+		return error('unsupported result of `${expr.name}`')
+	}
+	mut args := []BcParam{cap: expr.args.len}
+	for i, arg in expr.args {
+		// compiled functions get their parameters converted already
+		typ := if fn_idx >= 0 { decl.params[i].typ } else { arg.typ }
+		kind := slot_kind(typ)
+		if kind == .none_ || arg.is_mut {
+			return error('unsupported argument of `${expr.name}`')
+		}
+		args << BcParam{
+			reg:  c.expr(arg.expr, kind)!
+			kind: kind
+			typ:  typ
+		}
+	}
+	dst := if discard || ret == .none_ { -1 } else { c.new_reg(ret) }
+	c.calls << BcCallSite{
+		fn_idx: fn_idx
+		decl:   decl
+		args:   args
+		ret:    ret
+		ret_t:  decl.return_type
+		dst:    dst
+	}
+	c.emit(op: if fn_idx >= 0 { .call } else { .hcall }, imm: c.calls.len - 1)
+	return dst
+}
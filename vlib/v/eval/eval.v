@@ -71,6 +71,15 @@ pub mut:
 	trace_file_paths     []string
 	trace_function_names []string
 	back_trace           []EvalTrace
+
+	no_bytecode bool // run all functions with the AST walker, instead of compiling them to bytecode
+mut:
+	bc_index  map[string]int // fn name -> index in bc_funcs, or -1, when it can not be compiled
+	bc_funcs  []BcFunc
+	bc_ints   []i64 // the integer registers of the running compiled functions, see vm.v
+	bc_floats []f64
+	bc_itop   int // the end of the frame of the innermost running compiled function
+	bc_ftop   int
 }
 
 pub struct EvalTrace {
@@ -129,6 +138,11 @@ pub fn (mut e Eval) run_func(func ast.FnDecl, _args ...Object) {
 			else {}
 		}
 	} else {
+		fn_idx := e.compile_fn(func)
+		if fn_idx >= 0 {
+			e.run_compiled(fn_idx, args)
+			return
+		}
 		e.local_vars_stack << e.local_vars
 		e.local_vars = {}
 		old_scope := e.scope_idx
@@ -167,6 +181,8 @@ pub fn (mut e Eval) run_func(func ast.FnDecl, _args ...Object) {
 }
 
 pub fn (mut e Eval) register_symbols(mut files []&ast.File) {
+	e.bc_index = {}
+	e.bc_funcs = []
 	for mut file in files {
 		file.idx = e.trace_file_paths.len
 		e.trace_file_paths << file.path
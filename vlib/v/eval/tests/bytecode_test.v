@@ -0,0 +1,79 @@
+import v.eval
+
+const loops_code = '
+fn fib(n int) int {
+	if n < 2 {
+		return n
+	}
+	return fib(n - 1) + fib(n - 2)
+}
+
+fn loops(n int) int {
+	mut s := 0
+	for i in 0 .. n {
+		if i % 3 == 0 {
+			continue
+		}
+		s += i
+	}
+	for j := 0; j < n; j++ {
+		if j > 5 {
+			break
+		}
+		s += j * 100
+	}
+	mut k := u32(1)
+	for k < 1000 {
+		k <<= 1
+	}
+	return s + int(k)
+}
+
+fn area(r f64) f64 {
+	return 3.0 * r * r
+}
+
+fn areas(n int) int {
+	mut s := 0.0
+	for i in 0 .. n {
+		s += area(f64(i))
+	}
+	println(s)
+	return int(s) + fib(20) + loops(10)
+}
+
+areas(4)'
+
+fn test_bytecode_fib_loops_and_floats() {
+	mut e := eval.create()
+	ret := e.run(loops_code)!
+	// 42 + 6765 + (27 + 1500 + 1024)
+	assert ret[0].int_val() == 9358
+}
+
+fn test_bytecode_matches_the_ast_walker() {
+	mut e := eval.create()
+	e.no_bytecode = true
+	ret := e.run(loops_code)!
+	assert ret[0].int_val() == 9358
+}
+
+fn test_bytecode_calls_walked_functions() {
+	mut e := eval.create()
+	ret := e.run('
+	// not compiled, since it calls a method
+	fn digits(n int) int {
+		return n.str().len
+	}
+
+	fn sum(n int) int {
+		mut s := 0
+		for i in 1 .. n + 1 {
+			s += i
+		}
+		return s + digits(s)
+	}
+
+	sum(10)')!
+	assert ret[0].int_val() == 57
+}
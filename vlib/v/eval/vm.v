@@ -0,0 +1,333 @@
+module eval
+
+import v.ast
+import math
+
+// The VM runs the bytecode of compiled functions. The registers of all running compiled functions
+// are stacked in `bc_ints` and `bc_floats`: the frame of a callee starts right after the frame
+// of its caller, and the registers of the frame are accessed through a pointer to its start.
+
+// run_compiled runs the compiled function `fn_idx`, called by the AST walker, and stores its result
+// in `e.return_values`, like run_func does
+fn (mut e Eval) run_compiled(fn_idx int, args []Object) {
+	f := e.bc_funcs[fn_idx]
+	ib := e.bc_itop
+	fb := e.bc_ftop
+	e.bc_reserve(ib + f.nr_iregs, fb + f.nr_fregs)
+	for i, p in f.params {
+		if p.kind == .float_ {
+			e.bc_floats[fb + p.reg] = args[i].bc_float()
+		} else {
+			e.bc_ints[ib + p.reg] = args[i].bc_int()
+		}
+	}
+	ival, fval := e.exec(fn_idx, ib, fb)
+	e.bc_itop = ib
+	e.bc_ftop = fb
+	e.return_values = if f.ret == .none_ { [] } else { [e.bc_object(f.ret, f.ret_t, ival, fval)] }
+}
+
+// bc_reserve makes sure, that the register files have room for frames, that end at `itop` and `ftop`
+fn (mut e Eval) bc_reserve(itop int, ftop int) {
+	if itop >= e.bc_ints.len {
+		e.bc_ints << []i64{len: itop - e.bc_ints.len + 1024}
+	}
+	if ftop >= e.bc_floats.len {
+		e.bc_floats << []f64{len: ftop - e.bc_floats.len + 1024}
+	}
+}
+
+// exec is the dispatch loop of the VM. The frame of the function starts at `ib` in the integer
+// registers and at `fb` in the float ones, where the caller put the arguments already.
+// It returns the result in the first value for integers and bools, and in the second one for floats.
+@[direct_array_access]
+fn (mut e Eval) exec(fn_idx int, ib int, fb int) (i64, f64) {
+	f := e.bc_funcs[fn_idx]
+	itop := ib + f.nr_iregs
+	ftop := fb + f.nr_fregs
+	e.bc_reserve(itop, ftop)
+	mut ir := unsafe { &e.bc_ints[ib] }
+	mut fr := unsafe { &e.bc_floats[fb] }
+	mut pc := 0
+	for {
+		ins := f.code[pc]
+		pc++
+		unsafe {
+			match ins.op {
+				.iconst {
+					ir[ins.a] = ins.imm
+				}
+				.fconst {
+					fr[ins.a] = math.f64_from_bits(u64(ins.imm))
+				}
+				.imov {
+					ir[ins.a] = ir[ins.b]
+				}
+				.fmov {
+					fr[ins.a] = fr[ins.b]
+				}
+				.iadd {
+					ir[ins.a] = ir[ins.b] + ir[ins.c]
+				}
+				.isub {
+					ir[ins.a] = ir[ins.b] - ir[ins.c]
+				}
+				.imul {
+					ir[ins.a] = ir[ins.b] * ir[ins.c]
+				}
+				.idiv {
+					if ir[ins.c] == 0 {
+						e.panic('division by zero')
+					}
+					ir[ins.a] = ir[ins.b] / ir[ins.c]
+				}
+				.imod {
+					if ir[ins.c] == 0 {
+						e.panic('modulo by zero')
+					}
+					ir[ins.a] = ir[ins.b] % ir[ins.c]
+				}
+				.udiv {
+					if ir[ins.c] == 0 {
+						e.panic('division by zero')
+					}
+					ir[ins.a] = i64(u64(ir[ins.b]) / u64(ir[ins.c]))
+				}
+				.umod {
+					if ir[ins.c] == 0 {
+						e.panic('modulo by zero')
+					}
+					ir[ins.a] = i64(u64(ir[ins.b]) % u64(ir[ins.c]))
+				}
+				.iand {
+					ir[ins.a] = ir[ins.b] & ir[ins.c]
+				}
+				.ior {
+					ir[ins.a] = ir[ins.b] | ir[ins.c]
+				}
+				.ixor {
+					ir[ins.a] = ir[ins.b] ^ ir[ins.c]
+				}
+				.ishl {
+					ir[ins.a] = ir[ins.b] << ir[ins.c]
+				}
+				.ishr {
+					ir[ins.a] = ir[ins.b] >> ir[ins.c]
+				}
+				.ushr {
+					ir[ins.a] = i64(u64(ir[ins.b]) >> ir[ins.c])
+				}
+				.fadd {
+					fr[ins.a] = fr[ins.b] + fr[ins.c]
+				}
+				.fsub {
+					fr[ins.a] = fr[ins.b] - fr[ins.c]
+				}
+				.fmul {
+					fr[ins.a] = fr[ins.b] * fr[ins.c]
+				}
+				.fdiv {
+					fr[ins.a] = fr[ins.b] / fr[ins.c]
+				}
+				.iaddi {
+					ir[ins.a] = ir[ins.b] + ins.imm
+				}
+				.ineg {
+					ir[ins.a] = -ir[ins.b]
+				}
+				.inot {
+					ir[ins.a] = ~ir[ins.b]
+				}
+				.lnot {
+					ir[ins.a] = if ir[ins.b] == 0 { 1 } else { 0 }
+				}
+				.fneg {
+					fr[ins.a] = -fr[ins.b]
+				}
+				.i2f {
+					fr[ins.a] = f64(ir[ins.b])
+				}
+				.u2f {
+					fr[ins.a] = f64(u64(ir[ins.b]))
+				}
+				.f2i {
+					ir[ins.a] = i64(fr[ins.b])
+				}
+				.f2u {
+					ir[ins.a] = i64(u64(fr[ins.b]))
+				}
+				.ilt {
+					ir[ins.a] = if ir[ins.b] < ir[ins.c] { 1 } else { 0 }
+				}
+				.ile {
+					ir[ins.a] = if ir[ins.b] <= ir[ins.c] { 1 } else { 0 }
+				}
+				.ieq {
+					ir[ins.a] = if ir[ins.b] == ir[ins.c] { 1 } else { 0 }
+				}
+				.ine {
+					ir[ins.a] = if ir[ins.b] != ir[ins.c] { 1 } else { 0 }
+				}
+				.ult {
+					ir[ins.a] = if u64(ir[ins.b]) < u64(ir[ins.c]) { 1 } else { 0 }
+				}
+				.ule {
+					ir[ins.a] = if u64(ir[ins.b]) <= u64(ir[ins.c]) { 1 } else { 0 }
+				}
+				.flt {
+					ir[ins.a] = if fr[ins.b] < fr[ins.c] { 1 } else { 0 }
+				}
+				.fle {
+					ir[ins.a] = if fr[ins.b] <= fr[ins.c] { 1 } else { 0 }
+				}
+				.feq {
+					ir[ins.a] = if fr[ins.b] == fr[ins.c] { 1 } else { 0 }
+				}
+				.fne {
+					ir[ins.a] = if fr[ins.b] != fr[ins.c] { 1 } else { 0 }
+				}
+				.jmp {
+					pc = int(ins.imm)
+				}
+				.jz {
+					if ir[ins.a] == 0 {
+						pc = int(ins.imm)
+					}
+				}
+				.jnz {
+					if ir[ins.a] != 0 {
+						pc = int(ins.imm)
+					}
+				}
+				.jlt {
+					if ir[ins.a] < ir[ins.b] {
+						pc = int(ins.imm)
+					}
+				}
+				.jle {
+					if ir[ins.a] <= ir[ins.b] {
+						pc = int(ins.imm)
+					}
+				}
+				.jeq {
+					if ir[ins.a] == ir[ins.b] {
+						pc = int(ins.imm)
+					}
+				}
+				.jne {
+					if ir[ins.a] != ir[ins.b] {
+						pc = int(ins.imm)
+					}
+				}
+				.jult {
+					if u64(ir[ins.a]) < u64(ir[ins.b]) {
+						pc = int(ins.imm)
+					}
+				}
+				.jule {
+					if u64(ir[ins.a]) <= u64(ir[ins.b]) {
+						pc = int(ins.imm)
+					}
+				}
+				.call {
+					site := f.calls[ins.imm]
+					callee := e.bc_funcs[site.fn_idx]
+					e.bc_reserve(itop + callee.nr_iregs, ftop + callee.nr_fregs)
+					// the register files may have moved
+					ir = &e.bc_ints[ib]
+					fr = &e.bc_floats[fb]
+					for k, arg in site.args {
+						p := callee.params[k]
+						if arg.kind == .float_ {
+							e.bc_floats[ftop + p.reg] = fr[arg.reg]
+						} else {
+							e.bc_ints[itop + p.reg] = ir[arg.reg]
+						}
+					}
+					ival, fval := e.exec(site.fn_idx, itop, ftop)
+					ir = &e.bc_ints[ib]
+					fr = &e.bc_floats[fb]
+					if site.dst >= 0 {
+						if site.ret == .float_ {
+							fr[site.dst] = fval
+						} else {
+							ir[site.dst] = ival
+						}
+					}
+				}
+				.hcall {
+					site := f.calls[ins.imm]
+					mut args := []Object{cap: site.args.len}
+					for arg in site.args {
+						args << if arg.kind == .float_ {
+							e.bc_object(arg.kind, arg.typ, 0, fr[arg.reg])
+						} else {
+							e.bc_object(arg.kind, arg.typ, ir[arg.reg], 0)
+						}
+					}
+					// compiled functions, that the walker calls, get their frames after this one
+					e.bc_itop = itop
+					e.bc_ftop = ftop
+					e.run_func(site.decl, ...args)
+					ir = &e.bc_ints[ib]
+					fr = &e.bc_floats[fb]
+					if site.dst >= 0 {
+						res := e.return_values[0] or { e.error('`${site.decl.name}` returned no value') }
+						if site.ret == .float_ {
+							fr[site.dst] = res.bc_float()
+						} else {
+							ir[site.dst] = res.bc_int()
+						}
+					}
+				}
+				.ret {
+					return 0, 0
+				}
+				.iret {
+					return ir[ins.a], 0
+				}
+				.fret {
+					return 0, fr[ins.a]
+				}
+			}
+		}
+	}
+	return 0, 0
+}
+
+// bc_object boxes the value of a register, for the AST walker
+fn (e &Eval) bc_object(kind SlotKind, typ ast.Type, ival i64, fval f64) Object {
+	return match kind {
+		.float_ {
+			Object(Float{fval, i8(e.type_to_size(typ))})
+		}
+		.uint_ {
+			Object(Uint{u64(ival), i8(e.type_to_size(typ))})
+		}
+		.bool_ {
+			Object(ival != 0)
+		}
+		else {
+			Object(Int{ival, i8(e.type_to_size(typ))})
+		}
+	}
+}
+
+// bc_int unboxes an integer or a bool from the AST walker
+fn (o Object) bc_int() i64 {
+	return match o {
+		bool { if o { 1 } else { 0 } }
+		Float { i64(o.val) }
+		f64 { i64(o) }
+		else { o.int_val() }
+	}
+}
+
+// bc_float unboxes a number from the AST walker
+fn (o Object) bc_float() f64 {
+	return match o {
+		Float { o.val }
+		f64 { o }
+		else { f64(o.int_val()) }
+	}
+}
@@ -800,17 +800,24 @@ fn (mut g Gen) gen_array_sort(node ast.CallExpr) {
 	mut left_expr, mut right_expr := '', ''
 	mut use_lambda := false
 	mut lambda_fn_name := ''
+	// radix_key is the C expression for the key of the element `a`, when the elements are
+	// sorted by a plain number, so they can be radix sorted, instead of compared
+	mut radix_key := ''
+	mut radix_descending := false
 	// the only argument can only be an infix expression like `a < b` or `b.field > a.field`
 	if node.args.len == 0 {
 		comparison_type = g.unwrap(elem_type.set_nr_muls(0))
 		rlock g.array_sort_fn {
 			if compare_fn in g.array_sort_fn {
-				g.gen_array_sort_call(node, compare_fn, left_is_array)
+				g.gen_array_sort_call(node, '${compare_fn}_sort', left_is_array, true)
 				return
 			}
 		}
 		left_expr = '*a'
 		right_expr = '*b'
+		if !elem_type.is_ptr() && g.is_radix_sortable(comparison_type) {
+			radix_key = '*a'
+		}
 	} else if node.args[0].expr is ast.LambdaExpr {
 		lambda_fn_name = node.args[0].expr.func.decl.name
 		compare_fn = '${lambda_fn_name}_lambda_wrapper'
@@ -833,7 +840,7 @@ fn (mut g Gen) gen_array_sort(node ast.CallExpr) {
 		}
 		rlock g.array_sort_fn {
 			if compare_fn in g.array_sort_fn {
-				g.gen_array_sort_call(node, compare_fn, left_is_array)
+				g.gen_array_sort_call(node, '${compare_fn}_sort', left_is_array, true)
 				return
 			}
 		}
@@ -856,6 +863,22 @@ fn (mut g Gen) gen_array_sort(node ast.CallExpr) {
 				left_expr = '*' + left_expr
 			}
 		}
+		// `a.age < b.age` compares the same number field of both elements
+		right_name := infix_expr.right.str()
+		// `a` and `b` are pointers to the elements, so `sort(a < b)` compares `*a` and `*b`
+		key_muls := if infix_expr.left is ast.Ident {
+			infix_expr.left_type.nr_muls() - 1
+		} else {
+			infix_expr.left_type.nr_muls()
+		}
+		if key_muls == 0 && left_name.len == right_name.len && left_name[0] != right_name[0]
+			&& left_name[1..] == right_name[1..] && is_plain_sort_key(infix_expr.left)
+			&& !infix_expr.left_type.has_option_or_result() && g.is_radix_sortable(comparison_type) {
+			left_c := if left_name.starts_with('a') != is_reverse { left_expr } else { right_expr }
+			right_c := if left_name.starts_with('a') != is_reverse { right_expr } else { left_expr }
+			radix_key = if left_name.starts_with('a') { left_c } else { right_c }
+			radix_descending = is_reverse
+		}
 	}
 
 	// Register a new custom `compare_xxx` function for qsort()
@@ -888,12 +911,203 @@ fn (mut g Gen) gen_array_sort(node ast.CallExpr) {
 	g.sort_fn_definitions.writeln('\tif (${c_condition}) return -1;')
 	g.sort_fn_definitions.writeln('\telse return 1;')
 	g.sort_fn_definitions.writeln('}\n')
+	key_styp := if radix_key != '' { g.styp(comparison_type.unaliased) } else { '' }
+	g.gen_array_sort_fn(compare_fn, stype_arg, key_styp, radix_key, radix_descending)
 
 	// write call to the generated function
-	g.gen_array_sort_call(node, compare_fn, left_is_array)
+	g.gen_array_sort_call(node, '${compare_fn}_sort', left_is_array, true)
+}
+
+// is_radix_sortable reports whether values of type `t` are ordered by `<` as plain numbers
+fn (mut g Gen) is_radix_sortable(t Type) bool {
+	if t.sym.has_method('<') || t.unaliased_sym.has_method('<') || t.unaliased.is_ptr() {
+		return false
+	}
+	return t.unaliased_sym.kind in [.i8, .i16, .i32, .int, .i64, .isize, .u8, .u16, .u32, .u64,
+		.usize, .rune, .f32, .f64]
+}
+
+// is_plain_sort_key reports whether `expr` is `a`, or a field of `a`, like `a.pos.x`
+fn is_plain_sort_key(expr ast.Expr) bool {
+	return match expr {
+		ast.Ident { true }
+		ast.SelectorExpr { is_plain_sort_key(expr.expr) }
+		else { false }
+	}
+}
+
+// gen_array_sort_fn generates `${compare_fn}_sort(T* a, usize n)`, a sort function for the
+// elements of type `elem_styp`, with the comparison function `compare_fn` inlined, so that
+// there is no indirect call per comparison like with qsort(), and the elements are moved
+// with plain assignments, instead of byte wise swaps.
+// It is an introsort: a quicksort with a median of three pivot, that switches to a heapsort,
+// when the recursion gets too deep, and to an insertion sort for the short ranges.
+// When `key_expr` is not empty, the elements are sorted by a number of type `key_styp` (the
+// value of `key_expr` for the element `a`), and larger arrays are sorted with a stable LSD
+// radix sort on that number instead.
+fn (mut g Gen) gen_array_sort_fn(compare_fn string, elem_styp string, key_styp string, key_expr string, descending bool) {
+	fn_prefix := 'VV_LOC ${g.static_modifier}'
+	mut sb := strings.new_builder(4096)
+	name := '${compare_fn}_sort'
+	// insertion sort of a[lo..hi)
+	sb.writeln('${fn_prefix}void ${name}_insertion(${elem_styp}* a, usize lo, usize hi) {')
+	sb.writeln('\tfor (usize i = lo + 1; i < hi; i++) {')
+	sb.writeln('\t\t${elem_styp} x = a[i];')
+	sb.writeln('\t\tusize j = i;')
+	sb.writeln('\t\tfor (; j > lo && ${compare_fn}(&x, &a[j - 1]) < 0; j--) a[j] = a[j - 1];')
+	sb.writeln('\t\ta[j] = x;')
+	sb.writeln('\t}')
+	sb.writeln('}')
+	// heapsort of a[0..n)
+	sb.writeln('${fn_prefix}void ${name}_sift(${elem_styp}* a, usize root, usize n) {')
+	sb.writeln('\t${elem_styp} x = a[root];')
+	sb.writeln('\tfor (;;) {')
+	sb.writeln('\t\tusize child = 2 * root + 1;')
+	sb.writeln('\t\tif (child >= n) break;')
+	sb.writeln('\t\tif (child + 1 < n && ${compare_fn}(&a[child], &a[child + 1]) < 0) child++;')
+	sb.writeln('\t\tif (${compare_fn}(&x, &a[child]) >= 0) break;')
+	sb.writeln('\t\ta[root] = a[child];')
+	sb.writeln('\t\troot = child;')
+	sb.writeln('\t}')
+	sb.writeln('\ta[root] = x;')
+	sb.writeln('}')
+	sb.writeln('${fn_prefix}void ${name}_heap(${elem_styp}* a, usize n) {')
+	sb.writeln('\tfor (usize i = n / 2; i-- > 0;) ${name}_sift(a, i, n);')
+	sb.writeln('\tfor (usize end = n - 1; end > 0; end--) {')
+	sb.writeln('\t\t${sort_swap(elem_styp, 'a[0]', 'a[end]')}')
+	sb.writeln('\t\t${name}_sift(a, 0, end);')
+	sb.writeln('\t}')
+	sb.writeln('}')
+	// the quicksort recurses into the shorter part, and loops over the longer one
+	sb.writeln('${fn_prefix}void ${name}_intro(${elem_styp}* a, usize lo, usize hi, int depth) {')
+	sb.writeln('\twhile (hi - lo > 16) {')
+	sb.writeln('\t\tif (depth-- == 0) {')
+	sb.writeln('\t\t\t${name}_heap(a + lo, hi - lo);')
+	sb.writeln('\t\t\treturn;')
+	sb.writeln('\t\t}')
+	sb.writeln('\t\tusize mid = lo + (hi - lo - 1) / 2;')
+	sb.writeln('\t\tif (${compare_fn}(&a[mid], &a[lo]) < 0) ${sort_swap(elem_styp, 'a[mid]', 'a[lo]')}')
+	sb.writeln('\t\tif (${compare_fn}(&a[hi - 1], &a[mid]) < 0) {')
+	sb.writeln('\t\t\t${sort_swap(elem_styp, 'a[hi - 1]', 'a[mid]')}')
+	sb.writeln('\t\t\tif (${compare_fn}(&a[mid], &a[lo]) < 0) ${sort_swap(elem_styp, 'a[mid]', 'a[lo]')}')
+	sb.writeln('\t\t}')
+	sb.writeln('\t\t${elem_styp} pivot = a[mid];')
+	// the bounds checks keep the scans in the range, even for comparisons, that are not a strict order
+	sb.writeln('\t\tisize i = (isize)lo - 1, j = (isize)hi;')
+	sb.writeln('\t\tfor (;;) {')
+	sb.writeln('\t\t\tdo { i++; } while (i < (isize)hi - 1 && ${compare_fn}(&a[i], &pivot) < 0);')
+	sb.writeln('\t\t\tdo { j--; } while (j > (isize)lo && ${compare_fn}(&pivot, &a[j]) < 0);')
+	sb.writeln('\t\t\tif (i >= j) break;')
+	sb.writeln('\t\t\t${sort_swap(elem_styp, 'a[i]', 'a[j]')}')
+	sb.writeln('\t\t}')
+	sb.writeln('\t\tusize split = (usize)j + 1;')
+	sb.writeln('\t\tif (split - lo < hi - split) {')
+	sb.writeln('\t\t\t${name}_intro(a, lo, split, depth);')
+	sb.writeln('\t\t\tlo = split;')
+	sb.writeln('\t\t} else {')
+	sb.writeln('\t\t\t${name}_intro(a, split, hi, depth);')
+	sb.writeln('\t\t\thi = split;')
+	sb.writeln('\t\t}')
+	sb.writeln('\t}')
+	sb.writeln('\t${name}_insertion(a, lo, hi);')
+	sb.writeln('}')
+	has_radix := key_expr != ''
+	if has_radix {
+		g.gen_array_radix_sort_fn(mut sb, name, elem_styp, key_styp, key_expr, descending)
+	}
+	sb.writeln('${fn_prefix}void ${name}(${elem_styp}* a, usize n) {')
+	sb.writeln('\tif (n < 2) return;')
+	if has_radix {
+		sb.writeln('\tif (n >= 256 && n <= 0xFFFFFFFFu) {')
+		sb.writeln('\t\t${name}_radix(a, n);')
+		sb.writeln('\t\treturn;')
+		sb.writeln('\t}')
+	}
+	sb.writeln('\tint depth = 0;')
+	sb.writeln('\tfor (usize m = n; m > 1; m >>= 1) depth += 2;')
+	sb.writeln('\t${name}_intro(a, 0, n, depth);')
+	sb.writeln('}\n')
+	g.sort_fn_definitions.write_string(sb.str())
+}
+
+// sort_swap returns the C statement, that swaps `x` and `y` of type `styp`
+fn sort_swap(styp string, x string, y string) string {
+	return '{ ${styp} t = ${x}; ${x} = ${y}; ${y} = t; }'
 }
 
-fn (mut g Gen) gen_array_sort_call(node ast.CallExpr, compare_fn string, is_array bool) {
+// gen_array_radix_sort_fn generates `${name}_radix(T* a, usize n)`, a LSD radix sort of the
+// elements by the number `key_expr`, one byte per pass. The number is mapped to an u64, that
+// has the same order: the sign bit of the signed integers is flipped, and the negative floats
+// have all their bits flipped. The passes, in which all keys have the same byte, are skipped,
+// so small ranges of values need fewer passes.
+// Small elements are moved in every pass. Larger ones are sorted indirectly: only their keys
+// and indexes are radix sorted, and then each element is moved once, to its final place.
+fn (mut g Gen) gen_array_radix_sort_fn(mut sb strings.Builder, name string, elem_styp string, key_styp string, key_expr string, descending bool) {
+	fn_prefix := 'VV_LOC ${g.static_modifier}'
+	sb.writeln('${fn_prefix}u64 ${name}_key(${elem_styp}* a) {')
+	sb.writeln('\t${key_styp} x = ${key_expr};')
+	if key_styp in ['f32', 'f64'] {
+		sb.writeln('\tf64 f = (f64)x;')
+		sb.writeln('\tu64 k;')
+		sb.writeln('\tmemcpy(&k, &f, sizeof(k));')
+		sb.writeln('\tk = (k >> 63) ? ~k : (k | ((u64)1 << 63));')
+	} else {
+		// `(u64)x` sign extends the signed numbers, so the bits above the size of x are masked out
+		sb.writeln('\tu64 k = (u64)x;')
+		sb.writeln('\tif ((${key_styp})-1 < 0) k ^= (u64)1 << (sizeof(x) * 8 - 1);')
+		sb.writeln('\tif (sizeof(x) < 8) k &= ((u64)1 << (sizeof(x) * 8)) - 1;')
+	}
+	sb.writeln(if descending { '\treturn ~k;' } else { '\treturn k;' })
+	sb.writeln('}')
+	item := '${name}_item'
+	sb.writeln('typedef struct { u64 k; u32 i; } ${item};')
+	sb.writeln('${fn_prefix}void ${name}_radix(${elem_styp}* a, usize n) {')
+	sb.writeln('\tusize counts[8][256];')
+	sb.writeln('\tmemset(counts, 0, sizeof(counts));')
+	sb.writeln('\tfor (usize i = 0; i < n; i++) {')
+	sb.writeln('\t\tu64 k = ${name}_key(&a[i]);')
+	sb.writeln('\t\tfor (int d = 0; d < 8; d++) counts[d][(k >> (d * 8)) & 0xFF]++;')
+	sb.writeln('\t}')
+	sb.writeln('\tu64 first = ${name}_key(&a[0]);')
+	sb.writeln('\tif (sizeof(${elem_styp}) <= sizeof(${item})) {')
+	sb.writeln('\t\t${elem_styp}* buf = (${elem_styp}*)builtin___v_malloc(n * sizeof(${elem_styp}));')
+	sb.writeln('\t\t${elem_styp}* src = a;')
+	sb.writeln('\t\t${elem_styp}* dst = buf;')
+	sb.writeln('\t\tfor (int d = 0; d < 8; d++) {')
+	sb.writeln('\t\t\tusize* c = counts[d];')
+	sb.writeln('\t\t\tif (c[(first >> (d * 8)) & 0xFF] == n) continue;')
+	sb.writeln('\t\t\tusize sum = 0;')
+	sb.writeln('\t\t\tfor (int b = 0; b < 256; b++) { usize t = c[b]; c[b] = sum; sum += t; }')
+	sb.writeln('\t\t\tfor (usize i = 0; i < n; i++) dst[c[(${name}_key(&src[i]) >> (d * 8)) & 0xFF]++] = src[i];')
+	sb.writeln('\t\t\t${elem_styp}* t = src; src = dst; dst = t;')
+	sb.writeln('\t\t}')
+	sb.writeln('\t\tif (src != a) memcpy(a, src, n * sizeof(${elem_styp}));')
+	sb.writeln('\t\tbuiltin___v_free(buf);')
+	sb.writeln('\t\treturn;')
+	sb.writeln('\t}')
+	sb.writeln('\t${item}* items = (${item}*)builtin___v_malloc(2 * n * sizeof(${item}));')
+	sb.writeln('\t${item}* src = items;')
+	sb.writeln('\t${item}* dst = items + n;')
+	sb.writeln('\tfor (usize i = 0; i < n; i++) { src[i].k = ${name}_key(&a[i]); src[i].i = (u32)i; }')
+	sb.writeln('\tfor (int d = 0; d < 8; d++) {')
+	sb.writeln('\t\tusize* c = counts[d];')
+	sb.writeln('\t\tif (c[(first >> (d * 8)) & 0xFF] == n) continue;')
+	sb.writeln('\t\tusize sum = 0;')
+	sb.writeln('\t\tfor (int b = 0; b < 256; b++) { usize t = c[b]; c[b] = sum; sum += t; }')
+	sb.writeln('\t\tfor (usize i = 0; i < n; i++) dst[c[(src[i].k >> (d * 8)) & 0xFF]++] = src[i];')
+	sb.writeln('\t\t${item}* t = src; src = dst; dst = t;')
+	sb.writeln('\t}')
+	sb.writeln('\t${elem_styp}* sorted = (${elem_styp}*)builtin___v_malloc(n * sizeof(${elem_styp}));')
+	sb.writeln('\tfor (usize i = 0; i < n; i++) sorted[i] = a[src[i].i];')
+	sb.writeln('\tmemcpy(a, sorted, n * sizeof(${elem_styp}));')
+	sb.writeln('\tbuiltin___v_free(sorted);')
+	sb.writeln('\tbuiltin___v_free(items);')
+	sb.writeln('}')
+}
+
+// gen_array_sort_call writes the call of `sort_fn`, that was generated by gen_array_sort_fn,
+// when `is_generated` is true, or else of qsort(), with `sort_fn` as the compare function
+fn (mut g Gen) gen_array_sort_call(node ast.CallExpr, sort_fn string, is_array bool, is_generated bool) {
 	deref_field := if node.receiver_type.nr_muls() > node.left_type.nr_muls()
 		&& node.left_type.is_ptr() {
 		g.dot_or_ptr(node.left_type.deref())
@@ -905,19 +1119,34 @@ fn (mut g Gen) gen_array_sort_call(node ast.CallExpr, compare_fn string, is_arra
 	if is_array {
 		g.write('if (')
 		g.expr(node.left)
-		g.write2('${deref_field}len > 0) { ', 'qsort(')
+		if is_generated {
+			elem_styp := g.styp((g.table.final_sym(node.left_type).info as ast.Array).elem_type)
+			g.write2('${deref_field}len > 0) { ', '${sort_fn}((${elem_styp}*)')
+		} else {
+			g.write2('${deref_field}len > 0) { ', 'qsort(')
+		}
 		g.expr(node.left)
 		g.write('${deref_field}data, ')
 		g.expr(node.left)
-		g.write('${deref_field}len, ')
-		g.expr(node.left)
-		g.write2('${deref_field}element_size, (voidptr)${compare_fn});', ' }')
+		if is_generated {
+			g.write2('${deref_field}len);', ' }')
+		} else {
+			g.write('${deref_field}len, ')
+			g.expr(node.left)
+			g.write2('${deref_field}element_size, (voidptr)${sort_fn});', ' }')
+		}
 	} else {
 		info := g.table.final_sym(node.left_type).info as ast.ArrayFixed
 		elem_styp := g.styp(info.elem_type)
-		g.write('qsort(&')
-		g.expr(node.left)
-		g.write(', ${info.size}, sizeof(${elem_styp}), (voidptr)${compare_fn});')
+		if is_generated {
+			g.write('${sort_fn}((${elem_styp}*)&')
+			g.expr(node.left)
+			g.write(', ${info.size});')
+		} else {
+			g.write('qsort(&')
+			g.expr(node.left)
+			g.write(', ${info.size}, sizeof(${elem_styp}), (voidptr)${sort_fn});')
+		}
 	}
 	g.writeln('')
 }
@@ -962,7 +1191,7 @@ fn (mut g Gen) gen_fixed_array_sort_with_compare(node ast.CallExpr) {
 		compare_fn = node.args[0].expr.str()
 	}
 	// write call to the generated function
-	g.gen_array_sort_call(node, compare_fn, false)
+	g.gen_array_sort_call(node, compare_fn, false, false)
 }
 
 fn (mut g Gen) gen_fixed_array_reverse(node ast.CallExpr) {
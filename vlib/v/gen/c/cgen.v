@@ -202,6 +202,8 @@ mut:
 	sumtype_definitions       map[u32]bool    // `_TypeA_to_sumtype_TypeB()` fns that have been generated
 	trace_fn_definitions      []string
 	json_types                []ast.Type           // to avoid json gen duplicates
+	json_field_slots          map[string]int       // json key -> index in `jsonfields`, in the struct decoder that is being generated
+	json_stream_types         map[ast.Type]bool    // whether json.decode can use the streaming decoder for a type, see json_stream_supported
 	pcs                       []ProfileCounterMeta // -prof profile counter fn_names => fn counter name
 	hotcode_fn_names          []string
 	hotcode_fpaths            []string
@@ -392,7 +394,7 @@ pub fn gen(files []&ast.File, mut table ast.Table, pref_ &pref.Preferences) GenO
 	global_g.file = files.last()
 	if !pref_.no_parallel {
 		util.timing_start('cgen parallel processing')
-		mut pp := pool.new_pool_processor(callback: cgen_process_one_file_cb)
+		mut pp := util.build_pool(cgen_process_one_file_cb)
 		pp.set_shared_context(global_g) // TODO: make global_g shared
 		pp.work_on_items(files)
 		util.timing_measure('cgen parallel processing')
@@ -1030,6 +1032,9 @@ pub fn (mut g Gen) init() {
 		if !g.pref.skip_unused || g.table.used_features.used_attr_hidden {
 			g.cheaders.writeln(c_common_hidden_attr)
 		}
+		if !g.pref.skip_unused || g.table.used_features.used_thread_local {
+			g.cheaders.writeln(c_common_thread_local_attr)
+		}
 		if !g.pref.skip_unused || g.table.used_features.used_attr_noreturn {
 			g.cheaders.writeln(c_common_noreturn_attr)
 			g.cheaders.writeln(c_common_unreachable_attr)
@@ -229,6 +229,25 @@ const c_common_hidden_attr = '
 #endif
 '
 
+// VTHREAD_LOCAL is empty for tcc, where the `@[thread_local]` globals are shared by all threads
+const c_common_thread_local_attr = '
+#if !defined(VTHREAD_LOCAL)
+	#if defined(__cplusplus) && __cplusplus >= 201103L
+		#define VTHREAD_LOCAL thread_local
+	#elif defined(_MSC_VER)
+		#define VTHREAD_LOCAL __declspec(thread)
+	#elif defined(__TINYC__)
+		#define VTHREAD_LOCAL
+	#elif defined(__GNUC__) || defined(__clang__)
+		#define VTHREAD_LOCAL __thread
+	#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+		#define VTHREAD_LOCAL _Thread_local
+	#else
+		#define VTHREAD_LOCAL
+	#endif
+#endif
+'
+
 const c_common_noreturn_attr = '
 #if !defined(VNORETURN)
 	#if defined(__TINYC__)
@@ -488,9 +488,10 @@ fn (mut g Gen) global_decl(node ast.GlobalDecl) {
 		mut init := ''
 		extern := if field.is_extern { 'extern ' } else { '' }
 		modifier := if field.is_volatile { ' volatile ' } else { '' }
+		thread_local_kw := if field.is_thread_local { 'VTHREAD_LOCAL ' } else { '' }
 		final_c_name := field.name.all_after('C.')
 		if field.is_extern {
-			def_builder.writeln('${extern}${visibility_kw}${modifier}${styp} ${attributes}${final_c_name}; // global 2')
+			def_builder.writeln('${extern}${visibility_kw}${thread_local_kw}${modifier}${styp} ${attributes}${final_c_name}; // global 2')
 			g.global_const_defs[name] = GlobalConstDef{
 				mod:   node.mod
 				def:   def_builder.str()
@@ -500,7 +501,7 @@ fn (mut g Gen) global_decl(node ast.GlobalDecl) {
 		}
 		mut needs_ending_semicolon := false
 		if field.language != .c || field.has_expr {
-			def_builder.write_string('${extern}${visibility_kw}${modifier}${styp} ${attributes}${final_c_name}')
+			def_builder.write_string('${extern}${visibility_kw}${thread_local_kw}${modifier}${styp} ${attributes}${final_c_name}')
 			needs_ending_semicolon = true
 		}
 		if field.has_expr || cinit {
@@ -1726,7 +1726,8 @@ fn (mut g Gen) method_call(node ast.CallExpr) {
 	} else if receiver_type_name in ['int_literal', 'float_literal', 'vint_t'] {
 		name = 'builtin__${name}'
 	}
-	if left_sym.kind == .chan && node.kind in [.close, .try_pop, .try_push] {
+	if left_sym.kind == .chan && (node.kind in [.close, .try_pop, .try_push]
+		|| node.name in ['push_many', 'pop_many', 'try_pop_many']) {
 		name = 'sync__Channel_${node.name}'
 	}
 	mut is_range_slice := false
@@ -2000,6 +2001,7 @@ fn (mut g Gen) fn_call(node ast.CallExpr) {
 		g.is_json_fn = true
 		json_obj = g.new_tmp_var()
 		mut tmp2 := ''
+		mut is_json_stream := false
 		cur_line := g.go_before_last_stmt()
 		if is_json_encode || is_json_encode_pretty {
 			g.gen_json_for_type(node.args[0].typ)
@@ -2029,16 +2031,28 @@ fn (mut g Gen) fn_call(node ast.CallExpr) {
 			g.gen_json_for_type(ast_type.typ)
 			g.empty_line = true
 			g.writeln('// json.decode')
-			g.write('cJSON* ${json_obj} = json__json_parse(')
-			// Skip the first argument in json.decode which is a type
-			// its name was already used to generate the function call
-			g.is_js_call = true
-			g.call_args(node)
-			g.writeln(');')
-			tmp2 = g.new_tmp_var()
-			g.writeln('${result_name}_${typ} ${tmp2} = ${fn_name}(${json_obj});')
+			if g.json_stream_supported(ast_type.typ) {
+				// `json.decode(User, s)` => json.stream_decode_User(s), that falls back to
+				// json.decode_User(json_parse(s)) by itself
+				tmp2 = g.new_tmp_var()
+				stream_fn_name := fn_name.replace_once('json__decode_', 'json__stream_decode_')
+				g.write('${result_name}_${typ} ${tmp2} = ${stream_fn_name}(')
+				g.is_js_call = true
+				g.call_args(node)
+				g.writeln(');')
+				is_json_stream = true
+			} else {
+				g.write('cJSON* ${json_obj} = json__json_parse(')
+				// Skip the first argument in json.decode which is a type
+				// its name was already used to generate the function call
+				g.is_js_call = true
+				g.call_args(node)
+				g.writeln(');')
+				tmp2 = g.new_tmp_var()
+				g.writeln('${result_name}_${typ} ${tmp2} = ${fn_name}(${json_obj});')
+			}
 		}
-		if !g.is_autofree {
+		if !g.is_autofree && !is_json_stream {
 			g.write('cJSON_Delete(${json_obj}); // del')
 		}
 		g.write('\n${cur_line}')
@@ -177,7 +177,9 @@ ${enc_fn_dec} {
 				}
 			} else if psym.info is ast.Struct {
 				enc.writeln('\to = cJSON_CreateObject();')
+				g.gen_json_field_table(psym.info, mut dec)
 				g.gen_struct_enc_dec(utyp, psym.info, ret_styp, mut enc, mut dec, '')
+				g.json_field_slots.clear()
 			} else if psym.kind == .enum {
 				g.gen_enum_enc_dec(utyp, psym, mut enc, mut dec)
 			} else if psym.kind == .sum_type {
@@ -211,7 +213,9 @@ ${enc_fn_dec} {
 			if sym.info !is ast.Struct {
 				verror('json: ${sym.name} is not struct')
 			}
+			g.gen_json_field_table(sym.info as ast.Struct, mut dec)
 			g.gen_struct_enc_dec(utyp, sym.info, ret_styp, mut enc, mut dec, '')
+			g.json_field_slots.clear()
 		}
 		// cJSON_delete
 		dec.writeln('\t${result_name}_${ret_styp} ret;')
@@ -220,6 +224,9 @@ ${enc_fn_dec} {
 		enc.writeln('\treturn o;\n}')
 		g.gowrappers.writeln(dec.str())
 		g.gowrappers.writeln(enc.str())
+		if g.json_stream_supported(utyp) {
+			g.gen_json_stream_decoder(utyp, sym, init_styp)
+		}
 	}
 }
 
@@ -475,14 +482,14 @@ fn (mut g Gen) gen_sumtype_enc_dec(utyp ast.Type, sym ast.TypeSymbol, mut enc st
 		$if json_no_inline_sumtypes ? {
 			dec.writeln('\tif (strcmp("${unmangled_variant_name}", root->child->string) == 0) {')
 			if is_js_prim(variant_typ) {
-				gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
+				g.gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
 				dec.writeln('\t\t${variant_typ} value = ${js_dec_name(variant_typ)}(jsonroot_${tmp});')
 			} else if variant_sym.kind == .enum {
 				if g.is_enum_as_int(variant_sym) {
-					gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
+					g.gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
 					dec.writeln('\t\t${variant_typ} value = ${js_dec_name('u64')}(jsonroot_${tmp});')
 				} else {
-					gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
+					g.gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
 					dec.writeln('\t\t${variant_typ} value;')
 					tmp2 := g.new_tmp_var()
 					dec.writeln('\t\tstring ${tmp2} = json__decode_string(jsonroot_${tmp});')
@@ -490,10 +497,10 @@ fn (mut g Gen) gen_sumtype_enc_dec(utyp ast.Type, sym ast.TypeSymbol, mut enc st
 						dec)
 				}
 			} else if variant_sym.name == 'time.Time' {
-				gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
+				g.gen_js_get(ret_styp, tmp, unmangled_variant_name, mut dec, true)
 				dec.writeln('\t\t${variant_typ} value = time__unix(${js_dec_name('i64')}(jsonroot_${tmp}));')
 			} else {
-				gen_js_get_opt(js_dec_name(variant_typ), variant_typ, ret_styp, tmp, unmangled_variant_name, mut
+				g.gen_js_get_opt(js_dec_name(variant_typ), variant_typ, ret_styp, tmp, unmangled_variant_name, mut
 					dec, true)
 				dec.writeln('\t\t${variant_typ} value = *(${variant_typ}*)(${tmp}.data);')
 			}
@@ -506,7 +513,7 @@ fn (mut g Gen) gen_sumtype_enc_dec(utyp ast.Type, sym ast.TypeSymbol, mut enc st
 		} $else {
 			if variant_sym.name == 'time.Time' {
 				dec.writeln('\t\t\tif (strcmp("Time", ${type_var}) == 0) {')
-				gen_js_get(ret_styp, tmp, 'value', mut dec, true)
+				g.gen_js_get(ret_styp, tmp, 'value', mut dec, true)
 				dec.writeln('\t\t\t\t${variant_typ} ${tmp} = time__unix(${js_dec_name('i64')}(jsonroot_${tmp}));')
 				if utyp.has_flag(.option) {
 					dec.writeln('\t\t\t\t${prefix}res.state = 0;')
@@ -717,7 +724,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 			if field.typ.has_flag(.option) {
 				g.gen_json_for_type(field.typ)
 				base_typ := g.base_type(field.typ)
-				dec.writeln('\tif (js_get(root, "${name}") == NULL)')
+				dec.writeln('\tif (${g.js_get_expr(name)} == NULL)')
 				default_init := if field.typ.is_int() || field.typ.is_float() || field.typ.is_bool() {
 					'0'
 				} else {
@@ -725,9 +732,9 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 				}
 				dec.writeln('\t\tbuiltin___option_none(&(${base_typ}[]) { ${default_init} }, (${option_name}*)&${prefix}${op}${c_name(field.name)}, sizeof(${base_typ}));')
 				dec.writeln('\telse')
-				dec.writeln('\t\tbuiltin___option_ok(&(${base_typ}[]) {  json__json_print(js_get(root, "${name}")) }, (${option_name}*)&${prefix}${op}${c_name(field.name)}, sizeof(${base_typ}));')
+				dec.writeln('\t\tbuiltin___option_ok(&(${base_typ}[]) {  json__json_print(${g.js_get_expr(name)}) }, (${option_name}*)&${prefix}${op}${c_name(field.name)}, sizeof(${base_typ}));')
 			} else {
-				dec.writeln('\t${prefix}${op}${c_name(field.name)} = json__json_print(js_get(root, "${name}"));')
+				dec.writeln('\t${prefix}${op}${c_name(field.name)} = json__json_print(${g.js_get_expr(name)});')
 			}
 		} else {
 			// Now generate decoders for all field types in this struct
@@ -736,7 +743,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 			dec_name := js_dec_name(field_type)
 			if is_js_prim(field_type) {
 				tmp := g.new_tmp_var()
-				gen_js_get(styp, tmp, name, mut dec, is_required)
+				g.gen_js_get(styp, tmp, name, mut dec, is_required)
 				dec.writeln('\tif (jsonroot_${tmp}) {')
 				if utyp.has_flag(.option) {
 					dec.writeln('\t\tres.state = 0;')
@@ -754,11 +761,11 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 				tmp := g.new_tmp_var()
 				is_option_field := field.typ.has_flag(.option)
 				if field.typ.has_flag(.option) {
-					gen_js_get_opt(js_dec_name(field_type), field_type, styp, tmp, name, mut
+					g.gen_js_get_opt(js_dec_name(field_type), field_type, styp, tmp, name, mut
 						dec, is_required)
 					dec.writeln('\tif (jsonroot_${tmp} && !cJSON_IsNull(jsonroot_${tmp})) {')
 				} else {
-					gen_js_get(styp, tmp, name, mut dec, is_required)
+					g.gen_js_get(styp, tmp, name, mut dec, is_required)
 					dec.writeln('\tif (jsonroot_${tmp}) {')
 				}
 				if g.is_enum_as_int(field_sym) {
@@ -789,7 +796,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 				// time struct requires special treatment
 				// it has to be decoded from a unix timestamp number
 				tmp := g.new_tmp_var()
-				gen_js_get(styp, tmp, name, mut dec, is_required)
+				g.gen_js_get(styp, tmp, name, mut dec, is_required)
 				dec.writeln('\tif (jsonroot_${tmp}) {')
 				if field.typ.has_flag(.option) {
 					dec.writeln('\t\tif (!(cJSON_IsNull(jsonroot_${tmp}))) {\n')
@@ -818,7 +825,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 				parent_dec_name := js_dec_name(sparent_type)
 				if is_js_prim(sparent_type) {
 					tmp := g.new_tmp_var()
-					gen_js_get(styp, tmp, name, mut dec, is_required)
+					g.gen_js_get(styp, tmp, name, mut dec, is_required)
 					dec.writeln('\tif (jsonroot_${tmp}) {')
 					g.gen_prim_type_validation(field.name, parent_type, tmp, is_required,
 						'${result_name}_${styp}', mut dec)
@@ -832,7 +839,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 				} else {
 					g.gen_json_for_type(parent_type)
 					tmp := g.new_tmp_var()
-					gen_js_get_opt(dec_name, field_type, styp, tmp, name, mut dec, is_required)
+					g.gen_js_get_opt(dec_name, field_type, styp, tmp, name, mut dec, is_required)
 					dec.writeln('\tif (jsonroot_${tmp}) {')
 					dec.writeln('\t\t${prefix}${op}${c_name(field.name)} = *(${field_type}*) ${tmp}.data;')
 					if field.has_default_expr {
@@ -860,7 +867,7 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 					}
 				}
 				tmp := g.new_tmp_var()
-				gen_js_get_opt(dec_name, field_type, styp, tmp, name, mut dec, is_required)
+				g.gen_js_get_opt(dec_name, field_type, styp, tmp, name, mut dec, is_required)
 				dec.writeln('\tif (jsonroot_${tmp}) {')
 				if is_js_prim(g.styp(field.typ.clear_option_and_result())) {
 					g.gen_prim_type_validation(field.name, field.typ, tmp, is_required,
@@ -1003,8 +1010,95 @@ fn (mut g Gen) gen_struct_enc_dec(utyp ast.Type, type_info ast.TypeInfo, styp st
 	}
 }
 
-fn gen_js_get(styp string, tmp string, name string, mut dec strings.Builder, is_required bool) {
-	dec.writeln('\tcJSON *jsonroot_${tmp} = js_get(root, "${name}");')
+// gen_json_field_table generates the code, that collects the members of the JSON object `root`
+// into the local array `jsonfields`, in a single pass, so that the struct decoder does not have to
+// search the members again for each field (cJSON_GetObjectItemCaseSensitive is a linear search).
+// The keys are dispatched by their length first, so most of them are compared only once.
+// Like js_get, the first member with a given key wins.
+fn (mut g Gen) gen_json_field_table(info ast.Struct, mut dec strings.Builder) {
+	g.json_field_slots.clear()
+	mut names := []string{}
+	g.collect_json_field_names(info, mut names)
+	if names.len == 0 {
+		return
+	}
+	mut names_by_len := map[int][]string{}
+	for i, name in names {
+		g.json_field_slots[name] = i
+		names_by_len[name.len] << name
+	}
+	dec.writeln('\tcJSON* jsonfields[${names.len}] = {0};')
+	dec.writeln('\tfor (cJSON* jsonfield = root ? root->child : NULL; jsonfield != NULL; jsonfield = jsonfield->next) {')
+	dec.writeln('\t\tif (jsonfield->string == NULL) {')
+	dec.writeln('\t\t\tcontinue;')
+	dec.writeln('\t\t}')
+	dec.writeln('\t\tint jsonfield_idx = -1;')
+	dec.writeln('\t\tswitch (strlen(jsonfield->string)) {')
+	mut lens := names_by_len.keys()
+	lens.sort()
+	for len in lens {
+		dec.writeln('\t\tcase ${len}:')
+		for name in names_by_len[len] {
+			dec.writeln('\t\t\tif (memcmp(jsonfield->string, "${name}", ${len}) == 0) {')
+			dec.writeln('\t\t\t\tjsonfield_idx = ${g.json_field_slots[name]};')
+			dec.writeln('\t\t\t}')
+		}
+		dec.writeln('\t\t\tbreak;')
+	}
+	dec.writeln('\t\t}')
+	dec.writeln('\t\tif (jsonfield_idx != -1 && jsonfields[jsonfield_idx] == NULL) {')
+	dec.writeln('\t\t\tjsonfields[jsonfield_idx] = jsonfield;')
+	dec.writeln('\t\t}')
+	dec.writeln('\t}')
+}
+
+// collect_json_field_names appends the JSON keys, that gen_struct_enc_dec looks up for the fields
+// of `info` (including the ones of its embedded structs), to `names`, without duplicates
+fn (mut g Gen) collect_json_field_names(info ast.Struct, mut names []string) {
+	for field in info.fields {
+		mut name := field.name
+		mut is_skip := false
+		for attr in field.attrs {
+			match attr.name {
+				'json' {
+					if attr.arg == '-' {
+						is_skip = true
+					} else {
+						name = attr.arg
+					}
+				}
+				'skip' {
+					is_skip = true
+				}
+				else {}
+			}
+		}
+		if is_skip {
+			continue
+		}
+		if name !in names {
+			names << name
+		}
+		if field.is_embed {
+			field_sym := g.table.sym(field.typ)
+			if field_sym.info is ast.Struct && field.typ in info.embeds {
+				g.collect_json_field_names(field_sym.info, mut names)
+			}
+		}
+	}
+}
+
+// js_get_expr returns the C expression, that gets the member `name` of the JSON object `root`
+@[inline]
+fn (g &Gen) js_get_expr(name string) string {
+	if idx := g.json_field_slots[name] {
+		return 'jsonfields[${idx}]'
+	}
+	return 'js_get(root, "${name}")'
+}
+
+fn (mut g Gen) gen_js_get(styp string, tmp string, name string, mut dec strings.Builder, is_required bool) {
+	dec.writeln('\tcJSON *jsonroot_${tmp} = ${g.js_get_expr(name)};')
 	if is_required {
 		dec.writeln('\tif (jsonroot_${tmp} == 0) {')
 		dec.writeln('\t\treturn (${result_name}_${styp}){ .is_error = true, .err = builtin___v_error(_S("expected field \'${name}\' is missing")), .data = {0} };')
@@ -1012,9 +1106,9 @@ fn gen_js_get(styp string, tmp string, name string, mut dec strings.Builder, is_
 	}
 }
 
-fn gen_js_get_opt(dec_name string, field_type string, styp string, tmp string, name string, mut dec strings.Builder,
+fn (mut g Gen) gen_js_get_opt(dec_name string, field_type string, styp string, tmp string, name string, mut dec strings.Builder,
 	is_required bool) {
-	gen_js_get(styp, tmp, name, mut dec, is_required)
+	g.gen_js_get(styp, tmp, name, mut dec, is_required)
 	value_field_type := field_type.replace('*', '_ptr')
 	dec.writeln('\t${result_name}_${value_field_type.replace('*', '_ptr')} ${tmp} = {0};')
 	dec.writeln('\tif (jsonroot_${tmp}) {')
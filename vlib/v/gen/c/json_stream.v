@@ -0,0 +1,270 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+module c
+
+import v.ast
+import strings
+
+// The streaming json decoders parse the text with a json.Stream, directly into the V values,
+// without building a cJSON tree first. json.decode uses them for the structs and arrays, that
+// json_stream_supported accepts, and falls back to cJSON, when they fail:
+// ```
+// _result_User json__stream_decode_User(string text) {
+//     json__Stream js = json__new_stream(text);
+//     User res;
+//     if (json__stream_User(&js, &res)) {
+//         return ok(res);
+//     }
+//     return json__decode_User(json__json_parse(text));
+// }
+// ```
+
+// json_stream_supported reports whether json.decode can decode `typ` with the streaming decoders
+fn (mut g Gen) json_stream_supported(typ ast.Type) bool {
+	utyp := g.unwrap_generic(typ)
+	if supported := g.json_stream_types[utyp] {
+		return supported
+	}
+	sym := g.table.sym(utyp)
+	mut visiting := map[ast.Type]bool{}
+	supported := sym.kind in [.struct, .array] && g.json_stream_check(utyp, mut visiting)
+	g.json_stream_types[utyp] = supported
+	return supported
+}
+
+// json_stream_check reports whether the streaming decoders decode `typ` like the cJSON based ones.
+// These are the numbers, bools, strings, and the structs and arrays of them. Everything else
+// (options, pointers, aliases, enums, maps, sum types, time.Time, fixed arrays, embedded structs,
+// `@[raw]` fields, and several fields with the same key) is decoded only with cJSON.
+fn (mut g Gen) json_stream_check(typ ast.Type, mut visiting map[ast.Type]bool) bool {
+	if typ.has_option_or_result() || typ.is_any_kind_of_pointer() || typ.has_flag(.generic) {
+		return false
+	}
+	styp := vint2int(g.styp(typ))
+	if is_js_prim(styp) {
+		// a rune is decoded from a string
+		return styp != 'rune'
+	}
+	if typ in visiting {
+		// a recursive type, like `struct Node { children []Node }`
+		return true
+	}
+	visiting[typ] = true
+	sym := g.table.sym(typ)
+	if sym.info is ast.Array {
+		return sym.kind == .array && g.json_stream_check(sym.info.elem_type, mut visiting)
+	}
+	if sym.kind != .struct || sym.info !is ast.Struct || sym.name == 'time.Time' {
+		return false
+	}
+	info := sym.info as ast.Struct
+	if info.is_union || info.embeds.len > 0 {
+		return false
+	}
+	mut names := []string{}
+	for field in info.fields {
+		name, is_skip := json_field_name(field)
+		if is_skip {
+			continue
+		}
+		if name in names || field.attrs.contains('raw') || !g.json_stream_check(field.typ, mut visiting) {
+			return false
+		}
+		names << name
+	}
+	return true
+}
+
+// json_field_name returns the JSON key of a struct field, and whether it is skipped
+fn json_field_name(field ast.StructField) (string, bool) {
+	mut name := field.name
+	for attr in field.attrs {
+		match attr.name {
+			'json' {
+				if attr.arg == '-' {
+					return name, true
+				}
+				name = attr.arg
+			}
+			'skip' {
+				return name, true
+			}
+			else {}
+		}
+	}
+	return name, false
+}
+
+fn js_stream_name(typ string) string {
+	return js_dec_name(typ).replace_once('json__decode_', 'json__stream_')
+}
+
+fn js_stream_dec_name(typ string) string {
+	return js_dec_name(typ).replace_once('json__decode_', 'json__stream_decode_')
+}
+
+// gen_json_stream_decoder generates `json__stream_T`, that decodes a `T` value from a json.Stream,
+// and `json__stream_decode_T`, that json.decode calls. `init_styp` declares `res`, with the default value.
+fn (mut g Gen) gen_json_stream_decoder(utyp ast.Type, sym ast.TypeSymbol, init_styp string) {
+	styp := g.styp(utyp)
+	ret_styp := styp.replace('*', '_ptr')
+	fn_name := js_stream_name(styp)
+	fn_dec := 'bool ${fn_name}(json__Stream* js, ${styp}* out)'
+	entry_dec := '${result_name}_${ret_styp} ${js_stream_dec_name(styp)}(string text)'
+	extern_str := if g.pref.parallel_cc { 'extern ' } else { '' }
+	g.json_forward_decls.writeln('${extern_str}${fn_dec};')
+	g.json_forward_decls.writeln('${extern_str}${entry_dec};')
+	mut dec := strings.new_builder(100)
+	dec.writeln('${fn_dec} {')
+	dec.writeln('\t${init_styp};')
+	if sym.info is ast.Struct {
+		g.gen_json_stream_struct(sym.info, mut dec)
+	} else {
+		g.gen_json_stream_array(utyp, mut dec)
+	}
+	dec.writeln('\t*out = res;')
+	dec.writeln('\treturn true;')
+	dec.writeln('}')
+	dec.writeln('
+${entry_dec} {
+	json__Stream js = json__new_stream(text);
+	${styp} res;
+	if (${fn_name}(&js, &res)) {
+		${result_name}_${ret_styp} ret;
+		builtin___result_ok(&res, (${result_name}*)&ret, sizeof(res));
+		return ret;
+	}
+	// invalid JSON, or values that only the cJSON based decoder handles, or reports as errors
+	cJSON* root = json__json_parse(text);
+	${result_name}_${ret_styp} ret = ${js_dec_name(styp)}(root);
+	cJSON_Delete(root);
+	return ret;
+}')
+	g.gowrappers.writeln(dec.str())
+}
+
+// gen_json_stream_struct generates the body of `json__stream_T` for a struct. The keys are dispatched
+// by their length first, like in gen_json_field_table, and the first member with a given key wins.
+fn (mut g Gen) gen_json_stream_struct(info ast.Struct, mut dec strings.Builder) {
+	mut fields := []ast.StructField{}
+	mut names := []string{}
+	for field in info.fields {
+		name, is_skip := json_field_name(field)
+		if !is_skip {
+			fields << field
+			names << name
+		}
+	}
+	if fields.len > 0 {
+		dec.writeln('\tu8 jsonseen[${fields.len}] = {0};')
+	}
+	dec.writeln("\tint jsonmore = json__Stream_begin(js, '{', '}');")
+	dec.writeln('\twhile (jsonmore > 0) {')
+	dec.writeln('\t\tstring jsonkey;')
+	dec.writeln('\t\tif (!json__Stream_key(js, &jsonkey)) {')
+	dec.writeln('\t\t\treturn false;')
+	dec.writeln('\t\t}')
+	if fields.len > 0 {
+		dec.writeln('\t\tint jsonfield_idx = -1;')
+		mut idxs_by_len := map[int][]int{}
+		for i, name in names {
+			idxs_by_len[name.len] << i
+		}
+		mut lens := idxs_by_len.keys()
+		lens.sort()
+		dec.writeln('\t\tswitch (jsonkey.len) {')
+		for len in lens {
+			dec.writeln('\t\tcase ${len}:')
+			for i in idxs_by_len[len] {
+				dec.writeln('\t\t\tif (memcmp(jsonkey.str, "${names[i]}", ${len}) == 0) {')
+				dec.writeln('\t\t\t\tjsonfield_idx = ${i};')
+				dec.writeln('\t\t\t}')
+			}
+			dec.writeln('\t\t\tbreak;')
+		}
+		dec.writeln('\t\t}')
+		dec.writeln('\t\tif (jsonfield_idx != -1 && !jsonseen[jsonfield_idx]) {')
+		dec.writeln('\t\t\tjsonseen[jsonfield_idx] = 1;')
+		dec.writeln('\t\t\tswitch (jsonfield_idx) {')
+		for i, field in fields {
+			dec.writeln('\t\t\tcase ${i}: {')
+			g.gen_json_stream_value(field.typ, 'res.${c_name(field.name)}', '\t\t\t\t', mut
+				dec)
+			dec.writeln('\t\t\t\tbreak;')
+			dec.writeln('\t\t\t}')
+		}
+		dec.writeln('\t\t\t}')
+		// the unknown keys, and the duplicates of the known ones
+		dec.writeln('\t\t} else if (!json__Stream_skip(js)) {')
+	} else {
+		dec.writeln('\t\tif (!json__Stream_skip(js)) {')
+	}
+	dec.writeln('\t\t\treturn false;')
+	dec.writeln('\t\t}')
+	dec.writeln("\t\tjsonmore = json__Stream_next(js, '}');")
+	dec.writeln('\t}')
+	dec.writeln('\tif (jsonmore < 0) {')
+	dec.writeln('\t\treturn false;')
+	dec.writeln('\t}')
+	for i, field in fields {
+		if field.attrs.contains('required') {
+			// the cJSON based decoder reports the missing field
+			dec.writeln('\tif (!jsonseen[${i}]) {')
+			dec.writeln('\t\treturn false;')
+			dec.writeln('\t}')
+		} else if field.has_default_expr {
+			// like the cJSON based decoder, assign the default value again
+			dec.writeln('\tif (!jsonseen[${i}]) {')
+			default_str := g.expr_string_opt(field.typ, field.default_expr)
+			if default_str.count(';\n') > 1 {
+				dec.writeln(default_str.all_before_last('\n'))
+				dec.writeln('\t\tres.${c_name(field.name)} = ${default_str.all_after_last('\n')};')
+			} else {
+				dec.writeln('\t\tres.${c_name(field.name)} = ${default_str};')
+			}
+			dec.writeln('\t}')
+		}
+	}
+}
+
+// gen_json_stream_array generates the body of `json__stream_T` for an array
+fn (mut g Gen) gen_json_stream_array(utyp ast.Type, mut dec strings.Builder) {
+	value_type := g.table.value_type(utyp)
+	styp := g.styp(value_type)
+	noscan := g.check_noscan(value_type)
+	dec.writeln("\tint jsonmore = json__Stream_begin(js, '[', ']');")
+	dec.writeln('\tif (jsonmore < 0) {')
+	dec.writeln('\t\treturn false;')
+	dec.writeln('\t}')
+	dec.writeln('\tres = builtin____new_array${noscan}(0, 0, sizeof(${styp}));')
+	dec.writeln('\twhile (jsonmore > 0) {')
+	dec.writeln('\t\t${styp} val;')
+	g.gen_json_stream_value(value_type, 'val', '\t\t', mut dec)
+	dec.writeln('\t\tbuiltin__array_push${noscan}((array*)&res, &val);')
+	dec.writeln("\t\tjsonmore = json__Stream_next(js, ']');")
+	dec.writeln('\t}')
+	dec.writeln('\tif (jsonmore < 0) {')
+	dec.writeln('\t\treturn false;')
+	dec.writeln('\t}')
+}
+
+// gen_json_stream_value generates the code, that decodes a `typ` value from `js` into `target`.
+// The numbers are converted by the same decode_T functions, that the cJSON based decoders use.
+fn (mut g Gen) gen_json_stream_value(typ ast.Type, target string, indent string, mut dec strings.Builder) {
+	styp := vint2int(g.styp(typ))
+	if typ.is_string() {
+		dec.writeln('${indent}if (!json__Stream_string_value(js, &${target})) {')
+	} else if typ.is_bool() {
+		dec.writeln('${indent}if (!json__Stream_bool_value(js, &${target})) {')
+	} else if is_js_prim(styp) {
+		dec.writeln('${indent}cJSON jsonnum = {0};')
+		dec.writeln('${indent}if (json__Stream_number(js, &jsonnum)) {')
+		dec.writeln('${indent}\t${target} = ${js_dec_name(styp)}(&jsonnum);')
+		dec.writeln('${indent}} else {')
+	} else {
+		dec.writeln('${indent}if (!${js_stream_name(styp)}(js, &${target})) {')
+	}
+	dec.writeln('${indent}\treturn false;')
+	dec.writeln('${indent}}')
+}
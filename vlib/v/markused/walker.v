@@ -88,6 +88,7 @@ mut:
 	uses_arr_getter            bool
 	uses_arr_clone             bool
 	uses_arr_sorted            bool
+	uses_arr_sort              bool
 	uses_type_name             bool // sum_type.type_name()
 }
 
@@ -150,6 +151,8 @@ pub fn (mut w Walker) mark_global_as_used(ckey string) {
 	w.table.used_features.used_attr_weak = w.table.used_features.used_attr_weak || gfield.is_weak
 	w.table.used_features.used_attr_hidden = w.table.used_features.used_attr_hidden
 		|| gfield.is_hidden || gfield.is_hidden
+	w.table.used_features.used_thread_local = w.table.used_features.used_thread_local
+		|| gfield.is_thread_local
 	w.expr(gfield.expr)
 	if !gfield.has_expr {
 		w.mark_by_type(gfield.typ)
@@ -477,6 +480,14 @@ fn (mut w Walker) expr(node_ ast.Expr) {
 				&& node.left_type != 0 && w.table.final_sym(node.left_type).kind == .array {
 				w.uses_arr_sorted = true
 			}
+			if node.is_method && node.name in ['sort', 'sorted'] && !w.uses_arr_sort
+				&& node.left_type != 0
+				&& w.table.final_sym(node.left_type).kind in [.array, .array_fixed] {
+				// the generated sort functions allocate the buffers of the radix sort
+				w.uses_arr_sort = true
+				w.fn_by_name('malloc')
+				w.fn_by_name('free')
+			}
 			if !w.is_builtin_mod && !w.uses_external_type {
 				if node.is_method {
 					w.uses_external_type = node.mod == 'builtin'
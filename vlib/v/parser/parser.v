@@ -11,6 +11,7 @@ import v.util
 import v.errors
 import os
 import hash.fnv1a
+import sync.pool
 import strings
 
 @[minify]
@@ -289,14 +290,26 @@ pub fn parse_file(path string, mut table ast.Table, comments_mode scanner.Commen
 	$if trace_parse_file ? {
 		eprintln('> ${@MOD}.${@FN} comments_mode: ${comments_mode:-20} | path: ${path}')
 	}
+	file_idx := register_file_path(mut table, path)
+	s := scanner.new_scanner_file(path, file_idx, comments_mode, pref_) or { panic(err) }
+	return parse_scanned_file(path, s, mut table, pref_)
+}
+
+// register_file_path returns the index of `path` in `table.filelist`, adding it when needed
+fn register_file_path(mut table ast.Table, path string) i16 {
 	mut file_idx := i16(table.filelist.index(path))
 	if file_idx == -1 {
 		file_idx = i16(table.filelist.len)
 		table.filelist << path
 	}
+	return file_idx
+}
+
+// parse_scanned_file parses the tokens of a file, that was already scanned by `s`
+fn parse_scanned_file(path string, s &scanner.Scanner, mut table ast.Table, pref_ &pref.Preferences) &ast.File {
 	mut p := Parser{
 		content: .file
-		scanner: scanner.new_scanner_file(path, file_idx, comments_mode, pref_) or { panic(err) }
+		scanner: s
 		table:   table
 		pref:    pref_
 		// Only set vls mode if it's the file the user requested via `v -vls-mode file.v`
@@ -309,7 +322,7 @@ pub fn parse_file(path string, mut table ast.Table, comments_mode scanner.Commen
 		}
 		errors:           []errors.Error{}
 		warnings:         []errors.Warning{}
-		file_idx:         file_idx
+		file_idx:         s.file_idx
 	}
 	p.set_path(path)
 	res := p.parse()
@@ -420,16 +433,28 @@ pub fn (mut p Parser) parse() &ast.File {
 	return ast_file
 }
 
+// parse_files scans the files in `paths` on several threads (see scan_files_in_parallel), then
+// parses them sequentially, in order, into `table`.
+// Note: parsing on worker threads is not supported. It would need a separate table per thread,
+// and a deterministic merge of the registered types, functions and file indexes afterwards,
+// and the parser assumes a single shared `ast.Table` throughout.
 pub fn parse_files(paths []string, mut table ast.Table, pref_ &pref.Preferences) []&ast.File {
 	mut timers := util.new_timers(should_print: false, label: 'parse_files: ${paths}')
 	$if time_parsing ? {
 		timers.should_print = true
 	}
 	unsafe {
+		scanners := scan_files_in_parallel(paths, mut table, pref_)
 		mut files := []&ast.File{cap: paths.len}
-		for path in paths {
+		for i, path in paths {
 			timers.start('parse_file ${path}')
-			files << parse_file(path, mut table, .skip_comments, pref_)
+			if i < scanners.len && !isnil(scanners[i]) {
+				mut s := scanners[i]
+				s.show_collected_messages(pref_)
+				files << parse_scanned_file(path, s, mut table, pref_)
+			} else {
+				files << parse_file(path, mut table, .skip_comments, pref_)
+			}
 			timers.show('parse_file ${path}')
 		}
 		handle_codegen_for_multiple_files(mut files)
@@ -437,6 +462,62 @@ pub fn parse_files(paths []string, mut table ast.Table, pref_ &pref.Preferences)
 	}
 }
 
+// parallel_scan_min_files is the minimum number of files, for which it is worth to start
+// the scanning threads
+const parallel_scan_min_files = 4
+
+struct ScanJob {
+	path     string
+	file_idx i16
+}
+
+// scan_files_in_parallel reads and tokenizes the files on all cores. Only the scanning is done
+// in parallel, since it does not depend on the table. The parser registers types, functions and
+// file indexes in the shared `ast.Table` while it goes, so the files are still parsed one by one,
+// in the same order as before, which keeps the table (and the generated code) deterministic.
+// It returns an empty array, when the files should be scanned one by one instead; a nil scanner
+// means that the file could not be read, and parse_file will report that.
+fn scan_files_in_parallel(paths []string, mut table ast.Table, pref_ &pref.Preferences) []&scanner.Scanner {
+	if pref_.no_parallel || pref_.is_vls || paths.len < parallel_scan_min_files {
+		return []
+	}
+	util.timing_start('SCAN PARALLEL')
+	defer {
+		util.timing_measure_cumulative('SCAN PARALLEL')
+	}
+	mut jobs := []ScanJob{cap: paths.len}
+	for path in paths {
+		// fill the source cache in this thread, the scanning threads only read from it
+		util.read_file(path) or {}
+		jobs << ScanJob{
+			path:     path
+			file_idx: register_file_path(mut table, path)
+		}
+	}
+	// the scanning threads only collect their messages; they are shown in the file order later,
+	// by show_collected_messages
+	mut silent_pref := *pref_
+	silent_pref.output_mode = .silent
+	silent_pref.fatal_errors = false
+	if pref_.output_mode == .stdout && !pref_.check_only {
+		silent_pref.message_limit = -1
+	}
+	mut pp := util.build_pool(scan_one_file_cb)
+	pp.set_shared_context(&silent_pref)
+	pp.work_on_items(jobs)
+	return pp.get_results_ref[scanner.Scanner]()
+}
+
+fn scan_one_file_cb(mut pp pool.PoolProcessor, idx int, wid int) &scanner.Scanner {
+	job := pp.get_item[ScanJob](idx)
+	silent_pref := unsafe { &pref.Preferences(pp.get_shared_context()) }
+	if !os.is_file(job.path) {
+		return unsafe { nil }
+	}
+	return scanner.new_scanner_file_for_thread(job.path, job.file_idx, .skip_comments,
+		silent_pref) or { unsafe { nil } }
+}
+
 fn (mut p Parser) init_parse_fns() {
 	// p.prefix_parse_fns = make(100, 100, sizeof(PrefixParseFn))
 	// p.prefix_parse_fns[token.Kind.name] = parse_name
@@ -2746,6 +2827,7 @@ fn (mut p Parser) global_decl() ast.GlobalDecl {
 	mut is_weak := false
 	mut is_hidden := false
 	mut is_extern := false
+	mut is_thread_local := false
 	for ga in attrs {
 		match ga.name {
 			'export' { is_exported = true }
@@ -2753,6 +2835,7 @@ fn (mut p Parser) global_decl() ast.GlobalDecl {
 			'weak' { is_weak = true }
 			'hidden' { is_hidden = true }
 			'c_extern' { is_extern = true }
+			'thread_local' { is_thread_local = true }
 			else {}
 		}
 	}
@@ -2828,20 +2911,21 @@ fn (mut p Parser) global_decl() ast.GlobalDecl {
 			name = 'C.' + name
 		}
 		field := ast.GlobalField{
-			name:        name
-			has_expr:    has_expr
-			expr:        expr
-			pos:         pos
-			typ_pos:     typ_pos
-			typ:         typ
-			comments:    comments
-			is_markused: is_markused
-			is_volatile: is_volatile
-			is_exported: is_exported
-			is_weak:     is_weak
-			is_hidden:   is_hidden
-			is_extern:   is_extern
-			language:    language
+			name:            name
+			has_expr:        has_expr
+			expr:            expr
+			pos:             pos
+			typ_pos:         typ_pos
+			typ:             typ
+			comments:        comments
+			is_markused:     is_markused
+			is_volatile:     is_volatile
+			is_exported:     is_exported
+			is_weak:         is_weak
+			is_hidden:       is_hidden
+			is_extern:       is_extern
+			is_thread_local: is_thread_local
+			language:        language
 		}
 		fields << field
 		if name !in ast.global_reserved_type_names {
@@ -316,6 +316,29 @@ fn test_parse_with_stdout() {
 	parse(.stdout)!
 }
 
+fn test_parse_files_in_parallel() ! {
+	mut files := []string{}
+	scan_v(mut files, os.join_path(vroot, 'vlib/v/parser'))!
+	scan_v(mut files, os.join_path(vroot, 'vlib/v/scanner'))!
+	assert files.len >= parallel_scan_min_files
+	mut sequential_pref := pref.new_preferences()
+	sequential_pref.no_parallel = true
+	mut sequential_table := ast.new_table()
+	sequential := parse_files(files, mut sequential_table, sequential_pref)
+	mut parallel_table := ast.new_table()
+	parallel := parse_files(files, mut parallel_table, pref.new_preferences())
+	assert parallel_table.filelist == sequential_table.filelist
+	assert parallel.len == sequential.len
+	for i, f in parallel {
+		assert f.path == sequential[i].path
+		assert f.nr_tokens == sequential[i].nr_tokens
+		assert f.stmts.len == sequential[i].stmts.len
+		assert f.errors.len == 0
+	}
+	assert parallel_table.type_symbols.len == sequential_table.type_symbols.len
+	assert parallel_table.fns.len == sequential_table.fns.len
+}
+
 fn test_parse_vls_info() {
 	println(@LOCATION)
 	source_text := '
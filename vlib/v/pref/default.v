@@ -229,9 +229,10 @@ pub fn (mut p Preferences) fill_with_defaults() {
 		p.bare_builtin_dir = os.join_path(p.vroot, 'vlib', 'builtin', 'linux_bare')
 	}
 
-	$if prealloc {
+	$if prealloc && tinyc {
+		// with tcc, the -prealloc memory blocks are shared by all threads, see vlib/builtin/prealloc.c.v
 		if !p.no_parallel && p.is_verbose {
-			eprintln('disabling parallel cgen, since V was built with -prealloc')
+			eprintln('disabling parallel cgen, since V was built with -prealloc and tcc')
 		}
 		p.no_parallel = true
 	}
@@ -113,7 +113,27 @@ pub fn new_scanner_file(file_path string, file_idx i16, comments_mode CommentsMo
 		return error('${file_path} is not a .v file')
 	}
 	raw_text := util.read_file(file_path) or { return err }
-	mut s := &Scanner{
+	mut s := new_file_scanner(file_path, raw_text, file_idx, comments_mode, pref_)
+	s.scan_all_tokens_in_buffer()
+	return s
+}
+
+// new_scanner_file_for_thread is like new_scanner_file, but several files can be
+// scanned with it at once, on different threads. It does not use the global timers,
+// and `silent_pref` should have `output_mode: .silent`, so that the messages are only
+// collected. Show them later with `show_collected_messages`, in the main thread.
+// Note: the file should already be read with `util.read_file`, since its cache is not
+// safe to update from several threads.
+pub fn new_scanner_file_for_thread(file_path string, file_idx i16, comments_mode CommentsMode, silent_pref &pref.Preferences) !&Scanner {
+	raw_text := util.read_file(file_path) or { return err }
+	mut s := new_file_scanner(file_path, raw_text, file_idx, comments_mode, silent_pref)
+	s.scan_remaining_text()
+	s.tidx = 0
+	return s
+}
+
+fn new_file_scanner(file_path string, raw_text string, file_idx i16, comments_mode CommentsMode, pref_ &pref.Preferences) &Scanner {
+	return &Scanner{
 		pref:                        pref_
 		text:                        raw_text
 		all_tokens:                  []token.Token{cap: raw_text.len / 3}
@@ -126,8 +146,46 @@ pub fn new_scanner_file(file_path string, file_idx i16, comments_mode CommentsMo
 		file_base:                   os.base(file_path)
 		file_idx:                    file_idx
 	}
-	s.scan_all_tokens_in_buffer()
-	return s
+}
+
+// show_collected_messages switches a scanner created by `new_scanner_file_for_thread`
+// to `pref_`, and shows the messages it collected, like they would have been shown
+// while scanning with `pref_`, i.e. it exits after the first error.
+pub fn (mut s Scanner) show_collected_messages(pref_ &pref.Preferences) {
+	s.pref = pref_
+	if pref_.output_mode != .stdout || pref_.check_only {
+		// the messages are kept in the scanner, and are added to the ast.File by the parser
+		if pref_.fatal_errors && s.errors.len > 0 {
+			util.show_compiler_message('error:', s.errors[0].CompilerMessage)
+			exit(1)
+		}
+		return
+	}
+	// messages after the first error were never shown, since the scanner exits there
+	first_error_pos := if s.errors.len > 0 { s.errors[0].pos.pos } else { max_int }
+	// the notices and warnings are shown in source order, like the scanner shows them
+	mut ni := 0
+	mut wi := 0
+	for ni < s.notices.len || wi < s.warnings.len {
+		if wi >= s.warnings.len
+			|| (ni < s.notices.len && s.notices[ni].pos.pos <= s.warnings[wi].pos.pos) {
+			if s.notices[ni].pos.pos < first_error_pos {
+				util.show_compiler_message('notice:', s.notices[ni].CompilerMessage)
+			}
+			ni++
+		} else {
+			if s.warnings[wi].pos.pos < first_error_pos {
+				util.show_compiler_message('warning:', s.warnings[wi].CompilerMessage)
+			}
+			wi++
+		}
+	}
+	s.notices.clear()
+	s.warnings.clear()
+	if s.errors.len > 0 {
+		util.show_compiler_message('error:', s.errors[0].CompilerMessage)
+		exit(1)
+	}
 }
 
 const internally_generated_v_code = 'internally_generated_v_code'
@@ -0,0 +1,27 @@
+// vtest build: !tinyc
+@[has_globals]
+module main
+
+@[thread_local]
+__global tl_counter int
+
+__global shared_counter int
+
+fn count_in_thread(n int) int {
+	for _ in 0 .. n {
+		tl_counter++
+	}
+	return tl_counter
+}
+
+fn test_thread_local_globals_are_separate_for_each_thread() {
+	tl_counter = 100
+	shared_counter = 5
+	t1 := spawn count_in_thread(10)
+	t2 := spawn count_in_thread(20)
+	assert t1.wait() == 10
+	assert t2.wait() == 20
+	assert tl_counter == 100
+	assert count_in_thread(1) == 101
+	assert shared_counter == 5
+}
@@ -0,0 +1,23 @@
+// Copyright (c) 2019-2024 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+@[has_globals]
+module util
+
+import sync.pool
+
+__global g_build_pool = &pool.PoolProcessor(unsafe { nil })
+
+// build_pool returns the worker threads of the compiler, set up to run `callback` for each item.
+// The parallel stages of a build (the scanning, cgen, and the C compilation with -parallel-cc)
+// run one after the other, so they share this pool, and its threads are started once per process.
+// Note: it is not meant to be used by several threads at the same time.
+pub fn build_pool(callback pool.ThreadCB) &pool.PoolProcessor {
+	if g_build_pool == unsafe { nil } {
+		g_build_pool = pool.new_pool_processor(callback: callback, persistent: true)
+	}
+	g_build_pool.set_callback(callback)
+	g_build_pool.set_max_jobs(0)
+	g_build_pool.set_shared_context(unsafe { nil })
+	return g_build_pool
+}
@@ -6,6 +6,7 @@ module arm64
 
 import v2.ssa
 import v2.types
+import v2.gen.regalloc
 import encoding.binary
 
 pub struct Gen {
@@ -1389,14 +1390,6 @@ fn (mut g Gen) emit_mov_reg(rd int, rm int) {
 	g.emit(asm_mov_reg(Reg(rd), Reg(rm)))
 }
 
-struct Interval {
-mut:
-	val_id   int
-	start    int
-	end      int
-	has_call bool
-}
-
 // Calculate the size of a type in bytes
 fn (g Gen) type_size(typ_id ssa.TypeID) int {
 	if typ_id == 0 {
@@ -1474,172 +1467,31 @@ fn (g &Gen) lookup_struct_from_env(name string) ?types.Struct {
 	return none
 }
 
-fn (mut g Gen) allocate_registers(func ssa.Function) {
-	mut intervals := map[int]&Interval{}
-	mut call_indices := []int{}
-	mut instr_idx := 0
-
-	// Map block index to instruction range
-	mut block_start := map[int]int{}
-	mut block_end := map[int]int{}
-
-	for pid in func.params {
-		intervals[pid] = &Interval{
-			val_id: pid
-			start:  0
-			end:    0
-		}
-	}
-
-	for blk_id in func.blocks {
-		blk := g.mod.blocks[blk_id]
-		block_start[blk_id] = instr_idx
-		for val_id in blk.instrs {
-			val := g.mod.values[val_id]
-			if val.kind == .instruction || val.kind == .argument {
-				// Check if this is a call with indirect struct return (> 16 bytes)
-				// These values must stay on the stack - don't register-allocate them
-				mut skip_interval := false
-				if val.kind == .instruction {
-					instr := g.mod.instrs[val.index]
-					if instr.op == .call {
-						result_typ := g.mod.type_store.types[val.typ]
-						if result_typ.kind == .struct_t {
-							result_size := g.type_size(val.typ)
-							if result_size > 16 {
-								skip_interval = true
-							}
-						}
-					}
-				}
-
-				if !skip_interval && unsafe { intervals[val_id] == nil } {
-					intervals[val_id] = &Interval{
-						val_id: val_id
-						start:  instr_idx
-						end:    instr_idx
-					}
-				}
-			}
-
-			instr := g.mod.instrs[val.index]
-			if instr.op == .call {
-				call_indices << instr_idx
-			}
-
-			for op in instr.operands {
-				if g.mod.values[op].kind in [.instruction, .argument] {
-					if mut interval := intervals[op] {
-						if instr_idx > interval.end {
-							interval.end = instr_idx
-						}
-					}
-				}
-			}
-			instr_idx++
-		}
-		block_end[blk_id] = instr_idx
-	}
-
-	// Conservative approach: don't register-allocate values that cross block boundaries
-	// This is slower but correct for loops
-	mut block_of_def := map[int]int{}
-	for blk_id in func.blocks {
-		blk := g.mod.blocks[blk_id]
-		for val_id in blk.instrs {
-			block_of_def[val_id] = blk_id
-		}
-	}
+// Registers
+// Caller-saved (Temporaries): x11..x15; values live across calls are not kept in them
+// Callee-saved (Preserved): x19..x28
+// Reserve x8 and x9 as backend scratch registers
+// x10 is reserved as scratch for large offset operations
+const regalloc_config = regalloc.Config{
+	caller_saved: [11, 12, 13, 14, 15]
+	callee_saved: [19, 20, 21, 22, 23, 24, 25, 26, 27, 28]
+}
 
-	// Mark values used in different blocks than defined - extend to entire function
-	total_instrs := instr_idx
+fn (mut g Gen) allocate_registers(func ssa.Function) {
+	// Calls with indirect struct return (> 16 bytes) must keep their result on the stack
+	mut skip := map[int]bool{}
 	for blk_id in func.blocks {
-		blk := g.mod.blocks[blk_id]
-		for val_id in blk.instrs {
+		for val_id in g.mod.blocks[blk_id].instrs {
 			val := g.mod.values[val_id]
-			if val.kind != .instruction {
+			if val.kind != .instruction || g.mod.instrs[val.index].op != .call {
 				continue
 			}
-			instr := g.mod.instrs[val.index]
-			for op in instr.operands {
-				if g.mod.values[op].kind in [.instruction, .argument] {
-					if def_blk := block_of_def[op] {
-						if def_blk != blk_id {
-							// Value crosses block boundary - extend to entire function
-							if mut interval := intervals[op] {
-								interval.end = total_instrs
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	// Mark intervals that cross a function call
-	for _, mut interval in intervals {
-		for call_idx in call_indices {
-			if interval.start < call_idx && interval.end > call_idx {
-				interval.has_call = true
-				break
-			}
-		}
-	}
-
-	mut sorted := []&Interval{cap: intervals.len}
-	for _, i in intervals {
-		sorted << i
-	}
-	sorted.sort(a.start < b.start)
-
-	mut active := []&Interval{cap: 32}
-
-	// Registers
-	// Caller-saved (Temporaries): x9..x15
-	// Callee-saved (Preserved): x19..x28
-	// Reserve x8 and x9 as backend scratch registers
-	// x10 is reserved as scratch for large offset operations
-	short_regs := [11, 12, 13, 14, 15]
-	long_regs := [19, 20, 21, 22, 23, 24, 25, 26, 27, 28]
-
-	// Reusable arrays to avoid allocation in the hot loop
-	mut used := []bool{len: 32, init: false}
-	mut used_regs_set := []bool{len: 32, init: false}
-
-	for i in sorted {
-		// Remove expired intervals from active list
-		mut j := 0
-		for j < active.len {
-			if active[j].end < i.start {
-				active.delete(j)
-			} else {
-				j++
-			}
-		}
-
-		// Reset used array
-		for k in 0 .. 32 {
-			used[k] = false
-		}
-		for a in active {
-			used[g.reg_map[a.val_id]] = true
-		}
-
-		// Decide which pool to use (avoid clone)
-		pool := if i.has_call { long_regs } else { short_regs }
-
-		for r in pool {
-			if !used[r] {
-				g.reg_map[i.val_id] = r
-				active << i
-				// Only track used callee-saved regs for prologue saving
-				if r >= 19 && r <= 28 && !used_regs_set[r] {
-					used_regs_set[r] = true
-					g.used_regs << r
-				}
-				break
+			if g.mod.type_store.types[val.typ].kind == .struct_t && g.type_size(val.typ) > 16 {
+				skip[val_id] = true
 			}
 		}
 	}
-	g.used_regs.sort()
+	a := regalloc.allocate(g.mod, func, regalloc_config, skip)
+	g.reg_map = a.reg_map.clone()
+	g.used_regs = a.used_regs.clone()
 }
@@ -0,0 +1,105 @@
+// Numeric kernels for benchmarking the register allocation of the native backends.
+// They only use integers, locals, loops and calls, so that most of the time is spent
+// in the code, that the backend generates, and not in the runtime. The intermediate values
+// fit in 32 bits, so the results do not depend on the integer width of the backend.
+// Run the benchmark with: v run vlib/v2/gen/bench/run_bench.v [x64|arm64]
+
+fn sum_of_squares(n int) int {
+	mut sum := 0
+	for i := 0; i < n; i++ {
+		x := i % 10007
+		sum = (sum + x * x) % 1000000007
+	}
+	return sum
+}
+
+fn gcd(a int, b int) int {
+	mut x := a
+	mut y := b
+	for y != 0 {
+		t := x % y
+		x = y
+		y = t
+	}
+	return x
+}
+
+fn gcd_sum(n int) int {
+	mut sum := 0
+	for i := 1; i < n; i++ {
+		for j := 1; j < 64; j++ {
+			sum += gcd(i, j)
+		}
+	}
+	return sum
+}
+
+fn collatz_steps(n int) int {
+	mut total := 0
+	for i := 1; i < n; i++ {
+		mut x := i
+		for x != 1 {
+			if x % 2 == 0 {
+				x = x / 2
+			} else {
+				x = 3 * x + 1
+			}
+			total++
+		}
+	}
+	return total
+}
+
+fn count_primes(n int) int {
+	mut count := 0
+	for i := 2; i < n; i++ {
+		mut is_prime := 1
+		for d := 2; d * d <= i; d++ {
+			if i % d == 0 {
+				is_prime = 0
+				break
+			}
+		}
+		count += is_prime
+	}
+	return count
+}
+
+// lcg_mix keeps many values live across the loop, to put pressure on the allocator
+fn lcg_mix(n int) int {
+	mut a := 1
+	mut b := 2
+	mut c := 3
+	mut d := 4
+	mut e := 5
+	mut f := 6
+	mut g := 7
+	mut h := 8
+	for i := 0; i < n; i++ {
+		a = (a * 75 + 74) % 65537
+		b = (b + a) % 65521
+		c = (c ^ b) + i
+		d = (d + c * 3) % 1000003
+		e = (e * 7 + d) % 999983
+		f = (f + e - a % 17) % 104729
+		g = (g * 31 + f) % 65537
+		h = (h + g + b) % 1000000007
+	}
+	return (a + b + c + d + e + f + g + h) % 1000000007
+}
+
+fn fib(n int) int {
+	if n < 2 {
+		return n
+	}
+	return fib(n - 1) + fib(n - 2)
+}
+
+fn main() {
+	println(sum_of_squares(30000000))
+	println(gcd_sum(20000))
+	println(collatz_steps(100000))
+	println(count_primes(300000))
+	println(lcg_mix(20000000))
+	println(fib(30))
+}
@@ -0,0 +1,108 @@
+// Benchmark runner for the native backends of v2
+// Run with: ./v run vlib/v2/gen/bench/run_bench.v [x64|arm64] [runs]
+// It compiles kernels.v with v2 and with the reference compiler (-prod),
+// checks that both produce the same output, and compares their run times.
+
+module main
+
+import os
+import time
+
+fn main() {
+	vroot := os.dir(@VEXE)
+	v2_source := os.join_path(vroot, 'cmd', 'v2', 'v2.v')
+	v2_binary := os.join_path(vroot, 'cmd', 'v2', 'v2')
+	bench_dir := os.join_path(vroot, 'vlib', 'v2', 'gen', 'bench')
+	kernels := os.join_path(bench_dir, 'kernels.v')
+
+	mut backend := $if arm64 { 'arm64' } $else { 'x64' }
+	if os.args.contains('x64') {
+		backend = 'x64'
+	} else if os.args.contains('arm64') {
+		backend = 'arm64'
+	}
+	mut runs := 5
+	for arg in os.args[1..] {
+		if arg.int() > 0 {
+			runs = arg.int()
+		}
+	}
+
+	// Build v2 compiler
+	println('[*] Building v2...')
+	build_res := os.execute('${@VEXE} ${v2_source} -o ${v2_binary}')
+	if build_res.exit_code != 0 {
+		eprintln('Error: Failed to build v2')
+		eprintln(build_res.output)
+		exit(1)
+	}
+
+	v2_output := os.join_path(bench_dir, 'kernels_${backend}')
+	ref_output := os.join_path(bench_dir, 'kernels_ref')
+	defer {
+		os.rm(v2_output) or {}
+		os.rm(ref_output) or {}
+	}
+
+	println('[*] Compiling kernels.v with v2 -backend ${backend}...')
+	v2_res := os.execute('${v2_binary} -backend ${backend} ${kernels} -o ${v2_output}')
+	if v2_res.exit_code != 0 {
+		eprintln('Error: v2 compilation failed')
+		eprintln(v2_res.output)
+		exit(1)
+	}
+	println('[*] Compiling kernels.v with the reference compiler (-prod)...')
+	ref_res := os.execute('${@VEXE} -prod -n -w ${kernels} -o ${ref_output}')
+	if ref_res.exit_code != 0 {
+		eprintln('Error: reference compilation failed')
+		eprintln(ref_res.output)
+		exit(1)
+	}
+
+	ref_run := time_runs(ref_output, 1) or { exit(1) }
+	v2_run := time_runs(v2_output, 1) or { exit(1) }
+	expected := ref_run.output
+	actual := v2_run.output
+	if expected != actual {
+		eprintln('Error: output mismatch')
+		eprintln('Expected:\n${expected}')
+		eprintln('Got:\n${actual}')
+		exit(1)
+	}
+
+	v2_time := (time_runs(v2_output, runs) or { exit(1) }).best
+	ref_time := (time_runs(ref_output, runs) or { exit(1) }).best
+	println('\n========================================')
+	println('Best of ${runs} runs:')
+	println('  v2 -backend ${backend}: ${v2_time}')
+	println('  v -prod:            ${ref_time}')
+	println('  ratio:              ${f64(v2_time) / f64(ref_time):.2f}x')
+}
+
+struct RunResult {
+	output string
+	best   time.Duration
+}
+
+fn time_runs(binary string, runs int) ?RunResult {
+	mut best := time.Duration(0)
+	mut output := ''
+	for i in 0 .. runs {
+		sw := time.new_stopwatch()
+		res := os.execute(binary)
+		elapsed := sw.elapsed()
+		if res.exit_code != 0 {
+			eprintln('Error: ${binary} failed with exit code ${res.exit_code}')
+			eprintln(res.output)
+			return none
+		}
+		if i == 0 || elapsed < best {
+			best = elapsed
+		}
+		output = res.output.trim_space().replace('\r\n', '\n')
+	}
+	return RunResult{
+		output: output
+		best:   best
+	}
+}
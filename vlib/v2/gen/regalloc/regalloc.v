@@ -0,0 +1,319 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module regalloc
+
+import v2.ssa
+import v2.ssa.optimize
+
+// Linear scan register allocation, shared by the native backends.
+//
+// The instructions of a function are numbered in block order. The interval of a value spans
+// its definitions and uses, and the whole of each block, that it is live through, according
+// to the liveness analysis over the CFG. So a value, that is used in a loop, but defined before it,
+// stays allocated until the end of the loop, and a value, that is local to a block, is freed
+// right after its last use, even when the block is in the middle of a loop.
+
+// Config describes the registers of a target, in the order of preference.
+pub struct Config {
+pub:
+	// caller_saved registers are clobbered by calls, but need no saving in the prologue
+	caller_saved []int
+	// callee_saved registers survive calls, but have to be saved in the prologue, when used
+	callee_saved []int
+	// save_around_calls allows values, that are live across a call, to be kept in caller-saved
+	// registers; the backend then has to save and restore them around the call (see Allocation.call_saves).
+	// When it is false, such values only get callee-saved registers, or are spilled.
+	save_around_calls bool
+}
+
+// Allocation is the result of allocate/4. Values, that are in neither `reg_map` nor `spill_slots`,
+// were skipped, and are handled by the backend itself.
+pub struct Allocation {
+pub mut:
+	reg_map map[int]int // value id -> register
+	// used_regs are the callee-saved registers, that have to be saved in the prologue, sorted
+	used_regs []int
+	// spill_slots maps the values, that did not get a register, to stack slots. Values with
+	// disjoint intervals share the same slot, so there are only `nr_spill_slots` of them.
+	spill_slots    map[int]int
+	nr_spill_slots int
+	// call_saves maps a call instruction to the caller-saved registers, that hold values,
+	// which are live across it. Only filled, when Config.save_around_calls is true.
+	call_saves map[int][]int
+}
+
+struct Interval {
+mut:
+	val_id     int
+	start      int
+	end        int
+	crosses    bool // the value is live across a call
+	weight     f64  // the estimated cost of spilling it; uses in loops count more
+	reg        int = -1
+	spill_slot int = -1
+}
+
+// allocate assigns registers to the values of `func`. The values in `skip` are left alone.
+pub fn allocate(m &ssa.Module, func ssa.Function, cfg Config, skip map[int]bool) Allocation {
+	live := optimize.compute_liveness(m, func)
+
+	// Number the instructions, and find the block ranges and the calls
+	mut block_start := map[int]int{}
+	mut block_end := map[int]int{}
+	mut block_pos := map[int]int{}
+	mut calls := []int{}
+	mut call_ids := []int{}
+	mut idx := 0
+	for bi, blk_id in func.blocks {
+		block_pos[blk_id] = bi
+		block_start[blk_id] = idx
+		for val_id in m.blocks[blk_id].instrs {
+			op := m.instrs[m.values[val_id].index].op
+			if op in [.call, .call_indirect, .call_sret] {
+				calls << idx
+				call_ids << val_id
+			}
+			idx++
+		}
+		block_end[blk_id] = idx - 1
+	}
+
+	// Loop depth: a branch to an earlier (or the same) block is a back edge, and every block
+	// between its target and its source is considered to be in the loop
+	mut depth := []int{len: func.blocks.len}
+	for bi, blk_id in func.blocks {
+		for s in optimize.block_successors(m, blk_id) {
+			si := block_pos[s] or { continue }
+			if si <= bi {
+				for k in si .. bi + 1 {
+					depth[k]++
+				}
+			}
+		}
+	}
+
+	// Parameters are defined before the first instruction
+	mut intervals := map[int]&Interval{}
+	for pid in func.params {
+		if pid !in skip {
+			intervals[pid] = &Interval{
+				val_id: pid
+				start:  -1
+				end:    -1
+			}
+		}
+	}
+	// The definitions first, since a phi value may be used before its (assign) definition in block order.
+	// The phi instruction itself counts as a definition too, so that every phi value gets a location.
+	idx = 0
+	for blk_id in func.blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			def_id := if instr.op == .assign { instr.operands[0] } else { val_id }
+			if def_id !in skip && defines_value(m, def_id) {
+				if mut iv := intervals[def_id] {
+					iv.extend(idx)
+				} else {
+					intervals[def_id] = &Interval{
+						val_id: def_id
+						start:  idx
+						end:    idx
+					}
+				}
+			}
+			idx++
+		}
+	}
+	idx = 0
+	for bi, blk_id in func.blocks {
+		w := loop_weight(depth[bi])
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			if instr.op != .phi {
+				def_id := if instr.op == .assign { instr.operands[0] } else { val_id }
+				if mut iv := intervals[def_id] {
+					iv.weight += w
+				}
+				first_use := if instr.op == .assign { 1 } else { 0 }
+				for op in instr.operands[first_use..] {
+					if mut iv := intervals[op] {
+						iv.extend(idx)
+						iv.weight += w
+					}
+				}
+			}
+			idx++
+		}
+	}
+	// Values live into or out of a block cover the whole block
+	for blk_id in func.blocks {
+		for val_id in live.live_in_values(blk_id) {
+			if mut iv := intervals[val_id] {
+				iv.extend(block_start[blk_id])
+			}
+		}
+		for val_id in live.live_out_values(blk_id) {
+			if mut iv := intervals[val_id] {
+				iv.extend(block_end[blk_id])
+			}
+		}
+	}
+	for _, mut iv in intervals {
+		for c in calls {
+			if iv.start < c && iv.end > c {
+				iv.crosses = true
+				break
+			}
+		}
+	}
+
+	mut sorted := []&Interval{cap: intervals.len}
+	for _, iv in intervals {
+		sorted << iv
+	}
+	sorted.sort(a.start < b.start)
+
+	// Calls do not clobber callee-saved registers, while all other values prefer the caller-saved
+	// ones, since those do not have to be saved in the prologue
+	mut crossing_pool := cfg.callee_saved.clone()
+	if cfg.save_around_calls {
+		crossing_pool << cfg.caller_saved
+	}
+	mut local_pool := cfg.caller_saved.clone()
+	local_pool << cfg.callee_saved
+
+	mut res := Allocation{}
+	mut active := []&Interval{cap: 32}
+	mut busy := map[int]bool{}
+	for mut cur in sorted {
+		mut j := 0
+		for j < active.len {
+			if active[j].end < cur.start {
+				busy.delete(active[j].reg)
+				active.delete(j)
+			} else {
+				j++
+			}
+		}
+		pool := if cur.crosses { crossing_pool } else { local_pool }
+		for r in pool {
+			if !busy[r] {
+				cur.reg = r
+				break
+			}
+		}
+		if cur.reg < 0 {
+			// No free register: spill the cheapest of the current interval, and the active ones,
+			// that hold a register, which the current interval could use
+			mut victim := -1
+			mut victim_weight := cur.weight
+			for k, a in active {
+				if a.reg in pool && a.weight < victim_weight {
+					victim = k
+					victim_weight = a.weight
+				}
+			}
+			if victim < 0 {
+				continue
+			}
+			mut v := active[victim]
+			cur.reg = v.reg
+			v.reg = -1
+			active.delete(victim)
+		}
+		busy[cur.reg] = true
+		active << cur
+	}
+
+	// Spilled intervals share the stack slots, that are free again
+	mut free_slots := []int{}
+	mut active_slots := []&Interval{}
+	for mut cur in sorted {
+		if cur.reg >= 0 {
+			res.reg_map[cur.val_id] = cur.reg
+			if cur.reg in cfg.callee_saved && cur.reg !in res.used_regs {
+				res.used_regs << cur.reg
+			}
+			continue
+		}
+		mut j := 0
+		for j < active_slots.len {
+			if active_slots[j].end < cur.start {
+				free_slots << active_slots[j].spill_slot
+				active_slots.delete(j)
+			} else {
+				j++
+			}
+		}
+		if free_slots.len > 0 {
+			cur.spill_slot = free_slots.pop()
+		} else {
+			cur.spill_slot = res.nr_spill_slots
+			res.nr_spill_slots++
+		}
+		res.spill_slots[cur.val_id] = cur.spill_slot
+		active_slots << cur
+	}
+	res.used_regs.sort()
+
+	if cfg.save_around_calls {
+		for i, c in calls {
+			mut saves := []int{}
+			for iv in sorted {
+				if iv.reg >= 0 && iv.start < c && iv.end > c && iv.reg in cfg.caller_saved
+					&& iv.reg !in saves {
+					saves << iv.reg
+				}
+			}
+			if saves.len > 0 {
+				saves.sort()
+				res.call_saves[call_ids[i]] = saves
+			}
+		}
+	}
+	return res
+}
+
+fn (mut iv Interval) extend(pos int) {
+	if pos < iv.start {
+		iv.start = pos
+	}
+	if pos > iv.end {
+		iv.end = pos
+	}
+}
+
+// loop_weight is the weight of a use at the given loop depth; each level of nesting is
+// assumed to run 8 times, so that values used in inner loops are spilled last
+fn loop_weight(depth int) f64 {
+	mut w := 1.0
+	for d := 0; d < depth && d < 6; d++ {
+		w *= 8
+	}
+	return w
+}
+
+// defines_value returns true, when `val_id` is a value, that an instruction writes a result to
+fn defines_value(m &ssa.Module, val_id int) bool {
+	val := m.values[val_id]
+	if val.kind == .argument {
+		return true
+	}
+	if val.kind != .instruction {
+		return false
+	}
+	instr := m.instrs[val.index]
+	return match instr.op {
+		.ret, .br, .jmp, .switch_, .unreachable, .store, .fence, .assign {
+			false
+		}
+		.call, .call_indirect, .call_sret {
+			val.typ != 0 && m.type_store.types[val.typ].kind != .void_t
+		}
+		else {
+			true
+		}
+	}
+}
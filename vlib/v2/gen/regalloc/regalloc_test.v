@@ -0,0 +1,134 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module regalloc
+
+import v2.ssa
+import v2.ssa.optimize
+
+struct LoopFn {
+	func_id int
+	n       int // parameter
+	i       int // phi value: the loop counter
+	next    int // i + 1
+	header  int
+	body    int
+}
+
+// build_loop builds `fn f(n) { mut i := 0; for i < n { i++ }; return i }`,
+// as it looks after phi elimination
+fn build_loop(mut m ssa.Module) LoopFn {
+	i64_t := m.type_store.get_int(64)
+	func_id := m.new_function('f', i64_t, [i64_t])
+	n := m.add_value_node(.argument, i64_t, 'n', 0)
+	m.funcs[func_id].params << n
+	entry := m.add_block(func_id, 'entry')
+	header := m.add_block(func_id, 'header')
+	body := m.add_block(func_id, 'body')
+	exit := m.add_block(func_id, 'exit')
+	zero := m.get_or_add_const(i64_t, '0')
+	one := m.get_or_add_const(i64_t, '1')
+
+	i := m.add_instr(.phi, header, i64_t, [])
+	m.add_instr(.assign, entry, 0, [i, zero])
+	m.add_instr(.jmp, entry, 0, [m.blocks[header].val_id])
+	cond := m.add_instr(.lt, header, m.type_store.get_int(1), [i, n])
+	m.add_instr(.br, header, 0, [cond, m.blocks[body].val_id, m.blocks[exit].val_id])
+	next := m.add_instr(.add, body, i64_t, [i, one])
+	m.add_instr(.assign, body, 0, [i, next])
+	m.add_instr(.jmp, body, 0, [m.blocks[header].val_id])
+	m.add_instr(.ret, exit, 0, [i])
+	return LoopFn{
+		func_id: func_id
+		n:       n
+		i:       i
+		next:    next
+		header:  header
+		body:    body
+	}
+}
+
+fn test_liveness_of_a_loop() {
+	mut m := ssa.Module.new('test')
+	f := build_loop(mut m)
+	live := optimize.compute_liveness(m, m.funcs[f.func_id])
+	// the parameter and the counter are live around the whole loop
+	assert live.is_live_in(f.header, f.n)
+	assert live.is_live_in(f.header, f.i)
+	assert live.is_live_out(f.body, f.n)
+	assert live.is_live_out(f.body, f.i)
+	// i + 1 is copied to i in the same block
+	assert !live.is_live_out(f.body, f.next)
+	assert !live.is_live_in(f.header, f.next)
+}
+
+fn test_allocate_loop() {
+	mut m := ssa.Module.new('test')
+	f := build_loop(mut m)
+	a := allocate(m, m.funcs[f.func_id], Config{
+		caller_saved: [1, 2, 3]
+	}, map[int]bool{})
+	assert a.nr_spill_slots == 0
+	assert a.used_regs.len == 0
+	n_reg := a.reg_map[f.n] or { panic('n has no register') }
+	i_reg := a.reg_map[f.i] or { panic('i has no register') }
+	next_reg := a.reg_map[f.next] or { panic('next has no register') }
+	assert n_reg != i_reg
+	assert n_reg != next_reg
+	assert i_reg != next_reg
+}
+
+fn test_spill_prefers_values_outside_loops() {
+	mut m := ssa.Module.new('test')
+	f := build_loop(mut m)
+	// n, i and next are live at the same time in the loop body, so with 2 registers one of them
+	// is spilled; n is used the least often inside the loop
+	a := allocate(m, m.funcs[f.func_id], Config{
+		callee_saved: [1, 2]
+	}, map[int]bool{})
+	assert a.nr_spill_slots == 1
+	assert a.spill_slots[f.n] == 0
+	assert f.i in a.reg_map
+	assert f.next in a.reg_map
+	assert a.used_regs.len == 2
+}
+
+fn test_values_live_across_calls() {
+	mut m := ssa.Module.new('test')
+	i64_t := m.type_store.get_int(64)
+	func_id := m.new_function('g', i64_t, [i64_t])
+	x := m.add_value_node(.argument, i64_t, 'x', 0)
+	m.funcs[func_id].params << x
+	entry := m.add_block(func_id, 'entry')
+	callee := m.add_value_node(.global, 0, 'h', 0)
+	y := m.add_instr(.add, entry, i64_t, [x, x])
+	call := m.add_instr(.call, entry, i64_t, [callee, x])
+	sum := m.add_instr(.add, entry, i64_t, [y, call])
+	m.add_instr(.ret, entry, 0, [sum])
+
+	// y is live across the call, so it gets the callee-saved register
+	a := allocate(m, m.funcs[func_id], Config{
+		caller_saved:      [1, 2]
+		callee_saved:      [3]
+		save_around_calls: true
+	}, map[int]bool{})
+	assert a.reg_map[y] == 3
+	assert a.used_regs == [3]
+	assert call !in a.call_saves
+
+	// without callee-saved registers, it is kept in a caller-saved one, that is saved around the call
+	b := allocate(m, m.funcs[func_id], Config{
+		caller_saved:      [1, 2]
+		save_around_calls: true
+	}, map[int]bool{})
+	assert b.call_saves[call] == [b.reg_map[y]]
+
+	// or it is spilled, when that is not allowed
+	c := allocate(m, m.funcs[func_id], Config{
+		caller_saved: [1, 2]
+	}, map[int]bool{})
+	assert y !in c.reg_map
+	assert y in c.spill_slots
+	assert call !in c.call_saves
+}
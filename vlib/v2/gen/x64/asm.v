@@ -305,20 +305,22 @@ fn asm_mov_rax_mem_rcx(mut g Gen) {
 	g.emit(0x01)
 }
 
-// lea rax, [rbp + disp8]
-fn asm_lea_rax_rbp_disp8(mut g Gen, disp i8) {
-	g.emit(0x48)
-	g.emit(0x8D)
-	g.emit(0x45) // ModRM 01 = disp8
-	g.emit(u8(disp))
-}
-
-// lea rax, [rbp + disp32]
-fn asm_lea_rax_rbp_disp32(mut g Gen, disp i32) {
-	g.emit(0x48)
+// lea reg, [rbp + disp]
+fn asm_lea_reg_rbp_disp(mut g Gen, reg Reg, disp int) {
+	hw_reg := g.map_reg(int(reg))
+	mut rex := u8(0x48)
+	if hw_reg >= 8 {
+		rex |= 4
+	}
+	g.emit(rex)
 	g.emit(0x8D)
-	g.emit(0x85) // ModRM 10 = disp32
-	g.emit_u32(u32(disp))
+	if disp >= -128 && disp <= 127 {
+		g.emit(0x45 | ((hw_reg & 7) << 3)) // ModRM 01 = disp8
+		g.emit(u8(disp))
+	} else {
+		g.emit(0x85 | ((hw_reg & 7) << 3)) // ModRM 10 = disp32
+		g.emit_u32(u32(disp))
+	}
 }
 
 // lea reg, [rip + disp32] (for globals/strings)
@@ -5,6 +5,7 @@
 module x64
 
 import v2.ssa
+import v2.gen.regalloc
 import encoding.binary
 
 pub struct Gen {
@@ -21,16 +22,28 @@ mut:
 	pending_labels map[int][]int
 
 	// Register allocation
-	reg_map   map[int]int
-	used_regs []int
+	reg_map    map[int]int
+	used_regs  []int
+	call_saves map[int][]int // call value id -> caller-saved registers to preserve around it
+	save_slots map[int]int   // caller-saved register -> its save slot
 }
 
-struct Interval {
+// System V argument registers: RDI, RSI, RDX, RCX, R8, R9
+const abi_regs = [7, 6, 2, 1, 8, 9]
+
+// RAX, RCX and RDX are the scratch registers of the instruction selection (RDX for cqo/idiv),
+// and R10 holds the target of indirect calls, so none of them is allocated.
+const regalloc_config = regalloc.Config{
+	caller_saved:      [6, 7, 8, 9, 11] // RSI, RDI, R8, R9, R11
+	callee_saved:      [3, 12, 13, 14, 15] // RBX, R12, R13, R14, R15
+	save_around_calls: true
+}
+
+// RegMove is a register to register copy, that is part of a parallel move
+struct RegMove {
+	dst int
 mut:
-	val_id   int
-	start    int
-	end      int
-	has_call bool
+	src int
 }
 
 pub fn Gen.new(mod &ssa.Module) &Gen {
@@ -76,16 +89,30 @@ fn (mut g Gen) gen_func(func ssa.Function) {
 	g.pending_labels = map[int][]int{}
 	g.reg_map = map[int]int{}
 	g.used_regs = []int{}
+	g.call_saves = map[int][]int{}
+	g.save_slots = map[int]int{}
 
-	g.allocate_registers(func)
+	spill_slots, nr_spill_slots := g.allocate_registers(func)
 
 	// Calculate Stack Frame
-	mut slot_offset := 8
+	// The callee-saved registers are pushed right below the saved RBP, so the slots start after them
+	mut slot_offset := 8 + g.used_regs.len * 8
+
+	// Slots for the caller-saved registers, that are preserved around calls
+	for _, regs in g.call_saves {
+		for r in regs {
+			if r !in g.save_slots {
+				g.save_slots[r] = -slot_offset
+				slot_offset += 8
+			}
+		}
+	}
 
-	for pid in func.params {
-		g.stack_map[pid] = -slot_offset
-		slot_offset += 8
+	// Spill slots are shared by the values, whose live ranges do not overlap
+	for val_id, slot in spill_slots {
+		g.stack_map[val_id] = -(slot_offset + slot * 8)
 	}
+	slot_offset += nr_spill_slots * 8
 
 	for blk_id in func.blocks {
 		blk := g.mod.blocks[blk_id]
@@ -118,19 +145,14 @@ fn (mut g Gen) gen_func(func ssa.Function) {
 				// Align to 16 bytes
 				slot_offset = (slot_offset + 15) & ~0xF
 				slot_offset += alloc_size
+				// The pointer itself is not stored anywhere; it is recomputed with a lea when used
 				g.alloca_offsets[val_id] = -slot_offset
-				slot_offset += 8 // Slot for the pointer
 			}
-
-			if val_id in g.reg_map {
-				continue
-			}
-			g.stack_map[val_id] = -slot_offset
-			slot_offset += 8
 		}
 	}
 
-	g.stack_size = (slot_offset + 16) & ~0xF
+	// Keep RSP 16 byte aligned at calls: RBP is aligned, and the pushed registers are below it
+	g.stack_size = ((slot_offset + 15) & ~0xF) - g.used_regs.len * 8
 
 	g.elf.add_symbol(func.name, u64(g.curr_offset), true, 1)
 
@@ -155,27 +177,35 @@ fn (mut g Gen) gen_func(func ssa.Function) {
 
 	// Move Params (ABI: RDI, RSI, RDX, RCX, R8, R9)
 	// First 6 args in registers, rest on stack at [rbp+16], [rbp+24], ...
-	abi_regs := [7, 6, 2, 1, 8, 9]
+	// Spilled register params are stored first, then the ones, that live in registers, are moved
+	// as a parallel move, since their registers may be the argument registers of each other.
+	mut moves := []RegMove{}
 	for i, pid in func.params {
-		if i < 6 {
-			src := abi_regs[i]
-			if reg := g.reg_map[pid] {
-				asm_mov_reg_reg(mut g, Reg(reg), Reg(src))
-			} else {
-				offset := g.stack_map[pid]
-				asm_store_rbp_disp_reg(mut g, offset, Reg(src))
+		if i >= 6 {
+			break
+		}
+		if reg := g.reg_map[pid] {
+			moves << RegMove{
+				dst: reg
+				src: abi_regs[i]
 			}
-		} else {
-			// Stack parameters: [rbp+16] is 7th param, [rbp+24] is 8th, etc.
-			stack_param_offset := 16 + (i - 6) * 8
+		} else if offset := g.stack_map[pid] {
+			asm_store_rbp_disp_reg(mut g, offset, Reg(abi_regs[i]))
+		}
+	}
+	g.gen_parallel_moves(moves)
+	for i, pid in func.params {
+		if i < 6 {
+			continue
+		}
+		// Stack parameters: [rbp+16] is 7th param, [rbp+24] is 8th, etc.
+		stack_param_offset := 16 + (i - 6) * 8
+		if reg := g.reg_map[pid] {
+			asm_load_reg_rbp_disp(mut g, Reg(reg), stack_param_offset)
+		} else if offset := g.stack_map[pid] {
 			// Load from stack into RAX, then store to our slot
 			asm_load_reg_rbp_disp(mut g, rax, stack_param_offset)
-			if reg := g.reg_map[pid] {
-				asm_mov_reg_reg(mut g, Reg(reg), rax)
-			} else {
-				offset := g.stack_map[pid]
-				asm_store_rbp_disp_reg(mut g, offset, rax)
-			}
+			asm_store_rbp_disp_reg(mut g, offset, rax)
 		}
 	}
 
@@ -274,14 +304,7 @@ fn (mut g Gen) gen_instr(val_id int) {
 			g.store_reg_to_val(0, val_id)
 		}
 		.alloca {
-			off := g.alloca_offsets[val_id]
-			// lea rax, [rbp + off]
-			if off >= -128 && off <= 127 {
-				asm_lea_rax_rbp_disp8(mut g, i8(off))
-			} else {
-				asm_lea_rax_rbp_disp32(mut g, off)
-			}
-			g.store_reg_to_val(0, val_id)
+			// The address is recomputed by load_val_to_reg, wherever it is used
 		}
 		.get_element_ptr {
 			g.load_val_to_reg(0, instr.operands[0]) // Base -> RAX
@@ -292,30 +315,8 @@ fn (mut g Gen) gen_instr(val_id int) {
 			g.store_reg_to_val(0, val_id)
 		}
 		.call {
-			abi_regs := [7, 6, 2, 1, 8, 9]
-			num_args := instr.operands.len - 1
-
-			// Push stack arguments in reverse order (args 7+)
-			mut stack_args := 0
-			if num_args > 6 {
-				stack_args = num_args - 6
-				// Align stack to 16 bytes if odd number of stack args
-				if stack_args % 2 == 1 {
-					asm_push(mut g, rax)
-				}
-				// Push in reverse order
-				for i := num_args; i > 6; i-- {
-					g.load_val_to_reg(0, instr.operands[i]) // RAX
-					asm_push(mut g, rax)
-				}
-			}
-
-			// Load register arguments
-			for i in 1 .. instr.operands.len {
-				if i - 1 < 6 {
-					g.load_val_to_reg(abi_regs[i - 1], instr.operands[i])
-				}
-			}
+			g.save_caller_saved(val_id)
+			stack_args := g.gen_call_args(instr.operands, false)
 			fn_val := g.mod.values[instr.operands[0]]
 
 			// xor eax, eax (Clear AL for variadic function calls)
@@ -328,16 +329,8 @@ fn (mut g Gen) gen_instr(val_id int) {
 			g.elf.add_text_reloc(u64(g.elf.text_data.len), sym_idx, 4, -4)
 			g.emit_u32(0)
 
-			// Clean up stack arguments
-			if stack_args > 0 {
-				cleanup := (stack_args + (stack_args % 2)) * 8
-				if cleanup <= 127 {
-					asm_add_rsp_imm8(mut g, u8(cleanup))
-				} else {
-					asm_add_rsp_imm32(mut g, u32(cleanup))
-				}
-			}
-
+			g.cleanup_stack_args(stack_args)
+			g.restore_caller_saved(val_id)
 			if g.mod.type_store.types[g.mod.values[val_id].typ].kind != .void_t {
 				g.store_reg_to_val(0, val_id)
 			}
@@ -345,32 +338,10 @@ fn (mut g Gen) gen_instr(val_id int) {
 		.call_indirect {
 			// Indirect call through function pointer
 			// operands[0] is the function pointer, rest are arguments
-			abi_regs := [7, 6, 2, 1, 8, 9]
-			num_args := instr.operands.len - 1
-
-			// Push stack arguments in reverse order (args 7+)
-			mut stack_args := 0
-			if num_args > 6 {
-				stack_args = num_args - 6
-				// Align stack to 16 bytes if odd number of stack args
-				if stack_args % 2 == 1 {
-					asm_push(mut g, rax)
-				}
-				for i := num_args; i > 6; i-- {
-					g.load_val_to_reg(0, instr.operands[i])
-					asm_push(mut g, rax)
-				}
-			}
-
-			// Load register arguments
-			for i in 1 .. instr.operands.len {
-				if i - 1 < 6 {
-					g.load_val_to_reg(abi_regs[i - 1], instr.operands[i])
-				}
-			}
-
-			// Load function pointer to r10 (caller-saved, not used for args)
-			g.load_val_to_reg(10, instr.operands[0])
+			g.save_caller_saved(val_id)
+			// The function pointer is loaded to r10 (caller-saved, not used for args)
+			// together with the register arguments
+			stack_args := g.gen_call_args(instr.operands, true)
 
 			// xor eax, eax (Clear AL for variadic function calls)
 			asm_xor_eax_eax(mut g)
@@ -378,16 +349,8 @@ fn (mut g Gen) gen_instr(val_id int) {
 			// call *r10
 			asm_call_r10(mut g)
 
-			// Clean up stack arguments
-			if stack_args > 0 {
-				cleanup := (stack_args + (stack_args % 2)) * 8
-				if cleanup <= 127 {
-					asm_add_rsp_imm8(mut g, u8(cleanup))
-				} else {
-					asm_add_rsp_imm32(mut g, u32(cleanup))
-				}
-			}
-
+			g.cleanup_stack_args(stack_args)
+			g.restore_caller_saved(val_id)
 			if g.mod.type_store.types[g.mod.values[val_id].typ].kind != .void_t {
 				g.store_reg_to_val(0, val_id)
 			}
@@ -479,6 +442,133 @@ fn (mut g Gen) gen_instr(val_id int) {
 	}
 }
 
+// gen_call_args pushes the stack arguments (7+) of a call, and loads the register arguments.
+// `operands[0]` is the callee; with `indirect`, it is loaded to R10 too. It returns the number
+// of stack arguments.
+fn (mut g Gen) gen_call_args(operands []int, indirect bool) int {
+	num_args := operands.len - 1
+
+	// Push stack arguments in reverse order (args 7+)
+	mut stack_args := 0
+	if num_args > 6 {
+		stack_args = num_args - 6
+		// Align stack to 16 bytes if odd number of stack args
+		if stack_args % 2 == 1 {
+			asm_push(mut g, rax)
+		}
+		for i := num_args; i > 6; i-- {
+			g.load_val_to_reg(0, operands[i]) // RAX
+			asm_push(mut g, rax)
+		}
+	}
+
+	// The arguments, that are in registers, may be in the argument registers of each other,
+	// so they are moved in parallel first; constants and stack values are loaded after that.
+	mut moves := []RegMove{}
+	mut loads := []RegMove{}
+	for i in 1 .. operands.len {
+		if i - 1 >= 6 {
+			break
+		}
+		if reg := g.val_reg(operands[i]) {
+			moves << RegMove{
+				dst: abi_regs[i - 1]
+				src: reg
+			}
+		} else {
+			// for the loads, `src` is the value id
+			loads << RegMove{
+				dst: abi_regs[i - 1]
+				src: operands[i]
+			}
+		}
+	}
+	if indirect {
+		if reg := g.val_reg(operands[0]) {
+			moves << RegMove{
+				dst: 10
+				src: reg
+			}
+		} else {
+			loads << RegMove{
+				dst: 10
+				src: operands[0]
+			}
+		}
+	}
+	g.gen_parallel_moves(moves)
+	for l in loads {
+		g.load_val_to_reg(l.dst, l.src)
+	}
+	return stack_args
+}
+
+fn (mut g Gen) cleanup_stack_args(stack_args int) {
+	if stack_args > 0 {
+		cleanup := (stack_args + (stack_args % 2)) * 8
+		if cleanup <= 127 {
+			asm_add_rsp_imm8(mut g, u8(cleanup))
+		} else {
+			asm_add_rsp_imm32(mut g, u32(cleanup))
+		}
+	}
+}
+
+// save_caller_saved stores the caller-saved registers, that hold values live across the call `val_id`
+fn (mut g Gen) save_caller_saved(val_id int) {
+	saves := g.call_saves[val_id] or { return }
+	for r in saves {
+		asm_store_rbp_disp_reg(mut g, g.save_slots[r], Reg(r))
+	}
+}
+
+fn (mut g Gen) restore_caller_saved(val_id int) {
+	saves := g.call_saves[val_id] or { return }
+	for r in saves {
+		asm_load_reg_rbp_disp(mut g, Reg(r), g.save_slots[r])
+	}
+}
+
+// val_reg returns the register of a register allocated value
+fn (g &Gen) val_reg(val_id int) ?int {
+	kind := g.mod.values[val_id].kind
+	if kind != .instruction && kind != .argument {
+		return none
+	}
+	return g.reg_map[val_id] or { return none }
+}
+
+// gen_parallel_moves emits the register to register `moves` as if they all happened at once:
+// a register is only overwritten after all the moves, that read it, are done.
+// Cycles (like swapping RDI and RSI) are broken through RAX, which is never a destination.
+fn (mut g Gen) gen_parallel_moves(moves []RegMove) {
+	mut pending := moves.filter(it.dst != it.src)
+	for pending.len > 0 {
+		mut progress := false
+		mut i := 0
+		for i < pending.len {
+			dst := pending[i].dst
+			if pending.any(it.src == dst) {
+				i++
+				continue
+			}
+			asm_mov_reg_reg(mut g, Reg(dst), Reg(pending[i].src))
+			pending.delete(i)
+			progress = true
+		}
+		if !progress {
+			// Only cycles are left: park one of the sources in RAX
+			src := pending[0].src
+			asm_mov_reg_reg(mut g, rax, Reg(src))
+			for mut m in pending {
+				if m.src == src {
+					m.src = int(rax)
+				}
+			}
+		}
+	}
+}
+
 fn (mut g Gen) emit_jmp(target_idx int) {
 	asm_jmp_rel32(mut g)
 	if off := g.block_offsets[target_idx] {
@@ -541,6 +631,9 @@ fn (mut g Gen) load_val_to_reg(reg int, val_id int) {
 		sym_idx := g.elf.add_undefined(val.name)
 		g.elf.add_text_reloc(u64(g.elf.text_data.len), sym_idx, 2, -4)
 		g.emit_u32(0)
+	} else if off := g.alloca_offsets[val_id] {
+		// lea reg, [rbp + off]
+		asm_lea_reg_rbp_disp(mut g, Reg(reg), off)
 	} else {
 		if reg_idx := g.reg_map[val_id] {
 			if reg_idx != reg {
@@ -599,90 +692,20 @@ pub fn (mut g Gen) write_file(path string) {
 
 // Register Allocation Logic
 
-fn (mut g Gen) allocate_registers(func ssa.Function) {
-	mut intervals := map[int]&Interval{}
-	mut instr_idx := 0
-
-	for pid in func.params {
-		intervals[pid] = &Interval{
-			val_id: pid
-			start:  0
-			end:    0
-		}
-	}
-
-	// Track which values are alloca results - don't register allocate these
-	// as they hold addresses that may be needed across the function
-	mut alloca_vals := map[int]bool{}
-
+// allocate_registers runs the shared linear scan allocator, and returns the spill slots.
+// Allocas are not allocated at all, since their address is rematerialized with a lea.
+fn (mut g Gen) allocate_registers(func ssa.Function) (map[int]int, int) {
+	mut allocas := map[int]bool{}
 	for blk_id in func.blocks {
-		blk := g.mod.blocks[blk_id]
-		for val_id in blk.instrs {
-			val := g.mod.values[val_id]
-			if val.kind == .instruction || val.kind == .argument {
-				if unsafe { intervals[val_id] == nil } {
-					intervals[val_id] = &Interval{
-						val_id: val_id
-						start:  instr_idx
-						end:    instr_idx
-					}
-				}
-			}
-			instr := g.mod.instrs[val.index]
-			// Mark alloca results as non-register-allocatable
-			if instr.op == .alloca {
-				alloca_vals[val_id] = true
-			}
-			for op in instr.operands {
-				if g.mod.values[op].kind in [.instruction, .argument] {
-					if mut interval := intervals[op] {
-						if instr_idx > interval.end {
-							interval.end = instr_idx
-						}
-					}
-				}
-			}
-			instr_idx++
-		}
-	}
-
-	mut sorted := []&Interval{}
-	for _, i in intervals {
-		sorted << i
-	}
-	sorted.sort(a.start < b.start)
-
-	mut active := []&Interval{}
-	// Use callee-saved registers: RBX(3), R12(12), R13(13), R14(14), R15(15)
-	regs := [3, 12, 13, 14, 15]
-
-	for i in sorted {
-		// Skip alloca results - they must stay on stack to preserve addresses
-		if alloca_vals[i.val_id] {
-			continue
-		}
-		for j := 0; j < active.len; j++ {
-			if active[j].end < i.start {
-				active.delete(j)
-				j--
-			}
-		}
-		if active.len < regs.len {
-			mut used := []bool{len: 16, init: false}
-			for a in active {
-				used[g.reg_map[a.val_id]] = true
-			}
-			for r in regs {
-				if !used[r] {
-					g.reg_map[i.val_id] = r
-					active << i
-					if r !in g.used_regs {
-						g.used_regs << r
-					}
-					break
-				}
+		for val_id in g.mod.blocks[blk_id].instrs {
+			if g.mod.instrs[g.mod.values[val_id].index].op == .alloca {
+				allocas[val_id] = true
 			}
 		}
 	}
-	g.used_regs.sort()
+	a := regalloc.allocate(g.mod, func, regalloc_config, allocas)
+	g.reg_map = a.reg_map.clone()
+	g.used_regs = a.used_regs.clone()
+	g.call_saves = a.call_saves.clone()
+	return a.spill_slots.clone(), a.nr_spill_slots
 }
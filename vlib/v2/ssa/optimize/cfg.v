@@ -24,47 +24,13 @@ pub fn build_cfg(mut m ssa.Module) {
 			if blk.instrs.len == 0 {
 				continue
 			}
-			term_val_id := blk.instrs.last()
-			term := m.instrs[m.values[term_val_id].index]
-
 			// Clear the set for reuse
 			seen_succs.clear()
-
-			match term.op {
-				.br {
-					s1 := m.get_block_from_val(term.operands[1])
-					s2 := m.get_block_from_val(term.operands[2])
-					if !seen_succs[s1] {
-						seen_succs[s1] = true
-						m.blocks[blk_id].succs << s1
-					}
-					if !seen_succs[s2] {
-						seen_succs[s2] = true
-						m.blocks[blk_id].succs << s2
-					}
-				}
-				.jmp {
-					s := m.get_block_from_val(term.operands[0])
+			for s in block_successors(m, blk_id) {
+				if !seen_succs[s] {
 					seen_succs[s] = true
 					m.blocks[blk_id].succs << s
 				}
-				.switch_ {
-					// default
-					s := m.get_block_from_val(term.operands[1])
-					if !seen_succs[s] {
-						seen_succs[s] = true
-						m.blocks[blk_id].succs << s
-					}
-					// cases
-					for i := 3; i < term.operands.len; i += 2 {
-						cs := m.get_block_from_val(term.operands[i])
-						if !seen_succs[cs] {
-							seen_succs[cs] = true
-							m.blocks[blk_id].succs << cs
-						}
-					}
-				}
-				else {}
 			}
 
 			// Build predecessors - use seen_preds to check if already added
@@ -81,3 +47,32 @@ pub fn build_cfg(mut m ssa.Module) {
 		}
 	}
 }
+
+// block_successors returns the successors of a block, read from its terminator, in branch order.
+// The result may contain duplicates, when several edges lead to the same block.
+pub fn block_successors(m &ssa.Module, blk_id int) []int {
+	blk := m.blocks[blk_id]
+	if blk.instrs.len == 0 {
+		return []
+	}
+	term := m.instrs[m.values[blk.instrs.last()].index]
+	match term.op {
+		.br {
+			return [m.get_block_from_val(term.operands[1]), m.get_block_from_val(term.operands[2])]
+		}
+		.jmp {
+			return [m.get_block_from_val(term.operands[0])]
+		}
+		.switch_ {
+			// default, then the cases
+			mut res := [m.get_block_from_val(term.operands[1])]
+			for i := 3; i < term.operands.len; i += 2 {
+				res << m.get_block_from_val(term.operands[i])
+			}
+			return res
+		}
+		else {
+			return []
+		}
+	}
+}
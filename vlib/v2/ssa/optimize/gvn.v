@@ -0,0 +1,91 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Global Value Numbering ---
+// Dominator based value numbering: the dominator tree is walked depth first, with a scoped table
+// of the pure expressions, that are available in the current block. An instruction, that computes
+// the same expression as one in a dominating block, is replaced by it. Loads are not numbered,
+// since any store or call in between could change the memory.
+fn global_value_numbering(mut m ssa.Module) bool {
+	build_cfg(mut m)
+	compute_dominators(mut m)
+	mut changed := false
+	for func in m.funcs {
+		if func.blocks.len == 0 {
+			continue
+		}
+		mut available := map[string]int{}
+		if gvn_block(mut m, func.blocks[0], mut available) {
+			changed = true
+		}
+	}
+	return changed
+}
+
+fn gvn_block(mut m ssa.Module, blk_id int, mut available map[string]int) bool {
+	mut changed := false
+	mut added := []string{}
+	for val_id in m.blocks[blk_id].instrs {
+		instr := m.instrs[m.values[val_id].index]
+		if !is_pure_op(instr.op) || instr.operands.len == 0 {
+			continue
+		}
+		key := expression_key(m, val_id, instr)
+		if existing := available[key] {
+			m.replace_uses(val_id, existing)
+			nop_instr(mut m, val_id)
+			changed = true
+		} else {
+			available[key] = val_id
+			added << key
+		}
+	}
+	for child in m.blocks[blk_id].dom_tree {
+		if gvn_block(mut m, child, mut available) {
+			changed = true
+		}
+	}
+	// the expressions of this block are not available in its siblings
+	for key in added {
+		available.delete(key)
+	}
+	return changed
+}
+
+// is_pure_op returns true for the operations, whose result depends only on their operands.
+// Divisions are pure, but can trap, so they can be numbered, but not hoisted (see is_hoistable_op).
+fn is_pure_op(op ssa.OpCode) bool {
+	return op in [.add, .sub, .mul, .sdiv, .udiv, .srem, .urem, .fadd, .fsub, .fmul, .fdiv, .frem,
+		.shl, .lshr, .ashr, .and_, .or_, .xor, .get_element_ptr, .trunc, .zext, .sext, .fptoui,
+		.fptosi, .uitofp, .sitofp, .lt, .gt, .le, .ge, .eq, .ne, .select, .extractvalue]
+}
+
+fn is_commutative_op(op ssa.OpCode) bool {
+	return op in [.add, .mul, .and_, .or_, .xor, .eq, .ne, .fadd, .fmul]
+}
+
+// expression_key identifies the expression computed by an instruction. The operands of
+// commutative operations are sorted, so that `a + b` and `b + a` get the same key.
+fn expression_key(m &ssa.Module, val_id int, instr ssa.Instruction) string {
+	mut operands := instr.operands.clone()
+	if is_commutative_op(instr.op) && operands.len == 2 && operands[0] > operands[1] {
+		operands[0], operands[1] = operands[1], operands[0]
+	}
+	return '${int(instr.op)}:${m.values[val_id].typ}:${operands}'
+}
+
+// nop_instr turns an instruction, that has no uses anymore, into a no-op, like mem2reg does
+// for the promoted loads and stores. Dead code elimination removes it later.
+fn nop_instr(mut m ssa.Module, val_id int) {
+	idx := m.values[val_id].index
+	for op in m.instrs[idx].operands {
+		remove_use(mut m, op, val_id)
+	}
+	m.instrs[idx].op = .bitcast
+	m.instrs[idx].operands = []
+}
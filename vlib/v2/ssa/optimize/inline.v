@@ -0,0 +1,235 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Inlining ---
+// Small functions are inlined before mem2reg, while the locals are still allocas, and there are
+// no phi nodes yet. The blocks of the callee are cloned into the caller, and the calling block
+// is split after the call. Each `ret` of the clone becomes a store to a result slot and a jump
+// to the rest of the calling block, where the call is replaced by a load of the slot.
+// mem2reg then promotes the result slot and the locals of the callee, like any other alloca.
+
+// Cost model: callees up to these sizes are inlined, unless their calls are marked `never`.
+// Calls marked `always` are inlined regardless of the size of the callee.
+const inline_max_instrs = 40
+const inline_max_blocks = 8
+// inline_max_per_func limits the growth of a single caller
+const inline_max_per_func = 64
+
+struct InlineSite {
+	blk    int
+	call   int
+	callee int
+}
+
+// ClonedInstr is a cloned instruction, whose operands still refer to the values of the callee
+struct ClonedInstr {
+	val_id   int
+	orig     ssa.Instruction
+	operands []int
+}
+
+fn inline_small_functions(mut m ssa.Module) bool {
+	mut func_by_name := map[string]int{}
+	for i, f in m.funcs {
+		if f.blocks.len > 0 {
+			func_by_name[f.name] = i
+		}
+	}
+	mut changed := false
+	for fi in 0 .. m.funcs.len {
+		for _ in 0 .. inline_max_per_func {
+			site := find_inline_site(m, fi, func_by_name) or { break }
+			inline_call(mut m, fi, site)
+			changed = true
+		}
+	}
+	if changed {
+		build_cfg(mut m)
+	}
+	return changed
+}
+
+fn find_inline_site(m &ssa.Module, fi int, func_by_name map[string]int) ?InlineSite {
+	for blk_id in m.funcs[fi].blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			if instr.op != .call || instr.operands.len == 0 {
+				continue
+			}
+			callee := func_by_name[m.values[instr.operands[0]].name] or { continue }
+			if callee != fi && can_inline(m, callee, instr) {
+				return InlineSite{
+					blk:    blk_id
+					call:   val_id
+					callee: callee
+				}
+			}
+		}
+	}
+	return none
+}
+
+fn can_inline(m &ssa.Module, callee_idx int, call ssa.Instruction) bool {
+	if call.inline == .never {
+		return false
+	}
+	callee := m.funcs[callee_idx]
+	if callee.blocks.len == 0 || call.operands.len - 1 != callee.params.len {
+		return false
+	}
+	// Struct returns and parameters have special calling conventions in the backends
+	if m.type_store.types[callee.typ].kind !in [.void_t, .int_t, .ptr_t] {
+		return false
+	}
+	for pid in callee.params {
+		if m.type_store.types[m.values[pid].typ].kind !in [.int_t, .ptr_t] {
+			return false
+		}
+	}
+	if call.inline != .always && callee.blocks.len > inline_max_blocks {
+		return false
+	}
+	mut size := 0
+	for blk_id in callee.blocks {
+		if m.blocks[blk_id].instrs.len == 0 {
+			return false
+		}
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			// recursive functions would only be unrolled once, and phis mean that mem2reg already ran
+			if instr.op == .phi || (instr.op == .call && instr.operands.len > 0
+				&& m.values[instr.operands[0]].name == callee.name) {
+				return false
+			}
+			size++
+		}
+	}
+	return call.inline == .always || size <= inline_max_instrs
+}
+
+fn inline_call(mut m ssa.Module, fi int, site InlineSite) {
+	callee := m.funcs[site.callee]
+	call := m.instrs[m.values[site.call].index]
+	entry := m.funcs[fi].blocks[0]
+
+	// Split the calling block after the call
+	instrs := m.blocks[site.blk].instrs
+	pos := instrs.index(site.call)
+	cont := m.add_block(fi, '${m.blocks[site.blk].name}_cont')
+	m.blocks[cont].instrs = instrs[pos + 1..].clone()
+	for val_id in m.blocks[cont].instrs {
+		set_instr_block(mut m, val_id, cont)
+	}
+	m.blocks[site.blk].instrs = instrs[..pos].clone()
+
+	res_typ := m.values[site.call].typ
+	has_result := res_typ != 0 && m.type_store.types[res_typ].kind != .void_t
+		&& m.values[site.call].uses.len > 0
+	mut slot := 0
+	if has_result {
+		slot = m.add_instr_front(.alloca, entry, m.type_store.get_ptr(res_typ), [])
+	}
+
+	// Clone the blocks first, and then the instructions, without their operands, so that
+	// the operands can refer to values, that are defined later in the callee
+	mut vmap := map[int]int{}
+	for i, pid in callee.params {
+		vmap[pid] = call.operands[i + 1]
+	}
+	mut clones := []int{cap: callee.blocks.len}
+	for blk_id in callee.blocks {
+		clone := m.add_block(fi, '${callee.name}_${m.blocks[blk_id].name}')
+		vmap[m.blocks[blk_id].val_id] = m.blocks[clone].val_id
+		clones << clone
+	}
+	mut cloned := []ClonedInstr{}
+	for k, blk_id in callee.blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			if instr.op == .ret {
+				if has_result && instr.operands.len > 0 {
+					cloned << ClonedInstr{
+						val_id:   m.add_instr(.store, clones[k], 0, [])
+						orig:     instr
+						operands: [instr.operands[0], slot]
+					}
+				}
+				m.add_instr(.jmp, clones[k], 0, [m.blocks[cont].val_id])
+				continue
+			}
+			// the locals of the callee become locals of the caller
+			new_id := if instr.op == .alloca {
+				m.add_instr_front(.alloca, entry, instr.typ, [])
+			} else {
+				m.add_instr(instr.op, clones[k], instr.typ, [])
+			}
+			vmap[val_id] = new_id
+			cloned << ClonedInstr{
+				val_id:   new_id
+				orig:     instr
+				operands: instr.operands
+			}
+		}
+	}
+	for c in cloned {
+		idx := m.values[c.val_id].index
+		operands := c.operands.map(vmap[it] or { it })
+		m.instrs[idx] = ssa.Instruction{
+			...m.instrs[idx]
+			operands:   operands
+			pos:        c.orig.pos
+			atomic_ord: c.orig.atomic_ord
+			inline:     c.orig.inline
+		}
+		for op in operands {
+			if op < m.values.len && c.val_id !in m.values[op].uses {
+				m.values[op].uses << c.val_id
+			}
+		}
+	}
+
+	// Enter the inlined body instead of calling it, and read its result after it
+	m.add_instr(.jmp, site.blk, 0, [m.blocks[clones[0]].val_id])
+	if has_result {
+		res := m.add_instr_front(.load, cont, res_typ, [slot])
+		m.replace_uses(site.call, res)
+	}
+	for op in call.operands {
+		remove_use(mut m, op, site.call)
+	}
+
+	// Keep the inlined blocks and the rest of the calling block right after it
+	mut new_blocks := map[int]bool{}
+	for b in clones {
+		new_blocks[b] = true
+	}
+	new_blocks[cont] = true
+	mut order := []int{cap: m.funcs[fi].blocks.len}
+	for b in m.funcs[fi].blocks {
+		if new_blocks[b] {
+			continue
+		}
+		order << b
+		if b == site.blk {
+			order << clones
+			order << cont
+		}
+	}
+	m.funcs[fi].blocks = order
+}
+
+// set_instr_block updates the block of an instruction, that was moved to another block
+fn set_instr_block(mut m ssa.Module, val_id int, blk_id int) {
+	idx := m.values[val_id].index
+	if m.instrs[idx].block != blk_id {
+		m.instrs[idx] = ssa.Instruction{
+			...m.instrs[idx]
+			block: blk_id
+		}
+	}
+}
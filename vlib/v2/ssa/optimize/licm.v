@@ -0,0 +1,85 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Loop Invariant Code Motion ---
+// A pure instruction in a loop, whose operands are all defined outside of it, computes the same
+// value in every iteration, so it is moved to the preheader of the loop. Inner loops are processed
+// first, so an expression, that is invariant in several nested loops, moves out one loop at a time.
+// Only instructions, that can not trap, are hoisted: a division guarded by a condition in
+// the loop must not run, when the loop is not entered, or the condition is false.
+fn loop_invariant_code_motion(mut m ssa.Module) bool {
+	build_cfg(mut m)
+	compute_dominators(mut m)
+	mut changed := false
+	for fi in 0 .. m.funcs.len {
+		if m.funcs[fi].blocks.len == 0 {
+			continue
+		}
+		mut loops := find_loops(m, m.funcs[fi])
+		for li in 0 .. loops.len {
+			if !ensure_preheader(mut m, mut loops, li) {
+				continue
+			}
+			if hoist_loop_invariants(mut m, m.funcs[fi], loops[li]) {
+				changed = true
+			}
+		}
+	}
+	// new preheaders change the dominator tree
+	build_cfg(mut m)
+	compute_dominators(mut m)
+	return changed
+}
+
+fn hoist_loop_invariants(mut m ssa.Module, func ssa.Function, loop Loop) bool {
+	mut block_of := block_of_instrs(m, func)
+	mut changed := false
+	mut moved := true
+	for moved {
+		moved = false
+		for blk_id in func.blocks {
+			if !loop.body[blk_id] {
+				continue
+			}
+			mut k := 0
+			for k < m.blocks[blk_id].instrs.len {
+				val_id := m.blocks[blk_id].instrs[k]
+				instr := m.instrs[m.values[val_id].index]
+				if is_hoistable_op(instr.op) && instr.operands.len > 0
+					&& is_loop_invariant(m, loop, block_of, instr) {
+					m.blocks[blk_id].instrs.delete(k)
+					insert_before_terminator(mut m, loop.preheader, val_id)
+					block_of[val_id] = loop.preheader
+					moved = true
+					changed = true
+					continue
+				}
+				k++
+			}
+		}
+	}
+	return changed
+}
+
+// is_hoistable_op returns true for the pure operations, that can not trap
+fn is_hoistable_op(op ssa.OpCode) bool {
+	return is_pure_op(op) && op !in [.sdiv, .udiv, .srem, .urem, .fptoui, .fptosi]
+}
+
+fn is_loop_invariant(m &ssa.Module, loop Loop, block_of map[int]int, instr ssa.Instruction) bool {
+	for op in instr.operands {
+		if m.values[op].kind != .instruction {
+			continue
+		}
+		blk := block_of[op] or { return false }
+		if loop.body[blk] {
+			return false
+		}
+	}
+	return true
+}
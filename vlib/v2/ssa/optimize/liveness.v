@@ -0,0 +1,165 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Liveness Analysis ---
+// Liveness computes, which values are live at the start and at the end of each block of a function.
+// It runs on the code after phi elimination, which is what the backends see: an `assign` defines
+// its first operand and uses the second one, so a phi value may be defined several times,
+// and the (now empty) phi instructions are ignored.
+// Only instruction results and function arguments are tracked; the sets are bitsets over
+// the dense indexes in `values`.
+pub struct Liveness {
+pub:
+	values   []int       // dense index -> value id
+	index    map[int]int // value id -> dense index
+	live_in  map[int][]u64
+	live_out map[int][]u64
+}
+
+// is_live_in returns true, when `val_id` is live at the start of the block `blk_id`
+pub fn (l &Liveness) is_live_in(blk_id int, val_id int) bool {
+	return l.has(l.live_in[blk_id] or { return false }, val_id)
+}
+
+// is_live_out returns true, when `val_id` is live at the end of the block `blk_id`
+pub fn (l &Liveness) is_live_out(blk_id int, val_id int) bool {
+	return l.has(l.live_out[blk_id] or { return false }, val_id)
+}
+
+// live_in_values returns the ids of the values, that are live at the start of the block `blk_id`
+pub fn (l &Liveness) live_in_values(blk_id int) []int {
+	return l.members(l.live_in[blk_id] or { return [] })
+}
+
+// live_out_values returns the ids of the values, that are live at the end of the block `blk_id`
+pub fn (l &Liveness) live_out_values(blk_id int) []int {
+	return l.members(l.live_out[blk_id] or { return [] })
+}
+
+fn (l &Liveness) has(set []u64, val_id int) bool {
+	i := l.index[val_id] or { return false }
+	return set[i >> 6] & (u64(1) << (i & 63)) != 0
+}
+
+fn (l &Liveness) members(set []u64) []int {
+	mut res := []int{}
+	for w, word in set {
+		if word == 0 {
+			continue
+		}
+		for b in 0 .. 64 {
+			if word & (u64(1) << b) != 0 {
+				res << l.values[w * 64 + b]
+			}
+		}
+	}
+	return res
+}
+
+// is_tracked_value returns true for the values, that liveness analysis and register allocation care about
+pub fn is_tracked_value(m &ssa.Module, val_id int) bool {
+	kind := m.values[val_id].kind
+	return kind == .instruction || kind == .argument
+}
+
+// compute_liveness solves the usual backward dataflow equations over the CFG of `func`:
+//   live_out(b) = union of live_in(s) for each successor s of b
+//   live_in(b)  = use(b) + (live_out(b) - def(b))
+// iterating the blocks in reverse order, until nothing changes.
+pub fn compute_liveness(m &ssa.Module, func ssa.Function) Liveness {
+	mut values := []int{}
+	mut index := map[int]int{}
+	for pid in func.params {
+		index[pid] = values.len
+		values << pid
+	}
+	for blk_id in func.blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			for op in instr.operands {
+				if op !in index && is_tracked_value(m, op) {
+					index[op] = values.len
+					values << op
+				}
+			}
+			if val_id !in index && is_tracked_value(m, val_id) {
+				index[val_id] = values.len
+				values << val_id
+			}
+		}
+	}
+	words := (values.len + 63) / 64
+
+	// Local use (upward exposed) and def sets
+	mut uses := map[int][]u64{}
+	mut defs := map[int][]u64{}
+	mut succs := map[int][]int{}
+	for blk_id in func.blocks {
+		mut use := []u64{len: words}
+		mut def := []u64{len: words}
+		for val_id in m.blocks[blk_id].instrs {
+			instr := m.instrs[m.values[val_id].index]
+			if instr.op == .phi {
+				continue
+			}
+			first_use := if instr.op == .assign { 1 } else { 0 }
+			for op in instr.operands[first_use..] {
+				if i := index[op] {
+					if def[i >> 6] & (u64(1) << (i & 63)) == 0 {
+						use[i >> 6] |= u64(1) << (i & 63)
+					}
+				}
+			}
+			def_id := if instr.op == .assign { instr.operands[0] } else { val_id }
+			if i := index[def_id] {
+				def[i >> 6] |= u64(1) << (i & 63)
+			}
+		}
+		uses[blk_id] = use
+		defs[blk_id] = def
+		succs[blk_id] = block_successors(m, blk_id)
+	}
+
+	mut live_in := map[int][]u64{}
+	mut live_out := map[int][]u64{}
+	for blk_id in func.blocks {
+		live_in[blk_id] = []u64{len: words}
+		live_out[blk_id] = []u64{len: words}
+	}
+	mut changed := true
+	for changed {
+		changed = false
+		for bi := func.blocks.len - 1; bi >= 0; bi-- {
+			blk_id := func.blocks[bi]
+			mut out := []u64{len: words}
+			for s in succs[blk_id] {
+				s_in := live_in[s] or { continue }
+				for w in 0 .. words {
+					out[w] |= s_in[w]
+				}
+			}
+			use := uses[blk_id]
+			def := defs[blk_id]
+			mut in_ := []u64{len: words}
+			for w in 0 .. words {
+				in_[w] = use[w] | (out[w] & ~def[w])
+			}
+			if in_ != live_in[blk_id] || out != live_out[blk_id] {
+				changed = true
+				live_in[blk_id] = in_
+				live_out[blk_id] = out
+			}
+		}
+	}
+	return Liveness{
+		values:   values
+		index:    index
+		live_in:  live_in
+		live_out: live_out
+	}
+}
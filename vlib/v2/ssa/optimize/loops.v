@@ -0,0 +1,159 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Natural Loops ---
+// A back edge is an edge latch -> header, where the header dominates the latch. The loop of
+// the header is the header itself, plus every block, that can reach a latch without passing
+// through the header. Back edges to the same header form a single loop.
+// Needs the CFG and the dominator tree to be up to date.
+struct Loop {
+mut:
+	header    int
+	latches   []int
+	body      map[int]bool
+	preheader int = -1
+}
+
+// find_loops returns the natural loops of `func`, inner loops first
+fn find_loops(m &ssa.Module, func ssa.Function) []Loop {
+	mut loops := []Loop{}
+	mut loop_of_header := map[int]int{}
+	for blk_id in func.blocks {
+		if m.blocks[blk_id].idom < 0 {
+			// unreachable
+			continue
+		}
+		for h in m.blocks[blk_id].succs {
+			if !dominates(m, func, h, blk_id) {
+				continue
+			}
+			li := loop_of_header[h] or {
+				loop_of_header[h] = loops.len
+				mut body := map[int]bool{}
+				body[h] = true
+				loops << Loop{
+					header: h
+					body:   body
+				}
+				loops.len - 1
+			}
+			loops[li].latches << blk_id
+			mut stack := [blk_id]
+			for stack.len > 0 {
+				b := stack.pop()
+				if loops[li].body[b] {
+					continue
+				}
+				loops[li].body[b] = true
+				for p in m.blocks[b].preds {
+					if m.blocks[p].idom >= 0 {
+						stack << p
+					}
+				}
+			}
+		}
+	}
+	loops.sort(a.body.len < b.body.len)
+	return loops
+}
+
+// ensure_preheader makes sure, that the loop `li` has a preheader: a block outside of the loop,
+// whose only successor is the header, and which is the only predecessor of the header from
+// outside of the loop. Code placed at its end runs once, right before the loop is entered.
+// When the only outside predecessor of the header also branches elsewhere, the edge is split
+// with a new block, that is added to the enclosing loops too. Loops, that are entered from
+// several blocks, are left alone, and false is returned.
+// The preds and succs are kept up to date, but the dominator tree is not.
+fn ensure_preheader(mut m ssa.Module, mut loops []Loop, li int) bool {
+	if loops[li].preheader >= 0 {
+		return true
+	}
+	h := loops[li].header
+	mut outside := []int{}
+	for p in m.blocks[h].preds {
+		if !loops[li].body[p] {
+			outside << p
+		}
+	}
+	if outside.len != 1 {
+		return false
+	}
+	p := outside[0]
+	if m.blocks[p].succs.len == 1 {
+		loops[li].preheader = p
+		return true
+	}
+
+	fi := m.blocks[h].parent
+	ph := m.add_block(fi, 'preheader')
+	m.add_instr(.jmp, ph, 0, [m.blocks[h].val_id])
+	h_val := m.blocks[h].val_id
+	ph_val := m.blocks[ph].val_id
+	// p now branches to the preheader, and the phis of the header receive its values from there
+	term := m.blocks[p].instrs.last()
+	replace_block_operand(mut m, term, h_val, ph_val)
+	for val_id in m.blocks[h].instrs {
+		if m.instrs[m.values[val_id].index].op == .phi {
+			replace_block_operand(mut m, val_id, m.blocks[p].val_id, ph_val)
+		}
+	}
+	m.blocks[p].succs = m.blocks[p].succs.map(if it == h { ph } else { it })
+	m.blocks[h].preds = m.blocks[h].preds.map(if it == p { ph } else { it })
+	m.blocks[ph].preds = [p]
+	m.blocks[ph].succs = [h]
+
+	// keep the preheader right before the header in the block order
+	m.funcs[fi].blocks.delete_last()
+	pos := m.funcs[fi].blocks.index(h)
+	m.funcs[fi].blocks.insert(pos, ph)
+
+	for mut l in loops {
+		if l.body[p] && l.body[h] {
+			l.body[ph] = true
+		}
+	}
+	loops[li].preheader = ph
+	return true
+}
+
+// replace_block_operand replaces the references to a block in the operands of an instruction
+fn replace_block_operand(mut m ssa.Module, val_id int, old_blk_val int, new_blk_val int) {
+	idx := m.values[val_id].index
+	mut replaced := false
+	for i in 0 .. m.instrs[idx].operands.len {
+		if m.instrs[idx].operands[i] == old_blk_val {
+			m.instrs[idx].operands[i] = new_blk_val
+			replaced = true
+		}
+	}
+	if replaced {
+		remove_use(mut m, old_blk_val, val_id)
+		if val_id !in m.values[new_blk_val].uses {
+			m.values[new_blk_val].uses << val_id
+		}
+	}
+}
+
+// insert_before_terminator moves an existing instruction to the end of a block, before its terminator
+fn insert_before_terminator(mut m ssa.Module, blk_id int, val_id int) {
+	pos := m.blocks[blk_id].instrs.len - 1
+	m.blocks[blk_id].instrs.insert(pos, val_id)
+	set_instr_block(mut m, val_id, blk_id)
+}
+
+// block_of_instrs maps each instruction of `func` to the block, that lists it. Unlike the
+// `block` field of the instructions, it stays correct, after merge_blocks moved them.
+fn block_of_instrs(m &ssa.Module, func ssa.Function) map[int]int {
+	mut res := map[int]int{}
+	for blk_id in func.blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			res[val_id] = blk_id
+		}
+	}
+	return res
+}
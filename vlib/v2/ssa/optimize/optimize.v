@@ -13,33 +13,51 @@ const debug_verify = false
 // Optimize Module
 pub fn optimize(mut m ssa.Module) {
 	t := time.now()
-	// 1. Build Control Flow Graph (Predecessors)
+	// 1. Inline small functions, while the locals are still allocas
+	inline_small_functions(mut m)
+	$if debug_verify {
+		verify_and_panic(m, 'inline_small_functions')
+	}
+
+	// 2. Build Control Flow Graph (Predecessors)
 	build_cfg(mut m)
 	$if debug_verify {
 		verify_and_panic(m, 'build_cfg')
 	}
 
-	// 2. Compute Dominator Tree (Lengauer-Tarjan)
+	// 3. Compute Dominator Tree (Lengauer-Tarjan)
 	compute_dominators(mut m)
 	$if debug_verify {
 		verify_and_panic(m, 'compute_dominators')
 	}
 
-	// 3. Promote Memory to Register (Construct SSA / Phi Nodes)
+	// 4. Promote Memory to Register (Construct SSA / Phi Nodes)
 	promote_memory_to_register(mut m)
 	$if debug_verify {
 		verify_and_panic(m, 'promote_memory_to_register')
 	}
 
-	// 4. Scalar Optimizations (run until fixed point)
-	mut opt_changed := true
-	for opt_changed {
-		opt_changed = false
-		opt_changed = constant_fold(mut m) || opt_changed
-		opt_changed = branch_fold(mut m) || opt_changed
-		opt_changed = dead_code_elimination(mut m) || opt_changed
-		opt_changed = simplify_phi_nodes(mut m) || opt_changed
+	// 5. Scalar Optimizations (run until fixed point)
+	scalar_optimizations(mut m)
+	$if debug_verify {
+		verify_and_panic(m, 'scalar_optimizations')
+	}
+
+	// 6. Redundancy Elimination and Loop Optimizations
+	global_value_numbering(mut m)
+	$if debug_verify {
+		verify_and_panic(m, 'global_value_numbering')
 	}
+	loop_invariant_code_motion(mut m)
+	$if debug_verify {
+		verify_and_panic(m, 'loop_invariant_code_motion')
+	}
+	strength_reduction(mut m)
+	$if debug_verify {
+		verify_and_panic(m, 'strength_reduction')
+	}
+	// fold the new constant expressions, and remove the replaced instructions
+	scalar_optimizations(mut m)
 	$if debug_verify {
 		verify_and_panic(m, 'scalar_optimizations')
 	}
@@ -50,7 +68,7 @@ pub fn optimize(mut m ssa.Module) {
 		verify_and_panic(m, 'block_optimizations')
 	}
 
-	// 6. Eliminate Phi Nodes (Lower to Copies for Backend)
+	// 7. Eliminate Phi Nodes (Lower to Copies for Backend)
 	// This includes Critical Edge Splitting and Briggs Parallel Copy Resolution
 	eliminate_phi_nodes(mut m)
 	$if debug_verify {
@@ -59,3 +77,14 @@ pub fn optimize(mut m ssa.Module) {
 
 	println('SSA optimization took ${time.since(t)}')
 }
+
+fn scalar_optimizations(mut m ssa.Module) {
+	mut opt_changed := true
+	for opt_changed {
+		opt_changed = false
+		opt_changed = constant_fold(mut m) || opt_changed
+		opt_changed = branch_fold(mut m) || opt_changed
+		opt_changed = dead_code_elimination(mut m) || opt_changed
+		opt_changed = simplify_phi_nodes(mut m) || opt_changed
+	}
+}
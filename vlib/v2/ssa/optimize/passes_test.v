@@ -0,0 +1,191 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+struct TestLoop {
+	func_id   int
+	n         int // parameter
+	i         int // phi: the loop counter
+	invariant int // n * n
+	scaled    int // i * 8
+	header    int
+	body      int
+}
+
+// build_test_loop builds `fn f(n, p) { for i := 0; i < n; i++ { *p = i * 8 + n * n } }` in SSA form
+fn build_test_loop(mut m ssa.Module) TestLoop {
+	i64_t := m.type_store.get_int(64)
+	ptr_t := m.type_store.get_ptr(i64_t)
+	func_id := m.new_function('f', 0, [i64_t, ptr_t])
+	n := m.add_value_node(.argument, i64_t, 'n', 0)
+	p := m.add_value_node(.argument, ptr_t, 'p', 1)
+	m.funcs[func_id].params << n
+	m.funcs[func_id].params << p
+	entry := m.add_block(func_id, 'entry')
+	header := m.add_block(func_id, 'header')
+	body := m.add_block(func_id, 'body')
+	exit := m.add_block(func_id, 'exit')
+	zero := m.get_or_add_const(i64_t, '0')
+	one := m.get_or_add_const(i64_t, '1')
+	eight := m.get_or_add_const(i64_t, '8')
+
+	m.add_instr(.jmp, entry, 0, [m.blocks[header].val_id])
+	i := m.add_instr(.phi, header, i64_t, [])
+	cond := m.add_instr(.lt, header, m.type_store.get_int(1), [i, n])
+	m.add_instr(.br, header, 0, [cond, m.blocks[body].val_id, m.blocks[exit].val_id])
+	invariant := m.add_instr(.mul, body, i64_t, [n, n])
+	scaled := m.add_instr(.mul, body, i64_t, [i, eight])
+	sum := m.add_instr(.add, body, i64_t, [scaled, invariant])
+	m.add_instr(.store, body, 0, [sum, p])
+	next := m.add_instr(.add, body, i64_t, [i, one])
+	m.add_instr(.jmp, body, 0, [m.blocks[header].val_id])
+	m.add_instr(.ret, exit, 0, [])
+
+	m.instrs[m.values[i].index].operands = [zero, m.blocks[entry].val_id, next,
+		m.blocks[body].val_id]
+	m.values[zero].uses << i
+	m.values[next].uses << i
+	build_cfg(mut m)
+	return TestLoop{
+		func_id:   func_id
+		n:         n
+		i:         i
+		invariant: invariant
+		scaled:    scaled
+		header:    header
+		body:      body
+	}
+}
+
+fn instr_op(m &ssa.Module, val_id int) ssa.OpCode {
+	return m.instrs[m.values[val_id].index].op
+}
+
+fn test_gvn_replaces_dominated_expressions() {
+	mut m := ssa.Module.new('test')
+	i64_t := m.type_store.get_int(64)
+	func_id := m.new_function('g', i64_t, [i64_t, i64_t])
+	a := m.add_value_node(.argument, i64_t, 'a', 0)
+	b := m.add_value_node(.argument, i64_t, 'b', 1)
+	m.funcs[func_id].params << a
+	m.funcs[func_id].params << b
+	entry := m.add_block(func_id, 'entry')
+	next := m.add_block(func_id, 'next')
+	x := m.add_instr(.add, entry, i64_t, [a, b])
+	m.add_instr(.jmp, entry, 0, [m.blocks[next].val_id])
+	// the same sum, with the operands swapped, in a dominated block
+	y := m.add_instr(.add, next, i64_t, [b, a])
+	z := m.add_instr(.sub, next, i64_t, [y, x])
+	m.add_instr(.ret, next, 0, [z])
+
+	assert global_value_numbering(mut m)
+	assert m.instrs[m.values[z].index].operands == [x, x]
+	assert m.values[y].uses.len == 0
+	// a - b is a different expression
+	assert !global_value_numbering(mut m)
+}
+
+fn test_licm_hoists_invariants_to_the_preheader() {
+	mut m := ssa.Module.new('test')
+	l := build_test_loop(mut m)
+	assert loop_invariant_code_motion(mut m)
+	entry := m.funcs[l.func_id].blocks[0]
+	// n * n moved to the block before the loop, right before its terminator
+	assert l.invariant in m.blocks[entry].instrs
+	assert l.invariant !in m.blocks[l.body].instrs
+	assert m.blocks[entry].instrs[m.blocks[entry].instrs.len - 2] == l.invariant
+	// i * 8 depends on the loop counter
+	assert l.scaled in m.blocks[l.body].instrs
+	errors := verify(m).filter(!it.is_warning())
+	assert errors.len == 0, 'expected no errors, got: ${errors}'
+}
+
+fn test_strength_reduction_of_induction_variables() {
+	mut m := ssa.Module.new('test')
+	l := build_test_loop(mut m)
+	assert strength_reduction(mut m)
+	// i * 8 is replaced by a new phi in the header, that is incremented by 8
+	assert instr_op(m, l.scaled) == .bitcast
+	assert m.values[l.scaled].uses.len == 0
+	j := m.blocks[l.header].instrs[0]
+	assert j != l.i
+	assert instr_op(m, j) == .phi
+	phi := m.instrs[m.values[j].index]
+	assert phi.operands.len == 4
+	step := m.instrs[m.values[phi.operands[2]].index]
+	assert step.op == .add
+	assert step.operands[0] == j
+	assert m.values[step.operands[1]].name == '8'
+	errors := verify(m).filter(!it.is_warning())
+	assert errors.len == 0, 'expected no errors, got: ${errors}'
+}
+
+fn test_inline_small_function() {
+	mut m := ssa.Module.new('test')
+	i64_t := m.type_store.get_int(64)
+	// fn sq(x i64) i64 { return x * x }
+	sq := m.new_function('sq', i64_t, [i64_t])
+	x := m.add_value_node(.argument, i64_t, 'x', 0)
+	m.funcs[sq].params << x
+	sq_entry := m.add_block(sq, 'entry')
+	r := m.add_instr(.mul, sq_entry, i64_t, [x, x])
+	m.add_instr(.ret, sq_entry, 0, [r])
+	// fn main2(a i64) i64 { return sq(a) + 1 }
+	caller := m.new_function('main2', i64_t, [i64_t])
+	a := m.add_value_node(.argument, i64_t, 'a', 0)
+	m.funcs[caller].params << a
+	entry := m.add_block(caller, 'entry')
+	callee := m.add_value_node(.unknown, 0, 'sq', 0)
+	call := m.add_instr(.call, entry, i64_t, [callee, a])
+	sum := m.add_instr(.add, entry, i64_t, [call, m.get_or_add_const(i64_t, '1')])
+	ret := m.add_instr(.ret, entry, 0, [sum])
+
+	assert inline_small_functions(mut m)
+	for blk_id in m.funcs[caller].blocks {
+		for val_id in m.blocks[blk_id].instrs {
+			assert instr_op(m, val_id) != .call
+		}
+	}
+	assert m.values[call].uses.len == 0
+	// the callee itself is unchanged
+	assert m.funcs[sq].blocks == [sq_entry]
+	assert m.blocks[sq_entry].instrs.len == 2
+
+	compute_dominators(mut m)
+	promote_memory_to_register(mut m)
+	// after mem2reg, the result slot is gone, and sq(a) is just a * a
+	sum_instr := m.instrs[m.values[sum].index]
+	res := m.instrs[m.values[sum_instr.operands[0]].index]
+	assert res.op == .mul
+	assert res.operands == [a, a]
+	assert m.instrs[m.values[ret].index].operands == [sum]
+	errors := verify(m).filter(!it.is_warning())
+	assert errors.len == 0, 'expected no errors, got: ${errors}'
+}
+
+fn test_inline_respects_never_hint() {
+	mut m := ssa.Module.new('test')
+	i64_t := m.type_store.get_int(64)
+	sq := m.new_function('sq', i64_t, [i64_t])
+	x := m.add_value_node(.argument, i64_t, 'x', 0)
+	m.funcs[sq].params << x
+	sq_entry := m.add_block(sq, 'entry')
+	m.add_instr(.ret, sq_entry, 0, [m.add_instr(.mul, sq_entry, i64_t, [x, x])])
+	caller := m.new_function('main2', i64_t, [i64_t])
+	a := m.add_value_node(.argument, i64_t, 'a', 0)
+	m.funcs[caller].params << a
+	entry := m.add_block(caller, 'entry')
+	call := m.add_instr(.call, entry, i64_t, [m.add_value_node(.unknown, 0, 'sq', 0), a])
+	m.add_instr(.ret, entry, 0, [call])
+	idx := m.values[call].index
+	m.instrs[idx] = ssa.Instruction{
+		...m.instrs[idx]
+		inline: .never
+	}
+	assert !inline_small_functions(mut m)
+	assert m.funcs[caller].blocks == [entry]
+}
@@ -0,0 +1,185 @@
+// Copyright (c) 2026 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module optimize
+
+import v2.ssa
+
+// --- Strength Reduction of Induction Variables ---
+// A basic induction variable is a phi in a loop header, that starts with `init` and is
+// incremented by a constant `step` in every iteration:
+//   i = phi [init, preheader], [next, latch];  next = add i, step
+// A multiplication of it by a constant `c` (or a shift by a constant) is replaced by a new
+// induction variable, that starts with `init * c`, and is incremented by `step * c`, so that
+// indexing an array in a loop needs an add instead of a multiply in each iteration.
+// It runs on SSA form, before phi elimination.
+
+struct InductionVar {
+	phi  int
+	init int
+	next int
+	step i64
+}
+
+fn strength_reduction(mut m ssa.Module) bool {
+	build_cfg(mut m)
+	compute_dominators(mut m)
+	mut changed := false
+	for fi in 0 .. m.funcs.len {
+		if m.funcs[fi].blocks.len == 0 {
+			continue
+		}
+		mut loops := find_loops(m, m.funcs[fi])
+		for li in 0 .. loops.len {
+			if loops[li].latches.len != 1 || !ensure_preheader(mut m, mut loops, li) {
+				continue
+			}
+			if reduce_loop(mut m, m.funcs[fi], loops[li]) {
+				changed = true
+			}
+		}
+	}
+	build_cfg(mut m)
+	compute_dominators(mut m)
+	return changed
+}
+
+fn reduce_loop(mut m ssa.Module, func ssa.Function, loop Loop) bool {
+	ivs := find_induction_vars(m, loop)
+	if ivs.len == 0 {
+		return false
+	}
+	mut block_of := block_of_instrs(m, func)
+	mut reduced := map[string]int{} // 'phi:factor' -> the new induction variable
+	mut changed := false
+	for blk_id in func.blocks {
+		if !loop.body[blk_id] {
+			continue
+		}
+		for val_id in m.blocks[blk_id].instrs.clone() {
+			instr := m.instrs[m.values[val_id].index]
+			if instr.operands.len != 2 || instr.op !in [.mul, .shl] {
+				continue
+			}
+			mut iv_id := instr.operands[0]
+			mut other := instr.operands[1]
+			if instr.op == .mul && iv_id !in ivs {
+				iv_id, other = other, iv_id
+			}
+			iv := ivs[iv_id] or { continue }
+			if m.values[val_id].typ != m.values[iv_id].typ {
+				continue
+			}
+			c := const_int_value(m, other) or { continue }
+			mut factor := c
+			if instr.op == .shl {
+				if c < 0 || c > 62 {
+					continue
+				}
+				factor = i64(1) << c
+			}
+			key := '${iv_id}:${factor}'
+			j := reduced[key] or {
+				new_iv := add_scaled_induction_var(mut m, loop, iv, factor, mut block_of)
+				reduced[key] = new_iv
+				new_iv
+			}
+			m.replace_uses(val_id, j)
+			nop_instr(mut m, val_id)
+			changed = true
+		}
+	}
+	return changed
+}
+
+// find_induction_vars returns the basic induction variables of a loop with a preheader and a single latch
+fn find_induction_vars(m &ssa.Module, loop Loop) map[int]InductionVar {
+	mut res := map[int]InductionVar{}
+	pre_val := m.blocks[loop.preheader].val_id
+	latch_val := m.blocks[loop.latches[0]].val_id
+	for val_id in m.blocks[loop.header].instrs {
+		instr := m.instrs[m.values[val_id].index]
+		if instr.op != .phi || instr.operands.len != 4 {
+			continue
+		}
+		mut init := -1
+		mut next := -1
+		for i := 0; i < 4; i += 2 {
+			if instr.operands[i + 1] == pre_val {
+				init = instr.operands[i]
+			} else if instr.operands[i + 1] == latch_val {
+				next = instr.operands[i]
+			}
+		}
+		if init < 0 || next < 0 || m.values[next].kind != .instruction {
+			continue
+		}
+		next_instr := m.instrs[m.values[next].index]
+		if next_instr.op != .add || next_instr.operands.len != 2 {
+			continue
+		}
+		step_id := if next_instr.operands[0] == val_id {
+			next_instr.operands[1]
+		} else if next_instr.operands[1] == val_id {
+			next_instr.operands[0]
+		} else {
+			-1
+		}
+		if step_id < 0 {
+			continue
+		}
+		step := const_int_value(m, step_id) or { continue }
+		res[val_id] = InductionVar{
+			phi:  val_id
+			init: init
+			next: next
+			step: step
+		}
+	}
+	return res
+}
+
+// add_scaled_induction_var creates the induction variable `iv * factor`:
+//   preheader: init_j = mul init, factor
+//   header:    j = phi [init_j, preheader], [next_j, latch]
+//   after next: next_j = add j, step * factor
+fn add_scaled_induction_var(mut m ssa.Module, loop Loop, iv InductionVar, factor i64, mut block_of map[int]int) int {
+	typ := m.values[iv.phi].typ
+	factor_const := m.get_or_add_const(typ, factor.str())
+	step_const := m.get_or_add_const(typ, (iv.step * factor).str())
+
+	init_j := m.add_instr(.mul, loop.preheader, typ, [iv.init, factor_const])
+	m.blocks[loop.preheader].instrs.delete_last()
+	insert_before_terminator(mut m, loop.preheader, init_j)
+	block_of[init_j] = loop.preheader
+
+	j := m.add_instr_front(.phi, loop.header, typ, [])
+	block_of[j] = loop.header
+
+	next_blk := block_of[iv.next]
+	next_j := m.add_instr(.add, next_blk, typ, [j, step_const])
+	m.blocks[next_blk].instrs.delete_last()
+	pos := m.blocks[next_blk].instrs.index(iv.next)
+	m.blocks[next_blk].instrs.insert(pos + 1, next_j)
+	block_of[next_j] = next_blk
+
+	pre_val := m.blocks[loop.preheader].val_id
+	latch_val := m.blocks[loop.latches[0]].val_id
+	m.instrs[m.values[j].index].operands = [init_j, pre_val, next_j, latch_val]
+	m.values[init_j].uses << j
+	m.values[next_j].uses << j
+	return j
+}
+
+// const_int_value returns the value of an integer constant
+fn const_int_value(m &ssa.Module, val_id int) ?i64 {
+	val := m.values[val_id]
+	if val.kind != .constant || m.type_store.types[val.typ].kind != .int_t {
+		return none
+	}
+	if val.name.len == 0 || !(val.name[0].is_digit() || val.name[0] == `-`) {
+		return none
+	}
+	return val.name.i64()
+}
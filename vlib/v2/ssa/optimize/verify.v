@@ -32,6 +32,12 @@ fn (e VerifyError) str() string {
 	return '${s}: ${e.msg}'
 }
 
+// is_warning returns true for the non-critical errors, that verify_and_panic/2 tolerates
+fn (e VerifyError) is_warning() bool {
+	return e.msg.contains('does not dominate') || e.msg.contains('uses list')
+		|| e.msg.contains('phi') || e.msg.contains('block mismatch')
+}
+
 // verify performs comprehensive validation of SSA invariants.
 // Returns a list of errors found (empty if valid).
 // Call this after optimization passes to catch bugs.
@@ -63,8 +69,7 @@ pub fn verify_and_panic(m &ssa.Module, pass_name string) {
 		mut critical_errors := []VerifyError{}
 		mut warning_count := 0
 		for err in errors {
-			if err.msg.contains('does not dominate') || err.msg.contains('uses list')
-				|| err.msg.contains('phi') || err.msg.contains('block mismatch') {
+			if err.is_warning() {
 				warning_count++
 			} else {
 				critical_errors << err
@@ -107,6 +112,26 @@ fn verify_function(m &ssa.Module, func ssa.Function) []VerifyError {
 		errors << verify_block(m, func, blk_id)
 	}
 
+	// Passes that move instructions (inlining, LICM) must remove them from their old block
+	mut listed_in := map[int]int{}
+	for blk_id in func.blocks {
+		if blk_id < 0 || blk_id >= m.blocks.len {
+			continue
+		}
+		for val_id in m.blocks[blk_id].instrs {
+			if prev := listed_in[val_id] {
+				errors << VerifyError{
+					msg:      'instruction ${val_id} is listed in both block ${prev} and block ${blk_id}'
+					func_id:  func.id
+					block_id: blk_id
+					val_id:   val_id
+				}
+			} else {
+				listed_in[val_id] = blk_id
+			}
+		}
+	}
+
 	// Verify dominance (values must dominate their uses)
 	errors << verify_dominance(m, func)
 
@@ -30,12 +30,13 @@ pub fn (mut c Controller) register_controller[A, X](path string, mut global_app
 pub fn controller[A, X](path string, mut global_app A) !&ControllerPath {
 	routes := generate_routes[A, X](global_app) or { panic(err.msg()) }
 	controllers_sorted := check_duplicate_routes_in_controllers[A](global_app, routes)!
+	router := build_router(routes)
 
 	// generate struct with closure so the generic type is encapsulated in the closure
 	// no need to type `ControllerHandler` as generic since it's not needed for closures
 	return &ControllerPath{
 		path:    path
-		handler: fn [mut global_app, path, routes, controllers_sorted] [A, X](ctx &Context, mut url urllib.URL, host string) &Context {
+		handler: fn [mut global_app, path, router, controllers_sorted] [A, X](ctx &Context, mut url urllib.URL, host string) &Context {
 			// transform the url
 			url.path = url.path.all_after_first(path)
 
@@ -52,7 +53,7 @@ pub fn controller[A, X](path string, mut global_app A) !&ControllerPath {
 			mut user_context := X{}
 			user_context.Context = ctx
 
-			handle_route[A, X](mut global_app, mut user_context, url, host, &routes)
+			handle_route[A, X](mut global_app, mut user_context, url, host, router)
 			// we need to explicitly tell the V compiler to return a reference
 			return &user_context.Context
 		}
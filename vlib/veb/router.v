@@ -0,0 +1,212 @@
+module veb
+
+import net.http
+
+// Router is the compiled form of the routes returned by `generate_routes`.
+// It is built once at startup, and is then used to dispatch every request
+// with a single walk over the words of the URL path, instead of matching
+// the URL against each route in turn.
+@[heap]
+struct Router {
+mut:
+	// routes that have a `host:` attribute, keyed by their (lowercase) host
+	hosts map[string]&RouteTable
+	// routes that match any host
+	any_host &RouteTable = &RouteTable{}
+}
+
+// RouteTable keeps a separate routing tree for each HTTP method, so that a
+// lookup never has to skip routes that do not accept the request method.
+@[heap]
+struct RouteTable {
+mut:
+	methods map[int]&RouteNode
+}
+
+// RouteNode corresponds to one word of a route path. The children are split
+// by kind into static words, `:param` words and the `:path...` wildcard.
+@[heap]
+struct RouteNode {
+mut:
+	// the lowest declaration order of all routes in this subtree
+	min_order       int = max_int
+	static_children map[string]&RouteNode
+	param_child     &RouteNode = unsafe { nil }
+	// routes ending at this node
+	leaves []RouteLeaf
+	// routes ending with a `:path...` word after this node
+	wildcards []RouteLeaf
+}
+
+struct RouteLeaf {
+	name    string
+	order   int // position of the handler in the app declaration
+	route   Route
+	dynamic bool // the route path has `:param` words, which are passed as method arguments
+}
+
+// RouteMatch is the result of a successful router lookup
+struct RouteMatch {
+	name    string
+	route   Route
+	dynamic bool
+	params  []string
+}
+
+// build_router compiles `routes` into routing trees. When several routes
+// match an URL, the one that was declared first in the app wins.
+fn build_router(routes map[string]Route) &Router {
+	mut router := &Router{}
+	mut order := 0
+	for name, route in routes {
+		router.add(name, route, order)
+		order++
+	}
+	return router
+}
+
+fn (mut router Router) add(name string, route Route, order int) {
+	mut table := router.any_host
+	if route.host != '' {
+		table = router.hosts[route.host] or {
+			t := &RouteTable{}
+			router.hosts[route.host] = t
+			t
+		}
+	}
+	words := route.path.split('/').filter(it != '')
+	leaf := RouteLeaf{
+		name:    name
+		order:   order
+		route:   route
+		dynamic: route.path.contains('/:')
+	}
+	for method in route.methods {
+		mut root := table.methods[int(method)] or {
+			r := &RouteNode{}
+			table.methods[int(method)] = r
+			r
+		}
+		root.insert(words, leaf)
+		// `fn index()` without a path attribute also handles `/`
+		if name == 'index' && words == ['index'] {
+			root.leaves << leaf
+		}
+	}
+}
+
+fn (mut node RouteNode) insert(words []string, leaf RouteLeaf) {
+	if leaf.order < node.min_order {
+		node.min_order = leaf.order
+	}
+	if words.len == 0 {
+		node.leaves << leaf
+		return
+	}
+	word := words[0]
+	if words.len == 1 && word.starts_with(':') && word.ends_with('...') {
+		node.wildcards << leaf
+		return
+	}
+	if word.starts_with(':') {
+		if isnil(node.param_child) {
+			node.param_child = &RouteNode{}
+		}
+		node.param_child.insert(words[1..], leaf)
+		return
+	}
+	mut child := node.static_children[word] or {
+		c := &RouteNode{}
+		node.static_children[word] = c
+		c
+	}
+	child.insert(words[1..], leaf)
+}
+
+// match_route finds the handler for a request with the HTTP method `method`,
+// sent to `host`, and with the URL path split into `url_words`.
+fn (router &Router) match_route(method http.Method, host string, url_words []string) ?RouteMatch {
+	mut search := RouteSearch{
+		params: []string{cap: url_words.len}
+	}
+	if host != '' && router.hosts.len > 0 {
+		if table := router.hosts[host] {
+			if root := table.methods[int(method)] {
+				root.find(url_words, 0, mut search)
+			}
+		}
+	}
+	if root := router.any_host.methods[int(method)] {
+		root.find(url_words, 0, mut search)
+	}
+	if !search.found {
+		return none
+	}
+	return RouteMatch{
+		name:    search.best.name
+		route:   search.best.route
+		dynamic: search.best.dynamic
+		params:  search.best_params
+	}
+}
+
+// RouteSearch keeps the state of a single lookup in the routing trees
+struct RouteSearch {
+mut:
+	params      []string
+	found       bool
+	best        RouteLeaf
+	best_params []string
+}
+
+// improves_on returns true, if a route declared at position `order` is preferred
+// over the best route that was found so far
+@[inline]
+fn (search &RouteSearch) improves_on(order int) bool {
+	return !search.found || order < search.best.order
+}
+
+fn (mut search RouteSearch) accept(leaf RouteLeaf) {
+	search.found = true
+	search.best = leaf
+	search.best_params = search.params.clone()
+}
+
+// accept_wildcard is like `accept`, but also passes the URL words matched
+// by the `:path...` word as the last parameter
+fn (mut search RouteSearch) accept_wildcard(leaf RouteLeaf, rest string) {
+	search.accept(leaf)
+	search.best_params << rest
+}
+
+// find walks every branch of the tree that can match `url_words`, skipping
+// the subtrees that only have routes declared after the best match so far.
+@[direct_array_access]
+fn (node &RouteNode) find(url_words []string, i int, mut search RouteSearch) {
+	if !search.improves_on(node.min_order) {
+		return
+	}
+	if i == url_words.len {
+		// the leaves are sorted in declaration order
+		if node.leaves.len > 0 && search.improves_on(node.leaves[0].order) {
+			search.accept(node.leaves[0])
+		}
+	} else {
+		if child := node.static_children[url_words[i]] {
+			child.find(url_words, i + 1, mut search)
+		}
+		if !isnil(node.param_child) {
+			search.params << url_words[i]
+			node.param_child.find(url_words, i + 1, mut search)
+			search.params.delete_last()
+		}
+	}
+	if node.wildcards.len > 0 && search.improves_on(node.wildcards[0].order) {
+		if i == 0 {
+			// a catchall route (`/:path...`) matches every URL, including `/`
+			search.accept_wildcard(node.wildcards[0], '/' + url_words.join('/'))
+		} else if i < url_words.len {
+			search.accept_wildcard(node.wildcards[0], url_words[i..].join('/'))
+		}
+	}
+}
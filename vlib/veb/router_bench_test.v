@@ -0,0 +1,67 @@
+module veb
+
+import benchmark
+
+// Compares the compiled router with the linear scan over all routes, that
+// `handle_route` used before, for an app with 400 handlers.
+const bench_nr_routes = 400
+const bench_iterations = 20_000
+
+fn bench_routes() map[string]Route {
+	mut routes := map[string]Route{}
+	for i in 0 .. bench_nr_routes {
+		path := match i % 4 {
+			0 { '/api/v1/resource${i}' }
+			1 { '/api/v1/resource${i}/:id' }
+			2 { '/api/v1/resource${i}/:id/items/:item' }
+			else { '/static${i}/:path...' }
+		}
+		routes['handler${i}'] = Route{
+			methods: [.get]
+			path:    path
+		}
+	}
+	return routes
+}
+
+fn linear_match(routes map[string]Route, url_words []string) ?string {
+	for name, route in routes {
+		route_words := route.path.split('/').filter(it != '')
+		if !route.path.contains('/:') && url_words == route_words {
+			return name
+		}
+		if _ := route_matches(url_words, route_words) {
+			return name
+		}
+	}
+	return none
+}
+
+fn test_benchmark_router() {
+	routes := bench_routes()
+	router := build_router(routes)
+	mut urls := [][]string{}
+	for url in ['/api/v1/resource0', '/api/v1/resource201/42', '/api/v1/resource398/42/items/7',
+		'/static399/css/main.css', '/not/found'] {
+		urls << url.split('/').filter(it != '')
+	}
+	for url_words in urls {
+		linear := linear_match(routes, url_words) or { '' }
+		compiled := router.match_route(.get, '', url_words) or { RouteMatch{} }
+		assert linear == compiled.name
+	}
+
+	mut bmark := benchmark.start()
+	for _ in 0 .. bench_iterations / 100 {
+		for url_words in urls {
+			_ = linear_match(routes, url_words) or { '' }
+		}
+	}
+	bmark.measure('linear scan, ${bench_iterations / 100 * urls.len} lookups')
+	for _ in 0 .. bench_iterations {
+		for url_words in urls {
+			_ = router.match_route(.get, '', url_words) or { RouteMatch{} }
+		}
+	}
+	bmark.measure('router, ${bench_iterations * urls.len} lookups')
+}
@@ -0,0 +1,125 @@
+module veb
+
+import net.http
+
+fn new_test_route(path string, methods []http.Method, host string) Route {
+	return Route{
+		methods: methods
+		path:    path
+		host:    host
+	}
+}
+
+fn new_router_for_tests() &Router {
+	mut routes := map[string]Route{}
+	routes['admin'] = new_test_route('/admin', [.get], 'admin.example.com')
+	routes['index'] = new_test_route('/index', [.get], '')
+	routes['register'] = new_test_route('/register', [.get, .post], '')
+	routes['user'] = new_test_route('/:user', [.get], '')
+	routes['settings'] = new_test_route('/:user/settings', [.get], '')
+	routes['repo_settings'] = new_test_route('/:user/:repo/settings', [.get], '')
+	routes['files'] = new_test_route('/files/:path...', [.get], '')
+	routes['update'] = new_test_route('/user/:id', [.put], '')
+	return build_router(routes)
+}
+
+fn lookup(router &Router, method http.Method, host string, url string) RouteMatch {
+	return router.match_route(method, host, url.split('/').filter(it != '')) or {
+		panic('should match: ${method} ${host}${url}')
+	}
+}
+
+fn no_match(router &Router, method http.Method, host string, url string) bool {
+	router.match_route(method, host, url.split('/').filter(it != '')) or { return true }
+	return false
+}
+
+fn test_static_and_param_routes() {
+	router := new_router_for_tests()
+	m := lookup(router, .get, '', '/register')
+	assert m.name == 'register'
+	assert !m.dynamic
+	assert m.params.len == 0
+	u := lookup(router, .get, '', '/bob')
+	assert u.name == 'user'
+	assert u.dynamic
+	assert u.params == ['bob']
+}
+
+fn test_routes_match_in_declaration_order() {
+	mut routes := map[string]Route{}
+	routes['with_parameter'] = new_test_route('/:path', [.get], '')
+	routes['normal'] = new_test_route('/normal', [.get], '')
+	routes['nested_normal'] = new_test_route('/a/normal', [.get], '')
+	routes['nested_param'] = new_test_route('/a/:b', [.get], '')
+	router := build_router(routes)
+	assert lookup(router, .get, '', '/normal').name == 'with_parameter'
+	assert lookup(router, .get, '', '/a/normal').name == 'nested_normal'
+	assert lookup(router, .get, '', '/a/other').name == 'nested_param'
+}
+
+fn test_index_matches_root() {
+	router := new_router_for_tests()
+	assert lookup(router, .get, '', '/').name == 'index'
+	assert lookup(router, .get, '', '/index').name == 'index'
+}
+
+fn test_params_and_backtracking() {
+	router := new_router_for_tests()
+	m := lookup(router, .get, '', '/register/settings')
+	assert m.name == 'settings'
+	assert m.params == ['register']
+	r := lookup(router, .get, '', '/bob/v/settings')
+	assert r.name == 'repo_settings'
+	assert r.params == ['bob', 'v']
+	assert no_match(router, .get, '', '/bob/v/other')
+}
+
+fn test_wildcard() {
+	router := new_router_for_tests()
+	m := lookup(router, .get, '', '/files/a/b/c.txt')
+	assert m.name == 'files'
+	assert m.params == ['a/b/c.txt']
+	// without more words, `/files` is handled by the `/:user` route
+	assert lookup(router, .get, '', '/files').name == 'user'
+}
+
+fn test_catchall() {
+	mut routes := map[string]Route{}
+	routes['about'] = new_test_route('/about', [.get], '')
+	routes['catchall'] = new_test_route('/:path...', [.get], '')
+	router := build_router(routes)
+	assert lookup(router, .get, '', '/about').name == 'about'
+	m := lookup(router, .get, '', '/a/b')
+	assert m.name == 'catchall'
+	assert m.params == ['/a/b']
+	root := lookup(router, .get, '', '/')
+	assert root.params == ['/']
+}
+
+fn test_methods() {
+	router := new_router_for_tests()
+	assert lookup(router, .post, '', '/register').name == 'register'
+	assert lookup(router, .put, '', '/user/1').name == 'update'
+	assert no_match(router, .get, '', '/user/1')
+	assert no_match(router, .delete, '', '/register')
+}
+
+fn test_hosts() {
+	router := new_router_for_tests()
+	assert lookup(router, .get, 'admin.example.com', '/admin').name == 'admin'
+	// `/admin` is handled by the `/:user` route for all other hosts
+	assert lookup(router, .get, 'example.com', '/admin').name == 'user'
+	assert lookup(router, .get, 'admin.example.com', '/bob').name == 'user'
+}
+
+fn test_router_agrees_with_route_matches() {
+	router := new_router_for_tests()
+	for url in ['/bob/settings', '/bob/v/settings', '/files/x/y', '/files/x'] {
+		url_words := url.split('/').filter(it != '')
+		m := lookup(router, .get, '', url)
+		route_words := m.route.path.split('/').filter(it != '')
+		params := route_matches(url_words, route_words) or { panic('should match: ${url}') }
+		assert params == m.params
+	}
+}
@@ -120,7 +120,7 @@ $if !new_veb ? {
 	struct RequestParams {
 		global_app         voidptr
 		controllers        []&ControllerPath
-		routes             &map[string]Route
+		router             &Router
 		timeout_in_seconds int
 	mut:
 		// request body buffer
@@ -154,7 +154,7 @@ mut:
 	before_request()
 }
 
-fn handle_route[A, X](mut app A, mut user_context X, url urllib.URL, host string, routes &map[string]Route) {
+fn handle_route[A, X](mut app A, mut user_context X, url urllib.URL, host string, router &Router) {
 	mut route := Route{}
 	mut middleware_has_sent_response := false
 	mut not_found := false
@@ -234,96 +234,49 @@ fn handle_route[A, X](mut app A, mut user_context X, url urllib.URL, host string
 	}
 
 	// Route matching and match route specific middleware as last step
+	matched := router.match_route(user_context.Context.req.method, host, url_words) or {
+		// return 404
+		user_context.not_found()
+		not_found = true
+		return
+	}
+	route = matched.route
+	can_have_data_args := user_context.Context.req.method == .post
+		|| user_context.Context.req.method == .get
 	$for method in A.methods {
 		$if method.return_type is Result {
-			route = (*routes)[method.name] or {
-				eprintln('[veb] parsed attributes for the `${method.name}` are not found, skipping...')
-				Route{}
-			}
-
-			// Skip if the HTTP request method does not match the attributes
-			if user_context.Context.req.method in route.methods {
-				// Used for route matching
-				route_words := route.path.split('/').filter(it != '')
-
-				// Skip if the host does not match or is empty
-				if route.host == '' || route.host == host {
-					can_have_data_args := user_context.Context.req.method == .post
-						|| user_context.Context.req.method == .get
-					// Route immediate matches first
-					// For example URL `/register` matches route `/:user`, but `fn register()`
-					// should be called first.
-					if !route.path.contains('/:') && url_words == route_words {
-						// We found a match
-						$if A is MiddlewareApp {
-							if validate_middleware[X](mut user_context, route.middlewares) == false {
-								middleware_has_sent_response = true
-								return
-							}
-						}
-						if method.args.len > 1 && can_have_data_args {
-							// Populate method args with form or query values
-							mut args := []string{cap: method.args.len + 1}
-							data := if user_context.Context.req.method == .get {
-								user_context.Context.query
-							} else {
-								user_context.Context.form
-							}
-							for param in method.args[1..] {
-								args << data[param.name]
-							}
-							app.$method(mut user_context, args)
-						} else {
-							app.$method(mut user_context)
-						}
+			if method.name == matched.name {
+				$if A is MiddlewareApp {
+					if validate_middleware[X](mut user_context, route.middlewares) == false {
+						middleware_has_sent_response = true
 						return
 					}
-
-					if url_words.len == 0 && route_words == ['index'] && method.name == 'index' {
-						$if A is MiddlewareApp {
-							if validate_middleware[X](mut user_context, route.middlewares) == false {
-								middleware_has_sent_response = true
-								return
-							}
-						}
-
-						if method.args.len > 1 && can_have_data_args {
-							// Populate method args with form or query values
-							mut args := []string{cap: method.args.len + 1}
-							data := if user_context.Context.req.method == .get {
-								user_context.Context.query
-							} else {
-								user_context.Context.form
-							}
-							for param in method.args[1..] {
-								args << data[param.name]
-							}
-							app.$method(mut user_context, args)
-						} else {
-							app.$method(mut user_context)
-						}
-						return
+				}
+				if matched.dynamic {
+					if matched.params.len + 1 != method.args.len {
+						eprintln('[veb] warning: uneven parameters count (${method.args.len}) in `${method.name}`, compared to the veb route `${method.attrs}` (${matched.params.len})')
 					}
-
-					if params := route_matches(url_words, route_words) {
-						$if A is MiddlewareApp {
-							if validate_middleware[X](mut user_context, route.middlewares) == false {
-								middleware_has_sent_response = true
-								return
-							}
-						}
-						method_args := params.clone()
-						if method_args.len + 1 != method.args.len {
-							eprintln('[veb] warning: uneven parameters count (${method.args.len}) in `${method.name}`, compared to the veb route `${method.attrs}` (${method_args.len})')
-						}
-						app.$method(mut user_context, method_args)
-						return
+					app.$method(mut user_context, matched.params)
+				} else if method.args.len > 1 && can_have_data_args {
+					// Populate method args with form or query values
+					mut args := []string{cap: method.args.len + 1}
+					data := if user_context.Context.req.method == .get {
+						user_context.Context.query
+					} else {
+						user_context.Context.form
 					}
+					for param in method.args[1..] {
+						args << data[param.name]
+					}
+					app.$method(mut user_context, args)
+				} else {
+					app.$method(mut user_context)
 				}
+				return
 			}
 		}
 	}
-	// return 404
+	// the router returned a method, which is not a handler of `A`
 	user_context.not_found()
 	not_found = true
 	return
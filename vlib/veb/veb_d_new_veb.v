@@ -11,7 +11,7 @@ import net.urllib
 struct RequestParams {
 	global_app                voidptr
 	controllers_sorted        []&ControllerPath
-	routes                    &map[string]Route
+	router                    &Router
 	benchmark_page_generation bool
 }
 
@@ -35,7 +35,7 @@ pub fn run_new[A, X](mut global_app A, params RunParams) ! {
 	request_params := &RequestParams{
 		global_app:                global_app
 		controllers_sorted:        controllers_sorted
-		routes:                    &routes
+		router:                    build_router(routes)
 		benchmark_page_generation: params.benchmark_page_generation
 	}
 
@@ -60,9 +60,14 @@ fn parallel_request_handler[A, X](req fasthttp.HttpRequest) !fasthttp.HttpRespon
 
 	client_fd := req.client_conn_fd
 
+	// `req.buffer` borrows the read buffer of the fasthttp worker, which is reused
+	// for the next request, while the `http.Request`, and the query and form maps of
+	// the `Context` are public, and may be kept by the app after the route returns.
+	// That is why they are not built from the borrowed views of `req`; `bytestr()`
+	// makes the only copy of the raw request.
 	s := req.buffer.bytestr()
 	// Parse the raw request bytes into a standard `http.Request`.
-	req2 := http.parse_request_str(s.clone()) or {
+	req2 := http.parse_request_str(s) or {
 		return fasthttp.HttpResponse{
 			content: 'HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n'.bytes()
 		}
@@ -70,25 +75,47 @@ fn parallel_request_handler[A, X](req fasthttp.HttpRequest) !fasthttp.HttpRespon
 	// Create and populate the `veb.Context`.
 	completed_context := handle_request_and_route[A, X](mut global_app, req2, client_fd,
 		params)
-	// params.routes, params.controllers_sorted)
-	// Serialize the final `http.Response` into a byte array.
 	if completed_context.takeover {
 		eprintln('[veb] WARNING: ctx.takeover_conn() was called, but this is not supported by this server backend. The connection will be closed after this response.')
 	}
 
+	// The fasthttp server expects a complete response buffer to be returned.
+	// The final `http.Response` is serialized into the arena of the worker, which is
+	// reused after the response is sent.
+	content := if isnil(req.arena) {
+		completed_context.res.bytes()
+	} else {
+		mut arena := unsafe { req.arena }
+		write_response(mut arena, completed_context.res)
+	}
 	if completed_context.return_type == .file {
 		return fasthttp.HttpResponse{
-			content:   completed_context.res.bytes()
+			content:   content
 			file_path: completed_context.return_file
 		}
 	}
-
-	// The fasthttp server expects a complete response buffer to be returned.
 	return fasthttp.HttpResponse{
-		content: completed_context.res.bytes()
+		content: content
 	}
-} // handle_request_and_route is a unified function that creates the context,
+}
+
+// write_response serializes `res` like `res.bytes()`, but into `arena`, without
+// concatenating the response into a new string, and copying that into a new array
+fn write_response(mut arena fasthttp.Arena, res http.Response) []u8 {
+	arena.write_string('HTTP/')
+	arena.write_string(res.http_version)
+	arena.write_string(' ')
+	arena.write_decimal(res.status_code)
+	arena.write_string(' ')
+	arena.write_string(res.status_msg)
+	arena.write_string('\r\n')
+	arena.write_string(res.header.render(version: res.version()))
+	arena.write_string('\r\n')
+	arena.write_string(res.body)
+	return arena.bytes()
+}
 
+// handle_request_and_route is a unified function that creates the context,
 // runs middleware, and finds the correct route for a request.
 fn handle_request_and_route[A, X](mut app A, req http.Request, client_fd int, params RequestParams) &Context {
 	// Create and populate the `veb.Context` from the request.
@@ -138,6 +165,6 @@ fn handle_request_and_route[A, X](mut app A, req http.Request, client_fd int, pa
 	// Create a new user context and pass veb's context
 	mut user_context := X{}
 	user_context.Context = ctx
-	handle_route[A, X](mut app, mut user_context, url, host, params.routes)
+	handle_route[A, X](mut app, mut user_context, url, host, params.router)
 	return &user_context.Context
 }
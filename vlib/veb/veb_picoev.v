@@ -28,7 +28,7 @@ $if !new_veb ? {
 		mut pico_context := &RequestParams{
 			global_app:         unsafe { global_app }
 			controllers:        controllers_sorted
-			routes:             &routes
+			router:             build_router(routes)
 			timeout_in_seconds: params.timeout_in_seconds
 		}
 		pico_context.idx = []int{len: picoev.max_fds}
@@ -449,7 +449,7 @@ $if !new_veb ? {
 		// create a new user context and pass the veb's context
 		mut user_context := X{}
 		user_context.Context = ctx
-		handle_route[A, X](mut global_app, mut user_context, url, host, params.routes)
+		handle_route[A, X](mut global_app, mut user_context, url, host, params.router)
 		// we need to explicitly tell the V compiler to return a reference
 		return &user_context.Context
 	}